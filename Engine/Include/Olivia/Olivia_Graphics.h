@@ -1,5 +1,11 @@
 #pragma once
 #include "graphics/vulkan_mesh.h"
+#include "graphics/vulkan_texture.h"
+#include "graphics/vulkan_shader.h"
+#include "graphics/vulkan_skinning.h"
+#include "graphics/vulkan_particles.h"
+#include "graphics/vulkan_upscale.h"
+#include "graphics/vulkan_lighting.h"
 
 namespace olivia
 {
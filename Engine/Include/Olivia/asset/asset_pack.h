@@ -0,0 +1,102 @@
+#pragma once
+#include "olivia/olivia_platform.h"
+#include "olivia/graphics/mesh_simplify.h"
+
+namespace olivia
+{
+	constexpr uint32_t ASSET_PACK_MAGIC{ 0x41564C4F }; // "OLVA"
+	constexpr uint32_t ASSET_PACK_VERSION{ 3 };
+
+	constexpr uint32_t ASSET_BLOCK_MIN_SIZE{ (uint32_t)KILOBYTES(64)  };
+	constexpr uint32_t ASSET_BLOCK_MAX_SIZE{ (uint32_t)KILOBYTES(256) };
+	constexpr uint32_t ASSET_BLOCK_DEFAULT_SIZE{ (uint32_t)KILOBYTES(128) };
+
+	enum asset_codec_t : uint32_t
+	{
+		ASSET_CODEC_NONE,
+		ASSET_CODEC_LZ4,
+		ASSET_CODEC_ZSTD
+	};
+
+	// --- on-disk layout: header | mesh table | block table | block data ---
+
+	struct asset_pack_header_t
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t block_size;
+		uint32_t mesh_count;
+		uint32_t block_count;
+		uint32_t reserved;
+		uint64_t data_offset;
+	};
+
+	struct asset_pack_mesh_t
+	{
+		uint32_t   vertex_count;
+		uint32_t   vertex_stride;
+		uint32_t   index_count;        // of every level, the full mesh first
+		uint32_t   first_vertex_block;
+		uint32_t   vertex_block_count;
+		uint32_t   first_index_block;
+		uint32_t   index_block_count;
+		uint32_t   lod_count;
+		mesh_lod_t lods[MAX_MESH_LODS];
+		aabb_t     bounds;             // object space, computed at write time so loading never reads the vertices back
+	};
+
+	struct asset_pack_block_t
+	{
+		uint64_t      offset;
+		uint32_t      compressed_size;
+		uint32_t      raw_size;
+		asset_codec_t codec;
+		uint32_t      reserved;
+	};
+
+	// --- build ---
+
+	struct asset_mesh_source_t
+	{
+		const void* vertices;
+		uint32_t    vertex_count;
+		uint32_t    vertex_stride;
+		const void* indices;
+		uint32_t    index_count;
+		float       lod_max_error; // 0 stores the full mesh only
+	};
+
+	// meshes with a lod_max_error get their LOD chain generated here. the bounds are computed
+	// here too, the vertex position must be the first member of the vertex
+	bool write_asset_pack(const char* path, const asset_mesh_source_t* meshes, uint32_t mesh_count, asset_codec_t codec, uint32_t block_size);
+
+	// --- load ---
+
+	struct asset_pack_t
+	{
+		file_map_t                 file;
+		const asset_pack_header_t* header;
+		const asset_pack_mesh_t*   meshes;
+		const asset_pack_block_t*  blocks;
+	};
+
+	struct asset_block_target_t
+	{
+		uint32_t block;
+		void*    destination;
+		size_t   capacity;    // bytes the destination can take, a larger block fails the decode
+	};
+
+	// checks the tables and every block's range against the file before anything is read from them
+	bool open_asset_pack(const char* path, asset_pack_t& pack);
+
+	void close_asset_pack(asset_pack_t& pack);
+
+	bool decompress_asset_block(const asset_pack_t& pack, uint32_t block, void* destination, size_t capacity);
+
+	// decodes every target on the job system; each block is decoded into a
+	// cache-resident scratch buffer first so write-combined destinations
+	// (mapped upload memory) are only ever written sequentially
+	bool decompress_asset_blocks(const asset_pack_t& pack, const asset_block_target_t* targets, uint32_t count);
+
+} // olivia
@@ -0,0 +1,352 @@
+#pragma once
+#include "defines.h"
+
+#include <bit>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define OLIVIA_SSE2
+#endif
+
+namespace olivia
+{
+	// open addressing in the swiss table layout: every slot has a control byte that is
+	// empty, deleted, or 7 bits of the hash of its key. lookups compare a whole group of
+	// control bytes at once and only touch the keys whose 7 bits match
+	constexpr uint32_t HASH_MAP_GROUP_WIDTH{ 16 };
+	constexpr size_t   HASH_MAP_MIN_CAPACITY{ HASH_MAP_GROUP_WIDTH };
+
+	constexpr int8_t HASH_MAP_EMPTY{ -128 };
+	constexpr int8_t HASH_MAP_DELETED{ -2 };
+
+	template<typename _Kty, typename _Ty>
+	struct hash_map_slot_t
+	{
+		_Kty key;
+		_Ty  value;
+	};
+
+	// keys and values are copied bitwise like vector_t elements. integer, enum and pointer
+	// keys hash by value, anything else by its bytes, so struct keys need zeroed padding
+	template<typename _Kty, typename _Ty>
+	struct hash_map_t
+	{
+		int8_t*                     control;     // capacity + HASH_MAP_GROUP_WIDTH, the tail mirrors the first group
+		hash_map_slot_t<_Kty, _Ty>* slots;
+		size_t                      size;
+		size_t                      capacity;    // a power of two
+		size_t                      growth_left; // empty slots that may still be filled before a rehash
+	};
+
+	// --- hashing ---
+
+	inline uint64_t hash_mix(uint64_t x)
+	{
+		x ^= x >> 33;
+		x *= 0xFF51AFD7ED558CCDull;
+		x ^= x >> 33;
+		x *= 0xC4CEB9FE1A85EC53ull;
+		x ^= x >> 33;
+
+		return x;
+	}
+
+	inline uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0)
+	{
+		constexpr uint64_t MULTIPLIER{ 0x9E3779B97F4A7C15ull };
+
+		const uint8_t* bytes = (const uint8_t*)data;
+		uint64_t       hash  = seed ^ (size * MULTIPLIER);
+
+		for (; size >= 8; size -= 8, bytes += 8)
+		{
+			uint64_t chunk;
+			memcpy(&chunk, bytes, 8);
+
+			hash = (hash ^ hash_mix(chunk)) * MULTIPLIER;
+		}
+
+		if (size)
+		{
+			uint64_t tail{};
+			memcpy(&tail, bytes, size);
+
+			hash = (hash ^ hash_mix(tail)) * MULTIPLIER;
+		}
+
+		return hash_mix(hash);
+	}
+
+	template<typename _Kty>
+	uint64_t hash_key(const _Kty& key)
+	{
+		if constexpr (std::is_integral_v<_Kty> || std::is_enum_v<_Kty>)
+			return hash_mix((uint64_t)key);
+		else if constexpr (std::is_pointer_v<_Kty>)
+			return hash_mix((uint64_t)(uintptr_t)key);
+		else
+			return hash_bytes(&key, sizeof(_Kty));
+	}
+
+	template<typename _Kty>
+	bool hash_keys_equal(const _Kty& a, const _Kty& b)
+	{
+		if constexpr (std::is_integral_v<_Kty> || std::is_enum_v<_Kty> || std::is_pointer_v<_Kty>)
+			return a == b;
+		else
+			return memcmp(&a, &b, sizeof(_Kty)) == 0;
+	}
+
+	// --- control groups, bit i of a mask is the i-th slot of the group ---
+
+#ifdef OLIVIA_SSE2
+	typedef __m128i hash_group_t;
+
+	inline hash_group_t load_hash_group(const int8_t* control)        { return _mm_loadu_si128((const __m128i*)control); }
+	inline uint32_t     match_hash_group(hash_group_t group, int8_t h2) { return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2))); }
+	inline uint32_t     match_empty(hash_group_t group)                 { return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(HASH_MAP_EMPTY))); }
+	inline uint32_t     match_empty_or_deleted(hash_group_t group)      { return (uint32_t)_mm_movemask_epi8(_mm_cmplt_epi8(group, _mm_set1_epi8(-1))); }
+#else
+	struct hash_group_t { int8_t control[HASH_MAP_GROUP_WIDTH]; };
+
+	#define GROUP_MASK(expression) uint32_t r{}; for (uint32_t i = 0; i < HASH_MAP_GROUP_WIDTH; ++i) { r |= (expression) ? 1u << i : 0u; } return r
+
+	inline hash_group_t load_hash_group(const int8_t* control)        { hash_group_t group; memcpy(group.control, control, HASH_MAP_GROUP_WIDTH); return group; }
+	inline uint32_t     match_hash_group(hash_group_t group, int8_t h2) { GROUP_MASK(group.control[i] == h2); }
+	inline uint32_t     match_empty(hash_group_t group)                 { GROUP_MASK(group.control[i] == HASH_MAP_EMPTY); }
+	inline uint32_t     match_empty_or_deleted(hash_group_t group)      { GROUP_MASK(group.control[i] < -1); }
+
+	#undef GROUP_MASK
+#endif
+
+	// --- map ---
+
+	// at most 7/8 of the slots are full, so every probe ends at an empty slot
+	inline size_t hash_map_max_load(size_t capacity)
+	{
+		return capacity - capacity / 8;
+	}
+
+	template<typename _Kty, typename _Ty>
+	void set_hash_map_control(hash_map_t<_Kty, _Ty>& map, size_t index, int8_t control)
+	{
+		map.control[index] = control;
+
+		if (index < HASH_MAP_GROUP_WIDTH)
+		{
+			map.control[map.capacity + index] = control;
+		}
+	}
+
+	// the first empty or deleted slot on the key's probe sequence
+	template<typename _Kty, typename _Ty>
+	size_t find_hash_map_insert_index(const hash_map_t<_Kty, _Ty>& map, uint64_t hash)
+	{
+		const size_t mask     = map.capacity - 1;
+		size_t       position = (size_t)(hash >> 7) & mask;
+
+		// triangular steps, which visit every group of a power of two table
+		for (size_t step = HASH_MAP_GROUP_WIDTH;; step += HASH_MAP_GROUP_WIDTH)
+		{
+			uint32_t free = match_empty_or_deleted(load_hash_group(map.control + position));
+			if (free)
+				return (position + std::countr_zero(free)) & mask;
+
+			position = (position + step) & mask;
+		}
+	}
+
+	// SIZE_MAX when the key is not in the map
+	template<typename _Kty, typename _Ty>
+	size_t find_hash_map_index(const hash_map_t<_Kty, _Ty>& map, const _Kty& key, uint64_t hash)
+	{
+		const size_t mask     = map.capacity - 1;
+		const int8_t h2       = (int8_t)(hash & 0x7F);
+		size_t       position = (size_t)(hash >> 7) & mask;
+
+		for (size_t step = HASH_MAP_GROUP_WIDTH;; step += HASH_MAP_GROUP_WIDTH)
+		{
+			hash_group_t group = load_hash_group(map.control + position);
+
+			for (uint32_t match = match_hash_group(group, h2); match; match &= match - 1)
+			{
+				size_t index = (position + std::countr_zero(match)) & mask;
+				if (hash_keys_equal(map.slots[index].key, key))
+					return index;
+			}
+
+			// an empty slot ends every probe sequence that went through this group
+			if (match_empty(group))
+				return SIZE_MAX;
+
+			position = (position + step) & mask;
+		}
+	}
+
+	template<typename _Kty, typename _Ty>
+	void hash_map_rehash(hash_map_t<_Kty, _Ty>& map, size_t capacity)
+	{
+		assert(std::has_single_bit(capacity) && capacity >= HASH_MAP_MIN_CAPACITY && "capacity must be a power of two");
+		assert(hash_map_max_load(capacity) >= map.size && "capacity too small");
+
+		hash_map_t<_Kty, _Ty> rehashed{};
+
+		rehashed.capacity    = capacity;
+		rehashed.size        = map.size;
+		rehashed.growth_left = hash_map_max_load(capacity) - map.size;
+		rehashed.control     = (int8_t*)malloc(capacity + HASH_MAP_GROUP_WIDTH);
+		rehashed.slots       = (hash_map_slot_t<_Kty, _Ty>*)calloc(capacity, sizeof(hash_map_slot_t<_Kty, _Ty>));
+
+		assert(rehashed.control && rehashed.slots && "hash map allocation failed");
+
+		memset(rehashed.control, HASH_MAP_EMPTY, capacity + HASH_MAP_GROUP_WIDTH);
+
+		// keys are unique already, only free slots are searched for
+		for (size_t i = 0; i < map.capacity; ++i)
+		{
+			if (map.control[i] < 0)
+				continue;
+
+			size_t index = find_hash_map_insert_index(rehashed, hash_key(map.slots[i].key));
+
+			set_hash_map_control(rehashed, index, map.control[i]);
+			rehashed.slots[index] = map.slots[i];
+		}
+
+		free(map.control);
+		free(map.slots);
+
+		map = rehashed;
+	}
+
+	// the smallest capacity that holds count entries
+	inline size_t hash_map_capacity_for(size_t count)
+	{
+		size_t capacity = HASH_MAP_MIN_CAPACITY;
+		while (hash_map_max_load(capacity) < count)
+		{
+			capacity *= 2;
+		}
+
+		return capacity;
+	}
+
+	// room for count entries without a rehash
+	template<typename _Kty, typename _Ty>
+	auto create_hash_map(size_t count)
+	{
+		hash_map_t<_Kty, _Ty> map{};
+		hash_map_rehash(map, hash_map_capacity_for(count));
+
+		return map;
+	}
+
+	template<typename _Kty, typename _Ty>
+	void destroy_hash_map(hash_map_t<_Kty, _Ty>& map)
+	{
+		free(map.control);
+		free(map.slots);
+	}
+
+	template<typename _Kty, typename _Ty>
+	void hash_map_reserve(hash_map_t<_Kty, _Ty>& map, size_t count)
+	{
+		size_t capacity = hash_map_capacity_for(count);
+		if (capacity > map.capacity)
+		{
+			hash_map_rehash(map, capacity);
+		}
+	}
+
+	template<typename _Kty, typename _Ty>
+	void hash_map_clear(hash_map_t<_Kty, _Ty>& map)
+	{
+		memset(map.control, HASH_MAP_EMPTY, map.capacity + HASH_MAP_GROUP_WIDTH);
+
+		map.size        = 0;
+		map.growth_left = hash_map_max_load(map.capacity);
+	}
+
+	// nullptr when the key is not in the map; the pointer is valid until the next insert
+	template<typename _Kty, typename _Ty>
+	_Ty* hash_map_find(const hash_map_t<_Kty, _Ty>& map, const std::type_identity_t<_Kty>& key)
+	{
+		size_t index = find_hash_map_index(map, key, hash_key(key));
+		return index != SIZE_MAX ? &map.slots[index].value : nullptr;
+	}
+
+	// inserts or overwrites, returns where the value lives until the next insert
+	template<typename _Kty, typename _Ty>
+	_Ty* hash_map_insert(hash_map_t<_Kty, _Ty>& map, const std::type_identity_t<_Kty>& key, const std::type_identity_t<_Ty>& value)
+	{
+		const uint64_t hash = hash_key(key);
+
+		size_t index = find_hash_map_index(map, key, hash);
+		if (index != SIZE_MAX)
+		{
+			map.slots[index].value = value;
+			return &map.slots[index].value;
+		}
+
+		index = find_hash_map_insert_index(map, hash);
+
+		// deleted slots are reused for free, filling an empty one takes from the load budget
+		if (map.control[index] == HASH_MAP_EMPTY && map.growth_left == 0)
+		{
+			// with enough tombstones, clean them out at the same size: the table stays at most
+			// 25/32 full and an erase-heavy workload does not keep doubling it
+			size_t capacity = map.size * 32 <= map.capacity * 25 ? map.capacity : map.capacity * 2;
+
+			hash_map_rehash(map, capacity);
+			index = find_hash_map_insert_index(map, hash);
+		}
+
+		map.growth_left -= map.control[index] == HASH_MAP_EMPTY;
+		++map.size;
+
+		set_hash_map_control(map, index, (int8_t)(hash & 0x7F));
+		map.slots[index] = { key, value };
+
+		return &map.slots[index].value;
+	}
+
+	template<typename _Kty, typename _Ty>
+	bool hash_map_erase(hash_map_t<_Kty, _Ty>& map, const std::type_identity_t<_Kty>& key)
+	{
+		size_t index = find_hash_map_index(map, key, hash_key(key));
+		if (index == SIZE_MAX)
+			return false;
+
+		const size_t mask = map.capacity - 1;
+
+		// when no group window around the slot was ever full, no probe sequence went past
+		// it and the slot can become empty again instead of a tombstone
+		uint16_t empty_before = (uint16_t)match_empty(load_hash_group(map.control + ((index - HASH_MAP_GROUP_WIDTH) & mask)));
+		uint16_t empty_after  = (uint16_t)match_empty(load_hash_group(map.control + index));
+
+		bool was_never_full = empty_before && empty_after &&
+			(size_t)(std::countr_zero(empty_after) + std::countl_zero(empty_before)) < HASH_MAP_GROUP_WIDTH;
+
+		set_hash_map_control(map, index, was_never_full ? HASH_MAP_EMPTY : HASH_MAP_DELETED);
+
+		map.growth_left += was_never_full;
+		--map.size;
+
+		return true;
+	}
+
+	// the first full slot at or after index, capacity when there is none:
+	// for (size_t i = hash_map_next(map, 0); i < map.capacity; i = hash_map_next(map, i + 1))
+	template<typename _Kty, typename _Ty>
+	size_t hash_map_next(const hash_map_t<_Kty, _Ty>& map, size_t index)
+	{
+		while (index < map.capacity && map.control[index] < 0)
+		{
+			++index;
+		}
+
+		return index;
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "hash_map.h"
+#include "vector.h"
+
+namespace olivia
+{
+	// ids are dense, start at 0 and never change, so they fit in components, asset
+	// tables and hash map keys where the string itself would not
+	typedef uint32_t string_id_t;
+
+	constexpr string_id_t INVALID_STRING_ID{ UINT32_MAX };
+
+	struct string_interner_t
+	{
+		hash_map_t<uint64_t, string_id_t> ids;     // string hash -> id, a colliding string is rehashed with the next seed
+		vector_t<char>                    chars;   // every string, null terminated
+		vector_t<uint32_t>                offsets; // id -> offset in chars
+	};
+
+	inline string_interner_t create_string_interner(size_t string_count)
+	{
+		string_interner_t interner{};
+
+		interner.ids     = create_hash_map<uint64_t, string_id_t>(string_count);
+		interner.chars   = create_vector<char>(string_count * 16 + 1);
+		interner.offsets = create_vector<uint32_t>(string_count + 1);
+
+		return interner;
+	}
+
+	inline void destroy_string_interner(string_interner_t& interner)
+	{
+		destroy_hash_map(interner.ids);
+		destroy_vector(interner.chars);
+		destroy_vector(interner.offsets);
+	}
+
+	// valid until the next string is interned
+	inline const char* get_interned_string(const string_interner_t& interner, string_id_t id)
+	{
+		assert(id < interner.offsets.size && "invalid string id");
+		return interner.chars.data + interner.offsets.data[id];
+	}
+
+	inline bool interned_string_equals(const string_interner_t& interner, string_id_t id, const char* str, size_t length)
+	{
+		const char* interned = get_interned_string(interner, id);
+		return memcmp(interned, str, length) == 0 && interned[length] == '\0';
+	}
+
+	// INVALID_STRING_ID when the string was never interned
+	inline string_id_t find_string_id(const string_interner_t& interner, const char* str, size_t length)
+	{
+		for (uint64_t seed = 0;; ++seed)
+		{
+			string_id_t* id = hash_map_find(interner.ids, hash_bytes(str, length, seed));
+			if (!id)
+				return INVALID_STRING_ID;
+
+			if (interned_string_equals(interner, *id, str, length))
+				return *id;
+		}
+	}
+
+	inline string_id_t intern_string(string_interner_t& interner, const char* str, size_t length)
+	{
+		uint64_t hash = 0;
+
+		for (uint64_t seed = 0;; ++seed)
+		{
+			hash = hash_bytes(str, length, seed);
+
+			string_id_t* id = hash_map_find(interner.ids, hash);
+			if (!id)
+				break;
+
+			if (interned_string_equals(interner, *id, str, length))
+				return *id;
+		}
+
+		assert(interner.chars.size + length + 1 <= UINT32_MAX && "string interner full");
+
+		string_id_t id = (string_id_t)interner.offsets.size;
+
+		vector_push_back(interner.offsets, (uint32_t)interner.chars.size);
+
+		if (interner.chars.size + length + 1 > interner.chars.capacity)
+		{
+			size_t capacity = interner.chars.capacity * VECTOR_SCALE;
+			while (capacity < interner.chars.size + length + 1)
+			{
+				capacity *= VECTOR_SCALE;
+			}
+
+			vector_reserve(interner.chars, capacity);
+		}
+
+		memcpy(interner.chars.data + interner.chars.size, str, length);
+		interner.chars.data[interner.chars.size + length] = '\0';
+		interner.chars.size += length + 1;
+
+		hash_map_insert(interner.ids, hash, id);
+
+		return id;
+	}
+
+	inline string_id_t intern_string(string_interner_t& interner, const char* str)
+	{
+		return intern_string(interner, str, strlen(str));
+	}
+
+	inline string_id_t find_string_id(const string_interner_t& interner, const char* str)
+	{
+		return find_string_id(interner, str, strlen(str));
+	}
+}
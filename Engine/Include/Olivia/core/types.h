@@ -6,4 +6,6 @@ namespace olivia
 	struct vec3_t { float x, y, z;    };
 	struct vec4_t { float x, y, z, w; };
 
+	struct aabb_t { vec3_t min, max; };
+
 } // olivia
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include "defines.h"
 
+#include <cstring>
+
 namespace olivia
 {
 	constexpr uint32_t VECTOR_SCALE{ 2 };
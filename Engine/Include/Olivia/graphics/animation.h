@@ -0,0 +1,96 @@
+#pragma once
+#include "olivia/olivia_core.h"
+
+namespace olivia
+{
+	// skin_vertex_t stores 8 bit joint indices
+	constexpr uint32_t MAX_JOINTS{ 256 };
+
+	// joints are decompressed, blended and converted this many at a time, one sse register
+	constexpr uint32_t JOINT_LANES{ 4 };
+
+	constexpr uint32_t ANIMATIONS_PER_JOB{ 8 };
+
+	constexpr uint16_t NO_PARENT{ UINT16_MAX };
+
+	struct joint_transform_t
+	{
+		vec4_t rotation;    // unit quaternion
+		vec3_t translation;
+		float  scale;       // uniform
+	};
+
+	// affine 3x4 in rows, the layout the skinning shader reads
+	struct joint_matrix_t
+	{
+		vec4_t rows[3];
+	};
+
+	// 16 bytes; the rotation keeps the three smallest quaternion components, translation
+	// and scale are quantized over the range of the clip
+	struct joint_key_t
+	{
+		int16_t  rotation[3];
+		uint16_t largest;       // the dropped component, stored ones follow it cyclically
+		uint16_t translation[3];
+		uint16_t scale;
+	};
+
+	struct animation_clip_t
+	{
+		uint32_t           joint_count;
+		uint32_t           frame_count;
+		float              frame_rate;
+		vec3_t             translation_min;
+		vec3_t             translation_extent;
+		float              scale_min;
+		float              scale_extent;
+		const joint_key_t* keys;        // frame major, frame_count * joint_count
+	};
+
+	struct skeleton_t
+	{
+		uint32_t              joint_count;
+		const uint16_t*       parents;      // a parent comes before its children
+		const joint_matrix_t* inverse_bind;
+	};
+
+	// JOINT_LANES joints, one lane array per component
+	struct alignas(16) joint_block_t
+	{
+		float rotation[4][JOINT_LANES];
+		float translation[3][JOINT_LANES];
+		float scale[JOINT_LANES];
+	};
+
+	struct pose_t
+	{
+		joint_block_t blocks[MAX_JOINTS / JOINT_LANES];
+	};
+
+	struct animation_instance_t
+	{
+		const skeleton_t*       skeleton;
+		const animation_clip_t* clips[2];
+		float                   times[2];   // seconds, clips loop
+		float                   blend;      // weight of clips[1], which may be null at 0
+		joint_matrix_t*         palette;    // skeleton->joint_count skinning matrices
+	};
+
+	// quantizes frame_count * joint_count transforms (frame major) into keys
+	void compress_animation(const joint_transform_t* transforms, uint32_t joint_count, uint32_t frame_count, float frame_rate, joint_key_t* keys, animation_clip_t& clip);
+
+	// interpolates the two keyframes around time, the clip loops
+	void sample_animation(const animation_clip_t& clip, float time, pose_t& pose);
+
+	void blend_poses(const pose_t& a, const pose_t& b, float weight, uint32_t joint_count, pose_t& pose);
+
+	// model space joint transforms times the inverse bind matrices
+	void compute_skinning_palette(const skeleton_t& skeleton, const pose_t& pose, joint_matrix_t* palette);
+
+	joint_transform_t get_joint_transform(const pose_t& pose, uint32_t joint);
+
+	// samples, blends and converts the instances on the job system, returns once all are done
+	void update_animations(const animation_instance_t* instances, uint32_t count);
+
+} // olivia
@@ -0,0 +1,117 @@
+#pragma once
+#include "olivia/olivia_core.h"
+#include "olivia/core/vector.h"
+
+namespace olivia
+{
+	// children per node, one sse register per bound component
+	constexpr uint32_t BVH_WIDTH{ 4 };
+
+	// ranges at most this size become leaves
+	constexpr uint32_t BVH_LEAF_SIZE{ 4 };
+
+	constexpr uint32_t BVH_SAH_BINS{ 16 };
+
+	// a culling query is split into about this many jobs
+	constexpr uint32_t BVH_CULL_TASKS{ 128 };
+
+	constexpr uint32_t RAYS_PER_JOB{ 256 };
+
+	constexpr uint32_t BVH_INVALID{ UINT32_MAX };
+
+	// 128 bytes, the bounds of the children in lanes; an empty slot has inverted bounds
+	// and never passes a test
+	struct alignas(16) bvh_node_t
+	{
+		float    min_x[BVH_WIDTH];
+		float    min_y[BVH_WIDTH];
+		float    min_z[BVH_WIDTH];
+		float    max_x[BVH_WIDTH];
+		float    max_y[BVH_WIDTH];
+		float    max_z[BVH_WIDTH];
+		uint32_t children[BVH_WIDTH]; // node index, or the first item of a leaf
+		uint32_t counts[BVH_WIDTH];   // item count of a leaf, 0 for nodes and empty slots
+	};
+
+	// the items a subtree covers, contiguous since the build partitions in place
+	struct bvh_range_t
+	{
+		uint32_t first;
+		uint32_t count;
+	};
+
+	// nodes are stored parents first, the root is node 0
+	struct bvh_t
+	{
+		vector_t<bvh_node_t>  nodes;
+		vector_t<bvh_range_t> ranges;    // per node
+		vector_t<uint32_t>    parents;   // per node, BVH_INVALID for the root
+		vector_t<uint32_t>    items;     // instance indices in leaf order
+		vector_t<uint32_t>    leaves;    // per instance, the node whose slot holds it
+		vector_t<aabb_t>      bounds;    // per instance
+		vector_t<uint8_t>     dirty;     // per node, bounds to refit
+		uint32_t              instance_count;
+		uint32_t              dirty_count;
+	};
+
+	// planes point inwards, a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+	struct frustum_t
+	{
+		vec4_t planes[6];
+	};
+
+	struct bvh_cull_query_t
+	{
+		frustum_t frustum;
+		uint32_t* visible;       // instance_count entries, filled in leaf order
+		uint32_t  visible_count;
+	};
+
+	struct ray_t
+	{
+		vec3_t origin;
+		float  t_max;
+		vec3_t direction;
+	};
+
+	// the closest instance bounds along the ray, instance is BVH_INVALID on a miss
+	struct ray_hit_t
+	{
+		uint32_t instance;
+		float    t;
+	};
+
+	// --- bounds ---
+
+	aabb_t compute_aabb(const vec3_t* positions, uint32_t count, uint32_t stride);
+
+	// bounds of the box transformed by a column major 4x4 affine matrix
+	aabb_t transform_aabb(const aabb_t& aabb, const float* matrix);
+
+	// from a column major view projection with vulkan depth, reverse-Z and infinite far
+	// planes included
+	frustum_t make_frustum(const float* view_projection);
+
+	bool is_aabb_visible(const frustum_t& frustum, const aabb_t& aabb);
+
+	// --- bvh ---
+
+	// binned SAH over the instance bounds; rebuilding replaces the previous tree
+	void build_bvh(bvh_t& bvh, const aabb_t* bounds, uint32_t instance_count);
+
+	void destroy_bvh(bvh_t& bvh);
+
+	// moves an instance, its ancestors are refit by the next refit_bvh
+	void update_bvh_instance(bvh_t& bvh, uint32_t instance, const aabb_t& bounds);
+
+	// refits the nodes above updated instances; the topology is kept, so rebuild once
+	// instances have moved far from where the build put them
+	void refit_bvh(bvh_t& bvh);
+
+	// every query's culling is split into jobs over subtrees, all of them run together
+	void cull_bvh(const bvh_t& bvh, bvh_cull_query_t* queries, uint32_t query_count);
+
+	// rays are traced on the job system, RAYS_PER_JOB at a time
+	void intersect_bvh(const bvh_t& bvh, const ray_t* rays, uint32_t ray_count, ray_hit_t* hits);
+
+} // olivia
@@ -0,0 +1,41 @@
+#pragma once
+#include "olivia/core/defines.h"
+
+namespace olivia
+{
+	constexpr float DEFAULT_FRAME_TIME_TARGET_MS{ 1000.0f / 60.0f };
+
+	// weight of a new measurement in the smoothed cost: rises are followed faster than
+	// drops, a missed frame is worse than a few blurry ones
+	constexpr float DYNAMIC_RESOLUTION_RISE{ 0.6f };
+	constexpr float DYNAMIC_RESOLUTION_FALL{ 0.2f };
+
+	// relative to the target, the scale is left alone while the predicted frame time stays
+	// inside the band so noise does not resize every frame. the band sits mostly under the
+	// target, being over it is corrected almost right away
+	constexpr float DYNAMIC_RESOLUTION_OVER{ 0.01f };
+	constexpr float DYNAMIC_RESOLUTION_UNDER{ 0.05f };
+
+	// the gpu time of a frame is modelled as cost * scale^2, cost being what the frame would
+	// take at full resolution. fixed costs (the upscale, compute) make the model wrong away
+	// from the measured scale, re-measuring every frame still converges as long as they fit
+	// in the target
+	struct dynamic_resolution_t
+	{
+		float target_ms;
+		float min_scale;
+		float max_scale;
+		float scale;     // per axis, for the next frame
+		float cost;      // smoothed full resolution ms, 0 before the first measurement
+	};
+
+	dynamic_resolution_t create_dynamic_resolution(float target_ms, float min_scale = 0.5f, float max_scale = 1.0f);
+
+	// gpu_ms was measured on a frame rendered at measured_scale, with frames in flight an
+	// older one than controller.scale; returns the scale for the next frame
+	float update_dynamic_resolution(dynamic_resolution_t& controller, float gpu_ms, float measured_scale);
+
+	// the scaled extent, at least one pixel per axis
+	void scale_extent(uint32_t width, uint32_t height, float scale, uint32_t& scaled_width, uint32_t& scaled_height);
+
+} // olivia
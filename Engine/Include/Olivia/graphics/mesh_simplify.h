@@ -0,0 +1,56 @@
+#pragma once
+#include "olivia/olivia_core.h"
+
+namespace olivia
+{
+	// collapses per pass at most this fraction of what is left to remove, so collapses
+	// are picked from fresh costs
+	constexpr float SIMPLIFY_PASS_FRACTION{ 0.25f };
+
+	// triangle normals may turn this far (cosine) before a collapse is rejected as a fold
+	constexpr float SIMPLIFY_MIN_NORMAL_DOT{ 0.2f };
+
+	constexpr uint32_t MAX_MESH_LODS{ 4 };
+
+	// a level is only kept when it has at most this fraction of the previous level's indices
+	constexpr float MESH_LOD_MIN_REDUCTION{ 0.75f };
+
+	// one level of a mesh, first_index counts from the mesh's first index
+	struct mesh_lod_t
+	{
+		uint32_t first_index;
+		uint32_t index_count;
+		float    error;       // object space
+	};
+
+	struct lod_selection_t
+	{
+		float pixels_per_unit; // projected size of one unit at distance 1: viewport height / (2 tan(fov_y / 2))
+		float max_pixel_error;
+		float hysteresis;      // moving to a coarser level needs the error this fraction under max_pixel_error
+	};
+
+	// collapses edges onto one of their endpoints, cheapest quadric error first, until at
+	// most target_index_count indices remain or the next collapse would move the surface
+	// further than max_error. the vertices are not touched, so every level of a LOD chain
+	// indexes the same vertex range. vertices on open borders (which includes normal and
+	// uv seams, the vertices there are split) never move. returns the index count written
+	// to destination, error is the object space distance to the original surface.
+	uint32_t simplify_mesh(const vec3_t* positions, uint32_t vertex_count, uint32_t stride,
+		const uint32_t* indices, uint32_t index_count, uint32_t target_index_count, float max_error,
+		uint32_t* destination, float& error);
+
+	// writes the full mesh followed by up to MAX_MESH_LODS - 1 levels, each aiming for half the
+	// triangles of the one before and simplified from the full mesh so its error is measured
+	// against the original. destination needs room for MAX_MESH_LODS * index_count indices.
+	// returns the level count, lods[0] being the full mesh
+	uint32_t generate_mesh_lods(const vec3_t* positions, uint32_t vertex_count, uint32_t stride,
+		const uint32_t* indices, uint32_t index_count, float max_error,
+		uint32_t* destination, mesh_lod_t* lods);
+
+	// the coarsest level whose error, projected at distance, stays under max_pixel_error;
+	// levels coarser than current_lod must also clear the hysteresis band
+	uint32_t select_mesh_lod(const mesh_lod_t* lods, uint32_t lod_count, float scale, float distance,
+		uint32_t current_lod, const lod_selection_t& selection);
+
+} // olivia
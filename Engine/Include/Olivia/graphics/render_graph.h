@@ -0,0 +1,199 @@
+#pragma once
+#include "olivia/core/defines.h"
+
+#include <vulkan/vulkan.h>
+
+namespace olivia
+{
+	using graph_resource_t = uint32_t;
+	using graph_pass_t     = uint32_t;
+
+	constexpr uint32_t GRAPH_MAX_PASSES{ 32 };
+	constexpr uint32_t GRAPH_MAX_RESOURCES{ 32 };
+	constexpr uint32_t GRAPH_MAX_PASS_ACCESSES{ 8 };
+	constexpr uint32_t GRAPH_MAX_BARRIERS{ GRAPH_MAX_PASSES * GRAPH_MAX_PASS_ACCESSES + GRAPH_MAX_RESOURCES };
+
+	constexpr uint32_t GRAPH_NOT_USED{ UINT32_MAX };
+
+	enum graph_access_t : uint32_t
+	{
+		GRAPH_ACCESS_NONE,
+		GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE,
+		GRAPH_ACCESS_COLOR_ATTACHMENT_READ_WRITE,
+		GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE,
+		GRAPH_ACCESS_DEPTH_ATTACHMENT_READ,
+		GRAPH_ACCESS_SAMPLED_FRAGMENT,
+		GRAPH_ACCESS_SAMPLED_COMPUTE,
+		GRAPH_ACCESS_STORAGE_READ_COMPUTE,
+		GRAPH_ACCESS_STORAGE_WRITE_COMPUTE,
+		GRAPH_ACCESS_STORAGE_READ_VERTEX,
+		GRAPH_ACCESS_STORAGE_READ_FRAGMENT,
+		GRAPH_ACCESS_VERTEX_READ,
+		GRAPH_ACCESS_INDIRECT_READ,
+		GRAPH_ACCESS_TRANSFER_READ,
+		GRAPH_ACCESS_TRANSFER_WRITE,
+		GRAPH_ACCESS_PRESENT,
+		GRAPH_ACCESS_COUNT
+	};
+
+	struct graph_access_info_t
+	{
+		VkPipelineStageFlags2 stage;
+		VkAccessFlags2        access;
+		VkImageLayout         layout;
+		bool                  write;
+	};
+
+	const graph_access_info_t& get_graph_access_info(graph_access_t access);
+
+	enum graph_resource_type_t : uint32_t
+	{
+		GRAPH_RESOURCE_IMAGE,
+		GRAPH_RESOURCE_BUFFER
+	};
+
+	struct graph_resource_desc_t
+	{
+		const char*           name;
+		graph_resource_type_t type;
+		bool                  imported;
+
+		// --- image ---
+
+		VkFormat              format;
+		VkExtent2D            extent;
+		VkImageAspectFlags    aspect;
+
+		// --- buffer ---
+
+		VkDeviceSize          size;
+
+		// --- imported ---
+
+		graph_access_t        initial_access;
+		graph_access_t        final_access;
+		bool                  preserve_contents;
+	};
+
+	struct graph_resource_state_t
+	{
+		VkPipelineStageFlags2 write_stage;
+		VkAccessFlags2        write_access;
+		VkPipelineStageFlags2 read_stages;
+		VkPipelineStageFlags2 visible_stages;
+		VkAccessFlags2        visible_access;
+		VkImageLayout         layout;
+		bool                  touched;
+	};
+
+	struct graph_barrier_t
+	{
+		graph_resource_t      resource;
+		VkPipelineStageFlags2 src_stage;
+		VkAccessFlags2        src_access;
+		VkPipelineStageFlags2 dst_stage;
+		VkAccessFlags2        dst_access;
+		VkImageLayout         old_layout;
+		VkImageLayout         new_layout;
+	};
+
+	struct graph_pass_access_t
+	{
+		graph_resource_t resource;
+		graph_access_t   access;
+	};
+
+	typedef void (*graph_execute_function)(VkCommandBuffer cmd, void* data);
+
+	struct graph_pass_desc_t
+	{
+		const char*            name;
+		graph_execute_function execute;
+		void*                  data;
+		graph_pass_access_t    accesses[GRAPH_MAX_PASS_ACCESSES];
+		uint32_t               access_count;
+		bool                   side_effects;
+	};
+
+	struct render_graph_t
+	{
+		graph_resource_desc_t  resources[GRAPH_MAX_RESOURCES];
+		uint32_t               resource_count;
+		graph_pass_desc_t      passes[GRAPH_MAX_PASSES];
+		uint32_t               pass_count;
+
+		// --- compiled ---
+
+		bool                   culled[GRAPH_MAX_PASSES];
+		uint32_t               first_use[GRAPH_MAX_RESOURCES];
+		uint32_t               last_use[GRAPH_MAX_RESOURCES];
+		VkImageUsageFlags      image_usage[GRAPH_MAX_RESOURCES];
+		VkBufferUsageFlags     buffer_usage[GRAPH_MAX_RESOURCES];
+
+		// barriers recorded before pass i are [pass_barriers[i], pass_barriers[i + 1]),
+		// the final transitions of imported resources follow the last pass
+		graph_barrier_t        barriers[GRAPH_MAX_BARRIERS];
+		uint32_t               barrier_count;
+		uint32_t               pass_barriers[GRAPH_MAX_PASSES + 1];
+
+		// --- transient memory ---
+
+		VkDeviceSize           alias_offset[GRAPH_MAX_RESOURCES];
+		VkDeviceSize           alias_size[GRAPH_MAX_RESOURCES];
+		VkDeviceSize           transient_size;
+		VkDeviceSize           transient_alignment;
+		uint32_t               transient_memory_types;
+		bool                   aliased;
+
+		// --- realized ---
+
+		VkImage                images[GRAPH_MAX_RESOURCES];
+		VkImageView            views[GRAPH_MAX_RESOURCES];
+		VkBuffer               buffers[GRAPH_MAX_RESOURCES];
+		void*                  transient_allocation;
+	};
+
+	void reset_render_graph(render_graph_t& graph);
+
+	graph_resource_t render_graph_create_image(render_graph_t& graph, const char* name, VkFormat format, VkExtent2D extent, VkImageAspectFlags aspect);
+
+	graph_resource_t render_graph_create_buffer(render_graph_t& graph, const char* name, VkDeviceSize size);
+
+	// initial_access is how the resource was last used before the graph runs, final_access how it is used after
+	graph_resource_t render_graph_import_image(render_graph_t& graph, const char* name, VkImageAspectFlags aspect, graph_access_t initial_access, graph_access_t final_access, bool preserve_contents);
+
+	graph_resource_t render_graph_import_buffer(render_graph_t& graph, const char* name, graph_access_t initial_access, graph_access_t final_access);
+
+	graph_pass_t render_graph_add_pass(render_graph_t& graph, const char* name, graph_execute_function execute, void* data);
+
+	void render_graph_use(render_graph_t& graph, graph_pass_t pass, graph_resource_t resource, graph_access_t access);
+
+	// passes with side effects are never culled even when nothing reads what they write
+	void render_graph_set_side_effects(render_graph_t& graph, graph_pass_t pass);
+
+	// culls passes, computes lifetimes/usage and the barrier set. When memory
+	// requirements are given (indexed by resource, only transients are read)
+	// transient resources with disjoint lifetimes are placed in shared memory
+	void compile_render_graph(render_graph_t& graph, const VkMemoryRequirements* requirements);
+
+	// --- vulkan ---
+
+	// compiles the graph and creates its transient resources in a single
+	// shared allocation. release before realizing a rebuilt graph again
+	void realize_render_graph(render_graph_t& graph);
+
+	// transients are destroyed once the frames in flight are done with them
+	void release_render_graph(render_graph_t& graph);
+
+	void render_graph_set_image(render_graph_t& graph, graph_resource_t resource, VkImage image, VkImageView view);
+
+	void render_graph_set_buffer(render_graph_t& graph, graph_resource_t resource, VkBuffer buffer);
+
+	VkImageView render_graph_get_view(const render_graph_t& graph, graph_resource_t resource);
+
+	VkBuffer render_graph_get_buffer(const render_graph_t& graph, graph_resource_t resource);
+
+	// records every pass that was not culled, each preceded by the barriers it needs
+	void execute_render_graph(render_graph_t& graph, VkCommandBuffer cmd);
+
+} // olivia
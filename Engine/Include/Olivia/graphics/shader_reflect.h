@@ -0,0 +1,77 @@
+#pragma once
+#include "olivia/core/defines.h"
+
+#include <vulkan/vulkan.h>
+
+namespace olivia
+{
+	constexpr uint32_t SPIRV_MAGIC{ 0x07230203 };
+
+	constexpr uint32_t MAX_SHADER_SETS{ 4 };
+	constexpr uint32_t MAX_SHADER_BINDINGS{ 32 };
+	constexpr uint32_t MAX_SHADER_INPUTS{ 16 };
+	constexpr uint32_t MAX_SPECIALIZATION_CONSTANTS{ 16 };
+
+	struct shader_binding_t
+	{
+		uint32_t           set;
+		uint32_t           binding;
+		VkDescriptorType   type;
+		uint32_t           count;  // arrays of descriptors
+		VkShaderStageFlags stages;
+	};
+
+	// one per location, a matrix takes one location per column
+	struct shader_input_t
+	{
+		uint32_t location;
+		VkFormat format;
+		uint32_t size;
+	};
+
+	struct shader_spec_constant_t
+	{
+		uint32_t id;
+		uint32_t default_value; // bools are 0 / 1
+	};
+
+	// what a pipeline layout and a vertex input state need; merging the
+	// reflections of a pipeline's stages (or of pipelines sharing a layout)
+	// unions the bindings
+	struct shader_reflection_t
+	{
+		VkShaderStageFlags     stages;
+		uint32_t               local_size[3];      // compute only
+
+		shader_binding_t       bindings[MAX_SHADER_BINDINGS];
+		uint32_t               binding_count;
+
+		uint32_t               push_constant_size;
+		VkShaderStageFlags     push_constant_stages;
+
+		shader_input_t         inputs[MAX_SHADER_INPUTS]; // vertex only, sorted by location
+		uint32_t               input_count;
+
+		shader_spec_constant_t spec_constants[MAX_SPECIALIZATION_CONSTANTS];
+		uint32_t               spec_constant_count;
+	};
+
+	// size in bytes; false when the code is not SPIR-V or uses more than the limits above
+	bool reflect_shader(const uint32_t* code, size_t size, shader_reflection_t& reflection);
+
+	// bindings present in both must agree on type and count
+	void merge_shader_reflection(shader_reflection_t& into, const shader_reflection_t& from);
+
+	const shader_binding_t* find_shader_binding(const shader_reflection_t& reflection, uint32_t set, uint32_t binding);
+
+	bool has_spec_constant(const shader_reflection_t& reflection, uint32_t id);
+
+	// every binding and push constant the shader uses is declared by the layout reflection,
+	// a reloaded shader that passes can reuse the pipeline layout made for the old one
+	bool is_layout_compatible(const shader_reflection_t& layout, const shader_reflection_t& shader);
+
+	// the inputs in [first_location, end_location) packed into one interleaved binding in location
+	// order, e.g. per vertex then per instance; returns the attribute count
+	uint32_t get_vertex_input_attributes(const shader_reflection_t& reflection, uint32_t binding, uint32_t first_location, uint32_t end_location, VkVertexInputAttributeDescription* attributes, uint32_t& stride);
+
+} // olivia
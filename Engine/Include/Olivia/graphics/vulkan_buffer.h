@@ -1,5 +1,5 @@
 #pragma once
-#include "vulkan_core.h"
+#include "vulkan_memory.h"
 
 namespace olivia
 {
@@ -10,7 +10,9 @@ namespace olivia
 		VmaAllocationInfo info;
 	};
 
-	vulkan_buffer_t create_vulkan_buffer(VkBufferUsageFlags usage_flags, VmaMemoryUsage memory_usage, VmaAllocationCreateFlags allocation_flags, VkDeviceSize size);
+	// shared buffers are used on both the graphics and the async compute queue. running out of
+	// memory evicts, drains the deferred destroys and retries once before it aborts
+	vulkan_buffer_t create_vulkan_buffer(memory_category_t category, VkBufferUsageFlags usage_flags, VmaMemoryUsage memory_usage, VmaAllocationCreateFlags allocation_flags, VkDeviceSize size, bool shared = false);
 
 	void destroy_vulkan_buffer(vulkan_buffer_t& buffer);
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 #include "olivia/olivia_core.h"
+#include "olivia/core/vector.h"
+#include "render_graph.h"
+#include "dynamic_resolution.h"
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_vulkan.h>
@@ -21,6 +24,73 @@ namespace olivia
 {
 	constexpr uint32_t MAX_FRAMES{ 2 };
 
+	// reverse-Z: projections map the near plane to 1 and the far plane to 0
+	constexpr float       DEPTH_CLEAR_VALUE{ 0.0f };
+	constexpr VkCompareOp DEPTH_COMPARE_OP{ VK_COMPARE_OP_GREATER_OR_EQUAL };
+
+	enum render_pass_t : uint32_t
+	{
+		RENDER_PASS_DEPTH_PREPASS,
+		RENDER_PASS_MAIN,
+		RENDER_PASS_UPSCALE, // dynamic resolution only, the scene into the swapchain image
+		RENDER_PASS_COUNT
+	};
+
+	constexpr uint32_t TIMESTAMPS_PER_FRAME{ RENDER_PASS_COUNT * 2 };
+
+	typedef void (*frame_draw_function)(void);
+
+	// both live next to the executable and are rewritten when they are stale
+	constexpr const char* PIPELINE_CACHE_PATH = "olivia_pipeline.cache";
+	constexpr const char* DEVICE_CACHE_PATH   = "olivia_device.cache";
+
+	constexpr uint32_t DEVICE_CACHE_MAGIC{ 0x44564C4F }; // "OLVD"
+	constexpr uint32_t DEVICE_CACHE_VERSION{ 2 };
+
+	struct device_cache_t
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vendor_id;
+		uint32_t device_id;
+		uint32_t driver_version;
+	};
+
+	// what device selection found, optional paths check these before using a feature
+	struct gpu_capabilities_t
+	{
+		bool         discrete;
+		VkDeviceSize device_local_size;
+		uint32_t     compute_queue_index;  // compute without graphics (async compute), UINT32_MAX when missing
+		uint32_t     transfer_queue_index; // transfer only (copy engine), UINT32_MAX when missing
+	};
+
+	constexpr uint32_t MAX_COMPUTE_JOBS{ 32 };
+
+	// records compute work only (dispatches, barriers, copies), on a compute-only family
+	// nothing else is available
+	typedef void (*compute_record_function)(VkCommandBuffer cmd, void* data);
+
+	struct compute_job_t
+	{
+		compute_record_function record;
+		void*                   data;
+		VkPipelineStageFlags2   consumer_stages; // where the frame's graphics work first reads the results
+	};
+
+	// initial capacity, the queue grows when a frame releases more (texture eviction, graph rebuilds)
+	constexpr uint32_t DEFERRED_DESTROY_CAPACITY{ 512 };
+
+	// destroyed once the timeline reaches timeline_value; any handle may be null
+	struct deferred_destroy_t
+	{
+		uint64_t      timeline_value;
+		VkImage       image;
+		VkImageView   view;
+		VkBuffer      buffer;
+		VmaAllocation allocation;
+	};
+
 	struct vulkan_core_t
 	{
 		SDL_Window*        window;
@@ -29,7 +99,10 @@ namespace olivia
 		VkPhysicalDevice   gpu;
 		VkQueue            queue;
 		uint32_t           graphics_queue_index;
+		gpu_capabilities_t capabilities;
 		VkDevice           device;
+		bool               memory_budget;
+		bool               texture_compression_bc;
 		VmaAllocator       allocator;
 		VkCommandPool      command_pool;
 		VkCommandBuffer    command_buffers[5];
@@ -37,23 +110,172 @@ namespace olivia
 		uint32_t           swapchain_size;
 		VkExtent2D         swapchain_extent;
 		VkSurfaceFormatKHR swapchain_format;
+		bool               vsync;
 		VkImage            swapchain_images[5];
 		VkImageView        swapchain_views[5];
+		VkFormat           depth_format;
+		VkImage            depth_image;
+		VmaAllocation      depth_allocation;
+		VkImageView        depth_view;
+		bool               depth_prepass;
 		VkSemaphore        present_image[5];
 		VkSemaphore        acquire_image[MAX_FRAMES];
-		VkFence            queue_submit[MAX_FRAMES];
 		uint32_t           current_frame;
 		uint32_t           image_index;
+		render_pass_t      current_pass;
+
+		// --- pipeline cache ---
+
+		// loaded from and saved to PIPELINE_CACHE_PATH, pass it to every pipeline creation
+		VkPipelineCache    pipeline_cache;
+
+		// --- async compute ---
+
+		// the graphics queue and family when the gpu has no compute-only family
+		VkQueue            compute_queue;
+		uint32_t           compute_queue_index;
+		bool               async_compute;
+		VkCommandPool      compute_command_pool;
+		VkCommandBuffer    compute_command_buffers[MAX_FRAMES];
+
+		// signaled by compute submits, the graphics submit of the same frame waits for it
+		VkSemaphore        compute_timeline;
+		uint64_t           compute_timeline_value;
+		VkFlags64          compute_wait_stages; // VkPipelineStageFlags2, 0 when nothing was submitted
+		compute_job_t      compute_jobs[MAX_COMPUTE_JOBS];
+		uint32_t           compute_job_count;
+
+		// --- timeline ---
+
+		// every submit signals the next value, a frame slot is reusable once
+		// the value of the submit that last used it is reached
+		VkSemaphore        timeline;
+		uint64_t           timeline_value;
+		uint64_t           frame_timeline[MAX_FRAMES];
+		vector_t<deferred_destroy_t> deferred;
+
+		// --- cpu timings ---
+
+		float              gpu_wait_ms;
+		float              acquire_wait_ms;
+
+		// --- gpu timings ---
+
+		VkQueryPool        timestamp_pool;
+		float              timestamp_period;
+		uint32_t           timestamp_mask[MAX_FRAMES];
+		float              gpu_pass_ms[RENDER_PASS_COUNT];
+		float              gpu_frame_ms;      // first pass begin to last pass end
+
+		// --- dynamic resolution ---
+
+		// the scene passes render into the top left render_extent of a swapchain sized
+		// target, the upscale pass stretches that over the swapchain image
+		bool                 dynamic_resolution;
+		float                fixed_render_scale; // 0 lets the controller pick
+		dynamic_resolution_t resolution;
+		VkExtent2D           render_extent;
+		float                frame_render_scale[MAX_FRAMES]; // what each frame slot was rendered at
+
+		// --- frame graph ---
+
+		render_graph_t     frame_graph;
+		graph_resource_t   frame_backbuffer;
+		graph_resource_t   frame_depth;
+		graph_resource_t   frame_scene;       // the offscreen target, dynamic resolution only
 	};
 
+	extern vulkan_core_t g_vulkan_core;
+
 	void init_vulkan_core(SDL_Window* window);
 
 	void destroy_vulkan_core();
 
 	void recreate_swapchain();
 
-	void begin_frame();
+	// returns false when the swapchain had to be recreated and the frame is skipped
+	bool begin_frame();
+
+	// runs the frame graph, draw is called once inside every scene pass that is not culled
+	// (not in the upscale pass)
+	void draw_frame(frame_draw_function draw);
+
+	// pipelines drawn inside a pass must declare depth test/write enable and
+	// depth compare op as dynamic state, the pass sets them
+	void begin_pass(render_pass_t pass);
+
+	void end_pass();
 
 	void end_frame();
+
+	void set_depth_prepass(bool enabled);
+
+	bool is_depth_prepass_enabled();
+
+	// without vsync the swapchain presents immediately (or mailbox) when the surface supports it
+	void set_vsync(bool enabled);
+
+	// --- dynamic resolution ---
+
+	// the scene is rendered into an offscreen target and upscaled into the swapchain image,
+	// its resolution follows the gpu frame time. refused (and logged) without the upscale
+	// shaders, without timestamp queries only a fixed scale changes it
+	void set_dynamic_resolution(bool enabled);
+
+	bool is_dynamic_resolution_enabled();
+
+	// frame time the controller aims for and the per axis scale range it may use
+	void set_dynamic_resolution_target(float target_ms, float min_scale = 0.5f, float max_scale = 1.0f);
+
+	// pins the scale (0 hands it back to the controller), for tests and captures
+	void set_fixed_render_scale(float scale);
+
+	// per axis, 1 without dynamic resolution
+	float get_render_scale();
+
+	// what the scene passes render at, viewports and projections use it
+	VkExtent2D get_render_extent();
+
+	// --- async compute ---
+
+	// the job is recorded by the next begin_frame and overlaps that frame's graphics work up to
+	// consumer_stages (and the tail of the previous frame). jobs must not write what the previous
+	// frame still reads, double-buffer such resources by g_vulkan_core.current_frame. a frame
+	// begin_frame skips drops its jobs
+	void schedule_compute(compute_record_function record, void* data, VkPipelineStageFlags2 consumer_stages);
+
+	// serialized mode records the jobs at the start of the graphics command buffer instead;
+	// async compute cannot be enabled without a compute-only family
+	void set_async_compute(bool enabled);
+
+	bool is_async_compute_enabled();
+
+	// the families resources used on both queues are shared between (VK_SHARING_MODE_CONCURRENT),
+	// returns 1 when both queues come from the same family and exclusive sharing is enough
+	uint32_t get_shared_queue_families(uint32_t families[2]);
+
+	float get_gpu_pass_time(render_pass_t pass);
+
+	// of the last measured frame, 0 without timestamps
+	float get_gpu_frame_time();
+
+	// time begin_frame spent blocked on the gpu finishing the frame slot / on the swapchain
+	float get_gpu_wait_time();
+
+	float get_acquire_wait_time();
+
+	// the value signaled by the submit of the frame being recorded
+	uint64_t get_frame_timeline_value();
+
+	uint64_t get_completed_timeline_value();
+
+	// blocks until the gpu reaches value, returns immediately when it already has
+	void wait_timeline_value(uint64_t value);
+
+	// for resources the frames in flight may still use; released at the start
+	// of the first frame after the current frame's submit has completed
+	void defer_destroy_image(VkImage image, VkImageView view, VmaAllocation allocation);
+
+	void defer_destroy_buffer(VkBuffer buffer, VmaAllocation allocation);
 }
 
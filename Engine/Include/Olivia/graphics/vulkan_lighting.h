@@ -0,0 +1,120 @@
+#pragma once
+#include "vulkan_mesh.h"
+#include "vulkan_shader.h"
+
+namespace olivia
+{
+	// the view frustum is split into a froxel grid: screen tiles times exponential depth slices
+	constexpr uint32_t LIGHT_CLUSTER_X{ 16 };
+	constexpr uint32_t LIGHT_CLUSTER_Y{ 9 };
+	constexpr uint32_t LIGHT_CLUSTER_Z{ 24 };
+	constexpr uint32_t LIGHT_CLUSTER_COUNT{ LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z };
+
+	// lights past this in one cluster are dropped, the binning keeps the first ones it finds
+	constexpr uint32_t MAX_LIGHTS_PER_CLUSTER{ 128 };
+	constexpr uint32_t MAX_LIGHTS{ 8192 };
+
+	// next to the executable, compiled from shaders/light_cull.comp and shaders/olivia.*
+	constexpr const char* LIGHT_CULL_SHADER_PATH    = "light_cull.comp.spv";
+	constexpr const char* MESH_VERTEX_SHADER_PATH   = "olivia.vert.spv";
+	constexpr const char* MESH_FRAGMENT_SHADER_PATH = "olivia.frag.spv";
+
+	// olivia.frag: false loops over every light, for comparisons
+	constexpr uint32_t LIGHTING_CLUSTERED_CONSTANT{ 0 };
+
+	// std430 layout of lighting_common.glsl
+	struct light_t
+	{
+		vec3_t position;  // world space
+		float  radius;    // the light ends here
+		vec3_t color;
+		float  intensity;
+	};
+
+	// the camera the clusters are built for. view space looks down +z with y down, projected
+	// reverse-Z with an infinite far plane: ndc = view.xy / (tan_half_fov * view.z) and
+	// depth = z_near / view.z
+	struct light_view_t
+	{
+		float view[16];         // column major, world to view
+		float tan_half_fov_x;
+		float tan_half_fov_y;
+		float z_near;
+		float z_far;            // of the last slice, farther fragments use it
+	};
+
+	// push constants of light_cull.comp
+	struct light_cull_t
+	{
+		float    view[16];
+		float    projection[4]; // tan_half_fov_x, tan_half_fov_y, z_near, z_far
+		uint32_t light_count;
+	};
+
+	// push constants of olivia.vert and olivia.frag
+	struct lit_draw_t
+	{
+		float    view_projection[16];
+		float    cluster_scale[4];  // clusters per pixel in x and y, depth slice scale and bias on log(view z)
+		float    z_near;
+		uint32_t light_count;
+	};
+
+	// lights and clusters are per frame slot: the binning of one frame overlaps the shading of
+	// the previous one on async compute
+	struct lighting_t
+	{
+		shader_reflection_t   cull_reflection; // what the layouts were made from
+		shader_reflection_t   draw_reflection;
+		VkDescriptorSetLayout set_layout;
+		VkDescriptorPool      descriptor_pool;
+		VkDescriptorSet       sets[MAX_FRAMES];
+		VkPipelineLayout      cull_layout;
+		VkPipelineLayout      draw_layout;
+		VkPipeline            cull;
+		VkPipeline            draw[2];         // all lights, clustered
+		vulkan_buffer_t       lights[MAX_FRAMES];
+		vulkan_buffer_t       cluster_counts[MAX_FRAMES];
+		vulkan_buffer_t       cluster_lights[MAX_FRAMES];
+
+		// --- gpu timings ---
+
+		VkQueryPool           timestamp_pool;
+		bool                  timestamps[2];   // graphics family, compute family
+		bool                  timestamp_written[MAX_FRAMES];
+		float                 gpu_ms;
+
+		// --- frame ---
+
+		// copied into the frame slot's buffer when the culling job records
+		light_t*              light_data;
+		uint32_t              light_count;
+		light_cull_t          cull_push;
+		uint32_t              frame_light_count[MAX_FRAMES]; // what each slot was binned with
+		float                 frame_z_near[MAX_FRAMES];
+		float                 frame_z_far[MAX_FRAMES];
+		uint64_t              frame_culled[MAX_FRAMES];      // timeline value of the frame that binned the slot
+	};
+
+	void init_lighting();
+
+	void destroy_lighting();
+
+	// the lights of the next frame, up to MAX_LIGHTS
+	void set_lights(const light_t* lights, uint32_t count);
+
+	// queues the light binning as a compute job (async when available), consumed by fragment
+	// shading; call after set_lights and before begin_frame
+	void schedule_light_culling(const light_view_t& view);
+
+	// inside the main pass: binds the lit mesh pipeline, its lights and the push constants.
+	// vertex binding 0 takes vertex3d_t (the mesh group), binding 1 a column major model
+	// matrix per instance. clustered = false shades every fragment with every light.
+	// returns false without binding outside the main pass, e.g. in the depth pre-pass, and
+	// shades without lights when no culling was scheduled for the frame
+	bool bind_lit_pipeline(VkCommandBuffer cmd, const float view_projection[16], bool clustered = true);
+
+	// of the binning job, from the frame slot begin_frame last waited for
+	float get_light_culling_gpu_time();
+
+} // olivia
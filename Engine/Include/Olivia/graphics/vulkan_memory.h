@@ -0,0 +1,136 @@
+#pragma once
+#include "vulkan_core.h"
+#include "olivia/core/hash_map.h"
+
+namespace olivia
+{
+	enum memory_category_t : uint32_t
+	{
+		MEMORY_CATEGORY_MESH,      // the mesh group's vertex, index and skin data
+		MEMORY_CATEGORY_STAGING,   // host visible upload memory
+		MEMORY_CATEGORY_TEXTURE,   // streamed texture mips
+		MEMORY_CATEGORY_BUFFER,    // long-lived device buffers of the gpu systems (skinning, particles, lighting)
+		MEMORY_CATEGORY_TRANSIENT, // attachments and the frame graph's aliased transients
+		MEMORY_CATEGORY_COUNT
+	};
+
+	// fractions of the heap budget: above the high mark the evictors are asked to release
+	// down to the low mark, streaming stays under the low mark so the two do not fight
+	constexpr float MEMORY_PRESSURE_HIGH{ 0.90f };
+	constexpr float MEMORY_PRESSURE_LOW{ 0.85f };
+
+	constexpr uint32_t MAX_MEMORY_EVICTORS{ 8 };
+
+	// ring buffers, the oldest entries are overwritten
+	constexpr uint32_t MEMORY_TIMELINE_EVENTS{ 16384 };
+	constexpr uint32_t MEMORY_TIMELINE_FRAMES{ 4096 };
+
+	// returns the bytes it is going to release; memory comes back once the frames in flight
+	// are done with it, so an evictor may also just lower a limit its next update honours
+	typedef VkDeviceSize (*memory_eviction_function)(VkDeviceSize bytes, void* data);
+
+	enum memory_event_type_t : uint32_t
+	{
+		MEMORY_EVENT_ALLOCATE,
+		MEMORY_EVENT_FREE,
+		MEMORY_EVENT_EVICT,             // size is what the evictor promised
+		MEMORY_EVENT_OVER_BUDGET,       // size is the heap usage
+		MEMORY_EVENT_ALLOCATION_FAILED
+	};
+
+	struct memory_event_t
+	{
+		uint64_t            time;
+		VkDeviceSize        size;
+		uint32_t            frame;
+		memory_category_t   category;
+		memory_event_type_t type;
+	};
+
+	struct memory_frame_t
+	{
+		uint64_t     time;
+		uint32_t     frame;
+		VkDeviceSize heap_usage;
+		VkDeviceSize heap_budget;
+		VkDeviceSize category_bytes[MEMORY_CATEGORY_COUNT];
+	};
+
+	struct memory_allocation_t
+	{
+		VkDeviceSize      size;
+		memory_category_t category;
+	};
+
+	struct memory_evictor_t
+	{
+		memory_eviction_function function;
+		void*                    data;
+		memory_category_t        category;
+	};
+
+	// main thread only, like every other allocation path of the renderer
+	struct memory_telemetry_t
+	{
+		hash_map_t<VmaAllocation, memory_allocation_t> allocations;
+
+		uint32_t         heap_index; // the largest device local heap, the one budgets are checked on
+		VmaBudget        heap;       // refreshed by update_memory_budget
+		uint32_t         frame;
+		uint64_t         start;
+
+		VkDeviceSize     category_bytes[MEMORY_CATEGORY_COUNT];
+		VkDeviceSize     category_peak[MEMORY_CATEGORY_COUNT];
+		uint32_t         category_allocations[MEMORY_CATEGORY_COUNT];
+
+		VkDeviceSize     peak_usage;
+		uint32_t         over_budget_frames;
+		uint32_t         failed_allocations;
+		uint32_t         last_eviction_frame;
+
+		memory_evictor_t evictors[MAX_MEMORY_EVICTORS];
+		uint32_t         evictor_count;
+
+		memory_event_t*  events;
+		uint64_t         event_count;
+		memory_frame_t*  frames;
+		uint64_t         frame_count;
+	};
+
+	// after the allocator is created / before it is destroyed, allocations still tracked then are leaks
+	void init_memory_telemetry();
+
+	void destroy_memory_telemetry();
+
+	// every VMA allocation of the renderer goes through these, untracking an unknown allocation does nothing
+	void track_allocation(VmaAllocation allocation, memory_category_t category);
+
+	void untrack_allocation(VmaAllocation allocation);
+
+	// for allocations that failed and were handled without aborting
+	void report_allocation_failure(memory_category_t category, VkDeviceSize size);
+
+	// called by begin_frame: samples the heap budget and asks the evictors for room under pressure
+	void update_memory_budget();
+
+	// evictors are asked in registration order until enough is promised
+	void register_memory_evictor(memory_category_t category, memory_eviction_function function, void* data);
+
+	// returns what the evictors promised
+	VkDeviceSize request_memory_eviction(VkDeviceSize bytes);
+
+	uint32_t get_memory_heap_index();
+
+	const VmaBudget& get_memory_budget();
+
+	VkDeviceSize get_memory_category_bytes(memory_category_t category);
+
+	const char* get_memory_category_name(memory_category_t category);
+
+	void log_memory_usage();
+
+	// the timeline as a chrome://tracing / Perfetto JSON trace: per-frame counters of the heap
+	// and of every category, allocation events as instants and the totals under "otherData"
+	bool write_memory_trace(const char* path);
+
+} // olivia
@@ -1,5 +1,7 @@
 #pragma once
 #include "vulkan_buffer.h"
+#include "bvh.h"
+#include "olivia/asset/asset_pack.h"
 
 namespace olivia
 {
@@ -7,6 +9,7 @@ namespace olivia
 
 	constexpr size_t MESH_GROUP_V_BUFFER_SIZE{ MEGABYTES(150) };
 	constexpr size_t MESH_GROUP_I_BUFFER_SIZE{ MEGABYTES(50)  };
+	constexpr size_t MESH_GROUP_S_BUFFER_SIZE{ MEGABYTES(16)  };
 
 	constexpr uint32_t MAX_MESHES{ 10 };
 
@@ -17,18 +20,32 @@ namespace olivia
 		vec2_t uv;
 	};
 
+	// the skinned-vertex stream, parallel to a skinned mesh's vertices
+	struct skin_vertex_t
+	{
+		uint8_t joints[4];
+		uint8_t weights[4]; // unorm, summing to 255
+	};
+
 	struct mesh_group_t
 	{
 		vulkan_buffer_t vertex_buffer;
 		vulkan_buffer_t index_buffer;
+		vulkan_buffer_t skin_buffer;
 		size_t		    v_bytes_used;
 		size_t          i_bytes_used;
+		size_t          s_bytes_used;
 		uint32_t        mesh_count;
 
 		uint32_t v_offset[MAX_MESHES];
 		uint32_t i_offset[MAX_MESHES];
+		uint32_t s_offset[MAX_MESHES]; // UINT32_MAX for meshes without a skin
 		uint32_t v_count[MAX_MESHES];
-		uint32_t i_count[MAX_MESHES];
+		uint32_t i_count[MAX_MESHES];  // of the full mesh, its LOD levels follow it
+		aabb_t   bounds[MAX_MESHES];   // object space, of the bind pose for skinned meshes
+
+		mesh_lod_t lods[MAX_MESHES][MAX_MESH_LODS]; // every level indexes the mesh's vertices
+		uint32_t   lod_count[MAX_MESHES];
 	};
 
 	void init_mesh_group();
@@ -37,4 +54,21 @@ namespace olivia
 
 	mesh_t upload_mesh(const void* vertices, uint32_t vertex_count, const void* indices, uint32_t index_count);
 
+	// reserves space in the mesh group and returns the mapped destinations to be filled by the caller,
+	// who also sets the bounds
+	mesh_t reserve_mesh(uint32_t vertex_count, uint32_t index_count, void** vertices, void** indices);
+
+	// like reserve_mesh, plus vertex_count skin vertices the skinning pass reads
+	mesh_t reserve_skinned_mesh(uint32_t vertex_count, uint32_t index_count, void** vertices, void** indices, skin_vertex_t** skin);
+
+	void set_mesh_bounds(mesh_t mesh, const aabb_t& bounds);
+
+	// for a mesh reserved with the indices of every level, lods[0] being the full mesh
+	void set_mesh_lods(mesh_t mesh, const mesh_lod_t* lods, uint32_t lod_count);
+
+	const mesh_group_t& get_mesh_group();
+
+	// decompresses every mesh of the pack in parallel straight into the mesh group, LOD chains included
+	bool load_mesh_pack(const asset_pack_t& pack, mesh_t* meshes);
+
 } // olivia
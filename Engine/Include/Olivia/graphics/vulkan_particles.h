@@ -0,0 +1,175 @@
+#pragma once
+#include "vulkan_buffer.h"
+#include "vulkan_shader.h"
+
+namespace olivia
+{
+	// the depth sort runs 1024 particles per workgroup, capacities are powers of two from here
+	constexpr uint32_t MIN_PARTICLE_CAPACITY{ 1024 };
+	constexpr uint32_t MAX_PARTICLE_EMITS{ 64 };
+
+	// next to the executable, compiled from shaders/particle_*
+	constexpr const char* PARTICLE_SETUP_SHADER_PATH    = "particle_setup.comp.spv";
+	constexpr const char* PARTICLE_EMIT_SHADER_PATH     = "particle_emit.comp.spv";
+	constexpr const char* PARTICLE_SIMULATE_SHADER_PATH = "particle_simulate.comp.spv";
+	constexpr const char* PARTICLE_SORT_SHADER_PATH     = "particle_sort.comp.spv";
+	constexpr const char* PARTICLE_VERTEX_SHADER_PATH   = "particle.vert.spv";
+	constexpr const char* PARTICLE_FRAGMENT_SHADER_PATH = "particle.frag.spv";
+
+	enum particle_shader_t : uint32_t
+	{
+		PARTICLE_SHADER_SETUP,
+		PARTICLE_SHADER_EMIT,
+		PARTICLE_SHADER_SIMULATE,
+		PARTICLE_SHADER_SORT,
+		PARTICLE_SHADER_VERTEX,
+		PARTICLE_SHADER_FRAGMENT,
+		PARTICLE_SHADER_COUNT
+	};
+
+	// particle.vert specialization constant, bool
+	constexpr uint32_t PARTICLE_SORTED_CONSTANT{ 0 };
+
+	// counters buffer, in uints; the simulate dispatch and the draws are indirect
+	constexpr uint32_t PARTICLE_COUNTER_DEAD{ 0 };
+	constexpr uint32_t PARTICLE_COUNTER_ALIVE_IN{ 1 };
+	constexpr uint32_t PARTICLE_COUNTER_ALIVE_OUT{ 2 };
+	constexpr uint32_t PARTICLE_COUNTER_SIMULATE{ 4 }; // VkDispatchIndirectCommand
+	constexpr uint32_t PARTICLE_COUNTER_DRAW{ 8 };     // VkDrawIndirectCommand per parity
+	constexpr uint32_t PARTICLE_COUNTER_COUNT{ 16 };
+
+	// push constants of one emission, count particles spawn around position with a random
+	// offset in [-spread, spread] and velocity in [velocity - velocity_spread, velocity + velocity_spread].
+	// color is premultiplied, an alpha of 0 blends additively and does not need the sort
+	struct particle_emit_t
+	{
+		vec3_t   position;
+		float    life;             // seconds
+		vec3_t   spread;
+		float    size;             // billboard half extent
+		vec3_t   velocity;
+		uint32_t count;
+		vec3_t   velocity_spread;
+		uint32_t seed;             // filled by emit_particles
+		vec4_t   color;
+	};
+
+	struct particle_simulate_t
+	{
+		vec3_t gravity;
+		float  dt;
+	};
+
+	enum particle_setup_mode_t : uint32_t
+	{
+		PARTICLE_SETUP_INIT,    // every particle dead
+		PARTICLE_SETUP_PREPARE, // last frame's output becomes the input, simulate args from its count
+		PARTICLE_SETUP_FINISH   // draw args of this frame's parity from the output count
+	};
+
+	struct particle_setup_t
+	{
+		uint32_t mode;
+		uint32_t parity;
+		uint32_t capacity;
+	};
+
+	enum particle_sort_mode_t : uint32_t
+	{
+		PARTICLE_SORT_KEYS,        // distance keys of the alive list, padded to capacity
+		PARTICLE_SORT_LOCAL,       // full bitonic sort of each 1024 key block in shared memory
+		PARTICLE_SORT_GLOBAL_STEP, // one compare-exchange step wider than a block
+		PARTICLE_SORT_LOCAL_MERGE  // the remaining steps of a merge inside each block
+	};
+
+	struct particle_sort_t
+	{
+		uint32_t mode;
+		uint32_t k;
+		uint32_t j;
+		uint32_t capacity;
+		vec3_t   camera_position;
+		float    pad;
+	};
+
+	struct particle_draw_t
+	{
+		float  view_projection[16]; // column major
+		vec4_t camera_right;
+		vec4_t camera_up;
+	};
+
+	// state and lists are double-buffered by parity: each frame reads the previous
+	// parity and writes its own, which the same frame draws. nothing is read back
+	//
+	// a frame overwrites what the frame before last drew, which is only finished once
+	// its slot was waited on; a third frame in flight would need a third copy
+	static_assert(MAX_FRAMES == 2, "particle ping-pong buffers assume two frames in flight");
+
+	struct particle_system_t
+	{
+		uint32_t              capacity;
+		vulkan_buffer_t       particles[2]; // 48 bytes each, indexed by particle
+		vulkan_buffer_t       alive[2];     // compacted particle indices
+		vulkan_buffer_t       sort_keys[2]; // uvec2 distance key, particle index
+		vulkan_buffer_t       dead;         // free particle indices
+		vulkan_buffer_t       counters;
+
+		// what the layouts were made from, reloaded shaders must fit them
+		shader_reflection_t   compute_reflection;
+		shader_reflection_t   draw_reflection;
+		VkDescriptorSetLayout set_layout;
+		VkDescriptorPool      descriptor_pool;
+		VkDescriptorSet       sets[2];      // by output parity
+		VkPipelineLayout      compute_layout;
+		VkPipelineLayout      draw_layout;
+		VkPipeline            setup;
+		VkPipeline            emit;
+		VkPipeline            simulate;
+		VkPipeline            sort;
+		VkPipeline            draw[2];      // unsorted, sorted
+
+		// --- gpu timings ---
+
+		VkQueryPool           timestamp_pool;
+		bool                  timestamps[2]; // graphics family, compute family
+		bool                  timestamp_written[MAX_FRAMES];
+		float                 gpu_ms;
+		float                 record_ms;
+
+		// --- frame ---
+
+		particle_emit_t       emits[MAX_PARTICLE_EMITS];
+		uint32_t              emit_count;
+		uint32_t              seed;
+		particle_simulate_t   step;
+		bool                  sorted;
+		vec3_t                camera_position;
+		uint32_t              parity;        // written by the last recorded frame
+		bool                  parity_sorted; // its sort keys are valid
+		bool                  initialized;
+	};
+
+	// capacity is rounded up to a power of two, at least MIN_PARTICLE_CAPACITY
+	void init_particles(uint32_t capacity);
+
+	// safe to call when init_particles was not
+	void destroy_particles();
+
+	// queued for the next schedule_particles, emission beyond the free particles is dropped
+	void emit_particles(const particle_emit_t& emit);
+
+	// queues emission, simulation and compaction (plus the back to front sort when sorted is set)
+	// as one compute job consumed by the indirect draw; call before begin_frame
+	void schedule_particles(float dt, vec3_t gravity, bool sorted, vec3_t camera_position);
+
+	// indirect instanced billboards inside RENDER_PASS_MAIN, depth tested without writing.
+	// does nothing in the depth pre-pass, so it can be called from every pass of the frame
+	void draw_particles(const float view_projection[16], vec3_t camera_right, vec3_t camera_up);
+
+	// gpu time of the last completed particle job and cpu time spent recording it
+	float get_particle_gpu_time();
+
+	float get_particle_record_time();
+
+} // olivia
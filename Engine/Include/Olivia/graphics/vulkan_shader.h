@@ -0,0 +1,82 @@
+#pragma once
+#include "vulkan_core.h"
+#include "shader_reflect.h"
+
+namespace olivia
+{
+	constexpr uint32_t MAX_WATCHED_SHADERS{ 64 };
+	constexpr uint32_t MAX_SHADER_NAME{ 64 };
+
+	// how often hot reload looks at the SPIR-V next to the executable
+	constexpr uint64_t SHADER_POLL_INTERVAL_MS{ 250 };
+
+	struct shader_t
+	{
+		VkShaderModule      module;
+		shader_reflection_t reflection;
+	};
+
+	// point pSpecializationInfo at info; entries refer into the struct, do not copy it
+	struct shader_specialization_t
+	{
+		VkSpecializationMapEntry entries[MAX_SPECIALIZATION_CONSTANTS];
+		uint32_t                 values[MAX_SPECIALIZATION_CONSTANTS];
+		VkSpecializationInfo     info;
+	};
+
+	// recreates the owner's pipelines, the device is idle while it runs
+	typedef void (*shader_reload_function)(void* data);
+
+	struct shader_watch_t
+	{
+		char                   name[MAX_SHADER_NAME];
+		SDL_Time               modify_time;
+		shader_reload_function reload;
+		void*                  data;
+	};
+
+	struct shader_watcher_t
+	{
+		shader_watch_t watches[MAX_WATCHED_SHADERS];
+		uint32_t       watch_count;
+		bool           enabled;
+		uint64_t       last_poll;
+	};
+
+	// SPIR-V next to the executable, null (and logged) when it is missing
+	VkShaderModule load_shader_module(const char* name);
+
+	// module and reflection, false (and logged) when the file is missing or not reflectable
+	bool load_shader(const char* name, shader_t& shader);
+
+	// modules are only needed until the pipelines using them are created
+	void destroy_shader(shader_t& shader);
+
+	VkDescriptorSetLayout create_reflected_set_layout(const shader_reflection_t& reflection, uint32_t set);
+
+	// enough descriptors of each type for max_sets sets of the given set number
+	VkDescriptorPool create_reflected_descriptor_pool(const shader_reflection_t& reflection, uint32_t set, uint32_t max_sets);
+
+	// one push constant range covering every stage that declares push constants
+	VkPipelineLayout create_reflected_pipeline_layout(const shader_reflection_t& reflection, const VkDescriptorSetLayout* set_layouts, uint32_t set_count);
+
+	VkPipeline create_compute_pipeline(const shader_t& shader, VkPipelineLayout layout, const VkSpecializationInfo* specialization);
+
+	// ids that do not exist in shader are asserted against
+	void set_specialization_constant(shader_specialization_t& specialization, const shader_reflection_t& shader, uint32_t id, uint32_t value);
+
+	// --- hot reload ---
+
+	// reload runs once (per owner) when any of its shaders changes on disk, e.g. after
+	// rebuilding the compile_shaders target while the engine runs
+	void watch_shader(const char* name, shader_reload_function reload, void* data);
+
+	void unwatch_shaders(shader_reload_function reload);
+
+	// on by default in debug builds
+	void set_shader_hot_reload(bool enabled);
+
+	// called by begin_frame, stats the watched files every SHADER_POLL_INTERVAL_MS
+	void poll_shader_reload();
+
+} // olivia
@@ -0,0 +1,68 @@
+#pragma once
+#include "vulkan_mesh.h"
+#include "vulkan_shader.h"
+#include "animation.h"
+
+namespace olivia
+{
+	// per frame slot, bind pose vertices are skinned into vertex3d_t like the mesh group
+	constexpr VkDeviceSize SKINNING_OUTPUT_SIZE{ MEGABYTES(64) };
+	constexpr uint32_t     MAX_SKINNING_JOINTS{ 65536 };
+	constexpr uint32_t     MAX_SKINNED_DRAWS{ 1024 };
+
+	// next to the executable, compiled from shaders/skinning.comp
+	constexpr const char*  SKINNING_SHADER_PATH = "skinning.comp.spv";
+
+	// push constants of one dispatch, counted in vertices / joints
+	struct skinning_dispatch_t
+	{
+		uint32_t source_vertex;
+		uint32_t skin_vertex;
+		uint32_t vertex_count;
+		uint32_t output_vertex;
+		uint32_t first_joint;
+	};
+
+	struct skinned_draw_t
+	{
+		uint32_t        first_vertex; // vertexOffset into get_skinned_vertex_buffer(), the mesh's indices are reused
+		joint_matrix_t* palette;      // joint_count skinning matrices to fill before schedule_skinning
+	};
+
+	struct skinning_t
+	{
+		shader_reflection_t   reflection;   // what the layouts were made from
+		VkDescriptorSetLayout set_layout;
+		VkDescriptorPool      descriptor_pool;
+		VkDescriptorSet       sets[MAX_FRAMES];
+		VkPipelineLayout      pipeline_layout;
+		VkPipeline            pipeline;
+		vulkan_buffer_t       output[MAX_FRAMES];
+		vulkan_buffer_t       joints[MAX_FRAMES];
+
+		// --- frame ---
+
+		// written by the animation jobs, copied into joints once the frame slot is free
+		joint_matrix_t*       palette;
+		skinning_dispatch_t   dispatches[MAX_SKINNED_DRAWS];
+		uint32_t              dispatch_count;
+		uint32_t              output_vertex_count;
+		uint32_t              joint_count;
+		bool                  scheduled;
+	};
+
+	void init_skinning();
+
+	void destroy_skinning();
+
+	// reserves this frame's output vertices and palette for one instance of a skinned mesh
+	skinned_draw_t skin_mesh(mesh_t mesh, uint32_t joint_count);
+
+	// queues the frame's skinning pass as a compute job (async when available), consumed by
+	// vertex input; call after the palettes are written and before begin_frame
+	void schedule_skinning();
+
+	// the current frame's output, bind it in place of the mesh group vertex buffer
+	VkBuffer get_skinned_vertex_buffer();
+
+} // olivia
@@ -0,0 +1,88 @@
+#pragma once
+#include "vulkan_buffer.h"
+#include "olivia/platform/file_map.h"
+
+namespace olivia
+{
+	using texture_t = uint32_t;
+
+	constexpr texture_t INVALID_TEXTURE{ UINT32_MAX };
+
+	constexpr uint32_t MAX_TEXTURES{ 256 };
+	constexpr uint32_t MAX_TEXTURE_MIPS{ 16 };
+
+	constexpr VkDeviceSize TEXTURE_STAGING_SIZE{ MEGABYTES(32) };
+
+	// a texture stays at its coarsest mip until demand is reported, and
+	// finer levels are only kept while they were requested recently
+	constexpr uint32_t TEXTURE_DEMAND_FRAMES{ 120 };
+
+	// images an update may shrink, each one is an allocation and a deferred destroy
+	constexpr uint32_t TEXTURE_EVICTIONS_PER_FRAME{ 8 };
+
+	struct vulkan_image_t
+	{
+		VkImage       image;
+		VmaAllocation allocation;
+		VkImageView   view;
+	};
+
+	struct texture_slot_t
+	{
+		file_map_t     file;
+		VkFormat       format;
+		uint32_t       width;
+		uint32_t       height;
+		uint32_t       mip_count;
+		uint64_t       mip_offset[MAX_TEXTURE_MIPS];
+		uint64_t       mip_size[MAX_TEXTURE_MIPS];
+
+		// --- residency ---
+
+		vulkan_image_t image;
+		uint32_t       resident_mip;
+		uint32_t       requested_mip;
+		uint64_t       last_requested;
+		VkDeviceSize   resident_bytes;
+	};
+
+	struct texture_streamer_t
+	{
+		texture_slot_t    textures[MAX_TEXTURES];
+		uint32_t          texture_count;
+
+		vulkan_buffer_t   staging;
+		VkSampler         sampler;
+
+		uint32_t          heap_index;
+		VkDeviceSize      budget;
+		VkDeviceSize      resident_bytes; // every texture image still alive, the retiring ones included
+		VkDeviceSize      retiring_bytes[MAX_FRAMES]; // replaced images, freed once their frame slot comes around
+		VkDeviceSize      pressure; // promised to the memory telemetry's evictor, dropped by the next update
+		uint64_t          frame;
+	};
+
+	// budget == 0 uses 80% of the device local heap budget reported by VMA; streaming also
+	// keeps the heap under MEMORY_PRESSURE_LOW of its budget
+	void init_texture_streamer(VkDeviceSize budget);
+
+	void destroy_texture_streamer();
+
+	// loads a 2D BC-compressed KTX2 file; only the coarsest mip is uploaded up front. every
+	// level has to fit a frame's slice of the staging buffer
+	texture_t load_texture(const char* path);
+
+	// screen_size is the projected size of the texture in pixels along its larger axis
+	void request_texture(texture_t texture, float screen_size);
+
+	// records this frame's mip uploads/evictions; call outside of a rendering scope
+	void update_textures(VkCommandBuffer cmd);
+
+	// the view changes when residency changes, fetch it every frame
+	VkImageView get_texture_view(texture_t texture);
+
+	VkSampler get_texture_sampler();
+
+	VkDeviceSize get_texture_resident_bytes();
+
+} // olivia
@@ -0,0 +1,54 @@
+#pragma once
+#include "vulkan_shader.h"
+
+namespace olivia
+{
+	// next to the executable, compiled from shaders/upscale.*
+	constexpr const char* UPSCALE_VERTEX_SHADER_PATH   = "upscale.vert.spv";
+	constexpr const char* UPSCALE_FRAGMENT_SHADER_PATH = "upscale.frag.spv";
+
+	constexpr float DEFAULT_UPSCALE_SHARPNESS{ 0.5f };
+
+	enum upscale_filter_t : uint32_t
+	{
+		UPSCALE_FILTER_BILINEAR,
+		UPSCALE_FILTER_SHARPEN   // bilinear plus a contrast adaptive sharpening lobe
+	};
+
+	// push constants of upscale.frag; the scene is rendered into the top left corner of a
+	// target the size of the swapchain
+	struct upscale_push_t
+	{
+		float uv_scale[2];   // render extent / target extent
+		float uv_max[2];     // half a texel inside the rendered corner, bilinear taps never reach past it
+		float texel_size[2]; // of the target
+		float sharpness;     // 0 is plain bilinear
+		float padding;
+	};
+
+	struct upscaler_t
+	{
+		shader_reflection_t   reflection;
+		VkSampler             sampler;
+		VkDescriptorSetLayout set_layout;
+		VkDescriptorPool      descriptor_pool;
+		VkDescriptorSet       sets[MAX_FRAMES];
+		VkPipelineLayout      pipeline_layout;
+		VkPipeline            pipeline;
+		upscale_filter_t      filter;
+		float                 sharpness;
+	};
+
+	void init_upscaler();
+
+	void destroy_upscaler();
+
+	// false when the shaders were missing, rendering then stays at the swapchain resolution
+	bool is_upscaler_ready();
+
+	void set_upscale_filter(upscale_filter_t filter, float sharpness = DEFAULT_UPSCALE_SHARPNESS);
+
+	// inside the upscale pass: draws source, rendered at source_extent, over the whole swapchain image
+	void draw_upscale(VkCommandBuffer cmd, VkImageView source, VkExtent2D source_extent);
+
+} // olivia
@@ -2,15 +2,29 @@
 #include "olivia_core.h"
 #include "olivia_platform.h"
 #include "olivia_graphics.h"
+#include "olivia_asset.h"
 
 namespace olivia
 {
 	constexpr const char* OLIVIA_GAME = "olivia_game.dll";
+	constexpr size_t      OLIVIA_STORAGE_SIZE{ MEGABYTES(200) };
+
+	// longest step a live frame feeds the game, a debugger break should not look like a frame of seconds
+	constexpr float       OLIVIA_MAX_DT{ 0.1f };
 
 	typedef void (*olivia_load)(void*);
 	typedef void (*olivia_update)(float);
 	typedef void (*olivia_draw)(void);
 
+	struct run_options_t
+	{
+		const char* record_path;       // captures input, dt and the initial storage of the session
+		const char* replay_path;       // replays a recording with a hidden window and no vsync, then exits
+		const char* timings_path;      // per-frame cpu/gpu timings as csv
+		const char* memory_trace_path; // gpu memory timeline as a chrome trace, written at exit
+		bool        huge_pages;        // back the game storage with transparent huge pages
+	};
+
 	struct context_t
 	{
 		// --- state ---
@@ -22,15 +36,19 @@ namespace olivia
 		const char*       olivia_game_path;
 		void*             olivia_storage;
 		SDL_SharedObject* olivia_game;
+		olivia_load       olivia_load;
 		olivia_update     olivia_update;
 		olivia_draw       olivia_draw;
 	};
 
-	void game_load(const char* game, size_t game_storage_size);
+	// copies and loads the game dll and creates its storage, without calling olivia_load
+	bool game_open(const char* game, size_t game_storage_size, bool huge_pages = false);
+
+	void game_load(const char* game, size_t game_storage_size, bool huge_pages = false);
 
 	void reload();
 
-	void run(const char* game);
+	void run(const char* game, const run_options_t& options = {});
 
 
 } // olivia
\ No newline at end of file
@@ -1,3 +1,8 @@
 #pragma once
 
-#include "platform/sdl3_input.h"
\ No newline at end of file
+#include "platform/sdl3_input.h"
+#include "platform/sdl3_jobs.h"
+#include "platform/file_map.h"
+#include "platform/input_replay.h"
+#include "platform/storage_snapshot.h"
+#include "platform/startup_trace.h"
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include "olivia/olivia_core.h"
+
+namespace olivia
+{
+	struct file_map_t
+	{
+		const void* data;
+		size_t      size;
+		intptr_t    file;
+		void*       mapping;
+	};
+
+	bool map_file(const char* path, file_map_t& map);
+
+	void unmap_file(file_map_t& map);
+
+} // olivia
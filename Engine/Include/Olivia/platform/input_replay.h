@@ -0,0 +1,71 @@
+#pragma once
+#include "olivia/olivia_core.h"
+#include "sdl3_input.h"
+#include "file_map.h"
+
+#include <SDL3/SDL.h>
+
+namespace olivia
+{
+	constexpr uint32_t REPLAY_MAGIC{ 0x52564C4F }; // "OLVR"
+	constexpr uint32_t REPLAY_VERSION{ 1 };
+
+	// --- on-disk layout: header | zstd compressed storage | frames ---
+	// every frame record is followed by its event_count input events
+
+	struct replay_header_t
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t frame_count;
+		uint32_t event_size;
+		uint64_t storage_size;
+		uint64_t storage_compressed_size;
+	};
+
+	struct replay_frame_t
+	{
+		uint64_t timestamp;
+		float    dt;
+		uint32_t event_count;
+	};
+
+	// --- record ---
+
+	struct replay_recorder_t
+	{
+		SDL_IOStream*   file;
+		replay_header_t header;
+	};
+
+	// the storage snapshot is the state the first recorded frame starts from
+	bool begin_replay_recording(replay_recorder_t& recorder, const char* path, const void* storage, size_t storage_size);
+
+	// call after update_input_state, records the events it applied and the dt the frame is updated with
+	void record_replay_frame(replay_recorder_t& recorder, float dt);
+
+	// writes the final frame count into the header and closes the file
+	void end_replay_recording(replay_recorder_t& recorder);
+
+	// --- replay ---
+
+	struct replay_t
+	{
+		file_map_t             file;
+		const replay_header_t* header;
+		size_t                 offset;
+		uint32_t               frame;
+	};
+
+	bool open_replay(const char* path, replay_t& replay);
+
+	void close_replay(replay_t& replay);
+
+	// overwrites storage with the recorded snapshot, storage_size has to match the recording
+	bool restore_replay_storage(const replay_t& replay, void* storage, size_t storage_size);
+
+	// applies the next frame's events to g_input_state in place of update_input_state,
+	// returns false once every frame has been replayed
+	bool next_replay_frame(replay_t& replay, float& dt);
+
+} // olivia
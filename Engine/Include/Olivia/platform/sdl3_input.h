@@ -5,25 +5,173 @@
 
 namespace olivia
 {
+	constexpr uint32_t INPUT_KEY_WORDS{ (SDL_SCANCODE_COUNT + 63) / 64 };
+
+	// power of two, the queue only has to hold what arrives between two frames
+	constexpr uint32_t INPUT_EVENT_QUEUE_SIZE{ 1024 };
+	constexpr uint32_t MAX_FRAME_INPUT_EVENTS{ 256 };
+
+	constexpr uint32_t MAX_GAMEPADS{ 4 };
+	constexpr uint32_t INPUT_TEXT_SIZE{ 128 };
+
+	// gamepads are sampled on the input thread at this rate, independent of the frame rate
+	constexpr uint64_t INPUT_POLL_INTERVAL_NS{ 1000000 };
+
+	enum input_event_type_t : uint8_t
+	{
+		INPUT_EVENT_KEY_DOWN,
+		INPUT_EVENT_KEY_UP,
+		INPUT_EVENT_MOUSE_MOTION,
+		INPUT_EVENT_MOUSE_BUTTON_DOWN,
+		INPUT_EVENT_MOUSE_BUTTON_UP,
+		INPUT_EVENT_MOUSE_WHEEL,
+		INPUT_EVENT_GAMEPAD_BUTTON_DOWN,
+		INPUT_EVENT_GAMEPAD_BUTTON_UP,
+		INPUT_EVENT_GAMEPAD_AXIS,
+		INPUT_EVENT_TEXT
+	};
+
+	struct input_event_t
+	{
+		uint64_t           timestamp; // SDL_GetTicksNS() clock
+		input_event_type_t type;
+		uint8_t            device;    // gamepad slot
+		uint16_t           code;      // scancode, mouse/gamepad button or gamepad axis
+		float              x;         // mouse position, wheel or axis value
+		float              y;
+		float              dx;        // mouse motion
+		float              dy;
+		char               text[16];  // nul terminated UTF-8, longer input is split
+	};
+
+	// multi-producer (event watch, input thread), single consumer (update_input_state)
+	struct input_event_queue_t
+	{
+		input_event_t events[INPUT_EVENT_QUEUE_SIZE];
+		SDL_AtomicInt sequence[INPUT_EVENT_QUEUE_SIZE];
+		SDL_AtomicInt head;
+		SDL_AtomicInt tail;
+	};
+
+	struct input_system_t
+	{
+		input_event_queue_t queue;
+		SDL_AtomicInt       dropped_events;
+
+		// --- input thread ---
+
+		SDL_Thread*         thread;
+		SDL_AtomicInt       running;
+		SDL_Gamepad*        gamepads[MAX_GAMEPADS];
+		uint32_t            gamepad_buttons[MAX_GAMEPADS];
+		int16_t             gamepad_axes[MAX_GAMEPADS][SDL_GAMEPAD_AXIS_COUNT];
+	};
+
 	struct input_state_t
 	{
-		bool curr_keys[SDL_SCANCODE_COUNT];
-		bool prev_keys[SDL_SCANCODE_COUNT];
+		// --- keyboard ---
+
+		uint64_t      curr_keys[INPUT_KEY_WORDS];
+		uint64_t      prev_keys[INPUT_KEY_WORDS];
+		uint64_t      pressed_keys[INPUT_KEY_WORDS];
+		uint64_t      released_keys[INPUT_KEY_WORDS];
+
+		// --- mouse ---
+
+		uint32_t      curr_mouse_buttons;
+		uint32_t      prev_mouse_buttons;
+		uint32_t      pressed_mouse_buttons;
+		uint32_t      released_mouse_buttons;
+		float         mouse_x;
+		float         mouse_y;
+		float         mouse_dx;
+		float         mouse_dy;
+		float         wheel_x;
+		float         wheel_y;
+
+		// --- gamepads ---
+
+		uint32_t      curr_gamepad_buttons[MAX_GAMEPADS];
+		uint32_t      prev_gamepad_buttons[MAX_GAMEPADS];
+		uint32_t      pressed_gamepad_buttons[MAX_GAMEPADS];
+		uint32_t      released_gamepad_buttons[MAX_GAMEPADS];
+		float         gamepad_axes[MAX_GAMEPADS][SDL_GAMEPAD_AXIS_COUNT];
+
+		// --- text ---
+
+		char          text[INPUT_TEXT_SIZE];
+		uint32_t      text_length;
+
+		// --- frame ---
+
+		// every event applied by the last update, in arrival order
+		input_event_t events[MAX_FRAME_INPUT_EVENTS];
+		uint32_t      event_count;
+		uint32_t      dropped_events;
+		uint64_t      timestamp;
 	};
 
 	extern input_state_t g_input_state;
 
+	// installs the event watch and starts the gamepad polling thread; call after SDL_Init
+	void init_input();
+
+	void destroy_input();
+
+	bool push_input_event(const input_event_t& event);
+
+	// drains the event queue into g_input_state, call once per frame after pumping SDL events
 	void update_input_state();
 
+	// applies events that did not come from the queue (replays) exactly like update_input_state
+	void apply_input_events(const input_event_t* events, uint32_t count, uint64_t timestamp);
+
+	inline bool test_input_bit(const uint64_t* words, uint32_t bit)
+	{
+		return (words[bit >> 6] >> (bit & 63)) & 1;
+	}
+
+	// pressed/released also report presses shorter than a frame
 	inline bool is_key_pressed(SDL_Scancode code)
 	{
-		return (code >= 0 && code < 256) ? (g_input_state.curr_keys[code] && !g_input_state.prev_keys[code]) : false;
+		return (code >= 0 && code < SDL_SCANCODE_COUNT) ? test_input_bit(g_input_state.pressed_keys, code) : false;
+	}
+
+	inline bool is_key_released(SDL_Scancode code)
+	{
+		return (code >= 0 && code < SDL_SCANCODE_COUNT) ? test_input_bit(g_input_state.released_keys, code) : false;
 	}
 
 	inline bool is_key_down(SDL_Scancode code)
 	{
-		return (code >= 0 && code < 256) ? g_input_state.curr_keys[code] : false;
+		return (code >= 0 && code < SDL_SCANCODE_COUNT) ? test_input_bit(g_input_state.curr_keys, code) : false;
 	}
 
-} // olivia
+	// button is SDL_BUTTON_LEFT, SDL_BUTTON_RIGHT, ...
+	inline bool is_mouse_pressed(uint8_t button)
+	{
+		return button < 32 && ((g_input_state.pressed_mouse_buttons >> button) & 1);
+	}
 
+	inline bool is_mouse_down(uint8_t button)
+	{
+		return button < 32 && ((g_input_state.curr_mouse_buttons >> button) & 1);
+	}
+
+	inline bool is_gamepad_pressed(uint32_t gamepad, SDL_GamepadButton button)
+	{
+		return gamepad < MAX_GAMEPADS && button >= 0 && button < SDL_GAMEPAD_BUTTON_COUNT && ((g_input_state.pressed_gamepad_buttons[gamepad] >> button) & 1);
+	}
+
+	inline bool is_gamepad_down(uint32_t gamepad, SDL_GamepadButton button)
+	{
+		return gamepad < MAX_GAMEPADS && button >= 0 && button < SDL_GAMEPAD_BUTTON_COUNT && ((g_input_state.curr_gamepad_buttons[gamepad] >> button) & 1);
+	}
+
+	// [-1, 1] for sticks, [0, 1] for triggers
+	inline float get_gamepad_axis(uint32_t gamepad, SDL_GamepadAxis axis)
+	{
+		return (gamepad < MAX_GAMEPADS && axis >= 0 && axis < SDL_GAMEPAD_AXIS_COUNT) ? g_input_state.gamepad_axes[gamepad][axis] : 0.0f;
+	}
+
+} // olivia
@@ -0,0 +1,55 @@
+#pragma once
+#include "olivia/olivia_core.h"
+
+#include <SDL3/SDL.h>
+
+namespace olivia
+{
+	constexpr uint32_t MAX_JOB_WORKERS{ 32 };
+	constexpr uint32_t JOB_QUEUE_SIZE{ 4096 };
+
+	typedef void (*job_function)(void* data);
+	typedef void (*job_range_function)(uint32_t begin, uint32_t end, void* data);
+
+	struct job_t
+	{
+		job_function function;
+		void*        data;
+	};
+
+	struct job_counter_t
+	{
+		SDL_AtomicInt pending;
+	};
+
+	struct job_system_t
+	{
+		SDL_Thread*    workers[MAX_JOB_WORKERS];
+		uint32_t       worker_count;
+		SDL_Mutex*     mutex;
+		SDL_Condition* wake;
+		bool           running;
+
+		// --- queue ---
+
+		job_t          jobs[JOB_QUEUE_SIZE];
+		job_counter_t* counters[JOB_QUEUE_SIZE];
+		uint32_t       head;
+		uint32_t       tail;
+	};
+
+	// worker_count == 0 picks one worker per logical core minus the calling thread
+	void init_job_system(uint32_t worker_count);
+
+	void destroy_job_system();
+
+	uint32_t get_job_worker_count();
+
+	void run_jobs(const job_t* jobs, uint32_t count, job_counter_t* counter);
+
+	// the calling thread executes queued jobs while it waits
+	void wait_for_counter(job_counter_t* counter);
+
+	void parallel_for(uint32_t count, uint32_t batch_size, job_range_function function, void* data);
+
+} // olivia
@@ -0,0 +1,38 @@
+#pragma once
+#include "olivia/olivia_core.h"
+
+#include <SDL3/SDL.h>
+
+namespace olivia
+{
+	constexpr uint32_t MAX_STARTUP_SPANS{ 64 };
+
+	struct startup_span_t
+	{
+		const char*  name;
+		uint64_t     begin;
+		uint64_t     end;
+		SDL_ThreadID thread;
+	};
+
+	// spans can be opened from any thread, the trace only grows until it is reported
+	struct startup_trace_t
+	{
+		uint64_t       start;
+		SDL_ThreadID   main_thread;
+		startup_span_t spans[MAX_STARTUP_SPANS];
+		SDL_AtomicInt  span_count;
+		bool           reported;
+	};
+
+	void begin_startup_trace();
+
+	// returns UINT32_MAX once the trace is full or reported, end_startup_span ignores it
+	uint32_t begin_startup_span(const char* name);
+
+	void end_startup_span(uint32_t span);
+
+	// logs every span relative to begin_startup_trace, call once the first frame is presented
+	void report_startup_trace();
+
+} // olivia
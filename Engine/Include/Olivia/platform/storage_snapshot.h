@@ -0,0 +1,74 @@
+#pragma once
+#include "olivia/olivia_core.h"
+#include "sdl3_jobs.h"
+
+namespace olivia
+{
+	constexpr uint32_t MAX_STORAGE_SNAPSHOTS{ 16 };
+
+	// fixed so pointers saved inside the storage stay valid across runs (replays, snapshots)
+	constexpr uintptr_t STORAGE_BASE_ADDRESS{ 0x200000000000 };
+
+	// the reservation is committed a chunk at a time on first access, one x64 huge page
+	constexpr size_t    STORAGE_COMMIT_SIZE{ MEGABYTES(2) };
+
+	// the pages a snapshot changed, as they were at the previous snapshot;
+	// undoing snapshots newest to oldest walks the storage back in time
+	struct storage_snapshot_t
+	{
+		uint64_t      id;
+		uint32_t      page_count;
+		uint32_t*     pages;
+		void*         data;        // raw page contents until the compression job finished
+		size_t        data_size;
+		job_counter_t compressed;
+	};
+
+	struct storage_tracker_t
+	{
+		uint8_t*           base;
+		size_t             size;
+		size_t             page_size;   // dirty tracking granularity, the commit size with huge pages
+		uint32_t           page_count;
+		size_t             commit_size;
+		bool               huge_pages;
+		uint64_t*          committed;
+		uint8_t*           shadow;      // the storage as of the latest snapshot
+		uint64_t*          shadow_committed;
+		uint64_t*          dirty;       // fault handler bitset, pages written since the latest snapshot
+		void**             written;     // write watch results
+		uint32_t*          dirty_pages;
+
+		// --- history ---
+
+		storage_snapshot_t snapshots[MAX_STORAGE_SNAPSHOTS];
+		uint32_t           first;
+		uint32_t           count;
+		uint64_t           next_id;
+	};
+
+	// reserved at STORAGE_BASE_ADDRESS when it is free, zero filled, committed on first access
+	// and write tracked; only one game storage exists at a time. huge pages are a hint (linux only)
+	void* create_game_storage(size_t size, bool huge_pages = false);
+
+	void destroy_game_storage();
+
+	// copies only the pages written since the previous snapshot, their previous contents are
+	// compressed on the job system; call between frames while no job writes to the storage.
+	// the oldest snapshot is dropped once the history is full
+	uint64_t snapshot_game_storage();
+
+	// rewinds to a snapshot still in the history, newer snapshots are discarded
+	bool restore_game_storage(uint64_t id);
+
+	// 0 when no snapshot was taken yet
+	uint64_t get_latest_storage_snapshot();
+
+	uint32_t get_storage_snapshot_count();
+
+	// true for memory outside the game storage, reading an uncommitted chunk would commit it
+	bool is_game_storage_committed(const void* address);
+
+	size_t get_game_storage_committed();
+
+} // olivia
@@ -0,0 +1,36 @@
+// shared by the light binning and the lit mesh shaders, matches vulkan_lighting.h
+
+#define LIGHT_CLUSTER_X        16
+#define LIGHT_CLUSTER_Y        9
+#define LIGHT_CLUSTER_Z        24
+#define MAX_LIGHTS_PER_CLUSTER 128
+
+struct light_t
+{
+	vec3  position;
+	float radius;
+	vec3  color;
+	float intensity;
+};
+
+// the fragment stage includes this read-only
+#ifndef LIGHTING_ACCESS
+#define LIGHTING_ACCESS
+#endif
+
+layout(set = 0, binding = 0) readonly buffer lights_t
+{
+	light_t lights[];
+};
+
+// lights binned into each cluster, x + y * X + slice * X * Y
+layout(set = 0, binding = 1) LIGHTING_ACCESS buffer cluster_counts_t
+{
+	uint cluster_counts[];
+};
+
+// MAX_LIGHTS_PER_CLUSTER light indices per cluster
+layout(set = 0, binding = 2) LIGHTING_ACCESS buffer cluster_lights_t
+{
+	uint cluster_lights[];
+};
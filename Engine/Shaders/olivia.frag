@@ -1,8 +1,71 @@
 #version 460
+#extension GL_GOOGLE_include_directive : require
+
+#define LIGHTING_ACCESS readonly
+#include "lighting_common.glsl"
+
+// false shades with every light, the reference the clustered path is measured against
+layout(constant_id = 0) const bool CLUSTERED = true;
+
+layout(push_constant) uniform push_t
+{
+	mat4  view_projection;
+	vec4  cluster_scale; // clusters per pixel in x and y, slice scale and bias on log(view z)
+	float z_near;
+	uint  light_count;
+} push;
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec2 inUV;
 
 layout(location = 0) out vec4 fragColor;
 
+const vec3 ALBEDO  = vec3(0.8);
+const vec3 AMBIENT = vec3(0.03);
+
+vec3 shade(light_t light, vec3 normal)
+{
+	vec3  to_light = light.position - inPosition;
+	float distance = length(to_light);
+
+	// inverse square, windowed to reach zero at the radius
+	float window  = clamp(1.0 - pow(distance / light.radius, 4.0), 0.0, 1.0);
+	float falloff = window * window / (distance * distance + 1.0);
+
+	return light.color * light.intensity * falloff * max(dot(normal, to_light / max(distance, 1e-4)), 0.0);
+}
+
 void main()
 {
-	fragColor = vec4(1.0);
-}
\ No newline at end of file
+	vec3 normal = normalize(inNormal);
+	vec3 color  = AMBIENT;
+
+	if (push.light_count > 0)
+	{
+		if (CLUSTERED)
+		{
+			// reverse-Z with an infinite far plane: depth = z_near / view z
+			float view_z = push.z_near / gl_FragCoord.z;
+			uint  slice  = uint(clamp(log(view_z) * push.cluster_scale.z + push.cluster_scale.w, 0.0, float(LIGHT_CLUSTER_Z - 1)));
+			uvec2 tile   = min(uvec2(gl_FragCoord.xy * push.cluster_scale.xy), uvec2(LIGHT_CLUSTER_X - 1, LIGHT_CLUSTER_Y - 1));
+
+			uint cluster = tile.x + tile.y * LIGHT_CLUSTER_X + slice * LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y;
+			uint count   = cluster_counts[cluster];
+
+			for (uint i = 0; i < count; ++i)
+			{
+				color += shade(lights[cluster_lights[cluster * MAX_LIGHTS_PER_CLUSTER + i]], normal);
+			}
+		}
+		else
+		{
+			for (uint i = 0; i < push.light_count; ++i)
+			{
+				color += shade(lights[i], normal);
+			}
+		}
+	}
+
+	fragColor = vec4(color * ALBEDO, 1.0);
+}
@@ -8,7 +8,27 @@ layout (location = 2) in vec2 inUV;
 // Instance
 layout (location = 3) in mat4 inTransform;
 
+// lit_draw_t, shared with olivia.frag
+layout(push_constant) uniform push_t
+{
+	mat4  view_projection;
+	vec4  cluster_scale;
+	float z_near;
+	uint  light_count;
+} push;
+
+layout (location = 0) out vec3 outPosition;
+layout (location = 1) out vec3 outNormal;
+layout (location = 2) out vec2 outUV;
+
 void main()
 {
-	gl_Position = vec4(inPosition, 1.0);
-}
\ No newline at end of file
+	vec4 world = inTransform * vec4(inPosition, 1.0);
+
+	// uniformly scaled instances, the normal needs no inverse transpose
+	outPosition = world.xyz;
+	outNormal   = mat3(inTransform) * inNormal;
+	outUV       = inUV;
+
+	gl_Position = push.view_projection * world;
+}
@@ -0,0 +1,38 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#define PARTICLE_ACCESS readonly
+#include "particle_common.glsl"
+
+// one pipeline per permutation, the sorted one reads through the sort keys
+layout(constant_id = 0) const bool SORTED = false;
+
+layout(push_constant) uniform push_t
+{
+	mat4 view_projection;
+	vec4 camera_right;
+	vec4 camera_up;
+} push;
+
+layout(location = 0) out vec4 out_color;
+layout(location = 1) out vec2 out_uv;
+
+const vec2 corners[6] = vec2[](
+	vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+	vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main()
+{
+	uint particle = SORTED ? sort_keys[gl_InstanceIndex].y : alive_out[gl_InstanceIndex];
+
+	particle_t p      = particles_out[particle];
+	vec2       corner = corners[gl_VertexIndex];
+	vec3       world  = p.position.xyz + (push.camera_right.xyz * corner.x + push.camera_up.xyz * corner.y) * p.position.w;
+
+	// fades out over the particle's life
+	float fade = clamp(p.velocity.w / uintBitsToFloat(p.data.y), 0.0, 1.0);
+
+	gl_Position = push.view_projection * vec4(world, 1.0);
+	out_color   = unpackUnorm4x8(p.data.x) * fade;
+	out_uv      = corner;
+}
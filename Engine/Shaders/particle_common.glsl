@@ -0,0 +1,54 @@
+// shared by the particle shaders; the set bound for a frame maps its output parity to *_out
+
+struct particle_t
+{
+	vec4  position; // xyz, w billboard size
+	vec4  velocity; // xyz, w remaining life
+	uvec4 data;     // x packed color, y initial life bits
+};
+
+#define COUNTER_DEAD      0
+#define COUNTER_ALIVE_IN  1
+#define COUNTER_ALIVE_OUT 2
+#define COUNTER_SIMULATE  4
+#define COUNTER_DRAW      8
+
+// vertex stages include this read-only
+#ifndef PARTICLE_ACCESS
+#define PARTICLE_ACCESS
+#endif
+
+layout(set = 0, binding = 0) PARTICLE_ACCESS buffer particles_in_t
+{
+	particle_t particles_in[];
+};
+
+layout(set = 0, binding = 1) PARTICLE_ACCESS buffer particles_out_t
+{
+	particle_t particles_out[];
+};
+
+layout(set = 0, binding = 2) PARTICLE_ACCESS buffer alive_in_t
+{
+	uint alive_in[];
+};
+
+layout(set = 0, binding = 3) PARTICLE_ACCESS buffer alive_out_t
+{
+	uint alive_out[];
+};
+
+layout(set = 0, binding = 4) PARTICLE_ACCESS buffer dead_t
+{
+	uint dead[];
+};
+
+layout(set = 0, binding = 5) PARTICLE_ACCESS buffer counters_t
+{
+	uint counters[];
+};
+
+layout(set = 0, binding = 6) PARTICLE_ACCESS buffer sort_keys_t
+{
+	uvec2 sort_keys[];
+};
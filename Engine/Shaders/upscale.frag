@@ -0,0 +1,51 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform sampler2D scene;
+
+layout(push_constant) uniform push_t
+{
+	vec2  uv_scale;
+	vec2  uv_max;
+	vec2  texel_size;
+	float sharpness;
+	float padding;
+} push;
+
+layout(location = 0) in vec2 in_uv;
+
+layout(location = 0) out vec4 out_color;
+
+vec3 fetch(vec2 uv)
+{
+	return texture(scene, min(uv, push.uv_max)).rgb;
+}
+
+void main()
+{
+	vec2 uv = in_uv * push.uv_scale;
+
+	vec3 center = fetch(uv);
+
+	if (push.sharpness <= 0.0)
+	{
+		out_color = vec4(center, 1.0);
+		return;
+	}
+
+	// contrast adaptive sharpening on the source texels: a negative lobe on the cross
+	// neighbours, weaker where the neighbourhood is already contrasty so edges do not ring
+	vec3 north = fetch(uv - vec2(0.0, push.texel_size.y));
+	vec3 south = fetch(uv + vec2(0.0, push.texel_size.y));
+	vec3 west  = fetch(uv - vec2(push.texel_size.x, 0.0));
+	vec3 east  = fetch(uv + vec2(push.texel_size.x, 0.0));
+
+	vec3 low  = min(center, min(min(north, south), min(west, east)));
+	vec3 high = max(center, max(max(north, south), max(west, east)));
+
+	vec3 amount = sqrt(clamp(min(low, 1.0 - high) / max(high, 1e-4), 0.0, 1.0));
+	vec3 lobe   = -amount * mix(0.125, 0.2, push.sharpness);
+
+	vec3 color = (center + (north + south + west + east) * lobe) / (1.0 + 4.0 * lobe);
+
+	out_color = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
@@ -0,0 +1,410 @@
+#include "olivia/graphics/animation.h"
+#include "olivia/platform/sdl3_jobs.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define OLIVIA_SSE2
+#endif
+
+namespace olivia
+{
+	// --- lanes ---
+
+	// JOINT_LANES floats, sse where available so the math below is written once
+
+#ifdef OLIVIA_SSE2
+	typedef __m128 lane_t;
+
+	static inline lane_t load_lanes(const float* p)         { return _mm_load_ps(p); }
+	static inline void   store_lanes(float* p, lane_t a)    { _mm_store_ps(p, a); }
+	static inline lane_t load_unaligned(const float* p)     { return _mm_loadu_ps(p); }
+	static inline void   store_unaligned(float* p, lane_t a) { _mm_storeu_ps(p, a); }
+	static inline lane_t set_lanes(float a)                 { return _mm_set1_ps(a); }
+	static inline lane_t add(lane_t a, lane_t b)            { return _mm_add_ps(a, b); }
+	static inline lane_t sub(lane_t a, lane_t b)            { return _mm_sub_ps(a, b); }
+	static inline lane_t mul(lane_t a, lane_t b)            { return _mm_mul_ps(a, b); }
+	static inline lane_t div(lane_t a, lane_t b)            { return _mm_div_ps(a, b); }
+	static inline lane_t max_lanes(lane_t a, lane_t b)      { return _mm_max_ps(a, b); }
+	static inline lane_t sqrt_lanes(lane_t a)               { return _mm_sqrt_ps(a); }
+	static inline lane_t equal(lane_t a, lane_t b)          { return _mm_cmpeq_ps(a, b); }
+	static inline lane_t less(lane_t a, lane_t b)           { return _mm_cmplt_ps(a, b); }
+	static inline lane_t select(lane_t mask, lane_t a, lane_t b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+#else
+	struct lane_t { float v[JOINT_LANES]; };
+
+	#define LANE_OP(expression) lane_t r; for (uint32_t i = 0; i < JOINT_LANES; ++i) { r.v[i] = expression; } return r
+
+	static inline lane_t load_lanes(const float* p)         { LANE_OP(p[i]); }
+	static inline void   store_lanes(float* p, lane_t a)    { for (uint32_t i = 0; i < JOINT_LANES; ++i) p[i] = a.v[i]; }
+	static inline lane_t load_unaligned(const float* p)     { return load_lanes(p); }
+	static inline void   store_unaligned(float* p, lane_t a) { store_lanes(p, a); }
+	static inline lane_t set_lanes(float a)                 { LANE_OP(a); }
+	static inline lane_t add(lane_t a, lane_t b)            { LANE_OP(a.v[i] + b.v[i]); }
+	static inline lane_t sub(lane_t a, lane_t b)            { LANE_OP(a.v[i] - b.v[i]); }
+	static inline lane_t mul(lane_t a, lane_t b)            { LANE_OP(a.v[i] * b.v[i]); }
+	static inline lane_t div(lane_t a, lane_t b)            { LANE_OP(a.v[i] / b.v[i]); }
+	static inline lane_t max_lanes(lane_t a, lane_t b)      { LANE_OP(a.v[i] > b.v[i] ? a.v[i] : b.v[i]); }
+	static inline lane_t sqrt_lanes(lane_t a)               { LANE_OP(sqrtf(a.v[i])); }
+	// masks are 1.0 / 0.0 without sse
+	static inline lane_t equal(lane_t a, lane_t b)          { LANE_OP(a.v[i] == b.v[i] ? 1.0f : 0.0f); }
+	static inline lane_t less(lane_t a, lane_t b)           { LANE_OP(a.v[i] < b.v[i] ? 1.0f : 0.0f); }
+	static inline lane_t select(lane_t mask, lane_t a, lane_t b) { LANE_OP(mask.v[i] != 0.0f ? a.v[i] : b.v[i]); }
+
+	#undef LANE_OP
+#endif
+
+	static inline lane_t lerp(lane_t a, lane_t b, lane_t t)
+	{
+		return add(a, mul(sub(b, a), t));
+	}
+
+	// --- keys ---
+
+	static constexpr float ROTATION_RANGE{ 0.70710678f }; // the three smallest components of a unit quaternion
+	static constexpr float ROTATION_QUANTIZE{ 32767.0f / ROTATION_RANGE };
+	static constexpr float ROTATION_DEQUANTIZE{ ROTATION_RANGE / 32767.0f };
+
+	static uint16_t quantize_unorm(float value, float min, float extent)
+	{
+		if (extent <= 0.0f)
+			return 0;
+
+		float t = SDL_clamp((value - min) / extent, 0.0f, 1.0f);
+		return (uint16_t)(t * 65535.0f + 0.5f);
+	}
+
+	static void pack_joint_key(const joint_transform_t& transform, const animation_clip_t& clip, joint_key_t& key)
+	{
+		float q[4]{ transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w };
+
+		uint32_t largest{};
+		for (uint32_t i = 1; i < 4; ++i)
+		{
+			if (fabsf(q[i]) > fabsf(q[largest]))
+				largest = i;
+		}
+
+		// q and -q are the same rotation, keeping the dropped component positive lets it be rebuilt by a sqrt
+		const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			float value = SDL_clamp(q[(largest + 1 + i) & 3] * sign, -ROTATION_RANGE, ROTATION_RANGE);
+			key.rotation[i] = (int16_t)lrintf(value * ROTATION_QUANTIZE);
+		}
+
+		key.largest = (uint16_t)largest;
+
+		key.translation[0] = quantize_unorm(transform.translation.x, clip.translation_min.x, clip.translation_extent.x);
+		key.translation[1] = quantize_unorm(transform.translation.y, clip.translation_min.y, clip.translation_extent.y);
+		key.translation[2] = quantize_unorm(transform.translation.z, clip.translation_min.z, clip.translation_extent.z);
+		key.scale          = quantize_unorm(transform.scale, clip.scale_min, clip.scale_extent);
+	}
+
+	void compress_animation(const joint_transform_t* transforms, uint32_t joint_count, uint32_t frame_count, float frame_rate, joint_key_t* keys, animation_clip_t& clip)
+	{
+		assert(joint_count <= MAX_JOINTS && frame_count > 0 && "invalid animation");
+
+		const uint32_t key_count = joint_count * frame_count;
+
+		vec3_t translation_max{ -INFINITY, -INFINITY, -INFINITY };
+		float  scale_max{ -INFINITY };
+
+		clip = {};
+		clip.joint_count     = joint_count;
+		clip.frame_count     = frame_count;
+		clip.frame_rate      = frame_rate;
+		clip.translation_min = { INFINITY, INFINITY, INFINITY };
+		clip.scale_min       = INFINITY;
+		clip.keys            = keys;
+
+		for (uint32_t i = 0; i < key_count; ++i)
+		{
+			const joint_transform_t& transform = transforms[i];
+
+			clip.translation_min.x = SDL_min(clip.translation_min.x, transform.translation.x);
+			clip.translation_min.y = SDL_min(clip.translation_min.y, transform.translation.y);
+			clip.translation_min.z = SDL_min(clip.translation_min.z, transform.translation.z);
+			translation_max.x      = SDL_max(translation_max.x, transform.translation.x);
+			translation_max.y      = SDL_max(translation_max.y, transform.translation.y);
+			translation_max.z      = SDL_max(translation_max.z, transform.translation.z);
+			clip.scale_min         = SDL_min(clip.scale_min, transform.scale);
+			scale_max              = SDL_max(scale_max, transform.scale);
+		}
+
+		clip.translation_extent = { translation_max.x - clip.translation_min.x, translation_max.y - clip.translation_min.y, translation_max.z - clip.translation_min.z };
+		clip.scale_extent       = scale_max - clip.scale_min;
+
+		for (uint32_t i = 0; i < key_count; ++i)
+		{
+			pack_joint_key(transforms[i], clip, keys[i]);
+		}
+	}
+
+	// the keys of one joint block, widened into lanes; padding lanes repeat the last joint
+	static void decode_keys(const animation_clip_t& clip, const joint_key_t* keys, uint32_t first_joint, joint_block_t& block)
+	{
+		alignas(16) float stored[3][JOINT_LANES];
+		alignas(16) float largest[JOINT_LANES];
+		alignas(16) float translation[3][JOINT_LANES];
+		alignas(16) float scale[JOINT_LANES];
+
+		for (uint32_t lane = 0; lane < JOINT_LANES; ++lane)
+		{
+			const joint_key_t& key = keys[SDL_min(first_joint + lane, clip.joint_count - 1)];
+
+			stored[0][lane]      = key.rotation[0];
+			stored[1][lane]      = key.rotation[1];
+			stored[2][lane]      = key.rotation[2];
+			largest[lane]        = key.largest;
+			translation[0][lane] = key.translation[0];
+			translation[1][lane] = key.translation[1];
+			translation[2][lane] = key.translation[2];
+			scale[lane]          = key.scale;
+		}
+
+		const lane_t dequantize = set_lanes(ROTATION_DEQUANTIZE);
+		const lane_t zero       = set_lanes(0.0f);
+		const lane_t one        = set_lanes(1.0f);
+
+		lane_t a = mul(load_lanes(stored[0]), dequantize);
+		lane_t b = mul(load_lanes(stored[1]), dequantize);
+		lane_t c = mul(load_lanes(stored[2]), dequantize);
+		lane_t d = sqrt_lanes(max_lanes(zero, sub(one, add(add(mul(a, a), mul(b, b)), mul(c, c)))));
+
+		// component k is d when it was the largest, otherwise the stored one (k - largest - 1) & 3
+		lane_t index = load_lanes(largest);
+		for (uint32_t k = 0; k < 4; ++k)
+		{
+			lane_t offset = sub(index, set_lanes((float)k));
+			offset = select(less(offset, zero), add(offset, set_lanes(4.0f)), offset);
+
+			lane_t component = select(equal(offset, zero), d,
+				select(equal(offset, set_lanes(3.0f)), a,
+				select(equal(offset, set_lanes(2.0f)), b, c)));
+
+			store_lanes(block.rotation[k], component);
+		}
+
+		const float* translation_min    = &clip.translation_min.x;
+		const float* translation_extent = &clip.translation_extent.x;
+
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			lane_t value = mul(load_lanes(translation[axis]), set_lanes(translation_extent[axis] / 65535.0f));
+			store_lanes(block.translation[axis], add(set_lanes(translation_min[axis]), value));
+		}
+
+		store_lanes(block.scale, add(set_lanes(clip.scale_min), mul(load_lanes(scale), set_lanes(clip.scale_extent / 65535.0f))));
+	}
+
+	// nlerp along the shorter arc, translation and scale lerp
+	static void interpolate_block(const joint_block_t& a, const joint_block_t& b, lane_t t, joint_block_t& out)
+	{
+		lane_t ra[4], rb[4];
+		for (uint32_t k = 0; k < 4; ++k)
+		{
+			ra[k] = load_lanes(a.rotation[k]);
+			rb[k] = load_lanes(b.rotation[k]);
+		}
+
+		lane_t dot  = add(add(mul(ra[0], rb[0]), mul(ra[1], rb[1])), add(mul(ra[2], rb[2]), mul(ra[3], rb[3])));
+		lane_t sign = select(less(dot, set_lanes(0.0f)), set_lanes(-1.0f), set_lanes(1.0f));
+
+		lane_t r[4];
+		lane_t length = set_lanes(0.0f);
+		for (uint32_t k = 0; k < 4; ++k)
+		{
+			r[k]   = lerp(ra[k], mul(rb[k], sign), t);
+			length = add(length, mul(r[k], r[k]));
+		}
+
+		// precise division, rsqrt estimates drift over a hierarchy
+		lane_t inverse_length = div(set_lanes(1.0f), sqrt_lanes(length));
+
+		for (uint32_t k = 0; k < 4; ++k)
+		{
+			store_lanes(out.rotation[k], mul(r[k], inverse_length));
+		}
+
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			store_lanes(out.translation[axis], lerp(load_lanes(a.translation[axis]), load_lanes(b.translation[axis]), t));
+		}
+
+		store_lanes(out.scale, lerp(load_lanes(a.scale), load_lanes(b.scale), t));
+	}
+
+	void sample_animation(const animation_clip_t& clip, float time, pose_t& pose)
+	{
+		float position = time * clip.frame_rate;
+		position = fmodf(position, (float)clip.frame_count);
+		if (position < 0.0f)
+			position += (float)clip.frame_count;
+
+		uint32_t frame0 = SDL_min((uint32_t)position, clip.frame_count - 1);
+		uint32_t frame1 = (frame0 + 1) % clip.frame_count;
+		lane_t   t      = set_lanes(position - (float)frame0);
+
+		const joint_key_t* keys0 = clip.keys + (size_t)frame0 * clip.joint_count;
+		const joint_key_t* keys1 = clip.keys + (size_t)frame1 * clip.joint_count;
+
+		for (uint32_t joint = 0; joint < clip.joint_count; joint += JOINT_LANES)
+		{
+			joint_block_t a, b;
+			decode_keys(clip, keys0, joint, a);
+			decode_keys(clip, keys1, joint, b);
+
+			interpolate_block(a, b, t, pose.blocks[joint / JOINT_LANES]);
+		}
+	}
+
+	void blend_poses(const pose_t& a, const pose_t& b, float weight, uint32_t joint_count, pose_t& pose)
+	{
+		lane_t t = set_lanes(weight);
+
+		for (uint32_t joint = 0; joint < joint_count; joint += JOINT_LANES)
+		{
+			interpolate_block(a.blocks[joint / JOINT_LANES], b.blocks[joint / JOINT_LANES], t, pose.blocks[joint / JOINT_LANES]);
+		}
+	}
+
+	joint_transform_t get_joint_transform(const pose_t& pose, uint32_t joint)
+	{
+		const joint_block_t& block = pose.blocks[joint / JOINT_LANES];
+		const uint32_t       lane  = joint % JOINT_LANES;
+
+		return
+		{
+			{ block.rotation[0][lane], block.rotation[1][lane], block.rotation[2][lane], block.rotation[3][lane] },
+			{ block.translation[0][lane], block.translation[1][lane], block.translation[2][lane] },
+			block.scale[lane]
+		};
+	}
+
+	// --- hierarchy ---
+
+	// a * b for affine 3x4 rows, the implicit fourth row is (0, 0, 0, 1); out may alias either
+	static void multiply_affine(const joint_matrix_t& a, const joint_matrix_t& b, joint_matrix_t& out)
+	{
+		alignas(16) static const float UNIT_W[JOINT_LANES]{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+		const lane_t b0     = load_unaligned(&b.rows[0].x);
+		const lane_t b1     = load_unaligned(&b.rows[1].x);
+		const lane_t b2     = load_unaligned(&b.rows[2].x);
+		const lane_t unit_w = load_lanes(UNIT_W);
+
+		lane_t rows[3];
+		for (uint32_t row = 0; row < 3; ++row)
+		{
+			const vec4_t& r = a.rows[row];
+
+			rows[row] = add(add(mul(set_lanes(r.x), b0), mul(set_lanes(r.y), b1)), add(mul(set_lanes(r.z), b2), mul(set_lanes(r.w), unit_w)));
+		}
+
+		for (uint32_t row = 0; row < 3; ++row)
+		{
+			store_unaligned(&out.rows[row].x, rows[row]);
+		}
+	}
+
+	void compute_skinning_palette(const skeleton_t& skeleton, const pose_t& pose, joint_matrix_t* palette)
+	{
+		assert(skeleton.joint_count <= MAX_JOINTS && "too many joints");
+
+		alignas(16) joint_matrix_t model[MAX_JOINTS];
+
+		// local matrices, four joints at a time
+		const lane_t one = set_lanes(1.0f);
+		const lane_t two = set_lanes(2.0f);
+
+		for (uint32_t joint = 0; joint < skeleton.joint_count; joint += JOINT_LANES)
+		{
+			const joint_block_t& block = pose.blocks[joint / JOINT_LANES];
+
+			lane_t x = load_lanes(block.rotation[0]);
+			lane_t y = load_lanes(block.rotation[1]);
+			lane_t z = load_lanes(block.rotation[2]);
+			lane_t w = load_lanes(block.rotation[3]);
+			lane_t s = load_lanes(block.scale);
+
+			lane_t xx = mul(x, x), yy = mul(y, y), zz = mul(z, z);
+			lane_t xy = mul(x, y), xz = mul(x, z), yz = mul(y, z);
+			lane_t wx = mul(w, x), wy = mul(w, y), wz = mul(w, z);
+
+			alignas(16) float m[12][JOINT_LANES];
+			store_lanes(m[0],  mul(sub(one, mul(two, add(yy, zz))), s));
+			store_lanes(m[1],  mul(mul(two, sub(xy, wz)), s));
+			store_lanes(m[2],  mul(mul(two, add(xz, wy)), s));
+			store_lanes(m[3],  load_lanes(block.translation[0]));
+			store_lanes(m[4],  mul(mul(two, add(xy, wz)), s));
+			store_lanes(m[5],  mul(sub(one, mul(two, add(xx, zz))), s));
+			store_lanes(m[6],  mul(mul(two, sub(yz, wx)), s));
+			store_lanes(m[7],  load_lanes(block.translation[1]));
+			store_lanes(m[8],  mul(mul(two, sub(xz, wy)), s));
+			store_lanes(m[9],  mul(mul(two, add(yz, wx)), s));
+			store_lanes(m[10], mul(sub(one, mul(two, add(xx, yy))), s));
+			store_lanes(m[11], load_lanes(block.translation[2]));
+
+			const uint32_t lanes = SDL_min(JOINT_LANES, skeleton.joint_count - joint);
+			for (uint32_t lane = 0; lane < lanes; ++lane)
+			{
+				float* out = &model[joint + lane].rows[0].x;
+				for (uint32_t i = 0; i < 12; ++i)
+				{
+					out[i] = m[i][lane];
+				}
+			}
+		}
+
+		// parents are converted first, so one pass in joint order reaches model space
+		for (uint32_t joint = 0; joint < skeleton.joint_count; ++joint)
+		{
+			const uint16_t parent = skeleton.parents[joint];
+			if (parent != NO_PARENT)
+			{
+				assert(parent < joint && "a parent has to come before its children");
+				multiply_affine(model[parent], model[joint], model[joint]);
+			}
+
+			multiply_affine(model[joint], skeleton.inverse_bind[joint], palette[joint]);
+		}
+	}
+
+	// --- jobs ---
+
+	static void update_animation_range(uint32_t begin, uint32_t end, void* data)
+	{
+		const animation_instance_t* instances = (const animation_instance_t*)data;
+
+		// 8 KB each, kept off the heap so jobs share nothing
+		pose_t pose;
+		pose_t other;
+
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const animation_instance_t& instance = instances[i];
+
+			sample_animation(*instance.clips[0], instance.times[0], pose);
+
+			if (instance.blend > 0.0f && instance.clips[1])
+			{
+				sample_animation(*instance.clips[1], instance.times[1], other);
+				blend_poses(pose, other, instance.blend, instance.skeleton->joint_count, pose);
+			}
+
+			compute_skinning_palette(*instance.skeleton, pose, instance.palette);
+		}
+	}
+
+	void update_animations(const animation_instance_t* instances, uint32_t count)
+	{
+		if (count == 0)
+			return;
+
+		parallel_for(count, ANIMATIONS_PER_JOB, update_animation_range, (void*)instances);
+	}
+
+} // olivia
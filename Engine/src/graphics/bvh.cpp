@@ -0,0 +1,896 @@
+#include "olivia/graphics/bvh.h"
+#include "olivia/platform/sdl3_jobs.h"
+
+#include <float.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define OLIVIA_SSE2
+#endif
+
+namespace olivia
+{
+	// --- lanes ---
+
+	// one lane per child of a node; masks are bit i for child i
+
+#ifdef OLIVIA_SSE2
+	typedef __m128 lane_t;
+
+	static inline lane_t   load_lanes(const float* p)           { return _mm_load_ps(p); }
+	static inline lane_t   set_lanes(float a)                   { return _mm_set1_ps(a); }
+	static inline lane_t   add(lane_t a, lane_t b)              { return _mm_add_ps(a, b); }
+	static inline lane_t   sub(lane_t a, lane_t b)              { return _mm_sub_ps(a, b); }
+	static inline lane_t   mul(lane_t a, lane_t b)              { return _mm_mul_ps(a, b); }
+	static inline lane_t   min_lanes(lane_t a, lane_t b)        { return _mm_min_ps(a, b); }
+	static inline lane_t   max_lanes(lane_t a, lane_t b)        { return _mm_max_ps(a, b); }
+	static inline void     store_lanes(float* p, lane_t a)      { _mm_store_ps(p, a); }
+	static inline uint32_t less_mask(lane_t a, lane_t b)        { return (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+	static inline uint32_t less_equal_mask(lane_t a, lane_t b)  { return (uint32_t)_mm_movemask_ps(_mm_cmple_ps(a, b)); }
+#else
+	struct lane_t { float v[BVH_WIDTH]; };
+
+	#define LANE_OP(expression) lane_t r; for (uint32_t i = 0; i < BVH_WIDTH; ++i) { r.v[i] = expression; } return r
+	#define MASK_OP(expression) uint32_t r{}; for (uint32_t i = 0; i < BVH_WIDTH; ++i) { r |= (expression) ? 1u << i : 0u; } return r
+
+	static inline lane_t   load_lanes(const float* p)           { LANE_OP(p[i]); }
+	static inline lane_t   set_lanes(float a)                   { LANE_OP(a); }
+	static inline lane_t   add(lane_t a, lane_t b)              { LANE_OP(a.v[i] + b.v[i]); }
+	static inline lane_t   sub(lane_t a, lane_t b)              { LANE_OP(a.v[i] - b.v[i]); }
+	static inline lane_t   mul(lane_t a, lane_t b)              { LANE_OP(a.v[i] * b.v[i]); }
+	static inline lane_t   min_lanes(lane_t a, lane_t b)        { LANE_OP(a.v[i] < b.v[i] ? a.v[i] : b.v[i]); }
+	static inline lane_t   max_lanes(lane_t a, lane_t b)        { LANE_OP(a.v[i] > b.v[i] ? a.v[i] : b.v[i]); }
+	static inline void     store_lanes(float* p, lane_t a)      { for (uint32_t i = 0; i < BVH_WIDTH; ++i) p[i] = a.v[i]; }
+	static inline uint32_t less_mask(lane_t a, lane_t b)        { MASK_OP(a.v[i] < b.v[i]); }
+	static inline uint32_t less_equal_mask(lane_t a, lane_t b)  { MASK_OP(a.v[i] <= b.v[i]); }
+
+	#undef MASK_OP
+	#undef LANE_OP
+#endif
+
+	// --- bounds ---
+
+	static inline vec3_t min3(vec3_t a, vec3_t b) { return { SDL_min(a.x, b.x), SDL_min(a.y, b.y), SDL_min(a.z, b.z) }; }
+	static inline vec3_t max3(vec3_t a, vec3_t b) { return { SDL_max(a.x, b.x), SDL_max(a.y, b.y), SDL_max(a.z, b.z) }; }
+
+	static constexpr aabb_t EMPTY_AABB{ { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+
+	static inline void grow(aabb_t& aabb, const aabb_t& other)
+	{
+		aabb.min = min3(aabb.min, other.min);
+		aabb.max = max3(aabb.max, other.max);
+	}
+
+	static inline void grow(aabb_t& aabb, vec3_t point)
+	{
+		aabb.min = min3(aabb.min, point);
+		aabb.max = max3(aabb.max, point);
+	}
+
+	// half the surface area, enough for comparing SAH costs
+	static inline float half_area(const aabb_t& aabb)
+	{
+		vec3_t e{ aabb.max.x - aabb.min.x, aabb.max.y - aabb.min.y, aabb.max.z - aabb.min.z };
+		return e.x < 0.0f ? 0.0f : e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+
+	aabb_t compute_aabb(const vec3_t* positions, uint32_t count, uint32_t stride)
+	{
+		if (count == 0)
+			return {};
+
+		aabb_t aabb = EMPTY_AABB;
+
+		const uint8_t* position = (const uint8_t*)positions;
+		for (uint32_t i = 0; i < count; ++i, position += stride)
+		{
+			grow(aabb, *(const vec3_t*)position);
+		}
+
+		return aabb;
+	}
+
+	aabb_t transform_aabb(const aabb_t& aabb, const float* m)
+	{
+		const float center[3]{ (aabb.min.x + aabb.max.x) * 0.5f, (aabb.min.y + aabb.max.y) * 0.5f, (aabb.min.z + aabb.max.z) * 0.5f };
+		const float extent[3]{ (aabb.max.x - aabb.min.x) * 0.5f, (aabb.max.y - aabb.min.y) * 0.5f, (aabb.max.z - aabb.min.z) * 0.5f };
+
+		float c[3];
+		float e[3];
+
+		for (uint32_t row = 0; row < 3; ++row)
+		{
+			c[row] = m[12 + row];
+			e[row] = 0.0f;
+
+			for (uint32_t column = 0; column < 3; ++column)
+			{
+				c[row] += m[column * 4 + row] * center[column];
+				e[row] += SDL_fabsf(m[column * 4 + row]) * extent[column];
+			}
+		}
+
+		return { { c[0] - e[0], c[1] - e[1], c[2] - e[2] }, { c[0] + e[0], c[1] + e[1], c[2] + e[2] } };
+	}
+
+	frustum_t make_frustum(const float* m)
+	{
+		// rows of the column major matrix
+		vec4_t r[4];
+		for (uint32_t row = 0; row < 4; ++row)
+		{
+			r[row] = { m[row], m[4 + row], m[8 + row], m[12 + row] };
+		}
+
+		// -w <= x, y <= w and 0 <= z <= w; a plane with a zero normal is always passed
+		return
+		{
+			{
+				{ r[3].x + r[0].x, r[3].y + r[0].y, r[3].z + r[0].z, r[3].w + r[0].w },
+				{ r[3].x - r[0].x, r[3].y - r[0].y, r[3].z - r[0].z, r[3].w - r[0].w },
+				{ r[3].x + r[1].x, r[3].y + r[1].y, r[3].z + r[1].z, r[3].w + r[1].w },
+				{ r[3].x - r[1].x, r[3].y - r[1].y, r[3].z - r[1].z, r[3].w - r[1].w },
+				r[2],
+				{ r[3].x - r[2].x, r[3].y - r[2].y, r[3].z - r[2].z, r[3].w - r[2].w }
+			}
+		};
+	}
+
+	bool is_aabb_visible(const frustum_t& frustum, const aabb_t& aabb)
+	{
+		for (uint32_t i = 0; i < 6; ++i)
+		{
+			const vec4_t& plane = frustum.planes[i];
+
+			// the corner furthest along the plane normal
+			float x = plane.x >= 0.0f ? aabb.max.x : aabb.min.x;
+			float y = plane.y >= 0.0f ? aabb.max.y : aabb.min.y;
+			float z = plane.z >= 0.0f ? aabb.max.z : aabb.min.z;
+
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+				return false;
+		}
+
+		return true;
+	}
+
+	// --- build ---
+
+	struct build_range_t
+	{
+		uint32_t first;
+		uint32_t count;
+		aabb_t   bounds;
+		aabb_t   centroid_bounds;
+	};
+
+	struct bvh_builder_t
+	{
+		bvh_t&  bvh;
+		vec3_t* centroids; // per instance
+	};
+
+	static build_range_t make_range(const bvh_builder_t& builder, uint32_t first, uint32_t count)
+	{
+		build_range_t range{ first, count, EMPTY_AABB, EMPTY_AABB };
+
+		for (uint32_t i = first; i < first + count; ++i)
+		{
+			const uint32_t instance = builder.bvh.items.data[i];
+
+			grow(range.bounds, builder.bvh.bounds.data[instance]);
+			grow(range.centroid_bounds, builder.centroids[instance]);
+		}
+
+		return range;
+	}
+
+	// binned SAH along the widest centroid axis, partitions the items of the range in place
+	static void split_range(const bvh_builder_t& builder, const build_range_t& range, build_range_t& left, build_range_t& right)
+	{
+		const float* cmin = &range.centroid_bounds.min.x;
+		const float* cmax = &range.centroid_bounds.max.x;
+
+		uint32_t axis = 0;
+		for (uint32_t a = 1; a < 3; ++a)
+		{
+			axis = cmax[a] - cmin[a] > cmax[axis] - cmin[axis] ? a : axis;
+		}
+
+		const float extent = cmax[axis] - cmin[axis];
+		uint32_t*   items  = builder.bvh.items.data + range.first;
+
+		// coincident centroids, any split is as good
+		if (extent <= 0.0f)
+		{
+			const uint32_t half = range.count / 2;
+
+			left  = make_range(builder, range.first, half);
+			right = make_range(builder, range.first + half, range.count - half);
+			return;
+		}
+
+		const float scale = (float)BVH_SAH_BINS / extent;
+
+		uint32_t bin_counts[BVH_SAH_BINS]{};
+		aabb_t   bin_bounds[BVH_SAH_BINS];
+
+		for (uint32_t b = 0; b < BVH_SAH_BINS; ++b)
+		{
+			bin_bounds[b] = EMPTY_AABB;
+		}
+
+		auto bin_of = [&](uint32_t instance)
+		{
+			const float c = (&builder.centroids[instance].x)[axis];
+			return SDL_min((uint32_t)((c - cmin[axis]) * scale), BVH_SAH_BINS - 1);
+		};
+
+		for (uint32_t i = 0; i < range.count; ++i)
+		{
+			const uint32_t bin = bin_of(items[i]);
+
+			++bin_counts[bin];
+			grow(bin_bounds[bin], builder.bvh.bounds.data[items[i]]);
+		}
+
+		// cost of splitting after bin b, left sweep then right sweep
+		float  costs[BVH_SAH_BINS - 1];
+		aabb_t accumulated = EMPTY_AABB;
+		uint32_t count{};
+
+		for (uint32_t b = 0; b < BVH_SAH_BINS - 1; ++b)
+		{
+			grow(accumulated, bin_bounds[b]);
+			count += bin_counts[b];
+			costs[b] = half_area(accumulated) * (float)count;
+		}
+
+		accumulated = EMPTY_AABB;
+		count       = 0;
+
+		uint32_t best      = 0;
+		float    best_cost = FLT_MAX;
+
+		for (uint32_t b = BVH_SAH_BINS - 1; b > 0; --b)
+		{
+			grow(accumulated, bin_bounds[b]);
+			count += bin_counts[b];
+
+			const float cost = costs[b - 1] + half_area(accumulated) * (float)count;
+			if (cost < best_cost && count != range.count && count != 0)
+			{
+				best_cost = cost;
+				best      = b - 1;
+			}
+		}
+
+		uint32_t i   = 0;
+		uint32_t end = range.count;
+
+		while (i < end)
+		{
+			if (bin_of(items[i]) <= best)
+			{
+				++i;
+			}
+			else
+			{
+				const uint32_t swap = items[i];
+				items[i]      = items[--end];
+				items[end]    = swap;
+			}
+		}
+
+		left  = make_range(builder, range.first, i);
+		right = make_range(builder, range.first + i, range.count - i);
+	}
+
+	static void set_slot(bvh_node_t& node, uint32_t slot, const aabb_t& bounds)
+	{
+		node.min_x[slot] = bounds.min.x;
+		node.min_y[slot] = bounds.min.y;
+		node.min_z[slot] = bounds.min.z;
+		node.max_x[slot] = bounds.max.x;
+		node.max_y[slot] = bounds.max.y;
+		node.max_z[slot] = bounds.max.z;
+	}
+
+	static uint32_t build_node(const bvh_builder_t& builder, const build_range_t& range, uint32_t parent)
+	{
+		bvh_t& bvh = builder.bvh;
+
+		const uint32_t node = (uint32_t)bvh.nodes.size;
+
+		vector_push_back(bvh.nodes, {});
+		vector_push_back(bvh.ranges, { range.first, range.count });
+		vector_push_back(bvh.parents, parent);
+		vector_push_back(bvh.dirty, (uint8_t)0);
+
+		// split the largest range until the node is full, a 4-wide node is two levels
+		// of binary splits collapsed
+		build_range_t slots[BVH_WIDTH];
+		uint32_t      slot_count = 1;
+
+		slots[0] = range;
+
+		while (slot_count < BVH_WIDTH)
+		{
+			uint32_t largest = BVH_INVALID;
+			float    area    = -1.0f;
+
+			for (uint32_t i = 0; i < slot_count; ++i)
+			{
+				if (slots[i].count > BVH_LEAF_SIZE && half_area(slots[i].bounds) > area)
+				{
+					largest = i;
+					area    = half_area(slots[i].bounds);
+				}
+			}
+
+			if (largest == BVH_INVALID)
+				break;
+
+			build_range_t left, right;
+			split_range(builder, slots[largest], left, right);
+
+			slots[largest]        = left;
+			slots[slot_count++]   = right;
+		}
+
+		uint32_t children[BVH_WIDTH];
+		uint32_t counts[BVH_WIDTH];
+
+		for (uint32_t i = 0; i < BVH_WIDTH; ++i)
+		{
+			children[i] = BVH_INVALID;
+			counts[i]   = 0;
+
+			if (i >= slot_count)
+				continue;
+
+			if (slots[i].count <= BVH_LEAF_SIZE)
+			{
+				children[i] = slots[i].first;
+				counts[i]   = slots[i].count;
+
+				for (uint32_t item = slots[i].first; item < slots[i].first + slots[i].count; ++item)
+				{
+					bvh.leaves.data[bvh.items.data[item]] = node;
+				}
+			}
+			else
+			{
+				children[i] = build_node(builder, slots[i], node);
+			}
+		}
+
+		// the recursion may have moved the nodes
+		bvh_node_t& written = bvh.nodes.data[node];
+
+		for (uint32_t i = 0; i < BVH_WIDTH; ++i)
+		{
+			set_slot(written, i, i < slot_count ? slots[i].bounds : EMPTY_AABB);
+
+			written.children[i] = children[i];
+			written.counts[i]   = counts[i];
+		}
+
+		return node;
+	}
+
+	void build_bvh(bvh_t& bvh, const aabb_t* bounds, uint32_t instance_count)
+	{
+		destroy_bvh(bvh);
+
+		// a node holds at least two children and a leaf up to BVH_LEAF_SIZE items
+		const size_t node_estimate = SDL_max(instance_count / 2, 1u);
+
+		bvh.nodes          = create_vector<bvh_node_t>(node_estimate);
+		bvh.ranges         = create_vector<bvh_range_t>(node_estimate);
+		bvh.parents        = create_vector<uint32_t>(node_estimate);
+		bvh.dirty          = create_vector<uint8_t>(node_estimate);
+		bvh.items          = create_vector<uint32_t>(SDL_max(instance_count, 1u));
+		bvh.leaves         = create_vector<uint32_t>(SDL_max(instance_count, 1u));
+		bvh.bounds         = create_vector<aabb_t>(SDL_max(instance_count, 1u));
+		bvh.instance_count = instance_count;
+
+		if (instance_count == 0)
+			return;
+
+		vec3_t* centroids = (vec3_t*)malloc(instance_count * sizeof(vec3_t));
+		assert(centroids && "malloc failed");
+
+		memcpy(bvh.bounds.data, bounds, instance_count * sizeof(aabb_t));
+		bvh.bounds.size = instance_count;
+		bvh.items.size  = instance_count;
+		bvh.leaves.size = instance_count;
+
+		for (uint32_t i = 0; i < instance_count; ++i)
+		{
+			bvh.items.data[i] = i;
+			centroids[i]      = { (bounds[i].min.x + bounds[i].max.x) * 0.5f, (bounds[i].min.y + bounds[i].max.y) * 0.5f, (bounds[i].min.z + bounds[i].max.z) * 0.5f };
+		}
+
+		bvh_builder_t builder{ bvh, centroids };
+		build_node(builder, make_range(builder, 0, instance_count), BVH_INVALID);
+
+		free(centroids);
+	}
+
+	void destroy_bvh(bvh_t& bvh)
+	{
+		if (!bvh.nodes.data)
+			return;
+
+		destroy_vector(bvh.nodes);
+		destroy_vector(bvh.ranges);
+		destroy_vector(bvh.parents);
+		destroy_vector(bvh.items);
+		destroy_vector(bvh.leaves);
+		destroy_vector(bvh.bounds);
+		destroy_vector(bvh.dirty);
+
+		bvh = {};
+	}
+
+	// --- refit ---
+
+	void update_bvh_instance(bvh_t& bvh, uint32_t instance, const aabb_t& bounds)
+	{
+		assert(instance < bvh.instance_count && "instance out of range");
+
+		bvh.bounds.data[instance] = bounds;
+
+		// stops at the first ancestor an earlier update already marked
+		for (uint32_t node = bvh.leaves.data[instance]; node != BVH_INVALID && !bvh.dirty.data[node]; node = bvh.parents.data[node])
+		{
+			bvh.dirty.data[node] = 1;
+			++bvh.dirty_count;
+		}
+	}
+
+	void refit_bvh(bvh_t& bvh)
+	{
+		// children are stored after their parents, walking backwards refits them first
+		for (uint32_t node = (uint32_t)bvh.nodes.size; node-- > 0 && bvh.dirty_count;)
+		{
+			if (!bvh.dirty.data[node])
+				continue;
+
+			bvh_node_t& n = bvh.nodes.data[node];
+
+			for (uint32_t slot = 0; slot < BVH_WIDTH; ++slot)
+			{
+				if (n.children[slot] == BVH_INVALID)
+					continue;
+
+				aabb_t bounds = EMPTY_AABB;
+
+				if (n.counts[slot])
+				{
+					for (uint32_t item = n.children[slot]; item < n.children[slot] + n.counts[slot]; ++item)
+					{
+						grow(bounds, bvh.bounds.data[bvh.items.data[item]]);
+					}
+				}
+				else
+				{
+					const bvh_node_t& child = bvh.nodes.data[n.children[slot]];
+
+					for (uint32_t i = 0; i < BVH_WIDTH; ++i)
+					{
+						if (child.children[i] != BVH_INVALID)
+						{
+							grow(bounds, { { child.min_x[i], child.min_y[i], child.min_z[i] }, { child.max_x[i], child.max_y[i], child.max_z[i] } });
+						}
+					}
+				}
+
+				set_slot(n, slot, bounds);
+			}
+
+			bvh.dirty.data[node] = 0;
+			--bvh.dirty_count;
+		}
+	}
+
+	// --- frustum culling ---
+
+	// per child, outside any plane or not entirely inside all of them
+	static inline void test_children(const bvh_node_t& node, const frustum_t& frustum, uint32_t& outside, uint32_t& partial)
+	{
+		const lane_t zero = set_lanes(0.0f);
+
+		outside = 0;
+		partial = 0;
+
+		for (uint32_t i = 0; i < 6; ++i)
+		{
+			const vec4_t& plane = frustum.planes[i];
+
+			// the corners furthest along and against the normal, picked per plane so every lane
+			// uses the same arrays
+			const bool px = plane.x >= 0.0f;
+			const bool py = plane.y >= 0.0f;
+			const bool pz = plane.z >= 0.0f;
+
+			const lane_t nx = set_lanes(plane.x);
+			const lane_t ny = set_lanes(plane.y);
+			const lane_t nz = set_lanes(plane.z);
+			const lane_t w  = set_lanes(plane.w);
+
+			lane_t far  = add(add(mul(nx, load_lanes(px ? node.max_x : node.min_x)), mul(ny, load_lanes(py ? node.max_y : node.min_y))), add(mul(nz, load_lanes(pz ? node.max_z : node.min_z)), w));
+			lane_t near = add(add(mul(nx, load_lanes(px ? node.min_x : node.max_x)), mul(ny, load_lanes(py ? node.min_y : node.max_y))), add(mul(nz, load_lanes(pz ? node.min_z : node.max_z)), w));
+
+			outside |= less_mask(far, zero);
+			partial |= less_mask(near, zero);
+		}
+	}
+
+	enum bvh_task_kind_t : uint32_t
+	{
+		BVH_TASK_NODE,   // traverse a subtree
+		BVH_TASK_LEAF,   // test the items of a leaf one by one
+		BVH_TASK_INSIDE  // copy the items, the bounds are entirely inside
+	};
+
+	// writes its visible items at visible + range.first, compacted afterwards
+	struct bvh_cull_task_t
+	{
+		uint32_t        query;
+		bvh_task_kind_t kind;
+		uint32_t        node;
+		bvh_range_t     range;
+		uint32_t        visible_count;
+	};
+
+	struct bvh_cull_job_t
+	{
+		const bvh_t*      bvh;
+		bvh_cull_query_t* queries;
+		bvh_cull_task_t*  tasks;
+	};
+
+	static inline bvh_range_t get_slot_range(const bvh_t& bvh, const bvh_node_t& node, uint32_t slot)
+	{
+		return node.counts[slot] ? bvh_range_t{ node.children[slot], node.counts[slot] } : bvh.ranges.data[node.children[slot]];
+	}
+
+	static uint32_t cull_leaf(const bvh_t& bvh, const frustum_t& frustum, bvh_range_t range, uint32_t* visible)
+	{
+		uint32_t count{};
+
+		for (uint32_t item = range.first; item < range.first + range.count; ++item)
+		{
+			const uint32_t instance = bvh.items.data[item];
+			if (is_aabb_visible(frustum, bvh.bounds.data[instance]))
+			{
+				visible[count++] = instance;
+			}
+		}
+
+		return count;
+	}
+
+	static uint32_t cull_subtree(const bvh_t& bvh, const frustum_t& frustum, uint32_t root, uint32_t* visible)
+	{
+		uint32_t stack[128];
+		uint32_t stack_size{};
+		uint32_t count{};
+
+		stack[stack_size++] = root;
+
+		while (stack_size)
+		{
+			const bvh_node_t& node = bvh.nodes.data[stack[--stack_size]];
+
+			uint32_t outside, partial;
+			test_children(node, frustum, outside, partial);
+
+			for (uint32_t slot = 0; slot < BVH_WIDTH; ++slot)
+			{
+				if (node.children[slot] == BVH_INVALID || (outside & (1u << slot)))
+					continue;
+
+				if (!(partial & (1u << slot)))
+				{
+					const bvh_range_t range = get_slot_range(bvh, node, slot);
+
+					memcpy(visible + count, bvh.items.data + range.first, range.count * sizeof(uint32_t));
+					count += range.count;
+				}
+				else if (node.counts[slot])
+				{
+					count += cull_leaf(bvh, frustum, { node.children[slot], node.counts[slot] }, visible + count);
+				}
+				else
+				{
+					assert(stack_size < ARRAY_SIZE(stack) && "bvh too deep");
+					stack[stack_size++] = node.children[slot];
+				}
+			}
+		}
+
+		return count;
+	}
+
+	static void run_cull_tasks(uint32_t begin, uint32_t end, void* data)
+	{
+		const bvh_cull_job_t& job = *(const bvh_cull_job_t*)data;
+		const bvh_t&          bvh = *job.bvh;
+
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			bvh_cull_task_t&        task  = job.tasks[i];
+			const bvh_cull_query_t& query = job.queries[task.query];
+
+			uint32_t* visible = query.visible + task.range.first;
+
+			switch (task.kind)
+			{
+			case BVH_TASK_NODE:
+				task.visible_count = cull_subtree(bvh, query.frustum, task.node, visible);
+				break;
+			case BVH_TASK_LEAF:
+				task.visible_count = cull_leaf(bvh, query.frustum, task.range, visible);
+				break;
+			case BVH_TASK_INSIDE:
+				memcpy(visible, bvh.items.data + task.range.first, task.range.count * sizeof(uint32_t));
+				task.visible_count = task.range.count;
+				break;
+			}
+		}
+	}
+
+	static int compare_tasks(const void* a, const void* b)
+	{
+		const bvh_cull_task_t* ta = (const bvh_cull_task_t*)a;
+		const bvh_cull_task_t* tb = (const bvh_cull_task_t*)b;
+
+		return ta->range.first < tb->range.first ? -1 : ta->range.first > tb->range.first;
+	}
+
+	// breadth first from the root until the query has about target_count disjoint tasks
+	static uint32_t split_cull_query(const bvh_t& bvh, uint32_t query_index, const frustum_t& frustum, uint32_t target_count, bvh_cull_task_t* tasks)
+	{
+		uint32_t count{};
+		tasks[count++] = { query_index, BVH_TASK_NODE, 0, bvh.ranges.data[0], 0 };
+
+		uint32_t i = 0;
+		while (i < count)
+		{
+			if (tasks[i].kind != BVH_TASK_NODE || count + BVH_WIDTH - 1 > target_count)
+			{
+				++i;
+				continue;
+			}
+
+			const bvh_node_t& node = bvh.nodes.data[tasks[i].node];
+
+			uint32_t outside, partial;
+			test_children(node, frustum, outside, partial);
+
+			// the node's task is replaced by its children's
+			tasks[i] = tasks[--count];
+
+			for (uint32_t slot = 0; slot < BVH_WIDTH; ++slot)
+			{
+				if (node.children[slot] == BVH_INVALID || (outside & (1u << slot)))
+					continue;
+
+				bvh_task_kind_t kind = !(partial & (1u << slot)) ? BVH_TASK_INSIDE : node.counts[slot] ? BVH_TASK_LEAF : BVH_TASK_NODE;
+
+				tasks[count++] = { query_index, kind, node.children[slot], get_slot_range(bvh, node, slot), 0 };
+			}
+		}
+
+		return count;
+	}
+
+	void cull_bvh(const bvh_t& bvh, bvh_cull_query_t* queries, uint32_t query_count)
+	{
+		if (query_count == 0)
+			return;
+
+		if (bvh.instance_count == 0)
+		{
+			for (uint32_t q = 0; q < query_count; ++q)
+			{
+				queries[q].visible_count = 0;
+			}
+
+			return;
+		}
+
+		const uint32_t target_count = SDL_max(BVH_CULL_TASKS / query_count, BVH_WIDTH);
+		const uint32_t capacity     = target_count + BVH_WIDTH;
+
+		bvh_cull_task_t* tasks       = (bvh_cull_task_t*)malloc((size_t)query_count * capacity * sizeof(bvh_cull_task_t));
+		uint32_t*        task_counts = (uint32_t*)malloc(query_count * sizeof(uint32_t));
+		assert(tasks && task_counts && "malloc failed");
+
+		// queries get consecutive task ranges so one parallel_for runs them all
+		uint32_t task_count{};
+
+		for (uint32_t q = 0; q < query_count; ++q)
+		{
+			task_counts[q] = split_cull_query(bvh, q, queries[q].frustum, target_count, tasks + task_count);
+			task_count    += task_counts[q];
+		}
+
+		bvh_cull_job_t job{ &bvh, queries, tasks };
+		parallel_for(task_count, 1, run_cull_tasks, &job);
+
+		// every task wrote at the start of its item range, close the gaps in leaf order
+		bvh_cull_task_t* query_tasks = tasks;
+
+		for (uint32_t q = 0; q < query_count; ++q)
+		{
+			SDL_qsort(query_tasks, task_counts[q], sizeof(bvh_cull_task_t), compare_tasks);
+
+			uint32_t visible_count{};
+			for (uint32_t t = 0; t < task_counts[q]; ++t)
+			{
+				memmove(queries[q].visible + visible_count, queries[q].visible + query_tasks[t].range.first, query_tasks[t].visible_count * sizeof(uint32_t));
+				visible_count += query_tasks[t].visible_count;
+			}
+
+			queries[q].visible_count = visible_count;
+			query_tasks += task_counts[q];
+		}
+
+		free(task_counts);
+		free(tasks);
+	}
+
+	// --- ray queries ---
+
+	struct ray_stack_entry_t
+	{
+		uint32_t node;
+		float    t;
+	};
+
+	static ray_hit_t intersect_ray(const bvh_t& bvh, const ray_t& ray)
+	{
+		ray_hit_t hit{ BVH_INVALID, ray.t_max };
+
+		// 1 / 0 is an infinite slab, hit from anywhere inside it
+		const vec3_t inverse{ 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+		const lane_t ox = set_lanes(ray.origin.x);
+		const lane_t oy = set_lanes(ray.origin.y);
+		const lane_t oz = set_lanes(ray.origin.z);
+		const lane_t ix = set_lanes(inverse.x);
+		const lane_t iy = set_lanes(inverse.y);
+		const lane_t iz = set_lanes(inverse.z);
+
+		// the near and far planes of a slab swap with the sign of the direction
+		const bool nx = inverse.x < 0.0f;
+		const bool ny = inverse.y < 0.0f;
+		const bool nz = inverse.z < 0.0f;
+
+		ray_stack_entry_t stack[128];
+		uint32_t          stack_size{};
+
+		stack[stack_size++] = { 0, 0.0f };
+
+		while (stack_size)
+		{
+			const ray_stack_entry_t entry = stack[--stack_size];
+			if (entry.t >= hit.t)
+				continue;
+
+			const bvh_node_t& node = bvh.nodes.data[entry.node];
+
+			lane_t t_near = max_lanes(
+				max_lanes(mul(sub(load_lanes(nx ? node.max_x : node.min_x), ox), ix), mul(sub(load_lanes(ny ? node.max_y : node.min_y), oy), iy)),
+				max_lanes(mul(sub(load_lanes(nz ? node.max_z : node.min_z), oz), iz), set_lanes(0.0f)));
+
+			lane_t t_far = min_lanes(
+				min_lanes(mul(sub(load_lanes(nx ? node.min_x : node.max_x), ox), ix), mul(sub(load_lanes(ny ? node.min_y : node.max_y), oy), iy)),
+				min_lanes(mul(sub(load_lanes(nz ? node.min_z : node.max_z), oz), iz), set_lanes(hit.t)));
+
+			uint32_t mask = less_equal_mask(t_near, t_far);
+			if (!mask)
+				continue;
+
+			alignas(16) float t[BVH_WIDTH];
+			store_lanes(t, t_near);
+
+			// children are pushed far to near so the nearest is traversed first
+			uint32_t order[BVH_WIDTH];
+			uint32_t order_count{};
+
+			for (uint32_t slot = 0; slot < BVH_WIDTH; ++slot)
+			{
+				if (!(mask & (1u << slot)) || node.children[slot] == BVH_INVALID)
+					continue;
+
+				if (node.counts[slot])
+				{
+					for (uint32_t item = node.children[slot]; item < node.children[slot] + node.counts[slot]; ++item)
+					{
+						const uint32_t instance = bvh.items.data[item];
+						const aabb_t&  bounds   = bvh.bounds.data[instance];
+
+						float t0 = 0.0f;
+						float t1 = hit.t;
+
+						for (uint32_t axis = 0; axis < 3; ++axis)
+						{
+							const float o   = (&ray.origin.x)[axis];
+							const float inv = (&inverse.x)[axis];
+
+							float a = ((&bounds.min.x)[axis] - o) * inv;
+							float b = ((&bounds.max.x)[axis] - o) * inv;
+
+							t0 = SDL_max(t0, SDL_min(a, b));
+							t1 = SDL_min(t1, SDL_max(a, b));
+						}
+
+						if (t0 <= t1 && t0 < hit.t)
+						{
+							hit = { instance, t0 };
+						}
+					}
+
+					continue;
+				}
+
+				uint32_t j = order_count++;
+				while (j > 0 && t[order[j - 1]] < t[slot])
+				{
+					order[j] = order[j - 1];
+					--j;
+				}
+
+				order[j] = slot;
+			}
+
+			for (uint32_t i = 0; i < order_count; ++i)
+			{
+				assert(stack_size < ARRAY_SIZE(stack) && "bvh too deep");
+				stack[stack_size++] = { node.children[order[i]], t[order[i]] };
+			}
+		}
+
+		return hit;
+	}
+
+	struct ray_job_t
+	{
+		const bvh_t* bvh;
+		const ray_t* rays;
+		ray_hit_t*   hits;
+	};
+
+	static void intersect_ray_range(uint32_t begin, uint32_t end, void* data)
+	{
+		const ray_job_t& job = *(const ray_job_t*)data;
+
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			job.hits[i] = intersect_ray(*job.bvh, job.rays[i]);
+		}
+	}
+
+	void intersect_bvh(const bvh_t& bvh, const ray_t* rays, uint32_t ray_count, ray_hit_t* hits)
+	{
+		if (bvh.instance_count == 0)
+		{
+			for (uint32_t i = 0; i < ray_count; ++i)
+			{
+				hits[i] = { BVH_INVALID, rays[i].t_max };
+			}
+
+			return;
+		}
+
+		ray_job_t job{ &bvh, rays, hits };
+		parallel_for(ray_count, RAYS_PER_JOB, intersect_ray_range, &job);
+	}
+
+} // olivia
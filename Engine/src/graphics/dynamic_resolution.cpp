@@ -0,0 +1,61 @@
+#include "olivia/graphics/dynamic_resolution.h"
+
+#include <math.h>
+
+namespace olivia
+{
+	static float clamp_scale(const dynamic_resolution_t& controller, float scale)
+	{
+		return fminf(fmaxf(scale, controller.min_scale), controller.max_scale);
+	}
+
+	dynamic_resolution_t create_dynamic_resolution(float target_ms, float min_scale, float max_scale)
+	{
+		assert(target_ms > 0.0f && min_scale > 0.0f && min_scale <= max_scale && "invalid dynamic resolution range");
+
+		return { target_ms, min_scale, max_scale, max_scale, 0.0f };
+	}
+
+	float update_dynamic_resolution(dynamic_resolution_t& controller, float gpu_ms, float measured_scale)
+	{
+		if (gpu_ms <= 0.0f || measured_scale <= 0.0f)
+			return controller.scale;
+
+		const float cost = gpu_ms / (measured_scale * measured_scale);
+
+		if (controller.cost == 0.0f)
+		{
+			controller.cost = cost;
+		}
+		else
+		{
+			const float weight = cost > controller.cost ? DYNAMIC_RESOLUTION_RISE : DYNAMIC_RESOLUTION_FALL;
+			controller.cost += (cost - controller.cost) * weight;
+		}
+
+		const float desired = clamp_scale(controller, sqrtf(controller.target_ms / controller.cost));
+
+		// what the scale already picked would take, for the measurement that just came in
+		const float predicted = controller.cost * controller.scale * controller.scale;
+
+		// the range ends are always reached, the band there would leave the scale short of them
+		const bool at_limit = desired == controller.min_scale || desired == controller.max_scale;
+
+		const bool over  = predicted > controller.target_ms * (1.0f + DYNAMIC_RESOLUTION_OVER);
+		const bool under = predicted < controller.target_ms * (1.0f - DYNAMIC_RESOLUTION_UNDER);
+
+		if ((at_limit && desired != controller.scale) || over || under)
+		{
+			controller.scale = desired;
+		}
+
+		return controller.scale;
+	}
+
+	void scale_extent(uint32_t width, uint32_t height, float scale, uint32_t& scaled_width, uint32_t& scaled_height)
+	{
+		scaled_width  = (uint32_t)fmaxf(1.0f, floorf((float)width * scale + 0.5f));
+		scaled_height = (uint32_t)fmaxf(1.0f, floorf((float)height * scale + 0.5f));
+	}
+
+} // olivia
@@ -0,0 +1,414 @@
+#include "olivia/graphics/mesh_simplify.h"
+
+#include <SDL3/SDL.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+namespace olivia
+{
+	// --- quadrics ---
+
+	// the symmetric 4x4 plane quadric, summed squared distances to the planes weighted by
+	// triangle area; weight is the area sum the error is normalized by
+	struct quadric_t
+	{
+		double a2, b2, c2, d2;
+		double ab, ac, ad;
+		double bc, bd;
+		double cd;
+		double weight;
+	};
+
+	static void add_plane(quadric_t& q, double a, double b, double c, double d, double weight)
+	{
+		q.a2 += a * a * weight;
+		q.b2 += b * b * weight;
+		q.c2 += c * c * weight;
+		q.d2 += d * d * weight;
+		q.ab += a * b * weight;
+		q.ac += a * c * weight;
+		q.ad += a * d * weight;
+		q.bc += b * c * weight;
+		q.bd += b * d * weight;
+		q.cd += c * d * weight;
+
+		q.weight += weight;
+	}
+
+	static void add_quadric(quadric_t& q, const quadric_t& other)
+	{
+		q.a2 += other.a2; q.b2 += other.b2; q.c2 += other.c2; q.d2 += other.d2;
+		q.ab += other.ab; q.ac += other.ac; q.ad += other.ad;
+		q.bc += other.bc; q.bd += other.bd;
+		q.cd += other.cd;
+
+		q.weight += other.weight;
+	}
+
+	static double evaluate_quadric(const quadric_t& q, vec3_t p)
+	{
+		const double x = p.x, y = p.y, z = p.z;
+
+		return q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + q.d2
+			+ 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z + q.ad * x + q.bd * y + q.cd * z);
+	}
+
+	// mean squared distance of p to the planes of a and b together
+	static float collapse_cost(const quadric_t& a, const quadric_t& b, vec3_t p)
+	{
+		const double weight = a.weight + b.weight;
+		if (weight <= 0.0)
+			return 0.0f;
+
+		return (float)SDL_max((evaluate_quadric(a, p) + evaluate_quadric(b, p)) / weight, 0.0);
+	}
+
+	// --- geometry ---
+
+	static inline vec3_t get_position(const vec3_t* positions, uint32_t stride, uint32_t vertex)
+	{
+		return *(const vec3_t*)((const uint8_t*)positions + (size_t)vertex * stride);
+	}
+
+	static inline vec3_t sub(vec3_t a, vec3_t b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	static inline float  dot(vec3_t a, vec3_t b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	static inline vec3_t cross(vec3_t a, vec3_t b)
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	static int compare_edges(const void* a, const void* b)
+	{
+		const uint64_t ea = *(const uint64_t*)a;
+		const uint64_t eb = *(const uint64_t*)b;
+
+		return ea < eb ? -1 : ea > eb;
+	}
+
+	// vertices on an edge that does not have exactly two triangles
+	static void find_locked_vertices(const uint32_t* indices, uint32_t index_count, uint8_t* locked)
+	{
+		uint64_t* edges = (uint64_t*)malloc(index_count * sizeof(uint64_t));
+		assert(edges && "malloc failed");
+
+		for (uint32_t i = 0; i < index_count; ++i)
+		{
+			const uint32_t a = indices[i];
+			const uint32_t b = indices[i % 3 == 2 ? i - 2 : i + 1];
+
+			edges[i] = a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+		}
+
+		SDL_qsort(edges, index_count, sizeof(uint64_t), compare_edges);
+
+		for (uint32_t i = 0; i < index_count;)
+		{
+			uint32_t end = i + 1;
+			while (end < index_count && edges[end] == edges[i])
+			{
+				++end;
+			}
+
+			if (end - i != 2)
+			{
+				locked[edges[i] >> 32]        = 1;
+				locked[edges[i] & 0xFFFFFFFF] = 1;
+			}
+
+			i = end;
+		}
+
+		free(edges);
+	}
+
+	// --- simplify ---
+
+	struct collapse_t
+	{
+		uint32_t from;
+		uint32_t to;
+		float    cost;
+	};
+
+	static int compare_collapses(const void* a, const void* b)
+	{
+		const float ca = ((const collapse_t*)a)->cost;
+		const float cb = ((const collapse_t*)b)->cost;
+
+		return ca < cb ? -1 : ca > cb;
+	}
+
+	struct simplifier_t
+	{
+		const vec3_t* positions;
+		uint32_t      stride;
+		uint32_t*     indices;        // the working triangles
+		uint32_t      index_count;
+		quadric_t*    quadrics;       // per vertex
+		uint8_t*      locked;
+		uint8_t*      touched;        // changed this pass
+		uint32_t*     remap;
+		uint32_t*     first_triangle; // per vertex + 1, into vertex_triangles
+		uint32_t*     vertex_triangles;
+	};
+
+	static void build_adjacency(simplifier_t& s, uint32_t vertex_count)
+	{
+		memset(s.first_triangle, 0, (vertex_count + 1) * sizeof(uint32_t));
+
+		for (uint32_t i = 0; i < s.index_count; ++i)
+		{
+			++s.first_triangle[s.indices[i]];
+		}
+
+		// the end of every list, filling back to front leaves each entry at the start of its own
+		for (uint32_t v = 1; v <= vertex_count; ++v)
+		{
+			s.first_triangle[v] += s.first_triangle[v - 1];
+		}
+
+		for (uint32_t i = s.index_count; i-- > 0;)
+		{
+			s.vertex_triangles[--s.first_triangle[s.indices[i]]] = i / 3;
+		}
+	}
+
+	// moving from onto to must not fold any remaining triangle around from over
+	static bool is_collapse_valid(const simplifier_t& s, uint32_t from, uint32_t to)
+	{
+		const vec3_t target = get_position(s.positions, s.stride, to);
+
+		for (uint32_t t = s.first_triangle[from]; t < s.first_triangle[from + 1]; ++t)
+		{
+			const uint32_t* triangle = s.indices + s.vertex_triangles[t] * 3;
+
+			// collapses away
+			if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				continue;
+
+			vec3_t before[3];
+			vec3_t after[3];
+
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				before[i] = get_position(s.positions, s.stride, triangle[i]);
+				after[i]  = triangle[i] == from ? target : before[i];
+			}
+
+			const vec3_t n0 = cross(sub(before[1], before[0]), sub(before[2], before[0]));
+			const vec3_t n1 = cross(sub(after[1], after[0]), sub(after[2], after[0]));
+
+			const float length = sqrtf(dot(n0, n0) * dot(n1, n1));
+			if (length <= 0.0f || dot(n0, n1) < SIMPLIFY_MIN_NORMAL_DOT * length)
+				return false;
+		}
+
+		return true;
+	}
+
+	uint32_t simplify_mesh(const vec3_t* positions, uint32_t vertex_count, uint32_t stride,
+		const uint32_t* indices, uint32_t index_count, uint32_t target_index_count, float max_error,
+		uint32_t* destination, float& error)
+	{
+		assert(index_count % 3 == 0 && "not a triangle list");
+
+		memcpy(destination, indices, index_count * sizeof(uint32_t));
+		error = 0.0f;
+
+		if (index_count <= target_index_count || vertex_count == 0)
+			return index_count;
+
+		simplifier_t s{ positions, stride, destination, index_count };
+
+		s.quadrics         = (quadric_t*)calloc(vertex_count, sizeof(quadric_t));
+		s.locked           = (uint8_t*)calloc(vertex_count, 1);
+		s.touched          = (uint8_t*)malloc(vertex_count);
+		s.remap            = (uint32_t*)malloc(vertex_count * sizeof(uint32_t));
+		s.first_triangle   = (uint32_t*)malloc((vertex_count + 1) * sizeof(uint32_t));
+		s.vertex_triangles = (uint32_t*)malloc(index_count * sizeof(uint32_t));
+
+		collapse_t* collapses = (collapse_t*)malloc(index_count * sizeof(collapse_t));
+		assert(s.quadrics && s.locked && s.touched && s.remap && s.first_triangle && s.vertex_triangles && collapses && "malloc failed");
+
+		find_locked_vertices(indices, index_count, s.locked);
+
+		for (uint32_t v = 0; v < vertex_count; ++v)
+		{
+			s.remap[v] = v;
+		}
+
+		// every corner gets the plane of its triangle, weighted by area
+		for (uint32_t i = 0; i < index_count; i += 3)
+		{
+			const vec3_t p0 = get_position(positions, stride, indices[i + 0]);
+			const vec3_t p1 = get_position(positions, stride, indices[i + 1]);
+			const vec3_t p2 = get_position(positions, stride, indices[i + 2]);
+
+			const vec3_t n      = cross(sub(p1, p0), sub(p2, p0));
+			const double length = sqrt((double)dot(n, n));
+			if (length <= 0.0)
+				continue;
+
+			const double a = n.x / length;
+			const double b = n.y / length;
+			const double c = n.z / length;
+			const double d = -(a * p0.x + b * p0.y + c * p0.z);
+
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				add_plane(s.quadrics[indices[i + corner]], a, b, c, d, length * 0.5);
+			}
+		}
+
+		const float max_cost = max_error * max_error;
+		float       max_used{};
+
+		while (s.index_count > target_index_count)
+		{
+			// both directions of every edge, the cheaper one that may move
+			uint32_t collapse_count{};
+
+			for (uint32_t i = 0; i < s.index_count; ++i)
+			{
+				const uint32_t a = s.indices[i];
+				const uint32_t b = s.indices[i % 3 == 2 ? i - 2 : i + 1];
+
+				if (s.locked[a] && s.locked[b])
+					continue;
+
+				const float cost_ab = s.locked[a] ? FLT_MAX : collapse_cost(s.quadrics[a], s.quadrics[b], get_position(positions, stride, b));
+				const float cost_ba = s.locked[b] ? FLT_MAX : collapse_cost(s.quadrics[a], s.quadrics[b], get_position(positions, stride, a));
+
+				collapses[collapse_count++] = cost_ab <= cost_ba ? collapse_t{ a, b, cost_ab } : collapse_t{ b, a, cost_ba };
+			}
+
+			SDL_qsort(collapses, collapse_count, sizeof(collapse_t), compare_collapses);
+
+			build_adjacency(s, vertex_count);
+			memset(s.touched, 0, vertex_count);
+
+			// a collapse removes about two triangles
+			const uint32_t remaining_triangles = (s.index_count - target_index_count) / 3;
+			const uint32_t budget              = SDL_max((uint32_t)((float)remaining_triangles * SIMPLIFY_PASS_FRACTION), 1u);
+
+			uint32_t collapsed{};
+
+			for (uint32_t i = 0; i < collapse_count && collapsed < budget; ++i)
+			{
+				const collapse_t& collapse = collapses[i];
+				if (collapse.cost > max_cost)
+					break;
+
+				if (s.touched[collapse.from] || s.touched[collapse.to] || !is_collapse_valid(s, collapse.from, collapse.to))
+					continue;
+
+				s.remap[collapse.from] = collapse.to;
+				add_quadric(s.quadrics[collapse.to], s.quadrics[collapse.from]);
+
+				// the triangles around from change, keep their vertices out of this pass
+				for (uint32_t t = s.first_triangle[collapse.from]; t < s.first_triangle[collapse.from + 1]; ++t)
+				{
+					const uint32_t* triangle = s.indices + s.vertex_triangles[t] * 3;
+
+					s.touched[triangle[0]] = 1;
+					s.touched[triangle[1]] = 1;
+					s.touched[triangle[2]] = 1;
+				}
+
+				max_used = SDL_max(max_used, collapse.cost);
+				++collapsed;
+			}
+
+			if (collapsed == 0)
+				break;
+
+			// remap and drop the triangles that collapsed
+			uint32_t kept{};
+
+			for (uint32_t i = 0; i < s.index_count; i += 3)
+			{
+				const uint32_t a = s.remap[s.indices[i + 0]];
+				const uint32_t b = s.remap[s.indices[i + 1]];
+				const uint32_t c = s.remap[s.indices[i + 2]];
+
+				if (a == b || b == c || c == a)
+					continue;
+
+				s.indices[kept++] = a;
+				s.indices[kept++] = b;
+				s.indices[kept++] = c;
+			}
+
+			s.index_count = kept;
+		}
+
+		error = sqrtf(max_used);
+
+		free(collapses);
+		free(s.vertex_triangles);
+		free(s.first_triangle);
+		free(s.remap);
+		free(s.touched);
+		free(s.locked);
+		free(s.quadrics);
+
+		return s.index_count;
+	}
+
+	// --- lods ---
+
+	uint32_t generate_mesh_lods(const vec3_t* positions, uint32_t vertex_count, uint32_t stride,
+		const uint32_t* indices, uint32_t index_count, float max_error,
+		uint32_t* destination, mesh_lod_t* lods)
+	{
+		memcpy(destination, indices, index_count * sizeof(uint32_t));
+		lods[0] = { 0, index_count, 0.0f };
+
+		uint32_t lod_count = 1;
+		uint32_t used      = index_count;
+
+		while (lod_count < MAX_MESH_LODS)
+		{
+			const mesh_lod_t& previous = lods[lod_count - 1];
+
+			const uint32_t target = previous.index_count / 6 * 3;
+			if (target == 0)
+				break;
+
+			float error{};
+			uint32_t count = simplify_mesh(positions, vertex_count, stride, indices, index_count, target, max_error, destination + used, error);
+
+			if (count == 0 || (float)count > (float)previous.index_count * MESH_LOD_MIN_REDUCTION)
+				break;
+
+			// a level never claims to be closer to the surface than a finer one
+			lods[lod_count++] = { used, count, SDL_max(error, previous.error) };
+			used += count;
+		}
+
+		return lod_count;
+	}
+
+	uint32_t select_mesh_lod(const mesh_lod_t* lods, uint32_t lod_count, float scale, float distance,
+		uint32_t current_lod, const lod_selection_t& selection)
+	{
+		// a camera sitting on the instance sees the full mesh
+		const float pixels = selection.pixels_per_unit * scale / SDL_max(distance, 1e-3f);
+
+		uint32_t lod = 0;
+
+		for (uint32_t i = 1; i < lod_count; ++i)
+		{
+			const float max_error = i > current_lod ? selection.max_pixel_error * (1.0f - selection.hysteresis) : selection.max_pixel_error;
+			if (lods[i].error * pixels > max_error)
+				break;
+
+			lod = i;
+		}
+
+		return lod;
+	}
+
+} // olivia
@@ -0,0 +1,536 @@
+#include "olivia/graphics/render_graph.h"
+
+namespace olivia
+{
+	static const graph_access_info_t GRAPH_ACCESS_INFO[GRAPH_ACCESS_COUNT]
+	{
+		// GRAPH_ACCESS_NONE
+		{ VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED, false },
+		// GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE
+		{ VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true },
+		// GRAPH_ACCESS_COLOR_ATTACHMENT_READ_WRITE
+		{ VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true },
+		// GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE
+		{ VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, true },
+		// GRAPH_ACCESS_DEPTH_ATTACHMENT_READ
+		{ VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL, false },
+		// GRAPH_ACCESS_SAMPLED_FRAGMENT
+		{ VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false },
+		// GRAPH_ACCESS_SAMPLED_COMPUTE
+		{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false },
+		// GRAPH_ACCESS_STORAGE_READ_COMPUTE
+		{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false },
+		// GRAPH_ACCESS_STORAGE_WRITE_COMPUTE
+		{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true },
+		// GRAPH_ACCESS_STORAGE_READ_VERTEX
+		{ VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false },
+		// GRAPH_ACCESS_STORAGE_READ_FRAGMENT
+		{ VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false },
+		// GRAPH_ACCESS_VERTEX_READ
+		{ VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false },
+		// GRAPH_ACCESS_INDIRECT_READ
+		{ VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false },
+		// GRAPH_ACCESS_TRANSFER_READ
+		{ VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false },
+		// GRAPH_ACCESS_TRANSFER_WRITE
+		{ VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true },
+		// GRAPH_ACCESS_PRESENT
+		{ VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false },
+	};
+
+	const graph_access_info_t& get_graph_access_info(graph_access_t access)
+	{
+		return GRAPH_ACCESS_INFO[access];
+	}
+
+	static VkImageUsageFlags access_image_usage(graph_access_t access)
+	{
+		switch (access)
+		{
+		case GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE:
+		case GRAPH_ACCESS_COLOR_ATTACHMENT_READ_WRITE: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		case GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE:
+		case GRAPH_ACCESS_DEPTH_ATTACHMENT_READ:       return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		case GRAPH_ACCESS_SAMPLED_FRAGMENT:
+		case GRAPH_ACCESS_SAMPLED_COMPUTE:             return VK_IMAGE_USAGE_SAMPLED_BIT;
+		case GRAPH_ACCESS_STORAGE_READ_COMPUTE:
+		case GRAPH_ACCESS_STORAGE_WRITE_COMPUTE:
+		case GRAPH_ACCESS_STORAGE_READ_VERTEX:
+		case GRAPH_ACCESS_STORAGE_READ_FRAGMENT:       return VK_IMAGE_USAGE_STORAGE_BIT;
+		case GRAPH_ACCESS_TRANSFER_READ:               return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		case GRAPH_ACCESS_TRANSFER_WRITE:              return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		default:                                       return 0;
+		}
+	}
+
+	static VkBufferUsageFlags access_buffer_usage(graph_access_t access)
+	{
+		switch (access)
+		{
+		case GRAPH_ACCESS_STORAGE_READ_COMPUTE:
+		case GRAPH_ACCESS_STORAGE_WRITE_COMPUTE:
+		case GRAPH_ACCESS_STORAGE_READ_VERTEX:
+		case GRAPH_ACCESS_STORAGE_READ_FRAGMENT: return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		case GRAPH_ACCESS_VERTEX_READ:           return VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		case GRAPH_ACCESS_INDIRECT_READ:         return VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+		case GRAPH_ACCESS_TRANSFER_READ:         return VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		case GRAPH_ACCESS_TRANSFER_WRITE:        return VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		default:                                 return 0;
+		}
+	}
+
+	void reset_render_graph(render_graph_t& graph)
+	{
+		graph.resource_count = 0;
+		graph.pass_count     = 0;
+		graph.barrier_count  = 0;
+		graph.aliased        = false;
+	}
+
+	static graph_resource_t add_resource(render_graph_t& graph, const graph_resource_desc_t& desc)
+	{
+		assert(graph.resource_count < GRAPH_MAX_RESOURCES && "render graph resource overflow");
+
+		graph_resource_t resource = graph.resource_count++;
+		graph.resources[resource] = desc;
+		graph.images[resource]    = VK_NULL_HANDLE;
+		graph.views[resource]     = VK_NULL_HANDLE;
+		graph.buffers[resource]   = VK_NULL_HANDLE;
+
+		return resource;
+	}
+
+	graph_resource_t render_graph_create_image(render_graph_t& graph, const char* name, VkFormat format, VkExtent2D extent, VkImageAspectFlags aspect)
+	{
+		return add_resource(graph, { .name = name, .type = GRAPH_RESOURCE_IMAGE, .format = format, .extent = extent, .aspect = aspect });
+	}
+
+	graph_resource_t render_graph_create_buffer(render_graph_t& graph, const char* name, VkDeviceSize size)
+	{
+		return add_resource(graph, { .name = name, .type = GRAPH_RESOURCE_BUFFER, .size = size });
+	}
+
+	graph_resource_t render_graph_import_image(render_graph_t& graph, const char* name, VkImageAspectFlags aspect, graph_access_t initial_access, graph_access_t final_access, bool preserve_contents)
+	{
+		return add_resource(graph,
+		{
+			.name = name,
+			.type = GRAPH_RESOURCE_IMAGE,
+			.imported = true,
+			.aspect = aspect,
+			.initial_access = initial_access,
+			.final_access = final_access,
+			.preserve_contents = preserve_contents
+		});
+	}
+
+	graph_resource_t render_graph_import_buffer(render_graph_t& graph, const char* name, graph_access_t initial_access, graph_access_t final_access)
+	{
+		return add_resource(graph,
+		{
+			.name = name,
+			.type = GRAPH_RESOURCE_BUFFER,
+			.imported = true,
+			.initial_access = initial_access,
+			.final_access = final_access,
+			.preserve_contents = true
+		});
+	}
+
+	graph_pass_t render_graph_add_pass(render_graph_t& graph, const char* name, graph_execute_function execute, void* data)
+	{
+		assert(graph.pass_count < GRAPH_MAX_PASSES && "render graph pass overflow");
+
+		graph_pass_t pass = graph.pass_count++;
+		graph.passes[pass] = { .name = name, .execute = execute, .data = data };
+
+		return pass;
+	}
+
+	void render_graph_use(render_graph_t& graph, graph_pass_t pass, graph_resource_t resource, graph_access_t access)
+	{
+		graph_pass_desc_t& desc = graph.passes[pass];
+
+		assert(resource < graph.resource_count);
+		assert(desc.access_count < GRAPH_MAX_PASS_ACCESSES && "render graph pass access overflow");
+
+		desc.accesses[desc.access_count++] = { resource, access };
+	}
+
+	void render_graph_set_side_effects(render_graph_t& graph, graph_pass_t pass)
+	{
+		graph.passes[pass].side_effects = true;
+	}
+
+	// whether the access depends on what the resource held before: cleared
+	// attachments and copy destinations overwrite it, everything else reads it
+	static bool access_reads_contents(graph_access_t access)
+	{
+		switch (access)
+		{
+		case GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE:
+		case GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE:
+		case GRAPH_ACCESS_TRANSFER_WRITE:
+			return false;
+		default:
+			return true;
+		}
+	}
+
+	// backwards liveness: a pass survives when something after it (or outside
+	// the graph) reads what it writes. a write that overwrites the resource
+	// ends the liveness of earlier contents
+	static void cull_passes(render_graph_t& graph)
+	{
+		bool live[GRAPH_MAX_RESOURCES]{};
+
+		for (graph_resource_t r = 0; r < graph.resource_count; ++r)
+		{
+			const graph_resource_desc_t& desc = graph.resources[r];
+			live[r] = desc.imported && desc.final_access != GRAPH_ACCESS_NONE;
+		}
+
+		for (uint32_t p = graph.pass_count; p-- > 0;)
+		{
+			const graph_pass_desc_t& pass = graph.passes[p];
+
+			bool needed = pass.side_effects;
+
+			for (uint32_t a = 0; a < pass.access_count && !needed; ++a)
+			{
+				needed = get_graph_access_info(pass.accesses[a].access).write && live[pass.accesses[a].resource];
+			}
+
+			graph.culled[p] = !needed;
+
+			if (!needed)
+				continue;
+
+			for (uint32_t a = 0; a < pass.access_count; ++a)
+			{
+				if (!access_reads_contents(pass.accesses[a].access))
+					live[pass.accesses[a].resource] = false;
+			}
+
+			for (uint32_t a = 0; a < pass.access_count; ++a)
+			{
+				if (access_reads_contents(pass.accesses[a].access))
+					live[pass.accesses[a].resource] = true;
+			}
+		}
+	}
+
+	static void compute_lifetimes(render_graph_t& graph)
+	{
+		for (graph_resource_t r = 0; r < graph.resource_count; ++r)
+		{
+			graph.first_use[r]    = GRAPH_NOT_USED;
+			graph.last_use[r]     = GRAPH_NOT_USED;
+			graph.image_usage[r]  = 0;
+			graph.buffer_usage[r] = 0;
+		}
+
+		for (uint32_t p = 0; p < graph.pass_count; ++p)
+		{
+			if (graph.culled[p])
+				continue;
+
+			const graph_pass_desc_t& pass = graph.passes[p];
+
+			for (uint32_t a = 0; a < pass.access_count; ++a)
+			{
+				graph_resource_t r = pass.accesses[a].resource;
+
+				if (graph.first_use[r] == GRAPH_NOT_USED)
+					graph.first_use[r] = p;
+
+				graph.last_use[r] = p;
+
+				graph.image_usage[r]  |= access_image_usage(pass.accesses[a].access);
+				graph.buffer_usage[r] |= access_buffer_usage(pass.accesses[a].access);
+			}
+		}
+	}
+
+	static bool lifetimes_overlap(const render_graph_t& graph, graph_resource_t a, graph_resource_t b)
+	{
+		return graph.first_use[a] <= graph.last_use[b] && graph.first_use[b] <= graph.last_use[a];
+	}
+
+	static bool memory_overlaps(const render_graph_t& graph, graph_resource_t a, graph_resource_t b)
+	{
+		return graph.alias_offset[a] < graph.alias_offset[b] + graph.alias_size[b] &&
+			graph.alias_offset[b] < graph.alias_offset[a] + graph.alias_size[a];
+	}
+
+	static bool is_transient(const render_graph_t& graph, graph_resource_t r)
+	{
+		return !graph.resources[r].imported && graph.first_use[r] != GRAPH_NOT_USED;
+	}
+
+	// largest first, each placed at the lowest offset not used by a resource that is alive at the same time
+	static void alias_transients(render_graph_t& graph, const VkMemoryRequirements* requirements)
+	{
+		graph_resource_t order[GRAPH_MAX_RESOURCES];
+		uint32_t         order_count{};
+
+		graph.transient_size         = 0;
+		graph.transient_alignment    = 1;
+		graph.transient_memory_types = UINT32_MAX;
+
+		for (graph_resource_t r = 0; r < graph.resource_count; ++r)
+		{
+			graph.alias_offset[r] = 0;
+			graph.alias_size[r]   = 0;
+
+			if (!is_transient(graph, r))
+				continue;
+
+			graph.alias_size[r] = requirements[r].size;
+			if (requirements[r].alignment > graph.transient_alignment)
+				graph.transient_alignment = requirements[r].alignment;
+			graph.transient_memory_types &= requirements[r].memoryTypeBits;
+
+			uint32_t i = order_count++;
+			while (i > 0 && requirements[order[i - 1]].size < requirements[r].size)
+			{
+				order[i] = order[i - 1];
+				--i;
+			}
+			order[i] = r;
+		}
+
+		assert((order_count == 0 || graph.transient_memory_types != 0) && "transient resources have no memory type in common");
+
+		for (uint32_t i = 0; i < order_count; ++i)
+		{
+			graph_resource_t   r         = order[i];
+			const VkDeviceSize alignment = requirements[r].alignment;
+
+			VkDeviceSize offset{};
+
+			for (bool moved = true; moved;)
+			{
+				moved = false;
+
+				for (uint32_t j = 0; j < i; ++j)
+				{
+					graph_resource_t placed = order[j];
+
+					graph.alias_offset[r] = offset;
+
+					if (lifetimes_overlap(graph, r, placed) && memory_overlaps(graph, r, placed))
+					{
+						offset = (graph.alias_offset[placed] + graph.alias_size[placed] + alignment - 1) / alignment * alignment;
+						moved  = true;
+					}
+				}
+			}
+
+			graph.alias_offset[r] = offset;
+
+			if (offset + graph.alias_size[r] > graph.transient_size)
+				graph.transient_size = offset + graph.alias_size[r];
+		}
+
+		graph.aliased = true;
+	}
+
+	static void push_barrier(render_graph_t& graph, const graph_barrier_t& barrier)
+	{
+		assert(graph.barrier_count < GRAPH_MAX_BARRIERS && "render graph barrier overflow");
+		graph.barriers[graph.barrier_count++] = barrier;
+	}
+
+	static void init_resource_state(const render_graph_t& graph, graph_resource_t r, const graph_resource_state_t* states, graph_resource_state_t& state)
+	{
+		const graph_resource_desc_t& desc = graph.resources[r];
+
+		state = {};
+		state.touched = true;
+		state.layout  = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (desc.imported)
+		{
+			const graph_access_info_t& initial = get_graph_access_info(desc.initial_access);
+
+			if (initial.write)
+			{
+				state.write_stage  = initial.stage;
+				state.write_access = initial.access;
+			}
+			else
+			{
+				state.read_stages = initial.stage;
+			}
+
+			if (desc.preserve_contents)
+				state.layout = initial.layout;
+
+			return;
+		}
+
+		// transient memory is reused by every execution of the graph and, when
+		// aliased, by other transients: the first use waits for the last access
+		// to the same memory, earlier in this frame or in the previous one
+		for (graph_resource_t other = 0; other < graph.resource_count; ++other)
+		{
+			if (!is_transient(graph, other))
+				continue;
+
+			if (other != r && (!graph.aliased || !memory_overlaps(graph, r, other)))
+				continue;
+
+			if (other != r && graph.last_use[other] < graph.first_use[r])
+			{
+				state.write_stage  |= states[other].write_stage | states[other].read_stages;
+				state.write_access |= states[other].write_access;
+			}
+			else
+			{
+				const graph_pass_desc_t& pass = graph.passes[graph.last_use[other]];
+
+				for (uint32_t a = 0; a < pass.access_count; ++a)
+				{
+					if (pass.accesses[a].resource != other)
+						continue;
+
+					const graph_access_info_t& info = get_graph_access_info(pass.accesses[a].access);
+
+					state.write_stage |= info.stage;
+					if (info.write)
+						state.write_access |= info.access;
+				}
+			}
+		}
+	}
+
+	static void build_barriers(render_graph_t& graph)
+	{
+		graph_resource_state_t states[GRAPH_MAX_RESOURCES]{};
+
+		graph.barrier_count = 0;
+
+		for (uint32_t p = 0; p < graph.pass_count; ++p)
+		{
+			graph.pass_barriers[p] = graph.barrier_count;
+
+			if (graph.culled[p])
+				continue;
+
+			const graph_pass_desc_t& pass = graph.passes[p];
+
+			for (uint32_t a = 0; a < pass.access_count; ++a)
+			{
+				const graph_resource_t     r     = pass.accesses[a].resource;
+				const graph_access_info_t& info  = get_graph_access_info(pass.accesses[a].access);
+				const bool                 image = graph.resources[r].type == GRAPH_RESOURCE_IMAGE;
+
+				graph_resource_state_t& state = states[r];
+
+				if (!state.touched)
+					init_resource_state(graph, r, states, state);
+
+				const bool layout_change = image && info.layout != state.layout;
+
+				graph_barrier_t barrier
+				{
+					.resource   = r,
+					.dst_stage  = info.stage,
+					.dst_access = info.access,
+					.old_layout = image ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED,
+					.new_layout = image ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED
+				};
+
+				bool needed = false;
+
+				if (layout_change || info.write)
+				{
+					// layout transitions and writes wait for every earlier access (WAW, WAR)
+					barrier.src_stage  = state.write_stage | state.read_stages;
+					barrier.src_access = state.write_access;
+					needed = layout_change || barrier.src_stage != VK_PIPELINE_STAGE_2_NONE;
+				}
+				else if (state.write_stage != VK_PIPELINE_STAGE_2_NONE)
+				{
+					// reads only wait when the last write is not yet visible to this stage/access
+					bool visible = (info.stage & ~state.visible_stages) == 0 && (info.access & ~state.visible_access) == 0;
+
+					barrier.src_stage  = state.write_stage;
+					barrier.src_access = state.write_access;
+					needed = !visible;
+				}
+
+				if (needed)
+					push_barrier(graph, barrier);
+
+				if (layout_change || info.write)
+				{
+					// a layout transition behaves like a write for everything after it
+					state.write_stage    = info.stage;
+					state.write_access   = info.write ? info.access : VK_ACCESS_2_NONE;
+					state.read_stages    = info.write ? VK_PIPELINE_STAGE_2_NONE : info.stage;
+					state.visible_stages = info.write ? VK_PIPELINE_STAGE_2_NONE : info.stage;
+					state.visible_access = info.write ? VK_ACCESS_2_NONE : info.access;
+				}
+				else
+				{
+					state.read_stages |= info.stage;
+
+					if (needed)
+					{
+						state.visible_stages |= info.stage;
+						state.visible_access |= info.access;
+					}
+				}
+
+				if (image)
+					state.layout = info.layout;
+			}
+		}
+
+		graph.pass_barriers[graph.pass_count] = graph.barrier_count;
+
+		for (graph_resource_t r = 0; r < graph.resource_count; ++r)
+		{
+			const graph_resource_desc_t& desc = graph.resources[r];
+
+			if (!desc.imported || desc.final_access == GRAPH_ACCESS_NONE || !states[r].touched)
+				continue;
+
+			const graph_access_info_t&    info  = get_graph_access_info(desc.final_access);
+			const graph_resource_state_t& state = states[r];
+			const bool                    image = desc.type == GRAPH_RESOURCE_IMAGE;
+
+			graph_barrier_t barrier
+			{
+				.resource   = r,
+				.src_stage  = state.write_stage | state.read_stages,
+				.src_access = state.write_access,
+				.dst_stage  = info.stage,
+				.dst_access = info.access,
+				.old_layout = image ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED,
+				.new_layout = image ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED
+			};
+
+			bool layout_change = image && info.layout != state.layout;
+
+			if (layout_change || (info.stage != VK_PIPELINE_STAGE_2_NONE && state.write_stage != VK_PIPELINE_STAGE_2_NONE))
+				push_barrier(graph, barrier);
+		}
+	}
+
+	void compile_render_graph(render_graph_t& graph, const VkMemoryRequirements* requirements)
+	{
+		graph.aliased = false;
+
+		cull_passes(graph);
+		compute_lifetimes(graph);
+
+		if (requirements)
+			alias_transients(graph, requirements);
+
+		build_barriers(graph);
+	}
+
+} // olivia
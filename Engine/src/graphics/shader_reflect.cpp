@@ -0,0 +1,621 @@
+#include "olivia/graphics/shader_reflect.h"
+
+#include <string.h>
+
+namespace olivia
+{
+	// --- spir-v ---
+
+	enum spirv_op_t : uint32_t
+	{
+		SPIRV_OP_ENTRY_POINT          = 15,
+		SPIRV_OP_EXECUTION_MODE       = 16,
+		SPIRV_OP_TYPE_BOOL            = 20,
+		SPIRV_OP_TYPE_INT             = 21,
+		SPIRV_OP_TYPE_FLOAT           = 22,
+		SPIRV_OP_TYPE_VECTOR          = 23,
+		SPIRV_OP_TYPE_MATRIX          = 24,
+		SPIRV_OP_TYPE_IMAGE           = 25,
+		SPIRV_OP_TYPE_SAMPLER         = 26,
+		SPIRV_OP_TYPE_SAMPLED_IMAGE   = 27,
+		SPIRV_OP_TYPE_ARRAY           = 28,
+		SPIRV_OP_TYPE_RUNTIME_ARRAY   = 29,
+		SPIRV_OP_TYPE_STRUCT          = 30,
+		SPIRV_OP_TYPE_POINTER         = 32,
+		SPIRV_OP_CONSTANT             = 43,
+		SPIRV_OP_SPEC_CONSTANT_TRUE   = 48,
+		SPIRV_OP_SPEC_CONSTANT_FALSE  = 49,
+		SPIRV_OP_SPEC_CONSTANT        = 50,
+		SPIRV_OP_VARIABLE             = 59,
+		SPIRV_OP_DECORATE             = 71,
+		SPIRV_OP_MEMBER_DECORATE      = 72,
+		SPIRV_OP_TYPE_ACCELERATION    = 5341
+	};
+
+	enum spirv_decoration_t : uint32_t
+	{
+		SPIRV_DECORATION_SPEC_ID        = 1,
+		SPIRV_DECORATION_BLOCK          = 2,
+		SPIRV_DECORATION_BUFFER_BLOCK   = 3,
+		SPIRV_DECORATION_ARRAY_STRIDE   = 6,
+		SPIRV_DECORATION_MATRIX_STRIDE  = 7,
+		SPIRV_DECORATION_BUILTIN        = 11,
+		SPIRV_DECORATION_LOCATION       = 30,
+		SPIRV_DECORATION_BINDING        = 33,
+		SPIRV_DECORATION_DESCRIPTOR_SET = 34,
+		SPIRV_DECORATION_OFFSET         = 35
+	};
+
+	enum spirv_storage_t : uint32_t
+	{
+		SPIRV_STORAGE_UNIFORM_CONSTANT = 0,
+		SPIRV_STORAGE_INPUT            = 1,
+		SPIRV_STORAGE_UNIFORM          = 2,
+		SPIRV_STORAGE_PUSH_CONSTANT    = 9,
+		SPIRV_STORAGE_STORAGE_BUFFER   = 12
+	};
+
+	constexpr uint32_t SPIRV_EXECUTION_MODE_LOCAL_SIZE{ 17 };
+	constexpr uint32_t SPIRV_DIM_BUFFER{ 5 };
+	constexpr uint32_t SPIRV_DIM_SUBPASS_DATA{ 6 };
+	constexpr uint32_t SPIRV_NONE{ UINT32_MAX };
+
+	enum spirv_flag_t : uint32_t
+	{
+		SPIRV_FLAG_BLOCK        = 1 << 0,
+		SPIRV_FLAG_BUFFER_BLOCK = 1 << 1,
+		SPIRV_FLAG_BUILTIN      = 1 << 2,
+		SPIRV_FLAG_SIGNED       = 1 << 3
+	};
+
+	// what reflection needs to know about one result id
+	struct spirv_id_t
+	{
+		const uint32_t* words;         // the defining instruction
+		uint32_t        opcode;
+		uint32_t        type;          // pointee, element or component type
+		uint32_t        count;         // components, columns, array length or constant value
+		uint32_t        width;         // scalar bits
+		uint32_t        set;
+		uint32_t        binding;
+		uint32_t        location;
+		uint32_t        spec_id;
+		uint32_t        array_stride;
+		uint32_t        flags;
+	};
+
+	struct spirv_module_t
+	{
+		const uint32_t* code;
+		uint32_t        word_count;
+		spirv_id_t*     ids;
+		uint32_t        bound;
+	};
+
+	static uint32_t member_decoration(const spirv_module_t& module, uint32_t type, uint32_t member, uint32_t decoration)
+	{
+		for (uint32_t i = 5; i < module.word_count;)
+		{
+			const uint32_t* words  = module.code + i;
+			const uint32_t  length = words[0] >> 16;
+
+			if ((words[0] & 0xFFFF) == SPIRV_OP_MEMBER_DECORATE && words[1] == type && words[2] == member && words[3] == decoration)
+				return words[4];
+
+			i += length ? length : 1;
+		}
+
+		return SPIRV_NONE;
+	}
+
+	// byte size following the explicit layout decorations, runtime arrays count as empty
+	static uint32_t type_size(const spirv_module_t& module, uint32_t type, uint32_t matrix_stride)
+	{
+		const spirv_id_t& id = module.ids[type];
+
+		switch (id.opcode)
+		{
+		case SPIRV_OP_TYPE_BOOL:
+			return 4;
+		case SPIRV_OP_TYPE_INT:
+		case SPIRV_OP_TYPE_FLOAT:
+			return id.width / 8;
+		case SPIRV_OP_TYPE_VECTOR:
+			return id.count * type_size(module, id.type, SPIRV_NONE);
+		case SPIRV_OP_TYPE_MATRIX:
+			return id.count * (matrix_stride != SPIRV_NONE ? matrix_stride : type_size(module, id.type, SPIRV_NONE));
+		case SPIRV_OP_TYPE_ARRAY:
+			return module.ids[id.count].count * (id.array_stride ? id.array_stride : type_size(module, id.type, matrix_stride));
+		case SPIRV_OP_TYPE_STRUCT:
+		{
+			uint32_t size{};
+			const uint32_t member_count = (id.words[0] >> 16) - 2;
+
+			for (uint32_t member = 0; member < member_count; ++member)
+			{
+				uint32_t offset = member_decoration(module, type, member, SPIRV_DECORATION_OFFSET);
+				uint32_t stride = member_decoration(module, type, member, SPIRV_DECORATION_MATRIX_STRIDE);
+				uint32_t end    = (offset != SPIRV_NONE ? offset : size) + type_size(module, id.words[2 + member], stride);
+
+				size = end > size ? end : size;
+			}
+
+			return size;
+		}
+		default:
+			return 0;
+		}
+	}
+
+	static VkDescriptorType descriptor_type(const spirv_module_t& module, uint32_t storage_class, uint32_t type)
+	{
+		const spirv_id_t& id = module.ids[type];
+
+		if (storage_class == SPIRV_STORAGE_STORAGE_BUFFER)
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+		if (storage_class == SPIRV_STORAGE_UNIFORM)
+			return (id.flags & SPIRV_FLAG_BUFFER_BLOCK) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+		switch (id.opcode)
+		{
+		case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+			return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		case SPIRV_OP_TYPE_SAMPLER:
+			return VK_DESCRIPTOR_TYPE_SAMPLER;
+		case SPIRV_OP_TYPE_ACCELERATION:
+			return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+		case SPIRV_OP_TYPE_IMAGE:
+		{
+			const uint32_t dim     = id.words[3];
+			const bool     storage = id.words[7] == 2;
+
+			if (dim == SPIRV_DIM_SUBPASS_DATA)
+				return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+
+			if (dim == SPIRV_DIM_BUFFER)
+				return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+
+			return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		}
+		default:
+			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		}
+	}
+
+	static VkFormat input_format(const spirv_module_t& module, uint32_t type)
+	{
+		const spirv_id_t& id         = module.ids[type];
+		const uint32_t    components = id.opcode == SPIRV_OP_TYPE_VECTOR ? id.count : 1;
+		const spirv_id_t& scalar     = id.opcode == SPIRV_OP_TYPE_VECTOR ? module.ids[id.type] : id;
+
+		if (scalar.width != 32)
+			return VK_FORMAT_UNDEFINED;
+
+		static const VkFormat formats[3][4]
+		{
+			{ VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT },
+			{ VK_FORMAT_R32_SINT,   VK_FORMAT_R32G32_SINT,   VK_FORMAT_R32G32B32_SINT,   VK_FORMAT_R32G32B32A32_SINT   },
+			{ VK_FORMAT_R32_UINT,   VK_FORMAT_R32G32_UINT,   VK_FORMAT_R32G32B32_UINT,   VK_FORMAT_R32G32B32A32_UINT   }
+		};
+
+		const uint32_t kind = scalar.opcode == SPIRV_OP_TYPE_FLOAT ? 0 : (scalar.flags & SPIRV_FLAG_SIGNED) ? 1 : 2;
+
+		return formats[kind][components - 1];
+	}
+
+	static bool add_binding(shader_reflection_t& reflection, const shader_binding_t& binding)
+	{
+		if (reflection.binding_count == MAX_SHADER_BINDINGS || binding.set >= MAX_SHADER_SETS)
+			return false;
+
+		// sorted by set, then binding
+		uint32_t i = reflection.binding_count++;
+		for (; i > 0; --i)
+		{
+			const shader_binding_t& previous = reflection.bindings[i - 1];
+			if (previous.set < binding.set || (previous.set == binding.set && previous.binding < binding.binding))
+				break;
+
+			reflection.bindings[i] = previous;
+		}
+
+		reflection.bindings[i] = binding;
+		return true;
+	}
+
+	static bool add_input(shader_reflection_t& reflection, uint32_t location, VkFormat format, uint32_t size)
+	{
+		if (reflection.input_count == MAX_SHADER_INPUTS || format == VK_FORMAT_UNDEFINED)
+			return false;
+
+		uint32_t i = reflection.input_count++;
+		for (; i > 0 && reflection.inputs[i - 1].location > location; --i)
+		{
+			reflection.inputs[i] = reflection.inputs[i - 1];
+		}
+
+		reflection.inputs[i] = { location, format, size };
+		return true;
+	}
+
+	static bool add_variable(const spirv_module_t& module, const spirv_id_t& variable, uint32_t storage_class, shader_reflection_t& reflection)
+	{
+		// unwrap arrays of descriptors
+		uint32_t type  = module.ids[variable.type].type;
+		uint32_t count = 1;
+		while (module.ids[type].opcode == SPIRV_OP_TYPE_ARRAY || module.ids[type].opcode == SPIRV_OP_TYPE_RUNTIME_ARRAY)
+		{
+			if (module.ids[type].opcode == SPIRV_OP_TYPE_RUNTIME_ARRAY)
+				return false;
+
+			count *= module.ids[module.ids[type].count].count;
+			type   = module.ids[type].type;
+		}
+
+		switch (storage_class)
+		{
+		case SPIRV_STORAGE_UNIFORM_CONSTANT:
+		case SPIRV_STORAGE_UNIFORM:
+		case SPIRV_STORAGE_STORAGE_BUFFER:
+		{
+			VkDescriptorType descriptor = descriptor_type(module, storage_class, type);
+			if (descriptor == VK_DESCRIPTOR_TYPE_MAX_ENUM || variable.binding == SPIRV_NONE)
+				return false;
+
+			shader_binding_t binding
+			{
+				.set = variable.set != SPIRV_NONE ? variable.set : 0,
+				.binding = variable.binding,
+				.type = descriptor,
+				.count = count,
+				.stages = reflection.stages
+			};
+
+			return add_binding(reflection, binding);
+		}
+		case SPIRV_STORAGE_PUSH_CONSTANT:
+		{
+			reflection.push_constant_size   = type_size(module, type, SPIRV_NONE);
+			reflection.push_constant_stages = reflection.stages;
+			return true;
+		}
+		case SPIRV_STORAGE_INPUT:
+		{
+			// only vertex attributes matter, built-ins and interface blocks are skipped
+			if (reflection.stages != VK_SHADER_STAGE_VERTEX_BIT || (variable.flags & SPIRV_FLAG_BUILTIN) || variable.location == SPIRV_NONE)
+				return true;
+
+			const spirv_id_t& id = module.ids[type];
+			if (id.opcode == SPIRV_OP_TYPE_STRUCT)
+				return true;
+
+			const uint32_t columns = id.opcode == SPIRV_OP_TYPE_MATRIX ? id.count : 1;
+			const uint32_t column  = id.opcode == SPIRV_OP_TYPE_MATRIX ? id.type : type;
+
+			for (uint32_t i = 0; i < count * columns; ++i)
+			{
+				if (!add_input(reflection, variable.location + i, input_format(module, column), type_size(module, column, SPIRV_NONE)))
+					return false;
+			}
+
+			return true;
+		}
+		default:
+			return true;
+		}
+	}
+
+	static VkShaderStageFlags execution_stage(uint32_t model)
+	{
+		switch (model)
+		{
+		case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+		case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+		case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+		case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+		case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+		default: return 0;
+		}
+	}
+
+	bool reflect_shader(const uint32_t* code, size_t size, shader_reflection_t& reflection)
+	{
+		reflection = {};
+
+		if (size < 5 * sizeof(uint32_t) || (size % sizeof(uint32_t)) || code[0] != SPIRV_MAGIC)
+			return false;
+
+		spirv_module_t module
+		{
+			.code = code,
+			.word_count = (uint32_t)(size / sizeof(uint32_t)),
+			.bound = code[3]
+		};
+
+		module.ids = (spirv_id_t*)malloc(module.bound * sizeof(spirv_id_t));
+		assert(module.ids && "malloc failed");
+
+		for (uint32_t i = 0; i < module.bound; ++i)
+		{
+			module.ids[i] = { .set = SPIRV_NONE, .binding = SPIRV_NONE, .location = SPIRV_NONE, .spec_id = SPIRV_NONE };
+		}
+
+		// entry point, execution modes and decorations come before the types and
+		// variables, so a single pass sees everything an id needs when it is defined
+		bool valid = true;
+
+		for (uint32_t i = 5; i < module.word_count && valid;)
+		{
+			const uint32_t* words  = code + i;
+			const uint32_t  length = words[0] >> 16;
+			const uint32_t  opcode = words[0] & 0xFFFF;
+
+			if (length == 0 || i + length > module.word_count)
+			{
+				valid = false;
+				break;
+			}
+
+			i += length;
+
+			// the result id of type declarations is words[1], of values words[2]
+			const uint32_t type_result  = length > 1 ? words[1] : 0;
+			const uint32_t value_result = length > 2 ? words[2] : 0;
+
+			switch (opcode)
+			{
+			case SPIRV_OP_ENTRY_POINT:
+				reflection.stages = execution_stage(words[1]);
+				break;
+			case SPIRV_OP_EXECUTION_MODE:
+				if (words[2] == SPIRV_EXECUTION_MODE_LOCAL_SIZE)
+				{
+					reflection.local_size[0] = words[3];
+					reflection.local_size[1] = words[4];
+					reflection.local_size[2] = words[5];
+				}
+				break;
+			case SPIRV_OP_DECORATE:
+			{
+				if (type_result >= module.bound)
+				{
+					valid = false;
+					break;
+				}
+
+				spirv_id_t& id = module.ids[type_result];
+				switch (words[2])
+				{
+				case SPIRV_DECORATION_SPEC_ID:        id.spec_id = words[3];               break;
+				case SPIRV_DECORATION_BLOCK:          id.flags |= SPIRV_FLAG_BLOCK;        break;
+				case SPIRV_DECORATION_BUFFER_BLOCK:   id.flags |= SPIRV_FLAG_BUFFER_BLOCK; break;
+				case SPIRV_DECORATION_ARRAY_STRIDE:   id.array_stride = words[3];          break;
+				case SPIRV_DECORATION_BUILTIN:        id.flags |= SPIRV_FLAG_BUILTIN;      break;
+				case SPIRV_DECORATION_LOCATION:       id.location = words[3];              break;
+				case SPIRV_DECORATION_BINDING:        id.binding = words[3];               break;
+				case SPIRV_DECORATION_DESCRIPTOR_SET: id.set = words[3];                   break;
+				}
+				break;
+			}
+			case SPIRV_OP_TYPE_BOOL:
+			case SPIRV_OP_TYPE_INT:
+			case SPIRV_OP_TYPE_FLOAT:
+			case SPIRV_OP_TYPE_VECTOR:
+			case SPIRV_OP_TYPE_MATRIX:
+			case SPIRV_OP_TYPE_IMAGE:
+			case SPIRV_OP_TYPE_SAMPLER:
+			case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+			case SPIRV_OP_TYPE_ARRAY:
+			case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+			case SPIRV_OP_TYPE_STRUCT:
+			case SPIRV_OP_TYPE_POINTER:
+			case SPIRV_OP_TYPE_ACCELERATION:
+			{
+				if (type_result >= module.bound)
+				{
+					valid = false;
+					break;
+				}
+
+				spirv_id_t& id = module.ids[type_result];
+				id.words  = words;
+				id.opcode = opcode;
+
+				if (opcode == SPIRV_OP_TYPE_INT)
+				{
+					id.width = words[2];
+					id.flags |= words[3] ? (uint32_t)SPIRV_FLAG_SIGNED : 0u;
+				}
+				else if (opcode == SPIRV_OP_TYPE_FLOAT)
+				{
+					id.width = words[2];
+				}
+				else if (opcode == SPIRV_OP_TYPE_VECTOR || opcode == SPIRV_OP_TYPE_MATRIX || opcode == SPIRV_OP_TYPE_ARRAY)
+				{
+					id.type  = words[2];
+					id.count = words[3];
+				}
+				else if (opcode == SPIRV_OP_TYPE_RUNTIME_ARRAY || opcode == SPIRV_OP_TYPE_SAMPLED_IMAGE)
+				{
+					id.type = words[2];
+				}
+				else if (opcode == SPIRV_OP_TYPE_POINTER)
+				{
+					id.type = words[3];
+				}
+				break;
+			}
+			case SPIRV_OP_CONSTANT:
+			case SPIRV_OP_SPEC_CONSTANT:
+			case SPIRV_OP_SPEC_CONSTANT_TRUE:
+			case SPIRV_OP_SPEC_CONSTANT_FALSE:
+			{
+				if (value_result >= module.bound)
+				{
+					valid = false;
+					break;
+				}
+
+				spirv_id_t& id = module.ids[value_result];
+				id.opcode = opcode;
+				id.count  = opcode == SPIRV_OP_SPEC_CONSTANT_TRUE ? 1 : length > 3 ? words[3] : 0;
+
+				if (opcode != SPIRV_OP_CONSTANT && id.spec_id != SPIRV_NONE)
+				{
+					if (reflection.spec_constant_count == MAX_SPECIALIZATION_CONSTANTS)
+					{
+						valid = false;
+						break;
+					}
+
+					reflection.spec_constants[reflection.spec_constant_count++] = { id.spec_id, id.count };
+				}
+				break;
+			}
+			case SPIRV_OP_VARIABLE:
+			{
+				if (value_result >= module.bound || words[1] >= module.bound)
+				{
+					valid = false;
+					break;
+				}
+
+				spirv_id_t& id = module.ids[value_result];
+				id.opcode = opcode;
+				id.type   = words[1];
+
+				valid = add_variable(module, id, words[3], reflection);
+				break;
+			}
+			}
+		}
+
+		free(module.ids);
+
+		if (!valid)
+		{
+			reflection = {};
+			return false;
+		}
+
+		return reflection.stages != 0;
+	}
+
+	void merge_shader_reflection(shader_reflection_t& into, const shader_reflection_t& from)
+	{
+		into.stages |= from.stages;
+
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			into.local_size[i] = into.local_size[i] ? into.local_size[i] : from.local_size[i];
+		}
+
+		for (uint32_t i = 0; i < from.binding_count; ++i)
+		{
+			const shader_binding_t& binding = from.bindings[i];
+
+			shader_binding_t* existing = (shader_binding_t*)find_shader_binding(into, binding.set, binding.binding);
+			if (existing)
+			{
+				assert(existing->type == binding.type && existing->count == binding.count && "stages disagree on a binding");
+				existing->stages |= binding.stages;
+				continue;
+			}
+
+			bool added = add_binding(into, binding);
+			assert(added && "too many shader bindings");
+			(void)added;
+		}
+
+		if (from.push_constant_size)
+		{
+			into.push_constant_size    = from.push_constant_size > into.push_constant_size ? from.push_constant_size : into.push_constant_size;
+			into.push_constant_stages |= from.push_constant_stages;
+		}
+
+		if (!into.input_count)
+		{
+			memcpy(into.inputs, from.inputs, from.input_count * sizeof(shader_input_t));
+			into.input_count = from.input_count;
+		}
+
+		for (uint32_t i = 0; i < from.spec_constant_count; ++i)
+		{
+			if (has_spec_constant(into, from.spec_constants[i].id))
+				continue;
+
+			assert(into.spec_constant_count < MAX_SPECIALIZATION_CONSTANTS && "too many specialization constants");
+			into.spec_constants[into.spec_constant_count++] = from.spec_constants[i];
+		}
+	}
+
+	const shader_binding_t* find_shader_binding(const shader_reflection_t& reflection, uint32_t set, uint32_t binding)
+	{
+		for (uint32_t i = 0; i < reflection.binding_count; ++i)
+		{
+			if (reflection.bindings[i].set == set && reflection.bindings[i].binding == binding)
+				return &reflection.bindings[i];
+		}
+
+		return nullptr;
+	}
+
+	bool has_spec_constant(const shader_reflection_t& reflection, uint32_t id)
+	{
+		for (uint32_t i = 0; i < reflection.spec_constant_count; ++i)
+		{
+			if (reflection.spec_constants[i].id == id)
+				return true;
+		}
+
+		return false;
+	}
+
+	bool is_layout_compatible(const shader_reflection_t& layout, const shader_reflection_t& shader)
+	{
+		for (uint32_t i = 0; i < shader.binding_count; ++i)
+		{
+			const shader_binding_t& binding = shader.bindings[i];
+			const shader_binding_t* declared = find_shader_binding(layout, binding.set, binding.binding);
+
+			if (!declared || declared->type != binding.type || declared->count != binding.count || (binding.stages & ~declared->stages))
+				return false;
+		}
+
+		if (shader.push_constant_size)
+		{
+			if (shader.push_constant_size > layout.push_constant_size || (shader.push_constant_stages & ~layout.push_constant_stages))
+				return false;
+		}
+
+		return true;
+	}
+
+	uint32_t get_vertex_input_attributes(const shader_reflection_t& reflection, uint32_t binding, uint32_t first_location, uint32_t end_location, VkVertexInputAttributeDescription* attributes, uint32_t& stride)
+	{
+		uint32_t count{};
+		stride = 0;
+
+		for (uint32_t i = 0; i < reflection.input_count; ++i)
+		{
+			const shader_input_t& input = reflection.inputs[i];
+			if (input.location < first_location || input.location >= end_location)
+				continue;
+
+			attributes[count++] =
+			{
+				.location = input.location,
+				.binding = binding,
+				.format = input.format,
+				.offset = stride
+			};
+
+			stride += input.size;
+		}
+
+		return count;
+	}
+
+} // olivia
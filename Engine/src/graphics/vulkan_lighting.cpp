@@ -0,0 +1,510 @@
+#include "olivia/graphics/vulkan_lighting.h"
+
+#include <math.h>
+
+namespace olivia
+{
+	static lighting_t lighting{};
+
+	enum lighting_shader_t : uint32_t
+	{
+		LIGHTING_SHADER_CULL,
+		LIGHTING_SHADER_VERTEX,
+		LIGHTING_SHADER_FRAGMENT,
+		LIGHTING_SHADER_COUNT
+	};
+
+	static const char* LIGHTING_SHADER_PATHS[LIGHTING_SHADER_COUNT]
+	{
+		LIGHT_CULL_SHADER_PATH,
+		MESH_VERTEX_SHADER_PATH,
+		MESH_FRAGMENT_SHADER_PATH
+	};
+
+	static bool load_lighting_shaders(shader_t* shaders)
+	{
+		for (uint32_t i = 0; i < LIGHTING_SHADER_COUNT; ++i)
+		{
+			if (!load_shader(LIGHTING_SHADER_PATHS[i], shaders[i]))
+			{
+				for (uint32_t j = 0; j < i; ++j)
+				{
+					destroy_shader(shaders[j]);
+				}
+
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static VkPipeline create_lit_pipeline(const shader_t& vertex, const shader_t& fragment, bool clustered)
+	{
+		shader_specialization_t specialization{};
+		set_specialization_constant(specialization, fragment.reflection, LIGHTING_CLUSTERED_CONSTANT, clustered ? VK_TRUE : VK_FALSE);
+
+		VkPipelineShaderStageCreateInfo stages[]
+		{
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_VERTEX_BIT,
+				.module = vertex.module,
+				.pName = "main"
+			},
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+				.module = fragment.module,
+				.pName = "main",
+				.pSpecializationInfo = &specialization.info
+			}
+		};
+
+		// the mesh group's vertices, then a model matrix per instance
+		VkVertexInputAttributeDescription attributes[MAX_SHADER_INPUTS];
+		uint32_t vertex_stride{};
+		uint32_t instance_stride{};
+
+		uint32_t attribute_count = get_vertex_input_attributes(vertex.reflection, 0, 0, 3, attributes, vertex_stride);
+		attribute_count += get_vertex_input_attributes(vertex.reflection, 1, 3, MAX_SHADER_INPUTS, attributes + attribute_count, instance_stride);
+
+		assert(vertex_stride == sizeof(vertex3d_t) && instance_stride == 16 * sizeof(float) && "olivia.vert inputs do not match the streams");
+
+		VkVertexInputBindingDescription bindings[]
+		{
+			{ 0, vertex_stride,   VK_VERTEX_INPUT_RATE_VERTEX },
+			{ 1, instance_stride, VK_VERTEX_INPUT_RATE_INSTANCE }
+		};
+
+		VkPipelineVertexInputStateCreateInfo vertex_input
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+			.vertexBindingDescriptionCount = ARRAY_SIZE(bindings),
+			.pVertexBindingDescriptions = bindings,
+			.vertexAttributeDescriptionCount = attribute_count,
+			.pVertexAttributeDescriptions = attributes
+		};
+
+		VkPipelineInputAssemblyStateCreateInfo input_assembly
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+			.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+		};
+
+		VkPipelineViewportStateCreateInfo viewport
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+			.viewportCount = 1,
+			.scissorCount = 1
+		};
+
+		VkPipelineRasterizationStateCreateInfo rasterization
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+			.polygonMode = VK_POLYGON_MODE_FILL,
+			.cullMode = VK_CULL_MODE_NONE,
+			.lineWidth = 1.0f
+		};
+
+		VkPipelineMultisampleStateCreateInfo multisample
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+		};
+
+		VkPipelineDepthStencilStateCreateInfo depth_stencil
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
+		};
+
+		VkPipelineColorBlendAttachmentState blend_attachment
+		{
+			.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+		};
+
+		VkPipelineColorBlendStateCreateInfo blend
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+			.attachmentCount = 1,
+			.pAttachments = &blend_attachment
+		};
+
+		// begin_pass sets the depth state
+		VkDynamicState dynamic_states[]
+		{
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR,
+			VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+			VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+			VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
+		};
+
+		VkPipelineDynamicStateCreateInfo dynamic
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.dynamicStateCount = ARRAY_SIZE(dynamic_states),
+			.pDynamicStates = dynamic_states
+		};
+
+		VkPipelineRenderingCreateInfo rendering
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+			.colorAttachmentCount = 1,
+			.pColorAttachmentFormats = &g_vulkan_core.swapchain_format.format,
+			.depthAttachmentFormat = g_vulkan_core.depth_format
+		};
+
+		VkGraphicsPipelineCreateInfo pipeline_info
+		{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = &rendering,
+			.stageCount = ARRAY_SIZE(stages),
+			.pStages = stages,
+			.pVertexInputState = &vertex_input,
+			.pInputAssemblyState = &input_assembly,
+			.pViewportState = &viewport,
+			.pRasterizationState = &rasterization,
+			.pMultisampleState = &multisample,
+			.pDepthStencilState = &depth_stencil,
+			.pColorBlendState = &blend,
+			.pDynamicState = &dynamic,
+			.layout = lighting.draw_layout
+		};
+
+		VkPipeline pipeline{};
+		VK_CHECK(vkCreateGraphicsPipelines(g_vulkan_core.device, g_vulkan_core.pipeline_cache, 1, &pipeline_info, nullptr, &pipeline));
+
+		return pipeline;
+	}
+
+	static void create_lighting_pipelines(const shader_t* shaders)
+	{
+		lighting.cull = create_compute_pipeline(shaders[LIGHTING_SHADER_CULL], lighting.cull_layout, nullptr);
+
+		for (uint32_t clustered = 0; clustered < 2; ++clustered)
+		{
+			lighting.draw[clustered] = create_lit_pipeline(shaders[LIGHTING_SHADER_VERTEX], shaders[LIGHTING_SHADER_FRAGMENT], clustered);
+		}
+	}
+
+	static void destroy_lighting_pipelines()
+	{
+		vkDestroyPipeline(g_vulkan_core.device, lighting.draw[1], nullptr);
+		vkDestroyPipeline(g_vulkan_core.device, lighting.draw[0], nullptr);
+		vkDestroyPipeline(g_vulkan_core.device, lighting.cull, nullptr);
+	}
+
+	static void reload_lighting(void*)
+	{
+		shader_t shaders[LIGHTING_SHADER_COUNT];
+		if (!load_lighting_shaders(shaders))
+			return;
+
+		bool compatible = is_layout_compatible(lighting.cull_reflection, shaders[LIGHTING_SHADER_CULL].reflection);
+		compatible &= is_layout_compatible(lighting.draw_reflection, shaders[LIGHTING_SHADER_VERTEX].reflection);
+		compatible &= is_layout_compatible(lighting.draw_reflection, shaders[LIGHTING_SHADER_FRAGMENT].reflection);
+
+		if (compatible)
+		{
+			destroy_lighting_pipelines();
+			create_lighting_pipelines(shaders);
+		}
+		else
+		{
+			LOG_ERROR(TAG_RENDERER, "lighting shaders changed their bindings, restart to pick them up");
+		}
+
+		for (uint32_t i = 0; i < LIGHTING_SHADER_COUNT; ++i)
+		{
+			destroy_shader(shaders[i]);
+		}
+	}
+
+	void init_lighting()
+	{
+		lighting.light_data = (light_t*)malloc(MAX_LIGHTS * sizeof(light_t));
+		assert(lighting.light_data && "malloc failed");
+
+		for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+		{
+			lighting.lights[i] = create_vulkan_buffer(
+				MEMORY_CATEGORY_STAGING,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VMA_MEMORY_USAGE_AUTO,
+				VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+				MAX_LIGHTS * sizeof(light_t),
+				true);
+
+			lighting.cluster_counts[i] = create_vulkan_buffer(
+				MEMORY_CATEGORY_BUFFER,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				0,
+				LIGHT_CLUSTER_COUNT * sizeof(uint32_t),
+				true);
+
+			lighting.cluster_lights[i] = create_vulkan_buffer(
+				MEMORY_CATEGORY_BUFFER,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				0,
+				LIGHT_CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER * sizeof(uint32_t),
+				true);
+		}
+
+		// create timestamp queries, the job records on either queue family
+		{
+			uint32_t family_count{};
+			vkGetPhysicalDeviceQueueFamilyProperties(g_vulkan_core.gpu, &family_count, nullptr);
+
+			VkQueueFamilyProperties families[16];
+			family_count = SDL_min(family_count, (uint32_t)ARRAY_SIZE(families));
+			vkGetPhysicalDeviceQueueFamilyProperties(g_vulkan_core.gpu, &family_count, families);
+
+			lighting.timestamps[0] = families[g_vulkan_core.graphics_queue_index].timestampValidBits != 0;
+			lighting.timestamps[1] = families[g_vulkan_core.compute_queue_index].timestampValidBits != 0;
+
+			if (g_vulkan_core.timestamp_period > 0.0f && (lighting.timestamps[0] || lighting.timestamps[1]))
+			{
+				VkQueryPoolCreateInfo query_pool_info
+				{
+					.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+					.queryType = VK_QUERY_TYPE_TIMESTAMP,
+					.queryCount = 2 * MAX_FRAMES
+				};
+
+				VK_CHECK(vkCreateQueryPool(g_vulkan_core.device, &query_pool_info, nullptr, &lighting.timestamp_pool));
+			}
+		}
+
+		// without the shaders nothing is binned and bind_lit_pipeline does nothing
+		shader_t shaders[LIGHTING_SHADER_COUNT];
+		if (!load_lighting_shaders(shaders))
+			return;
+
+		// one set layout for the binning and the shading, push constants differ
+		shader_reflection_t layout{};
+		for (uint32_t i = 0; i < LIGHTING_SHADER_COUNT; ++i)
+		{
+			const bool compute = shaders[i].reflection.stages == VK_SHADER_STAGE_COMPUTE_BIT;
+
+			merge_shader_reflection(compute ? lighting.cull_reflection : lighting.draw_reflection, shaders[i].reflection);
+			merge_shader_reflection(layout, shaders[i].reflection);
+		}
+
+		assert(lighting.cull_reflection.push_constant_size == sizeof(light_cull_t) && "light_cull.comp disagrees with light_cull_t");
+		assert(lighting.draw_reflection.push_constant_size == sizeof(lit_draw_t) && "olivia.vert/frag disagree with lit_draw_t");
+
+		// create descriptor sets
+		{
+			lighting.set_layout      = create_reflected_set_layout(layout, 0);
+			lighting.descriptor_pool = create_reflected_descriptor_pool(layout, 0, MAX_FRAMES);
+
+			VkDescriptorSetLayout set_layouts[MAX_FRAMES];
+			for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+			{
+				set_layouts[i] = lighting.set_layout;
+			}
+
+			VkDescriptorSetAllocateInfo set_info
+			{
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+				.descriptorPool = lighting.descriptor_pool,
+				.descriptorSetCount = MAX_FRAMES,
+				.pSetLayouts = set_layouts
+			};
+
+			VK_CHECK(vkAllocateDescriptorSets(g_vulkan_core.device, &set_info, lighting.sets));
+
+			for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+			{
+				VkDescriptorBufferInfo buffer_infos[]
+				{
+					{ lighting.lights[i].buffer,         0, VK_WHOLE_SIZE },
+					{ lighting.cluster_counts[i].buffer, 0, VK_WHOLE_SIZE },
+					{ lighting.cluster_lights[i].buffer, 0, VK_WHOLE_SIZE }
+				};
+
+				VkWriteDescriptorSet writes[ARRAY_SIZE(buffer_infos)];
+				for (uint32_t binding = 0; binding < ARRAY_SIZE(buffer_infos); ++binding)
+				{
+					writes[binding] =
+					{
+						.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+						.dstSet = lighting.sets[i],
+						.dstBinding = binding,
+						.descriptorCount = 1,
+						.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+						.pBufferInfo = &buffer_infos[binding]
+					};
+				}
+
+				vkUpdateDescriptorSets(g_vulkan_core.device, ARRAY_SIZE(writes), writes, 0, nullptr);
+			}
+		}
+
+		lighting.cull_layout = create_reflected_pipeline_layout(lighting.cull_reflection, &lighting.set_layout, 1);
+		lighting.draw_layout = create_reflected_pipeline_layout(lighting.draw_reflection, &lighting.set_layout, 1);
+
+		create_lighting_pipelines(shaders);
+
+		for (uint32_t i = 0; i < LIGHTING_SHADER_COUNT; ++i)
+		{
+			destroy_shader(shaders[i]);
+			watch_shader(LIGHTING_SHADER_PATHS[i], reload_lighting, nullptr);
+		}
+
+		LOG_INFO(TAG_RENDERER, "lighting: %u clusters, up to %u lights, %.1f MB per frame slot", LIGHT_CLUSTER_COUNT, MAX_LIGHTS,
+			(double)(MAX_LIGHTS * sizeof(light_t) + LIGHT_CLUSTER_COUNT * (MAX_LIGHTS_PER_CLUSTER + 1) * sizeof(uint32_t)) / (1024.0 * 1024.0));
+	}
+
+	void destroy_lighting()
+	{
+		unwatch_shaders(reload_lighting);
+
+		vkDestroyQueryPool(g_vulkan_core.device, lighting.timestamp_pool, nullptr);
+
+		destroy_lighting_pipelines();
+		vkDestroyPipelineLayout(g_vulkan_core.device, lighting.draw_layout, nullptr);
+		vkDestroyPipelineLayout(g_vulkan_core.device, lighting.cull_layout, nullptr);
+		vkDestroyDescriptorPool(g_vulkan_core.device, lighting.descriptor_pool, nullptr);
+		vkDestroyDescriptorSetLayout(g_vulkan_core.device, lighting.set_layout, nullptr);
+
+		for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+		{
+			destroy_vulkan_buffer(lighting.lights[i]);
+			destroy_vulkan_buffer(lighting.cluster_counts[i]);
+			destroy_vulkan_buffer(lighting.cluster_lights[i]);
+		}
+
+		free(lighting.light_data);
+
+		lighting = {};
+	}
+
+	void set_lights(const light_t* lights, uint32_t count)
+	{
+		assert(count <= MAX_LIGHTS && "too many lights");
+
+		memcpy(lighting.light_data, lights, count * sizeof(light_t));
+		lighting.light_count = count;
+	}
+
+	static void read_light_culling_timings()
+	{
+		const uint32_t frame = g_vulkan_core.current_frame;
+
+		if (!lighting.timestamp_written[frame])
+			return;
+
+		// the frame slot was waited for, the results are available
+		uint64_t timestamps[2]{};
+		VkResult result = vkGetQueryPoolResults(
+			g_vulkan_core.device,
+			lighting.timestamp_pool,
+			frame * 2, 2,
+			sizeof(timestamps), timestamps, sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT);
+
+		if (result == VK_SUCCESS)
+		{
+			lighting.gpu_ms = (float)((double)(timestamps[1] - timestamps[0]) * g_vulkan_core.timestamp_period * 1e-6);
+		}
+
+		lighting.timestamp_written[frame] = false;
+	}
+
+	static void record_light_culling(VkCommandBuffer cmd, void*)
+	{
+		const uint32_t frame = g_vulkan_core.current_frame;
+
+		read_light_culling_timings();
+
+		// the frame slot is free here, begin_frame waited for it
+		memcpy(lighting.lights[frame].info.pMappedData, lighting.light_data, lighting.light_count * sizeof(light_t));
+		vmaFlushAllocation(g_vulkan_core.allocator, lighting.lights[frame].allocation, 0, lighting.light_count * sizeof(light_t));
+
+		lighting.cull_push.light_count   = lighting.light_count;
+		lighting.frame_light_count[frame] = lighting.light_count;
+		lighting.frame_z_near[frame]      = lighting.cull_push.projection[2];
+		lighting.frame_z_far[frame]       = lighting.cull_push.projection[3];
+		lighting.frame_culled[frame]      = get_frame_timeline_value();
+
+		const bool timed = lighting.timestamp_pool && lighting.timestamps[is_async_compute_enabled() ? 1 : 0];
+		if (timed)
+		{
+			vkCmdResetQueryPool(cmd, lighting.timestamp_pool, frame * 2, 2);
+			vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, lighting.timestamp_pool, frame * 2);
+		}
+
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, lighting.cull);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, lighting.cull_layout, 0, 1, &lighting.sets[frame], 0, nullptr);
+		vkCmdPushConstants(cmd, lighting.cull_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(lighting.cull_push), &lighting.cull_push);
+		vkCmdDispatch(cmd, (LIGHT_CLUSTER_COUNT + 63) / 64, 1, 1);
+
+		if (timed)
+		{
+			vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, lighting.timestamp_pool, frame * 2 + 1);
+			lighting.timestamp_written[frame] = true;
+		}
+	}
+
+	void schedule_light_culling(const light_view_t& view)
+	{
+		if (!lighting.cull)
+			return;
+
+		assert(view.z_near > 0.0f && view.z_far > view.z_near && "invalid cluster depth range");
+
+		memcpy(lighting.cull_push.view, view.view, sizeof(lighting.cull_push.view));
+		lighting.cull_push.projection[0] = view.tan_half_fov_x;
+		lighting.cull_push.projection[1] = view.tan_half_fov_y;
+		lighting.cull_push.projection[2] = view.z_near;
+		lighting.cull_push.projection[3] = view.z_far;
+
+		schedule_compute(record_light_culling, nullptr, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+	}
+
+	bool bind_lit_pipeline(VkCommandBuffer cmd, const float view_projection[16], bool clustered)
+	{
+		if (!lighting.cull || g_vulkan_core.current_pass != RENDER_PASS_MAIN)
+			return false;
+
+		const uint32_t   frame  = g_vulkan_core.current_frame;
+		const VkExtent2D extent = get_render_extent();
+
+		// the slot still holds the bins of an older frame when this one scheduled no culling
+		const bool  culled      = lighting.frame_culled[frame] == get_frame_timeline_value();
+
+		// slice = Z * log(view z / near) / log(far / near)
+		const float z_near      = culled ? lighting.frame_z_near[frame] : 0.0f;
+		const float slice_scale = z_near > 0.0f ? (float)LIGHT_CLUSTER_Z / logf(lighting.frame_z_far[frame] / z_near) : 0.0f;
+
+		lit_draw_t draw
+		{
+			.cluster_scale =
+			{
+				(float)LIGHT_CLUSTER_X / (float)extent.width,
+				(float)LIGHT_CLUSTER_Y / (float)extent.height,
+				slice_scale,
+				z_near > 0.0f ? -logf(z_near) * slice_scale : 0.0f
+			},
+			.z_near = z_near,
+			.light_count = culled ? lighting.frame_light_count[frame] : 0
+		};
+		memcpy(draw.view_projection, view_projection, sizeof(draw.view_projection));
+
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, lighting.draw[clustered ? 1 : 0]);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, lighting.draw_layout, 0, 1, &lighting.sets[frame], 0, nullptr);
+		vkCmdPushConstants(cmd, lighting.draw_layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(draw), &draw);
+
+		return true;
+	}
+
+	float get_light_culling_gpu_time()
+	{
+		return lighting.gpu_ms;
+	}
+
+} // olivia
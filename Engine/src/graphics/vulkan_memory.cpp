@@ -0,0 +1,301 @@
+#include "olivia/graphics/vulkan_memory.h"
+
+namespace olivia
+{
+	static memory_telemetry_t memory{};
+
+	static const char* MEMORY_CATEGORY_NAMES[MEMORY_CATEGORY_COUNT]{ "mesh", "staging", "texture", "buffer", "transient" };
+
+	static const char* MEMORY_EVENT_NAMES[]{ "allocate", "free", "evict", "over budget", "allocation failed" };
+
+	static void push_memory_event(memory_event_type_t type, memory_category_t category, VkDeviceSize size)
+	{
+		memory.events[memory.event_count++ % MEMORY_TIMELINE_EVENTS] =
+		{
+			.time = SDL_GetTicksNS(),
+			.size = size,
+			.frame = memory.frame,
+			.category = category,
+			.type = type
+		};
+	}
+
+	void init_memory_telemetry()
+	{
+		memory.allocations = create_hash_map<VmaAllocation, memory_allocation_t>(1024);
+		memory.events      = (memory_event_t*)malloc(MEMORY_TIMELINE_EVENTS * sizeof(memory_event_t));
+		memory.frames      = (memory_frame_t*)malloc(MEMORY_TIMELINE_FRAMES * sizeof(memory_frame_t));
+		memory.start       = SDL_GetTicksNS();
+
+		assert(memory.events && memory.frames && "malloc failed");
+
+		const VkPhysicalDeviceMemoryProperties* memory_properties;
+		vmaGetMemoryProperties(g_vulkan_core.allocator, &memory_properties);
+
+		VkDeviceSize heap_size{};
+		for (uint32_t i = 0; i < memory_properties->memoryHeapCount; ++i)
+		{
+			const VkMemoryHeap& heap = memory_properties->memoryHeaps[i];
+
+			if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) && heap.size > heap_size)
+			{
+				memory.heap_index = i;
+				heap_size = heap.size;
+			}
+		}
+
+		VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+		vmaGetHeapBudgets(g_vulkan_core.allocator, budgets);
+
+		memory.heap = budgets[memory.heap_index];
+	}
+
+	void destroy_memory_telemetry()
+	{
+		if (memory.allocations.size)
+		{
+			LOG_WARN(TAG_RENDERER, "%zu gpu allocations were never released", memory.allocations.size);
+
+			for (size_t i = hash_map_next(memory.allocations, 0); i < memory.allocations.capacity; i = hash_map_next(memory.allocations, i + 1))
+			{
+				const memory_allocation_t& allocation = memory.allocations.slots[i].value;
+
+				LOG_WARN(TAG_RENDERER, "  %-9s %llu KB", MEMORY_CATEGORY_NAMES[allocation.category], (unsigned long long)(allocation.size / KILOBYTES(1)));
+			}
+		}
+
+		destroy_hash_map(memory.allocations);
+		free(memory.events);
+		free(memory.frames);
+
+		memory = {};
+	}
+
+	void track_allocation(VmaAllocation allocation, memory_category_t category)
+	{
+		if (!allocation)
+			return;
+
+		VmaAllocationInfo info;
+		vmaGetAllocationInfo(g_vulkan_core.allocator, allocation, &info);
+
+		hash_map_insert(memory.allocations, allocation, { info.size, category });
+
+		memory.category_bytes[category] += info.size;
+		memory.category_peak[category]   = SDL_max(memory.category_peak[category], memory.category_bytes[category]);
+		memory.category_allocations[category]++;
+
+		push_memory_event(MEMORY_EVENT_ALLOCATE, category, info.size);
+	}
+
+	void untrack_allocation(VmaAllocation allocation)
+	{
+		memory_allocation_t* tracked = allocation ? hash_map_find(memory.allocations, allocation) : nullptr;
+		if (!tracked)
+			return;
+
+		memory.category_bytes[tracked->category] -= tracked->size;
+		memory.category_allocations[tracked->category]--;
+
+		push_memory_event(MEMORY_EVENT_FREE, tracked->category, tracked->size);
+
+		hash_map_erase(memory.allocations, allocation);
+	}
+
+	void report_allocation_failure(memory_category_t category, VkDeviceSize size)
+	{
+		memory.failed_allocations++;
+
+		push_memory_event(MEMORY_EVENT_ALLOCATION_FAILED, category, size);
+	}
+
+	void update_memory_budget()
+	{
+		memory.frame++;
+
+		// lets VMA refresh the budget from VK_EXT_memory_budget once per frame
+		vmaSetCurrentFrameIndex(g_vulkan_core.allocator, memory.frame);
+
+		VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+		vmaGetHeapBudgets(g_vulkan_core.allocator, budgets);
+
+		memory.heap       = budgets[memory.heap_index];
+		memory.peak_usage = SDL_max(memory.peak_usage, memory.heap.usage);
+
+		memory_frame_t& sample = memory.frames[memory.frame_count++ % MEMORY_TIMELINE_FRAMES];
+
+		sample.time        = SDL_GetTicksNS();
+		sample.frame       = memory.frame;
+		sample.heap_usage  = memory.heap.usage;
+		sample.heap_budget = memory.heap.budget;
+		memcpy(sample.category_bytes, memory.category_bytes, sizeof(sample.category_bytes));
+
+		const VkDeviceSize high = (VkDeviceSize)((double)memory.heap.budget * MEMORY_PRESSURE_HIGH);
+		const VkDeviceSize low  = (VkDeviceSize)((double)memory.heap.budget * MEMORY_PRESSURE_LOW);
+
+		if (memory.heap.usage <= high)
+			return;
+
+		memory.over_budget_frames++;
+
+		// what was evicted last time only shows up in the usage once the frames in flight
+		// released it, asking again before that would evict twice
+		if (memory.frame - memory.last_eviction_frame <= MAX_FRAMES)
+			return;
+
+		push_memory_event(MEMORY_EVENT_OVER_BUDGET, MEMORY_CATEGORY_COUNT, memory.heap.usage);
+
+		LOG_WARN(TAG_RENDERER, "heap %u at %llu of %llu MB, evicting",
+			memory.heap_index,
+			(unsigned long long)(memory.heap.usage / MEGABYTES(1)),
+			(unsigned long long)(memory.heap.budget / MEGABYTES(1)));
+
+		request_memory_eviction(memory.heap.usage - low);
+	}
+
+	void register_memory_evictor(memory_category_t category, memory_eviction_function function, void* data)
+	{
+		assert(memory.evictor_count < MAX_MEMORY_EVICTORS && "too many memory evictors");
+
+		memory.evictors[memory.evictor_count++] = { function, data, category };
+	}
+
+	VkDeviceSize request_memory_eviction(VkDeviceSize bytes)
+	{
+		VkDeviceSize promised{};
+
+		for (uint32_t i = 0; i < memory.evictor_count && promised < bytes; ++i)
+		{
+			const memory_evictor_t& evictor = memory.evictors[i];
+
+			VkDeviceSize released = evictor.function(bytes - promised, evictor.data);
+			if (released)
+			{
+				push_memory_event(MEMORY_EVENT_EVICT, evictor.category, released);
+				promised += released;
+			}
+		}
+
+		memory.last_eviction_frame = memory.frame;
+
+		return promised;
+	}
+
+	uint32_t get_memory_heap_index()
+	{
+		return memory.heap_index;
+	}
+
+	const VmaBudget& get_memory_budget()
+	{
+		return memory.heap;
+	}
+
+	VkDeviceSize get_memory_category_bytes(memory_category_t category)
+	{
+		return memory.category_bytes[category];
+	}
+
+	const char* get_memory_category_name(memory_category_t category)
+	{
+		return category < MEMORY_CATEGORY_COUNT ? MEMORY_CATEGORY_NAMES[category] : "heap";
+	}
+
+	void log_memory_usage()
+	{
+		LOG_INFO(TAG_RENDERER, "heap %u: %llu of %llu MB, peak %llu MB, %u frames over budget, %u failed allocations",
+			memory.heap_index,
+			(unsigned long long)(memory.heap.usage / MEGABYTES(1)),
+			(unsigned long long)(memory.heap.budget / MEGABYTES(1)),
+			(unsigned long long)(memory.peak_usage / MEGABYTES(1)),
+			memory.over_budget_frames,
+			memory.failed_allocations);
+
+		for (uint32_t category = 0; category < MEMORY_CATEGORY_COUNT; ++category)
+		{
+			LOG_INFO(TAG_RENDERER, "  %-9s %8.2f MB in %u allocations, peak %.2f MB",
+				MEMORY_CATEGORY_NAMES[category],
+				(double)memory.category_bytes[category] / MEGABYTES(1),
+				memory.category_allocations[category],
+				(double)memory.category_peak[category] / MEGABYTES(1));
+		}
+	}
+
+	static double trace_time(uint64_t time)
+	{
+		return (double)(time - memory.start) * 1e-3;
+	}
+
+	bool write_memory_trace(const char* path)
+	{
+		SDL_IOStream* file = SDL_IOFromFile(path, "w");
+		if (!file)
+		{
+			LOG_ERROR(TAG_RENDERER, "failed to write memory trace %s: %s", path, SDL_GetError());
+			return false;
+		}
+
+		SDL_IOprintf(file, "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [\n");
+
+		// counters in MB, timestamps in microseconds since init_memory_telemetry
+		const uint64_t first_frame = memory.frame_count > MEMORY_TIMELINE_FRAMES ? memory.frame_count - MEMORY_TIMELINE_FRAMES : 0;
+
+		for (uint64_t i = first_frame; i < memory.frame_count; ++i)
+		{
+			const memory_frame_t& sample = memory.frames[i % MEMORY_TIMELINE_FRAMES];
+			const double          ts     = trace_time(sample.time);
+
+			SDL_IOprintf(file, "{\"name\": \"heap %u\", \"ph\": \"C\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"args\": {\"usage\": %.3f, \"budget\": %.3f}},\n",
+				memory.heap_index, ts, (double)sample.heap_usage / MEGABYTES(1), (double)sample.heap_budget / MEGABYTES(1));
+
+			SDL_IOprintf(file, "{\"name\": \"categories\", \"ph\": \"C\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"args\": {", ts);
+
+			for (uint32_t category = 0; category < MEMORY_CATEGORY_COUNT; ++category)
+			{
+				SDL_IOprintf(file, "%s\"%s\": %.3f", category ? ", " : "", MEMORY_CATEGORY_NAMES[category], (double)sample.category_bytes[category] / MEGABYTES(1));
+			}
+
+			SDL_IOprintf(file, "}},\n");
+		}
+
+		const uint64_t first_event = memory.event_count > MEMORY_TIMELINE_EVENTS ? memory.event_count - MEMORY_TIMELINE_EVENTS : 0;
+
+		for (uint64_t i = first_event; i < memory.event_count; ++i)
+		{
+			const memory_event_t& event = memory.events[i % MEMORY_TIMELINE_EVENTS];
+
+			SDL_IOprintf(file, "{\"name\": \"%s %s\", \"cat\": \"memory\", \"ph\": \"i\", \"s\": \"p\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"args\": {\"bytes\": %llu, \"frame\": %u}},\n",
+				MEMORY_EVENT_NAMES[event.type],
+				get_memory_category_name(event.category),
+				trace_time(event.time),
+				(unsigned long long)event.size,
+				event.frame);
+		}
+
+		// the trace format allows a trailing metadata event, it keeps every entry above comma terminated
+		SDL_IOprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"gpu memory\"}}\n],\n");
+
+		SDL_IOprintf(file, "\"otherData\": {\n\t\"heap\": %u,\n\t\"budget\": %llu,\n\t\"usage\": %llu,\n\t\"peak_usage\": %llu,\n\t\"over_budget_frames\": %u,\n\t\"failed_allocations\": %u,\n\t\"dropped_events\": %llu",
+			memory.heap_index,
+			(unsigned long long)memory.heap.budget,
+			(unsigned long long)memory.heap.usage,
+			(unsigned long long)memory.peak_usage,
+			memory.over_budget_frames,
+			memory.failed_allocations,
+			(unsigned long long)first_event);
+
+		for (uint32_t category = 0; category < MEMORY_CATEGORY_COUNT; ++category)
+		{
+			SDL_IOprintf(file, ",\n\t\"%s\": { \"bytes\": %llu, \"peak\": %llu, \"allocations\": %u }",
+				MEMORY_CATEGORY_NAMES[category],
+				(unsigned long long)memory.category_bytes[category],
+				(unsigned long long)memory.category_peak[category],
+				memory.category_allocations[category]);
+		}
+
+		SDL_IOprintf(file, "\n}\n}\n");
+
+		return SDL_CloseIO(file);
+	}
+
+} // olivia
@@ -0,0 +1,633 @@
+#include "olivia/graphics/vulkan_particles.h"
+
+namespace olivia
+{
+	static particle_system_t particles{};
+
+	static const char* PARTICLE_SHADER_PATHS[PARTICLE_SHADER_COUNT]
+	{
+		PARTICLE_SETUP_SHADER_PATH,
+		PARTICLE_EMIT_SHADER_PATH,
+		PARTICLE_SIMULATE_SHADER_PATH,
+		PARTICLE_SORT_SHADER_PATH,
+		PARTICLE_VERTEX_SHADER_PATH,
+		PARTICLE_FRAGMENT_SHADER_PATH
+	};
+
+	static bool load_particle_shaders(shader_t* shaders)
+	{
+		for (uint32_t i = 0; i < PARTICLE_SHADER_COUNT; ++i)
+		{
+			if (!load_shader(PARTICLE_SHADER_PATHS[i], shaders[i]))
+			{
+				for (uint32_t j = 0; j < i; ++j)
+				{
+					destroy_shader(shaders[j]);
+				}
+
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static VkPipeline create_draw_pipeline(const shader_t& vertex, const shader_t& fragment, bool sorted)
+	{
+		// the sorted permutation reads the particles through the sort keys
+		shader_specialization_t specialization{};
+		set_specialization_constant(specialization, vertex.reflection, PARTICLE_SORTED_CONSTANT, sorted ? VK_TRUE : VK_FALSE);
+
+		VkPipelineShaderStageCreateInfo stages[]
+		{
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_VERTEX_BIT,
+				.module = vertex.module,
+				.pName = "main",
+				.pSpecializationInfo = &specialization.info
+			},
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+				.module = fragment.module,
+				.pName = "main"
+			}
+		};
+
+		// billboards are expanded from the particle buffers, no vertex input
+		VkPipelineVertexInputStateCreateInfo vertex_input
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO
+		};
+
+		VkPipelineInputAssemblyStateCreateInfo input_assembly
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+			.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+		};
+
+		VkPipelineViewportStateCreateInfo viewport
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+			.viewportCount = 1,
+			.scissorCount = 1
+		};
+
+		VkPipelineRasterizationStateCreateInfo rasterization
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+			.polygonMode = VK_POLYGON_MODE_FILL,
+			.cullMode = VK_CULL_MODE_NONE,
+			.lineWidth = 1.0f
+		};
+
+		VkPipelineMultisampleStateCreateInfo multisample
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+		};
+
+		VkPipelineDepthStencilStateCreateInfo depth_stencil
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
+		};
+
+		// premultiplied alpha, additive where the emitted alpha is 0
+		VkPipelineColorBlendAttachmentState blend_attachment
+		{
+			.blendEnable = VK_TRUE,
+			.srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+			.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+			.colorBlendOp = VK_BLEND_OP_ADD,
+			.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+			.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+			.alphaBlendOp = VK_BLEND_OP_ADD,
+			.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+		};
+
+		VkPipelineColorBlendStateCreateInfo blend
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+			.attachmentCount = 1,
+			.pAttachments = &blend_attachment
+		};
+
+		VkDynamicState dynamic_states[]
+		{
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR,
+			VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+			VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+			VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
+		};
+
+		VkPipelineDynamicStateCreateInfo dynamic
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.dynamicStateCount = ARRAY_SIZE(dynamic_states),
+			.pDynamicStates = dynamic_states
+		};
+
+		VkPipelineRenderingCreateInfo rendering
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+			.colorAttachmentCount = 1,
+			.pColorAttachmentFormats = &g_vulkan_core.swapchain_format.format,
+			.depthAttachmentFormat = g_vulkan_core.depth_format
+		};
+
+		VkGraphicsPipelineCreateInfo pipeline_info
+		{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = &rendering,
+			.stageCount = ARRAY_SIZE(stages),
+			.pStages = stages,
+			.pVertexInputState = &vertex_input,
+			.pInputAssemblyState = &input_assembly,
+			.pViewportState = &viewport,
+			.pRasterizationState = &rasterization,
+			.pMultisampleState = &multisample,
+			.pDepthStencilState = &depth_stencil,
+			.pColorBlendState = &blend,
+			.pDynamicState = &dynamic,
+			.layout = particles.draw_layout
+		};
+
+		VkPipeline pipeline{};
+		VK_CHECK(vkCreateGraphicsPipelines(g_vulkan_core.device, g_vulkan_core.pipeline_cache, 1, &pipeline_info, nullptr, &pipeline));
+
+		return pipeline;
+	}
+
+	static void create_particle_pipelines(const shader_t* shaders)
+	{
+		particles.setup    = create_compute_pipeline(shaders[PARTICLE_SHADER_SETUP], particles.compute_layout, nullptr);
+		particles.emit     = create_compute_pipeline(shaders[PARTICLE_SHADER_EMIT], particles.compute_layout, nullptr);
+		particles.simulate = create_compute_pipeline(shaders[PARTICLE_SHADER_SIMULATE], particles.compute_layout, nullptr);
+		particles.sort     = create_compute_pipeline(shaders[PARTICLE_SHADER_SORT], particles.compute_layout, nullptr);
+
+		for (uint32_t sorted = 0; sorted < 2; ++sorted)
+		{
+			particles.draw[sorted] = create_draw_pipeline(shaders[PARTICLE_SHADER_VERTEX], shaders[PARTICLE_SHADER_FRAGMENT], sorted);
+		}
+	}
+
+	static void destroy_particle_pipelines()
+	{
+		vkDestroyPipeline(g_vulkan_core.device, particles.draw[1], nullptr);
+		vkDestroyPipeline(g_vulkan_core.device, particles.draw[0], nullptr);
+		vkDestroyPipeline(g_vulkan_core.device, particles.sort, nullptr);
+		vkDestroyPipeline(g_vulkan_core.device, particles.simulate, nullptr);
+		vkDestroyPipeline(g_vulkan_core.device, particles.emit, nullptr);
+		vkDestroyPipeline(g_vulkan_core.device, particles.setup, nullptr);
+	}
+
+	static void reload_particles(void*)
+	{
+		shader_t shaders[PARTICLE_SHADER_COUNT];
+		if (!load_particle_shaders(shaders))
+			return;
+
+		bool compatible = true;
+		for (uint32_t i = 0; i < PARTICLE_SHADER_COUNT; ++i)
+		{
+			const bool compute = shaders[i].reflection.stages == VK_SHADER_STAGE_COMPUTE_BIT;
+			compatible &= is_layout_compatible(compute ? particles.compute_reflection : particles.draw_reflection, shaders[i].reflection);
+		}
+
+		if (compatible)
+		{
+			destroy_particle_pipelines();
+			create_particle_pipelines(shaders);
+		}
+		else
+		{
+			LOG_ERROR(TAG_RENDERER, "particle shaders changed their bindings, restart to pick them up");
+		}
+
+		for (uint32_t i = 0; i < PARTICLE_SHADER_COUNT; ++i)
+		{
+			destroy_shader(shaders[i]);
+		}
+	}
+
+	void init_particles(uint32_t capacity)
+	{
+		assert(!particles.capacity && "particles already initialized");
+
+		capacity = SDL_max(capacity, MIN_PARTICLE_CAPACITY);
+		while (capacity & (capacity - 1))
+		{
+			capacity = (capacity | (capacity - 1)) + 1;
+		}
+
+		particles.capacity = capacity;
+
+		// written on the compute queue, drawn on the graphics queue
+		for (uint32_t i = 0; i < 2; ++i)
+		{
+			particles.particles[i] = create_vulkan_buffer(MEMORY_CATEGORY_BUFFER, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, capacity * 48ull, true);
+			particles.alive[i]     = create_vulkan_buffer(MEMORY_CATEGORY_BUFFER, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, capacity * sizeof(uint32_t), true);
+			particles.sort_keys[i] = create_vulkan_buffer(MEMORY_CATEGORY_BUFFER, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, capacity * sizeof(uint32_t) * 2ull, true);
+		}
+
+		particles.dead     = create_vulkan_buffer(MEMORY_CATEGORY_BUFFER, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, capacity * sizeof(uint32_t), true);
+		particles.counters = create_vulkan_buffer(
+			MEMORY_CATEGORY_BUFFER,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+			0,
+			PARTICLE_COUNTER_COUNT * sizeof(uint32_t),
+			true);
+
+		// create timestamp queries, the job records on either queue family
+		{
+			uint32_t family_count{};
+			vkGetPhysicalDeviceQueueFamilyProperties(g_vulkan_core.gpu, &family_count, nullptr);
+
+			VkQueueFamilyProperties families[16];
+			family_count = SDL_min(family_count, (uint32_t)ARRAY_SIZE(families));
+			vkGetPhysicalDeviceQueueFamilyProperties(g_vulkan_core.gpu, &family_count, families);
+
+			particles.timestamps[0] = families[g_vulkan_core.graphics_queue_index].timestampValidBits != 0;
+			particles.timestamps[1] = families[g_vulkan_core.compute_queue_index].timestampValidBits != 0;
+
+			if (g_vulkan_core.timestamp_period > 0.0f && (particles.timestamps[0] || particles.timestamps[1]))
+			{
+				VkQueryPoolCreateInfo query_pool_info
+				{
+					.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+					.queryType = VK_QUERY_TYPE_TIMESTAMP,
+					.queryCount = 2 * MAX_FRAMES
+				};
+
+				VK_CHECK(vkCreateQueryPool(g_vulkan_core.device, &query_pool_info, nullptr, &particles.timestamp_pool));
+			}
+		}
+
+		LOG_INFO(TAG_RENDERER, "particles: capacity %u, %.1f MB", capacity, (double)(capacity * (48ull * 2 + 4 * 3 + 8 * 2)) / (1024.0 * 1024.0));
+		// without the shaders nothing is scheduled or drawn
+		shader_t shaders[PARTICLE_SHADER_COUNT];
+		if (!load_particle_shaders(shaders))
+			return;
+
+		// one set layout for every stage, push constants differ between compute and draw
+		shader_reflection_t layout{};
+		for (uint32_t i = 0; i < PARTICLE_SHADER_COUNT; ++i)
+		{
+			const bool compute = shaders[i].reflection.stages == VK_SHADER_STAGE_COMPUTE_BIT;
+
+			merge_shader_reflection(compute ? particles.compute_reflection : particles.draw_reflection, shaders[i].reflection);
+			merge_shader_reflection(layout, shaders[i].reflection);
+		}
+
+		assert(particles.compute_reflection.push_constant_size <= sizeof(particle_emit_t) && "particle compute push constants grew");
+		assert(particles.draw_reflection.push_constant_size == sizeof(particle_draw_t) && "particle.vert disagrees with particle_draw_t");
+
+		// create descriptor sets
+		{
+			particles.set_layout      = create_reflected_set_layout(layout, 0);
+			particles.descriptor_pool = create_reflected_descriptor_pool(layout, 0, 2);
+
+			VkDescriptorSetLayout set_layouts[2]{ particles.set_layout, particles.set_layout };
+
+			VkDescriptorSetAllocateInfo set_info
+			{
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+				.descriptorPool = particles.descriptor_pool,
+				.descriptorSetCount = 2,
+				.pSetLayouts = set_layouts
+			};
+
+			VK_CHECK(vkAllocateDescriptorSets(g_vulkan_core.device, &set_info, particles.sets));
+
+			for (uint32_t out = 0; out < 2; ++out)
+			{
+				const uint32_t in = out ^ 1;
+
+				VkDescriptorBufferInfo buffer_infos[]
+				{
+					{ particles.particles[in].buffer,  0, VK_WHOLE_SIZE },
+					{ particles.particles[out].buffer, 0, VK_WHOLE_SIZE },
+					{ particles.alive[in].buffer,      0, VK_WHOLE_SIZE },
+					{ particles.alive[out].buffer,     0, VK_WHOLE_SIZE },
+					{ particles.dead.buffer,           0, VK_WHOLE_SIZE },
+					{ particles.counters.buffer,       0, VK_WHOLE_SIZE },
+					{ particles.sort_keys[out].buffer, 0, VK_WHOLE_SIZE }
+				};
+
+				VkWriteDescriptorSet writes[ARRAY_SIZE(buffer_infos)];
+				for (uint32_t binding = 0; binding < ARRAY_SIZE(buffer_infos); ++binding)
+				{
+					writes[binding] =
+					{
+						.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+						.dstSet = particles.sets[out],
+						.dstBinding = binding,
+						.descriptorCount = 1,
+						.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+						.pBufferInfo = &buffer_infos[binding]
+					};
+				}
+
+				vkUpdateDescriptorSets(g_vulkan_core.device, ARRAY_SIZE(writes), writes, 0, nullptr);
+			}
+		}
+
+		particles.compute_layout = create_reflected_pipeline_layout(particles.compute_reflection, &particles.set_layout, 1);
+		particles.draw_layout    = create_reflected_pipeline_layout(particles.draw_reflection, &particles.set_layout, 1);
+
+		create_particle_pipelines(shaders);
+
+		for (uint32_t i = 0; i < PARTICLE_SHADER_COUNT; ++i)
+		{
+			destroy_shader(shaders[i]);
+			watch_shader(PARTICLE_SHADER_PATHS[i], reload_particles, nullptr);
+		}
+	}
+
+	void destroy_particles()
+	{
+		if (!particles.capacity)
+			return;
+
+		unwatch_shaders(reload_particles);
+
+		vkDestroyQueryPool(g_vulkan_core.device, particles.timestamp_pool, nullptr);
+
+		destroy_particle_pipelines();
+		vkDestroyPipelineLayout(g_vulkan_core.device, particles.draw_layout, nullptr);
+		vkDestroyPipelineLayout(g_vulkan_core.device, particles.compute_layout, nullptr);
+		vkDestroyDescriptorPool(g_vulkan_core.device, particles.descriptor_pool, nullptr);
+		vkDestroyDescriptorSetLayout(g_vulkan_core.device, particles.set_layout, nullptr);
+
+		for (uint32_t i = 0; i < 2; ++i)
+		{
+			destroy_vulkan_buffer(particles.particles[i]);
+			destroy_vulkan_buffer(particles.alive[i]);
+			destroy_vulkan_buffer(particles.sort_keys[i]);
+		}
+
+		destroy_vulkan_buffer(particles.dead);
+		destroy_vulkan_buffer(particles.counters);
+
+		particles = {};
+	}
+
+	void emit_particles(const particle_emit_t& emit)
+	{
+		if (emit.count == 0)
+			return;
+
+		if (particles.emit_count == MAX_PARTICLE_EMITS)
+		{
+			LOG_WARN(TAG_RENDERER, "particles: more than %u emits in a frame, dropped", MAX_PARTICLE_EMITS);
+			return;
+		}
+
+		particle_emit_t& queued = particles.emits[particles.emit_count++];
+
+		queued      = emit;
+		queued.seed = ++particles.seed * 0x9E3779B9u;
+	}
+
+	static void compute_barrier(VkCommandBuffer cmd, VkPipelineStageFlags2 dst_stages, VkAccessFlags2 dst_access)
+	{
+		VkMemoryBarrier2 barrier
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+			.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+			.dstStageMask = dst_stages,
+			.dstAccessMask = dst_access
+		};
+
+		VkDependencyInfo dependency
+		{
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.memoryBarrierCount = 1,
+			.pMemoryBarriers = &barrier
+		};
+
+		vkCmdPipelineBarrier2(cmd, &dependency);
+	}
+
+	static void barrier_before_compute(VkCommandBuffer cmd)
+	{
+		compute_barrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+	}
+
+	static void read_particle_timings()
+	{
+		const uint32_t frame = g_vulkan_core.current_frame;
+
+		if (!particles.timestamp_written[frame])
+			return;
+
+		// the frame slot was waited for, the results are available
+		uint64_t timestamps[2]{};
+		VkResult result = vkGetQueryPoolResults(
+			g_vulkan_core.device,
+			particles.timestamp_pool,
+			frame * 2, 2,
+			sizeof(timestamps), timestamps, sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT);
+
+		if (result == VK_SUCCESS)
+		{
+			particles.gpu_ms = (float)((double)(timestamps[1] - timestamps[0]) * g_vulkan_core.timestamp_period * 1e-6);
+		}
+
+		particles.timestamp_written[frame] = false;
+	}
+
+	static void record_particles(VkCommandBuffer cmd, void*)
+	{
+		const uint64_t record_start = SDL_GetPerformanceCounter();
+		const uint32_t frame        = g_vulkan_core.current_frame;
+		const uint32_t out          = particles.parity ^ 1;
+
+		read_particle_timings();
+
+		const bool timed = particles.timestamp_pool && particles.timestamps[is_async_compute_enabled() ? 1 : 0];
+		if (timed)
+		{
+			vkCmdResetQueryPool(cmd, particles.timestamp_pool, frame * 2, 2);
+			vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, particles.timestamp_pool, frame * 2);
+		}
+
+		// earlier work on the same queue may still read the counters
+		barrier_before_compute(cmd);
+
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, particles.compute_layout, 0, 1, &particles.sets[out], 0, nullptr);
+
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, particles.setup);
+
+		if (!particles.initialized)
+		{
+			particle_setup_t init{ PARTICLE_SETUP_INIT, out, particles.capacity };
+
+			vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(init), &init);
+			vkCmdDispatch(cmd, particles.capacity / 256, 1, 1);
+			barrier_before_compute(cmd);
+
+			particles.initialized = true;
+		}
+
+		// prepare
+		{
+			particle_setup_t prepare{ PARTICLE_SETUP_PREPARE, out, particles.capacity };
+
+			vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(prepare), &prepare);
+			vkCmdDispatch(cmd, 1, 1, 1);
+			compute_barrier(cmd,
+				VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+				VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+		}
+
+		// emit, the new particles are appended to the output list ahead of the survivors
+		if (particles.emit_count)
+		{
+			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, particles.emit);
+
+			for (uint32_t i = 0; i < particles.emit_count; ++i)
+			{
+				const particle_emit_t& emit = particles.emits[i];
+
+				vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(emit), &emit);
+				vkCmdDispatch(cmd, (emit.count + 63) / 64, 1, 1);
+			}
+
+			barrier_before_compute(cmd);
+		}
+
+		// simulate and compact, as many threads as particles were alive last frame
+		{
+			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, particles.simulate);
+			vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(particles.step), &particles.step);
+			vkCmdDispatchIndirect(cmd, particles.counters.buffer, PARTICLE_COUNTER_SIMULATE * sizeof(uint32_t));
+			barrier_before_compute(cmd);
+		}
+
+		// finish
+		{
+			particle_setup_t finish{ PARTICLE_SETUP_FINISH, out, particles.capacity };
+
+			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, particles.setup);
+			vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(finish), &finish);
+			vkCmdDispatch(cmd, 1, 1, 1);
+		}
+
+		// bitonic sort of the whole key buffer, dead slots are padded to the end
+		if (particles.sorted)
+		{
+			const uint32_t blocks = particles.capacity / 1024;
+
+			particle_sort_t sort
+			{
+				.mode = PARTICLE_SORT_KEYS,
+				.capacity = particles.capacity,
+				.camera_position = particles.camera_position
+			};
+
+			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, particles.sort);
+
+			barrier_before_compute(cmd);
+			vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sort), &sort);
+			vkCmdDispatch(cmd, blocks, 1, 1);
+
+			sort.mode = PARTICLE_SORT_LOCAL;
+			barrier_before_compute(cmd);
+			vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sort), &sort);
+			vkCmdDispatch(cmd, blocks, 1, 1);
+
+			for (uint32_t k = 2048; k <= particles.capacity; k <<= 1)
+			{
+				sort.k = k;
+
+				for (uint32_t j = k >> 1; j >= 1024; j >>= 1)
+				{
+					sort.mode = PARTICLE_SORT_GLOBAL_STEP;
+					sort.j    = j;
+					barrier_before_compute(cmd);
+					vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sort), &sort);
+					vkCmdDispatch(cmd, blocks, 1, 1);
+				}
+
+				sort.mode = PARTICLE_SORT_LOCAL_MERGE;
+				barrier_before_compute(cmd);
+				vkCmdPushConstants(cmd, particles.compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sort), &sort);
+				vkCmdDispatch(cmd, blocks, 1, 1);
+			}
+		}
+
+		if (timed)
+		{
+			vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, particles.timestamp_pool, frame * 2 + 1);
+			particles.timestamp_written[frame] = true;
+		}
+
+		particles.parity        = out;
+		particles.parity_sorted = particles.sorted;
+		particles.emit_count    = 0;
+
+		particles.record_ms = (float)((double)(SDL_GetPerformanceCounter() - record_start) * 1000.0 / (double)SDL_GetPerformanceFrequency());
+	}
+
+	void schedule_particles(float dt, vec3_t gravity, bool sorted, vec3_t camera_position)
+	{
+		if (!particles.setup)
+			return;
+
+		particles.step            = { gravity, dt };
+		particles.sorted          = sorted;
+		particles.camera_position = camera_position;
+
+		// the draw reads the indirect args and the buffers from the vertex shader on
+		schedule_compute(record_particles, nullptr, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+	}
+
+	void draw_particles(const float view_projection[16], vec3_t camera_right, vec3_t camera_up)
+	{
+		// billboards never write depth, so the pre-pass has nothing to draw
+		if (!particles.setup || !particles.initialized || g_vulkan_core.current_pass != RENDER_PASS_MAIN)
+			return;
+
+		VkCommandBuffer cmd    = g_vulkan_core.command_buffers[g_vulkan_core.current_frame];
+		const uint32_t  parity = particles.parity;
+
+		particle_draw_t draw
+		{
+			.camera_right = { camera_right.x, camera_right.y, camera_right.z, 0.0f },
+			.camera_up = { camera_up.x, camera_up.y, camera_up.z, 0.0f }
+		};
+		memcpy(draw.view_projection, view_projection, sizeof(draw.view_projection));
+
+		// tested against the scene, including after a pre-pass, but never written
+		vkCmdSetDepthWriteEnable(cmd, VK_FALSE);
+		vkCmdSetDepthCompareOp(cmd, DEPTH_COMPARE_OP);
+
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, particles.draw[particles.parity_sorted]);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, particles.draw_layout, 0, 1, &particles.sets[parity], 0, nullptr);
+		vkCmdPushConstants(cmd, particles.draw_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(draw), &draw);
+		vkCmdDrawIndirect(cmd, particles.counters.buffer, (PARTICLE_COUNTER_DRAW + parity * 4) * sizeof(uint32_t), 1, sizeof(VkDrawIndirectCommand));
+
+		// back to what begin_pass set
+		const bool depth_from_prepass = g_vulkan_core.depth_prepass;
+
+		vkCmdSetDepthWriteEnable(cmd, depth_from_prepass ? VK_FALSE : VK_TRUE);
+		vkCmdSetDepthCompareOp(cmd, depth_from_prepass ? VK_COMPARE_OP_EQUAL : DEPTH_COMPARE_OP);
+	}
+
+	float get_particle_gpu_time()
+	{
+		return particles.gpu_ms;
+	}
+
+	float get_particle_record_time()
+	{
+		return particles.record_ms;
+	}
+
+} // olivia
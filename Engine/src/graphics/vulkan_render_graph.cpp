@@ -0,0 +1,241 @@
+#include "olivia/graphics/render_graph.h"
+#include "olivia/graphics/vulkan_memory.h"
+
+namespace olivia
+{
+	void realize_render_graph(render_graph_t& graph)
+	{
+		VkMemoryRequirements requirements[GRAPH_MAX_RESOURCES]{};
+
+		// lifetimes and usage flags first, the resources are created from them
+		compile_render_graph(graph, nullptr);
+
+		for (graph_resource_t r = 0; r < graph.resource_count; ++r)
+		{
+			const graph_resource_desc_t& desc = graph.resources[r];
+
+			if (desc.imported || graph.first_use[r] == GRAPH_NOT_USED)
+				continue;
+
+			if (desc.type == GRAPH_RESOURCE_IMAGE)
+			{
+				VkImageCreateInfo image_info
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+					.imageType = VK_IMAGE_TYPE_2D,
+					.format = desc.format,
+					.extent = { desc.extent.width, desc.extent.height, 1 },
+					.mipLevels = 1,
+					.arrayLayers = 1,
+					.samples = VK_SAMPLE_COUNT_1_BIT,
+					.tiling = VK_IMAGE_TILING_OPTIMAL,
+					.usage = graph.image_usage[r],
+					.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+					.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+				};
+
+				VK_CHECK(vkCreateImage(g_vulkan_core.device, &image_info, nullptr, &graph.images[r]));
+				vkGetImageMemoryRequirements(g_vulkan_core.device, graph.images[r], &requirements[r]);
+			}
+			else
+			{
+				VkBufferCreateInfo buffer_info
+				{
+					.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+					.size = desc.size,
+					.usage = graph.buffer_usage[r],
+					.sharingMode = VK_SHARING_MODE_EXCLUSIVE
+				};
+
+				VK_CHECK(vkCreateBuffer(g_vulkan_core.device, &buffer_info, nullptr, &graph.buffers[r]));
+				vkGetBufferMemoryRequirements(g_vulkan_core.device, graph.buffers[r], &requirements[r]);
+			}
+		}
+
+		compile_render_graph(graph, requirements);
+
+		if (graph.transient_size == 0)
+			return;
+
+		// one block for every transient, resources that are never alive at the same time share memory
+		VkMemoryRequirements memory_requirements
+		{
+			.size = graph.transient_size,
+			.alignment = graph.transient_alignment,
+			.memoryTypeBits = graph.transient_memory_types
+		};
+
+		VmaAllocationCreateInfo allocation_info
+		{
+			.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
+			.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		};
+
+		VmaAllocation allocation{};
+		VK_CHECK(vmaAllocateMemory(g_vulkan_core.allocator, &memory_requirements, &allocation_info, &allocation, nullptr));
+
+		track_allocation(allocation, MEMORY_CATEGORY_TRANSIENT);
+
+		graph.transient_allocation = allocation;
+
+		for (graph_resource_t r = 0; r < graph.resource_count; ++r)
+		{
+			const graph_resource_desc_t& desc = graph.resources[r];
+
+			if (graph.images[r] && !desc.imported)
+			{
+				VK_CHECK(vmaBindImageMemory2(g_vulkan_core.allocator, allocation, graph.alias_offset[r], graph.images[r], nullptr));
+
+				VkImageViewCreateInfo view_info
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+					.image = graph.images[r],
+					.viewType = VK_IMAGE_VIEW_TYPE_2D,
+					.format = desc.format,
+					.subresourceRange = { desc.aspect, 0, 1, 0, 1 }
+				};
+
+				VK_CHECK(vkCreateImageView(g_vulkan_core.device, &view_info, nullptr, &graph.views[r]));
+			}
+			else if (graph.buffers[r] && !desc.imported)
+			{
+				VK_CHECK(vmaBindBufferMemory2(g_vulkan_core.allocator, allocation, graph.alias_offset[r], graph.buffers[r], nullptr));
+			}
+		}
+	}
+
+	void release_render_graph(render_graph_t& graph)
+	{
+		for (graph_resource_t r = 0; r < graph.resource_count; ++r)
+		{
+			if (graph.resources[r].imported)
+				continue;
+
+			if (graph.images[r])
+				defer_destroy_image(graph.images[r], graph.views[r], VK_NULL_HANDLE);
+			if (graph.buffers[r])
+				defer_destroy_buffer(graph.buffers[r], VK_NULL_HANDLE);
+
+			graph.views[r]   = VK_NULL_HANDLE;
+			graph.images[r]  = VK_NULL_HANDLE;
+			graph.buffers[r] = VK_NULL_HANDLE;
+		}
+
+		if (graph.transient_allocation)
+		{
+			defer_destroy_buffer(VK_NULL_HANDLE, (VmaAllocation)graph.transient_allocation);
+			graph.transient_allocation = nullptr;
+		}
+	}
+
+	void render_graph_set_image(render_graph_t& graph, graph_resource_t resource, VkImage image, VkImageView view)
+	{
+		assert(graph.resources[resource].imported && "only imported resources can be set");
+
+		graph.images[resource] = image;
+		graph.views[resource]  = view;
+	}
+
+	void render_graph_set_buffer(render_graph_t& graph, graph_resource_t resource, VkBuffer buffer)
+	{
+		assert(graph.resources[resource].imported && "only imported resources can be set");
+
+		graph.buffers[resource] = buffer;
+	}
+
+	VkImageView render_graph_get_view(const render_graph_t& graph, graph_resource_t resource)
+	{
+		return graph.views[resource];
+	}
+
+	VkBuffer render_graph_get_buffer(const render_graph_t& graph, graph_resource_t resource)
+	{
+		return graph.buffers[resource];
+	}
+
+	static void record_barriers(const render_graph_t& graph, VkCommandBuffer cmd, uint32_t first, uint32_t last)
+	{
+		VkImageMemoryBarrier2  image_barriers[GRAPH_MAX_RESOURCES];
+		VkBufferMemoryBarrier2 buffer_barriers[GRAPH_MAX_RESOURCES];
+		uint32_t               image_barrier_count{};
+		uint32_t               buffer_barrier_count{};
+
+		if (first == last)
+			return;
+
+		assert(last - first <= GRAPH_MAX_RESOURCES && "render graph barrier batch overflow");
+
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const graph_barrier_t&       barrier = graph.barriers[i];
+			const graph_resource_desc_t& desc    = graph.resources[barrier.resource];
+
+			if (desc.type == GRAPH_RESOURCE_IMAGE)
+			{
+				assert(graph.images[barrier.resource] && "render graph image was not set");
+
+				image_barriers[image_barrier_count++] =
+				{
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = barrier.src_stage,
+					.srcAccessMask = barrier.src_access,
+					.dstStageMask = barrier.dst_stage,
+					.dstAccessMask = barrier.dst_access,
+					.oldLayout = barrier.old_layout,
+					.newLayout = barrier.new_layout,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = graph.images[barrier.resource],
+					.subresourceRange = { desc.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS }
+				};
+			}
+			else
+			{
+				assert(graph.buffers[barrier.resource] && "render graph buffer was not set");
+
+				buffer_barriers[buffer_barrier_count++] =
+				{
+					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+					.srcStageMask = barrier.src_stage,
+					.srcAccessMask = barrier.src_access,
+					.dstStageMask = barrier.dst_stage,
+					.dstAccessMask = barrier.dst_access,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.buffer = graph.buffers[barrier.resource],
+					.offset = 0,
+					.size = VK_WHOLE_SIZE
+				};
+			}
+		}
+
+		VkDependencyInfo dependency_info
+		{
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.bufferMemoryBarrierCount = buffer_barrier_count,
+			.pBufferMemoryBarriers = buffer_barriers,
+			.imageMemoryBarrierCount = image_barrier_count,
+			.pImageMemoryBarriers = image_barriers
+		};
+
+		vkCmdPipelineBarrier2(cmd, &dependency_info);
+	}
+
+	void execute_render_graph(render_graph_t& graph, VkCommandBuffer cmd)
+	{
+		for (uint32_t p = 0; p < graph.pass_count; ++p)
+		{
+			if (graph.culled[p])
+				continue;
+
+			const graph_pass_desc_t& pass = graph.passes[p];
+
+			record_barriers(graph, cmd, graph.pass_barriers[p], graph.pass_barriers[p + 1]);
+
+			pass.execute(cmd, pass.data);
+		}
+
+		record_barriers(graph, cmd, graph.pass_barriers[graph.pass_count], graph.barrier_count);
+	}
+
+} // olivia
@@ -0,0 +1,330 @@
+#include "olivia/graphics/vulkan_shader.h"
+
+namespace olivia
+{
+#ifdef OLIVIA_DEBUG
+	static shader_watcher_t shader_watcher{ .enabled = true };
+#else
+	static shader_watcher_t shader_watcher{};
+#endif
+
+	static void* load_shader_code(const char* name, size_t& size)
+	{
+		char path[512];
+		SDL_snprintf(path, sizeof(path), "%s%s", SDL_GetBasePath(), name);
+
+		void* code = SDL_LoadFile(path, &size);
+		if (!code)
+		{
+			LOG_ERROR(TAG_RENDERER, "failed to load %s: %s", path, SDL_GetError());
+		}
+
+		return code;
+	}
+
+	static VkShaderModule create_shader_module(const void* code, size_t size)
+	{
+		VkShaderModuleCreateInfo module_info
+		{
+			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+			.codeSize = size,
+			.pCode = (const uint32_t*)code
+		};
+
+		VkShaderModule module{};
+		VK_CHECK(vkCreateShaderModule(g_vulkan_core.device, &module_info, nullptr, &module));
+
+		return module;
+	}
+
+	VkShaderModule load_shader_module(const char* name)
+	{
+		size_t size{};
+		void* code = load_shader_code(name, size);
+		if (!code)
+			return VK_NULL_HANDLE;
+
+		VkShaderModule module = create_shader_module(code, size);
+
+		SDL_free(code);
+
+		return module;
+	}
+
+	bool load_shader(const char* name, shader_t& shader)
+	{
+		shader = {};
+
+		size_t size{};
+		void* code = load_shader_code(name, size);
+		if (!code)
+			return false;
+
+		// SDL_LoadFile allocations are aligned well enough to read words from
+		if (!reflect_shader((const uint32_t*)code, size, shader.reflection))
+		{
+			LOG_ERROR(TAG_RENDERER, "%s is not reflectable SPIR-V", name);
+			SDL_free(code);
+			return false;
+		}
+
+		shader.module = create_shader_module(code, size);
+
+		SDL_free(code);
+
+		return true;
+	}
+
+	void destroy_shader(shader_t& shader)
+	{
+		vkDestroyShaderModule(g_vulkan_core.device, shader.module, nullptr);
+		shader.module = VK_NULL_HANDLE;
+	}
+
+	VkDescriptorSetLayout create_reflected_set_layout(const shader_reflection_t& reflection, uint32_t set)
+	{
+		VkDescriptorSetLayoutBinding bindings[MAX_SHADER_BINDINGS];
+		uint32_t binding_count{};
+
+		for (uint32_t i = 0; i < reflection.binding_count; ++i)
+		{
+			const shader_binding_t& binding = reflection.bindings[i];
+			if (binding.set != set)
+				continue;
+
+			bindings[binding_count++] =
+			{
+				.binding = binding.binding,
+				.descriptorType = binding.type,
+				.descriptorCount = binding.count,
+				.stageFlags = binding.stages
+			};
+		}
+
+		VkDescriptorSetLayoutCreateInfo set_layout_info
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.bindingCount = binding_count,
+			.pBindings = bindings
+		};
+
+		VkDescriptorSetLayout set_layout{};
+		VK_CHECK(vkCreateDescriptorSetLayout(g_vulkan_core.device, &set_layout_info, nullptr, &set_layout));
+
+		return set_layout;
+	}
+
+	VkDescriptorPool create_reflected_descriptor_pool(const shader_reflection_t& reflection, uint32_t set, uint32_t max_sets)
+	{
+		VkDescriptorPoolSize pool_sizes[MAX_SHADER_BINDINGS];
+		uint32_t pool_size_count{};
+
+		for (uint32_t i = 0; i < reflection.binding_count; ++i)
+		{
+			const shader_binding_t& binding = reflection.bindings[i];
+			if (binding.set != set)
+				continue;
+
+			uint32_t j = 0;
+			while (j < pool_size_count && pool_sizes[j].type != binding.type)
+			{
+				++j;
+			}
+
+			if (j == pool_size_count)
+			{
+				pool_sizes[pool_size_count++] = { binding.type, 0 };
+			}
+
+			pool_sizes[j].descriptorCount += binding.count * max_sets;
+		}
+
+		VkDescriptorPoolCreateInfo pool_info
+		{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.maxSets = max_sets,
+			.poolSizeCount = pool_size_count,
+			.pPoolSizes = pool_sizes
+		};
+
+		VkDescriptorPool pool{};
+		VK_CHECK(vkCreateDescriptorPool(g_vulkan_core.device, &pool_info, nullptr, &pool));
+
+		return pool;
+	}
+
+	VkPipelineLayout create_reflected_pipeline_layout(const shader_reflection_t& reflection, const VkDescriptorSetLayout* set_layouts, uint32_t set_count)
+	{
+		VkPushConstantRange push_range
+		{
+			.stageFlags = reflection.push_constant_stages,
+			.size = reflection.push_constant_size
+		};
+
+		VkPipelineLayoutCreateInfo pipeline_layout_info
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			.setLayoutCount = set_count,
+			.pSetLayouts = set_layouts,
+			.pushConstantRangeCount = reflection.push_constant_size ? 1u : 0u,
+			.pPushConstantRanges = &push_range
+		};
+
+		VkPipelineLayout pipeline_layout{};
+		VK_CHECK(vkCreatePipelineLayout(g_vulkan_core.device, &pipeline_layout_info, nullptr, &pipeline_layout));
+
+		return pipeline_layout;
+	}
+
+	VkPipeline create_compute_pipeline(const shader_t& shader, VkPipelineLayout layout, const VkSpecializationInfo* specialization)
+	{
+		assert(shader.reflection.stages == VK_SHADER_STAGE_COMPUTE_BIT && "not a compute shader");
+
+		VkComputePipelineCreateInfo pipeline_info
+		{
+			.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+			.stage =
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+				.module = shader.module,
+				.pName = "main",
+				.pSpecializationInfo = specialization
+			},
+			.layout = layout
+		};
+
+		VkPipeline pipeline{};
+		VK_CHECK(vkCreateComputePipelines(g_vulkan_core.device, g_vulkan_core.pipeline_cache, 1, &pipeline_info, nullptr, &pipeline));
+
+		return pipeline;
+	}
+
+	void set_specialization_constant(shader_specialization_t& specialization, const shader_reflection_t& shader, uint32_t id, uint32_t value)
+	{
+		assert(has_spec_constant(shader, id) && "the shader has no such specialization constant");
+		(void)shader;
+
+		VkSpecializationInfo& info = specialization.info;
+
+		uint32_t i = 0;
+		while (i < info.mapEntryCount && specialization.entries[i].constantID != id)
+		{
+			++i;
+		}
+
+		if (i == info.mapEntryCount)
+		{
+			assert(i < MAX_SPECIALIZATION_CONSTANTS && "too many specialization constants");
+
+			specialization.entries[i] =
+			{
+				.constantID = id,
+				.offset = i * (uint32_t)sizeof(uint32_t),
+				.size = sizeof(uint32_t)
+			};
+
+			++info.mapEntryCount;
+		}
+
+		specialization.values[i] = value;
+
+		info.pMapEntries = specialization.entries;
+		info.dataSize    = info.mapEntryCount * sizeof(uint32_t);
+		info.pData       = specialization.values;
+	}
+
+	// --- hot reload ---
+
+	static SDL_Time get_shader_modify_time(const char* name)
+	{
+		char path[512];
+		SDL_snprintf(path, sizeof(path), "%s%s", SDL_GetBasePath(), name);
+
+		SDL_PathInfo info{};
+		return SDL_GetPathInfo(path, &info) ? info.modify_time : 0;
+	}
+
+	void watch_shader(const char* name, shader_reload_function reload, void* data)
+	{
+		assert(shader_watcher.watch_count < MAX_WATCHED_SHADERS && "too many watched shaders");
+
+		shader_watch_t& watch = shader_watcher.watches[shader_watcher.watch_count++];
+
+		SDL_strlcpy(watch.name, name, sizeof(watch.name));
+		watch.modify_time = get_shader_modify_time(name);
+		watch.reload      = reload;
+		watch.data        = data;
+	}
+
+	void unwatch_shaders(shader_reload_function reload)
+	{
+		uint32_t kept{};
+
+		for (uint32_t i = 0; i < shader_watcher.watch_count; ++i)
+		{
+			if (shader_watcher.watches[i].reload != reload)
+			{
+				shader_watcher.watches[kept++] = shader_watcher.watches[i];
+			}
+		}
+
+		shader_watcher.watch_count = kept;
+	}
+
+	void set_shader_hot_reload(bool enabled)
+	{
+		shader_watcher.enabled = enabled;
+	}
+
+	void poll_shader_reload()
+	{
+		if (!shader_watcher.enabled || !shader_watcher.watch_count)
+			return;
+
+		const uint64_t now = SDL_GetTicks();
+		if (now - shader_watcher.last_poll < SHADER_POLL_INTERVAL_MS)
+			return;
+
+		shader_watcher.last_poll = now;
+
+		// every owner reloads once however many of its shaders changed
+		shader_watch_t* changed[MAX_WATCHED_SHADERS];
+		uint32_t changed_count{};
+
+		for (uint32_t i = 0; i < shader_watcher.watch_count; ++i)
+		{
+			shader_watch_t& watch = shader_watcher.watches[i];
+
+			SDL_Time modify_time = get_shader_modify_time(watch.name);
+			if (!modify_time || modify_time == watch.modify_time)
+				continue;
+
+			watch.modify_time = modify_time;
+
+			LOG_INFO(TAG_RENDERER, "shader %s changed", watch.name);
+
+			bool owner_seen = false;
+			for (uint32_t j = 0; j < changed_count; ++j)
+			{
+				owner_seen |= changed[j]->reload == watch.reload && changed[j]->data == watch.data;
+			}
+
+			if (!owner_seen)
+			{
+				changed[changed_count++] = &watch;
+			}
+		}
+
+		if (!changed_count)
+			return;
+
+		vkDeviceWaitIdle(g_vulkan_core.device);
+
+		for (uint32_t i = 0; i < changed_count; ++i)
+		{
+			changed[i]->reload(changed[i]->data);
+		}
+	}
+
+} // olivia
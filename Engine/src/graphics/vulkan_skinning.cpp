@@ -0,0 +1,215 @@
+#include "olivia/graphics/vulkan_skinning.h"
+
+namespace olivia
+{
+	static skinning_t skinning{};
+
+	static void reload_skinning(void*)
+	{
+		shader_t shader;
+		if (!load_shader(SKINNING_SHADER_PATH, shader))
+			return;
+
+		if (is_layout_compatible(skinning.reflection, shader.reflection))
+		{
+			vkDestroyPipeline(g_vulkan_core.device, skinning.pipeline, nullptr);
+			skinning.pipeline = create_compute_pipeline(shader, skinning.pipeline_layout, nullptr);
+		}
+		else
+		{
+			LOG_ERROR(TAG_RENDERER, "%s changed its bindings, restart to pick it up", SKINNING_SHADER_PATH);
+		}
+
+		destroy_shader(shader);
+	}
+
+	void init_skinning()
+	{
+		const mesh_group_t& mesh_group = get_mesh_group();
+
+		skinning.palette = (joint_matrix_t*)malloc(MAX_SKINNING_JOINTS * sizeof(joint_matrix_t));
+		assert(skinning.palette && "malloc failed");
+
+		for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+		{
+			skinning.output[i] = create_vulkan_buffer(
+				MEMORY_CATEGORY_BUFFER,
+				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				0,
+				SKINNING_OUTPUT_SIZE,
+				true);
+
+			skinning.joints[i] = create_vulkan_buffer(
+				MEMORY_CATEGORY_STAGING,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VMA_MEMORY_USAGE_AUTO,
+				VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+				MAX_SKINNING_JOINTS * sizeof(joint_matrix_t),
+				true);
+		}
+
+		// without the shader skinned meshes are simply not skinned
+		shader_t shader;
+		if (!load_shader(SKINNING_SHADER_PATH, shader))
+			return;
+
+		skinning.reflection = shader.reflection;
+		assert(shader.reflection.push_constant_size == sizeof(skinning_dispatch_t) && "skinning.comp disagrees with skinning_dispatch_t");
+
+		// create descriptor sets
+		{
+			skinning.set_layout      = create_reflected_set_layout(shader.reflection, 0);
+			skinning.descriptor_pool = create_reflected_descriptor_pool(shader.reflection, 0, MAX_FRAMES);
+
+			VkDescriptorSetLayout set_layouts[MAX_FRAMES];
+			for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+			{
+				set_layouts[i] = skinning.set_layout;
+			}
+
+			VkDescriptorSetAllocateInfo set_info
+			{
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+				.descriptorPool = skinning.descriptor_pool,
+				.descriptorSetCount = MAX_FRAMES,
+				.pSetLayouts = set_layouts
+			};
+
+			VK_CHECK(vkAllocateDescriptorSets(g_vulkan_core.device, &set_info, skinning.sets));
+
+			for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+			{
+				VkDescriptorBufferInfo buffer_infos[]
+				{
+					{ mesh_group.vertex_buffer.buffer, 0, VK_WHOLE_SIZE },
+					{ mesh_group.skin_buffer.buffer,   0, VK_WHOLE_SIZE },
+					{ skinning.joints[i].buffer,       0, VK_WHOLE_SIZE },
+					{ skinning.output[i].buffer,       0, VK_WHOLE_SIZE }
+				};
+
+				VkWriteDescriptorSet writes[ARRAY_SIZE(buffer_infos)];
+				for (uint32_t binding = 0; binding < ARRAY_SIZE(buffer_infos); ++binding)
+				{
+					writes[binding] =
+					{
+						.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+						.dstSet = skinning.sets[i],
+						.dstBinding = binding,
+						.descriptorCount = 1,
+						.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+						.pBufferInfo = &buffer_infos[binding]
+					};
+				}
+
+				vkUpdateDescriptorSets(g_vulkan_core.device, ARRAY_SIZE(writes), writes, 0, nullptr);
+			}
+		}
+
+		skinning.pipeline_layout = create_reflected_pipeline_layout(shader.reflection, &skinning.set_layout, 1);
+		skinning.pipeline        = create_compute_pipeline(shader, skinning.pipeline_layout, nullptr);
+
+		destroy_shader(shader);
+
+		watch_shader(SKINNING_SHADER_PATH, reload_skinning, nullptr);
+	}
+
+	void destroy_skinning()
+	{
+		unwatch_shaders(reload_skinning);
+
+		vkDestroyPipeline(g_vulkan_core.device, skinning.pipeline, nullptr);
+		vkDestroyPipelineLayout(g_vulkan_core.device, skinning.pipeline_layout, nullptr);
+		vkDestroyDescriptorPool(g_vulkan_core.device, skinning.descriptor_pool, nullptr);
+		vkDestroyDescriptorSetLayout(g_vulkan_core.device, skinning.set_layout, nullptr);
+
+		for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+		{
+			destroy_vulkan_buffer(skinning.output[i]);
+			destroy_vulkan_buffer(skinning.joints[i]);
+		}
+
+		free(skinning.palette);
+
+		skinning = {};
+	}
+
+	skinned_draw_t skin_mesh(mesh_t mesh, uint32_t joint_count)
+	{
+		const mesh_group_t& mesh_group = get_mesh_group();
+
+		assert(mesh < mesh_group.mesh_count && mesh_group.s_offset[mesh] != UINT32_MAX && "mesh has no skin");
+		assert(joint_count <= MAX_JOINTS && "too many joints");
+
+		// the first instance after a schedule starts the next frame
+		if (skinning.scheduled)
+		{
+			skinning.dispatch_count      = 0;
+			skinning.output_vertex_count = 0;
+			skinning.joint_count         = 0;
+			skinning.scheduled           = false;
+		}
+
+		const uint32_t vertex_count = mesh_group.v_count[mesh];
+
+		assert(skinning.dispatch_count < MAX_SKINNED_DRAWS && "too many skinned draws");
+		assert((skinning.output_vertex_count + vertex_count) * sizeof(vertex3d_t) <= SKINNING_OUTPUT_SIZE && "skinning output overflow");
+		assert(skinning.joint_count + joint_count <= MAX_SKINNING_JOINTS && "skinning palette overflow");
+
+		skinning.dispatches[skinning.dispatch_count++] =
+		{
+			.source_vertex = mesh_group.v_offset[mesh] / (uint32_t)sizeof(vertex3d_t),
+			.skin_vertex = mesh_group.s_offset[mesh] / (uint32_t)sizeof(skin_vertex_t),
+			.vertex_count = vertex_count,
+			.output_vertex = skinning.output_vertex_count,
+			.first_joint = skinning.joint_count
+		};
+
+		skinned_draw_t draw
+		{
+			.first_vertex = skinning.output_vertex_count,
+			.palette = skinning.palette + skinning.joint_count
+		};
+
+		skinning.output_vertex_count += vertex_count;
+		skinning.joint_count         += joint_count;
+
+		return draw;
+	}
+
+	static void record_skinning(VkCommandBuffer cmd, void*)
+	{
+		const uint32_t frame = g_vulkan_core.current_frame;
+
+		// the frame slot is free here, begin_frame waited for it
+		memcpy(skinning.joints[frame].info.pMappedData, skinning.palette, skinning.joint_count * sizeof(joint_matrix_t));
+		vmaFlushAllocation(g_vulkan_core.allocator, skinning.joints[frame].allocation, 0, skinning.joint_count * sizeof(joint_matrix_t));
+
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, skinning.pipeline);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, skinning.pipeline_layout, 0, 1, &skinning.sets[frame], 0, nullptr);
+
+		for (uint32_t i = 0; i < skinning.dispatch_count; ++i)
+		{
+			const skinning_dispatch_t& dispatch = skinning.dispatches[i];
+
+			vkCmdPushConstants(cmd, skinning.pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(dispatch), &dispatch);
+			vkCmdDispatch(cmd, (dispatch.vertex_count + 63) / 64, 1, 1);
+		}
+	}
+
+	void schedule_skinning()
+	{
+		skinning.scheduled = true;
+
+		if (!skinning.pipeline || skinning.dispatch_count == 0)
+			return;
+
+		schedule_compute(record_skinning, nullptr, VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT);
+	}
+
+	VkBuffer get_skinned_vertex_buffer()
+	{
+		return skinning.output[g_vulkan_core.current_frame].buffer;
+	}
+
+} // olivia
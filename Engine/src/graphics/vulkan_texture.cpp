@@ -0,0 +1,640 @@
+#include "olivia/graphics/vulkan_texture.h"
+
+namespace olivia
+{
+	static texture_streamer_t texture_streamer{};
+
+	static const uint8_t KTX2_IDENTIFIER[12]{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	struct ktx2_header_t
+	{
+		uint8_t  identifier[12];
+		uint32_t vk_format;
+		uint32_t type_size;
+		uint32_t pixel_width;
+		uint32_t pixel_height;
+		uint32_t pixel_depth;
+		uint32_t layer_count;
+		uint32_t face_count;
+		uint32_t level_count;
+		uint32_t supercompression_scheme;
+		uint32_t dfd_byte_offset;
+		uint32_t dfd_byte_length;
+		uint32_t kvd_byte_offset;
+		uint32_t kvd_byte_length;
+		uint64_t sgd_byte_offset;
+		uint64_t sgd_byte_length;
+	};
+
+	struct ktx2_level_t
+	{
+		uint64_t byte_offset;
+		uint64_t byte_length;
+		uint64_t uncompressed_byte_length;
+	};
+
+	static bool is_bc_format(VkFormat format)
+	{
+		return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+
+	// BC1 and BC4 store 4x4 texels in 8 bytes, the others in 16
+	static VkDeviceSize bc_block_size(VkFormat format)
+	{
+		if (format <= VK_FORMAT_BC1_RGBA_SRGB_BLOCK || format == VK_FORMAT_BC4_UNORM_BLOCK || format == VK_FORMAT_BC4_SNORM_BLOCK)
+			return 8;
+
+		return 16;
+	}
+
+	static VkExtent3D mip_extent(const texture_slot_t& texture, uint32_t mip)
+	{
+		return { SDL_max(texture.width >> mip, 1u), SDL_max(texture.height >> mip, 1u), 1 };
+	}
+
+	static VkDeviceSize mip_chain_size(const texture_slot_t& texture, uint32_t first_mip)
+	{
+		VkDeviceSize size{};
+
+		for (uint32_t mip = first_mip; mip < texture.mip_count; ++mip)
+		{
+			size += texture.mip_size[mip];
+		}
+
+		return size;
+	}
+
+	static VkDeviceSize staged_size(VkDeviceSize size)
+	{
+		return (size + 15) & ~15ull;
+	}
+
+	// what the textures keep once the retired images are released
+	static VkDeviceSize live_bytes()
+	{
+		VkDeviceSize retiring{};
+
+		for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+		{
+			retiring += texture_streamer.retiring_bytes[i];
+		}
+
+		return texture_streamer.resident_bytes - retiring;
+	}
+
+	static uint32_t target_mip(const texture_slot_t& texture)
+	{
+		if (texture_streamer.frame - texture.last_requested > TEXTURE_DEMAND_FRAMES)
+			return texture.mip_count - 1;
+
+		return texture.requested_mip;
+	}
+
+	static void retire_image(vulkan_image_t& image)
+	{
+		if (!image.image)
+			return;
+
+		// frames in flight may still sample the old image
+		defer_destroy_image(image.image, image.view, image.allocation);
+		image = {};
+	}
+
+	static void destroy_image(vulkan_image_t& image)
+	{
+		vkDestroyImageView(g_vulkan_core.device, image.view, nullptr);
+		untrack_allocation(image.allocation);
+		vmaDestroyImage(g_vulkan_core.allocator, image.image, image.allocation);
+		image = {};
+	}
+
+	static bool create_texture_image(const texture_slot_t& texture, uint32_t first_mip, bool within_budget, vulkan_image_t& image)
+	{
+		VkImageCreateInfo image_info
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = texture.format,
+			.extent = mip_extent(texture, first_mip),
+			.mipLevels = texture.mip_count - first_mip,
+			.arrayLayers = 1,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+		};
+
+		VmaAllocationCreateInfo allocation_info
+		{
+			.flags = within_budget ? VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT : 0u,
+			.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+		};
+
+		// running out of memory here is expected under pressure, the caller keeps the old residency
+		if (vmaCreateImage(g_vulkan_core.allocator, &image_info, &allocation_info, &image.image, &image.allocation, nullptr) != VK_SUCCESS)
+		{
+			report_allocation_failure(MEMORY_CATEGORY_TEXTURE, mip_chain_size(texture, first_mip));
+			image = {};
+			return false;
+		}
+
+		track_allocation(image.allocation, MEMORY_CATEGORY_TEXTURE);
+
+		VkImageViewCreateInfo view_info
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = image.image,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = texture.format,
+			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, image_info.mipLevels, 0, 1 }
+		};
+
+		VK_CHECK(vkCreateImageView(g_vulkan_core.device, &view_info, nullptr, &image.view));
+
+		return true;
+	}
+
+	// moves a texture to a new most detailed mip: resident levels are copied
+	// GPU side, missing ones come from staging, dropped ones are released
+	static bool set_texture_residency(texture_slot_t& texture, uint32_t new_mip, VkCommandBuffer cmd, VkDeviceSize& staging_offset, VkDeviceSize staging_end)
+	{
+		const uint32_t old_mip = texture.resident_mip;
+
+		VkDeviceSize upload_size{};
+		for (uint32_t mip = new_mip; mip < SDL_min(old_mip, texture.mip_count); ++mip)
+		{
+			upload_size += staged_size(texture.mip_size[mip]);
+		}
+
+		if (staging_offset + upload_size > staging_end)
+			return false;
+
+		// a smaller image replacing the old one may go over the budget until the old one is
+		// released, refusing it would keep eviction from making progress under pressure
+		const bool shrinking = texture.image.image && new_mip > old_mip;
+
+		vulkan_image_t image{};
+		if (!create_texture_image(texture, new_mip, !shrinking, image))
+			return false;
+
+		VkImageMemoryBarrier2 barriers[2]
+		{
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+				.srcAccessMask = VK_ACCESS_2_NONE,
+				.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+				.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+				.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = image.image,
+				.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1 }
+			},
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				.srcAccessMask = VK_ACCESS_2_NONE,
+				.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+				.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+				.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = texture.image.image,
+				.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1 }
+			}
+		};
+
+		VkDependencyInfo dependency
+		{
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.imageMemoryBarrierCount = texture.image.image ? 2u : 1u,
+			.pImageMemoryBarriers = barriers
+		};
+
+		vkCmdPipelineBarrier2(cmd, &dependency);
+
+		// levels both images share
+		for (uint32_t mip = SDL_max(new_mip, old_mip); mip < texture.mip_count && texture.image.image; ++mip)
+		{
+			VkImageCopy region
+			{
+				.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - old_mip, 0, 1 },
+				.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - new_mip, 0, 1 },
+				.extent = mip_extent(texture, mip)
+			};
+
+			vkCmdCopyImage(cmd, texture.image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		}
+
+		// levels streamed in from the file
+		for (uint32_t mip = new_mip; mip < SDL_min(old_mip, texture.mip_count); ++mip)
+		{
+			memcpy((uint8_t*)texture_streamer.staging.info.pMappedData + staging_offset, (const uint8_t*)texture.file.data + texture.mip_offset[mip], texture.mip_size[mip]);
+
+			VkBufferImageCopy region
+			{
+				.bufferOffset = staging_offset,
+				.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - new_mip, 0, 1 },
+				.imageExtent = mip_extent(texture, mip)
+			};
+
+			vkCmdCopyBufferToImage(cmd, texture_streamer.staging.buffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+			staging_offset += staged_size(texture.mip_size[mip]);
+		}
+
+		VkImageMemoryBarrier2 ready
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+			.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+			.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = image.image,
+			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1 }
+		};
+
+		dependency.imageMemoryBarrierCount = 1;
+		dependency.pImageMemoryBarriers    = &ready;
+
+		vkCmdPipelineBarrier2(cmd, &dependency);
+
+		// the old image stays counted until the frame slot comes around and it is released
+		if (texture.image.image)
+			texture_streamer.retiring_bytes[g_vulkan_core.current_frame] += texture.resident_bytes;
+
+		retire_image(texture.image);
+
+		VmaAllocationInfo allocation_info;
+		vmaGetAllocationInfo(g_vulkan_core.allocator, image.allocation, &allocation_info);
+
+		texture_streamer.resident_bytes += allocation_info.size;
+
+		texture.image          = image;
+		texture.resident_mip   = new_mip;
+		texture.resident_bytes = allocation_info.size;
+
+		return true;
+	}
+
+	// drops resident mips of the texture that needs them least, as many as it takes to free
+	// bytes in one new image: detail nobody asked for goes first, then least recently requested.
+	// a texture shrinks once per frame
+	static bool evict_texture_mips(texture_t exclude, VkDeviceSize bytes, bool* evicted, VkCommandBuffer cmd, VkDeviceSize& staging_offset, VkDeviceSize staging_end)
+	{
+		texture_t victim{ INVALID_TEXTURE };
+		bool      victim_unwanted{};
+		uint64_t  victim_last_requested{ UINT64_MAX };
+
+		for (texture_t i = 0; i < texture_streamer.texture_count; ++i)
+		{
+			const texture_slot_t& texture = texture_streamer.textures[i];
+
+			if (i == exclude || evicted[i] || texture.resident_mip + 1 >= texture.mip_count)
+				continue;
+
+			bool unwanted = texture.resident_mip < target_mip(texture);
+
+			if ((unwanted && !victim_unwanted) || (unwanted == victim_unwanted && texture.last_requested < victim_last_requested))
+			{
+				victim                = i;
+				victim_unwanted       = unwanted;
+				victim_last_requested = texture.last_requested;
+			}
+		}
+
+		if (victim == INVALID_TEXTURE)
+			return false;
+
+		texture_slot_t&    texture  = texture_streamer.textures[victim];
+		const VkDeviceSize resident = mip_chain_size(texture, texture.resident_mip);
+		uint32_t           new_mip  = texture.resident_mip + 1;
+
+		while (new_mip + 1 < texture.mip_count && resident - mip_chain_size(texture, new_mip) < bytes)
+		{
+			++new_mip;
+		}
+
+		evicted[victim] = true;
+
+		return set_texture_residency(texture, new_mip, cmd, staging_offset, staging_end);
+	}
+
+	// the mips go in the next update_textures, it has the command buffer the copies are recorded into
+	static VkDeviceSize evict_textures(VkDeviceSize bytes, void*)
+	{
+		// retiring images are already on their way out
+		VkDeviceSize live      = live_bytes();
+		VkDeviceSize evictable = live - SDL_min(texture_streamer.pressure, live);
+		VkDeviceSize promised  = SDL_min(bytes, evictable);
+
+		texture_streamer.pressure += promised;
+
+		return promised;
+	}
+
+	void init_texture_streamer(VkDeviceSize budget)
+	{
+		texture_streamer.staging = create_vulkan_buffer(
+			MEMORY_CATEGORY_STAGING,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VMA_MEMORY_USAGE_AUTO,
+			VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+			TEXTURE_STAGING_SIZE);
+
+		VkSamplerCreateInfo sampler_info
+		{
+			.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+			.magFilter = VK_FILTER_LINEAR,
+			.minFilter = VK_FILTER_LINEAR,
+			.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+			.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			.maxLod = VK_LOD_CLAMP_NONE
+		};
+
+		VK_CHECK(vkCreateSampler(g_vulkan_core.device, &sampler_info, nullptr, &texture_streamer.sampler));
+
+		texture_streamer.heap_index = get_memory_heap_index();
+
+		if (budget == 0)
+		{
+			budget = get_memory_budget().budget / 10 * 8;
+		}
+
+		texture_streamer.budget = budget;
+
+		register_memory_evictor(MEMORY_CATEGORY_TEXTURE, evict_textures, nullptr);
+
+		LOG_INFO(TAG_RENDERER, "texture budget %llu MB on heap %u", (unsigned long long)(budget / MEGABYTES(1)), texture_streamer.heap_index);
+	}
+
+	void destroy_texture_streamer()
+	{
+		for (texture_t i = 0; i < texture_streamer.texture_count; ++i)
+		{
+			texture_slot_t& texture = texture_streamer.textures[i];
+
+			if (texture.image.image)
+				destroy_image(texture.image);
+
+			unmap_file(texture.file);
+		}
+
+		vkDestroySampler(g_vulkan_core.device, texture_streamer.sampler, nullptr);
+		destroy_vulkan_buffer(texture_streamer.staging);
+
+		texture_streamer = {};
+	}
+
+	texture_t load_texture(const char* path)
+	{
+		assert(texture_streamer.texture_count < MAX_TEXTURES && "too many textures");
+
+		texture_slot_t texture{};
+
+		if (!map_file(path, texture.file))
+		{
+			LOG_ERROR(TAG_RENDERER, "failed to open texture %s", path);
+			return INVALID_TEXTURE;
+		}
+
+		const ktx2_header_t* header = (const ktx2_header_t*)texture.file.data;
+
+		bool valid = texture.file.size >= sizeof(ktx2_header_t) &&
+			memcmp(header->identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0 &&
+			texture.file.size >= sizeof(ktx2_header_t) + sizeof(ktx2_level_t) * header->level_count;
+
+		if (!valid)
+		{
+			LOG_ERROR(TAG_RENDERER, "%s is not a KTX2 file", path);
+			unmap_file(texture.file);
+			return INVALID_TEXTURE;
+		}
+
+		valid = is_bc_format((VkFormat)header->vk_format) &&
+			header->supercompression_scheme == 0 &&
+			header->pixel_depth <= 1 &&
+			header->layer_count <= 1 &&
+			header->face_count == 1 &&
+			header->level_count >= 1 &&
+			header->level_count <= MAX_TEXTURE_MIPS &&
+			g_vulkan_core.texture_compression_bc;
+
+		if (!valid)
+		{
+			LOG_ERROR(TAG_RENDERER, "%s: only single 2D BC textures without supercompression are supported", path);
+			unmap_file(texture.file);
+			return INVALID_TEXTURE;
+		}
+
+		uint32_t max_levels = 1;
+		while ((SDL_max(header->pixel_width, header->pixel_height) >> max_levels) != 0)
+		{
+			++max_levels;
+		}
+
+		if (header->pixel_width == 0 || header->pixel_height == 0 || header->level_count > max_levels)
+		{
+			LOG_ERROR(TAG_RENDERER, "%s: invalid size %ux%u with %u levels", path, header->pixel_width, header->pixel_height, header->level_count);
+			unmap_file(texture.file);
+			return INVALID_TEXTURE;
+		}
+
+		texture.format    = (VkFormat)header->vk_format;
+		texture.width     = header->pixel_width;
+		texture.height    = header->pixel_height;
+		texture.mip_count = header->level_count;
+
+		const ktx2_level_t* levels = (const ktx2_level_t*)(header + 1);
+
+		// a level is uploaded in one go, from a frame's slice of the staging buffer
+		const VkDeviceSize staging_slice = TEXTURE_STAGING_SIZE / MAX_FRAMES;
+
+		for (uint32_t mip = 0; mip < texture.mip_count; ++mip)
+		{
+			const VkExtent3D   extent   = mip_extent(texture, mip);
+			const VkDeviceSize expected = (VkDeviceSize)((extent.width + 3) / 4) * ((extent.height + 3) / 4) * bc_block_size(texture.format);
+
+			if (levels[mip].byte_length > texture.file.size || levels[mip].byte_offset > texture.file.size - levels[mip].byte_length)
+			{
+				LOG_ERROR(TAG_RENDERER, "%s: mip %u is out of bounds", path, mip);
+				unmap_file(texture.file);
+				return INVALID_TEXTURE;
+			}
+
+			if (levels[mip].byte_length != expected)
+			{
+				LOG_ERROR(TAG_RENDERER, "%s: mip %u is %llu bytes, %ux%u takes %llu", path, mip,
+					(unsigned long long)levels[mip].byte_length, extent.width, extent.height, (unsigned long long)expected);
+				unmap_file(texture.file);
+				return INVALID_TEXTURE;
+			}
+
+			if (staged_size(expected) > staging_slice)
+			{
+				LOG_ERROR(TAG_RENDERER, "%s: mip %u is %llu MB, larger than the %llu MB staging slice it streams through", path, mip,
+					(unsigned long long)(expected / MEGABYTES(1)), (unsigned long long)(staging_slice / MEGABYTES(1)));
+				unmap_file(texture.file);
+				return INVALID_TEXTURE;
+			}
+
+			texture.mip_offset[mip] = levels[mip].byte_offset;
+			texture.mip_size[mip]   = levels[mip].byte_length;
+		}
+
+		texture.resident_mip   = texture.mip_count;
+		texture.requested_mip  = texture.mip_count - 1;
+		texture.last_requested = texture_streamer.frame;
+
+		texture_t handle = texture_streamer.texture_count++;
+		texture_streamer.textures[handle] = texture;
+
+		return handle;
+	}
+
+	void request_texture(texture_t texture, float screen_size)
+	{
+		assert(texture < texture_streamer.texture_count);
+
+		texture_slot_t& slot = texture_streamer.textures[texture];
+
+		// one texel per pixel: every halving of the screen size drops a mip
+		float    texels = (float)SDL_max(slot.width, slot.height);
+		uint32_t mip    = 0;
+
+		while (mip + 1 < slot.mip_count && texels > screen_size * 2.0f)
+		{
+			texels *= 0.5f;
+			++mip;
+		}
+
+		// several requests in a frame keep the most detailed one
+		if (slot.last_requested != texture_streamer.frame || mip < slot.requested_mip)
+			slot.requested_mip = mip;
+
+		slot.last_requested = texture_streamer.frame;
+	}
+
+	void update_textures(VkCommandBuffer cmd)
+	{
+		texture_streamer.frame++;
+
+		// begin_frame released what this frame slot retired when it was last used
+		const uint32_t slot = g_vulkan_core.current_frame;
+
+		texture_streamer.resident_bytes      -= texture_streamer.retiring_bytes[slot];
+		texture_streamer.retiring_bytes[slot] = 0;
+
+		// the effective limit also accounts for what everything else on the heap is using,
+		// begin_frame refreshed the budget right before
+		const VmaBudget& heap = get_memory_budget();
+
+		VkDeviceSize heap_limit  = (VkDeviceSize)((double)heap.budget * MEMORY_PRESSURE_LOW);
+		VkDeviceSize other_usage = heap.usage > texture_streamer.resident_bytes ? heap.usage - texture_streamer.resident_bytes : 0;
+		VkDeviceSize heap_room   = heap_limit > other_usage ? heap_limit - other_usage : 0;
+		VkDeviceSize limit       = SDL_min(texture_streamer.budget, heap_room);
+
+		if (texture_streamer.pressure)
+		{
+			VkDeviceSize live = live_bytes();
+
+			limit = SDL_min(limit, live - SDL_min(texture_streamer.pressure, live));
+			texture_streamer.pressure = 0;
+		}
+
+		// each frame slot owns its own slice of the staging buffer, free once begin_frame waited for the slot
+		const VkDeviceSize staging_slice = TEXTURE_STAGING_SIZE / MAX_FRAMES;
+		VkDeviceSize staging_offset      = staging_slice * g_vulkan_core.current_frame;
+		const VkDeviceSize staging_end   = staging_offset + staging_slice;
+
+		// the rest of the excess goes in the next frames
+		bool     evicted[MAX_TEXTURES]{};
+		uint32_t evictions{};
+
+		while (live_bytes() > limit && evictions < TEXTURE_EVICTIONS_PER_FRAME)
+		{
+			if (!evict_texture_mips(INVALID_TEXTURE, live_bytes() - limit, evicted, cmd, staging_offset, staging_end))
+				break;
+
+			++evictions;
+		}
+
+		// one mip finer per texture per frame, largest deficit first
+		bool streamed[MAX_TEXTURES]{};
+
+		for (;;)
+		{
+			texture_t best{ INVALID_TEXTURE };
+			uint32_t  best_deficit{};
+
+			for (texture_t i = 0; i < texture_streamer.texture_count; ++i)
+			{
+				const texture_slot_t& texture = texture_streamer.textures[i];
+				uint32_t target = target_mip(texture);
+
+				if (streamed[i] || texture.resident_mip <= target)
+					continue;
+
+				uint32_t deficit = texture.resident_mip - target;
+				if (deficit > best_deficit)
+				{
+					best         = i;
+					best_deficit = deficit;
+				}
+			}
+
+			if (best == INVALID_TEXTURE)
+				break;
+
+			streamed[best] = true;
+
+			texture_slot_t& texture = texture_streamer.textures[best];
+			uint32_t        new_mip = texture.resident_mip - 1;
+
+			VkDeviceSize cost = mip_chain_size(texture, new_mip) - mip_chain_size(texture, SDL_min(texture.resident_mip, texture.mip_count));
+
+			while (live_bytes() + cost > limit && evictions < TEXTURE_EVICTIONS_PER_FRAME)
+			{
+				if (!evict_texture_mips(best, live_bytes() + cost - limit, evicted, cmd, staging_offset, staging_end))
+					break;
+
+				++evictions;
+			}
+
+			// evicted memory is only free once it is released, the texture streams in a later frame
+			if (texture_streamer.resident_bytes + cost > limit)
+				continue;
+
+			if (!set_texture_residency(texture, new_mip, cmd, staging_offset, staging_end))
+				break;
+		}
+	}
+
+	VkImageView get_texture_view(texture_t texture)
+	{
+		assert(texture < texture_streamer.texture_count);
+
+		return texture_streamer.textures[texture].image.view;
+	}
+
+	VkSampler get_texture_sampler()
+	{
+		return texture_streamer.sampler;
+	}
+
+	VkDeviceSize get_texture_resident_bytes()
+	{
+		return texture_streamer.resident_bytes;
+	}
+
+} // olivia
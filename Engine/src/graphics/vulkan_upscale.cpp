@@ -0,0 +1,271 @@
+#include "olivia/graphics/vulkan_upscale.h"
+
+namespace olivia
+{
+	static upscaler_t upscaler{};
+
+	static bool load_upscale_shaders(shader_t* shaders)
+	{
+		if (!load_shader(UPSCALE_VERTEX_SHADER_PATH, shaders[0]))
+			return false;
+
+		if (!load_shader(UPSCALE_FRAGMENT_SHADER_PATH, shaders[1]))
+		{
+			destroy_shader(shaders[0]);
+			return false;
+		}
+
+		return true;
+	}
+
+	static VkPipeline create_upscale_pipeline(const shader_t* shaders)
+	{
+		VkPipelineShaderStageCreateInfo stages[]
+		{
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_VERTEX_BIT,
+				.module = shaders[0].module,
+				.pName = "main"
+			},
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+				.module = shaders[1].module,
+				.pName = "main"
+			}
+		};
+
+		// one fullscreen triangle from gl_VertexIndex
+		VkPipelineVertexInputStateCreateInfo vertex_input
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO
+		};
+
+		VkPipelineInputAssemblyStateCreateInfo input_assembly
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+			.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+		};
+
+		VkPipelineViewportStateCreateInfo viewport
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+			.viewportCount = 1,
+			.scissorCount = 1
+		};
+
+		VkPipelineRasterizationStateCreateInfo rasterization
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+			.polygonMode = VK_POLYGON_MODE_FILL,
+			.cullMode = VK_CULL_MODE_NONE,
+			.lineWidth = 1.0f
+		};
+
+		VkPipelineMultisampleStateCreateInfo multisample
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+		};
+
+		VkPipelineColorBlendAttachmentState blend_attachment
+		{
+			.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+		};
+
+		VkPipelineColorBlendStateCreateInfo blend
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+			.attachmentCount = 1,
+			.pAttachments = &blend_attachment
+		};
+
+		VkDynamicState dynamic_states[]
+		{
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR
+		};
+
+		VkPipelineDynamicStateCreateInfo dynamic
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.dynamicStateCount = ARRAY_SIZE(dynamic_states),
+			.pDynamicStates = dynamic_states
+		};
+
+		// the upscale pass has no depth attachment
+		VkPipelineRenderingCreateInfo rendering
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+			.colorAttachmentCount = 1,
+			.pColorAttachmentFormats = &g_vulkan_core.swapchain_format.format
+		};
+
+		VkGraphicsPipelineCreateInfo pipeline_info
+		{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = &rendering,
+			.stageCount = ARRAY_SIZE(stages),
+			.pStages = stages,
+			.pVertexInputState = &vertex_input,
+			.pInputAssemblyState = &input_assembly,
+			.pViewportState = &viewport,
+			.pRasterizationState = &rasterization,
+			.pMultisampleState = &multisample,
+			.pColorBlendState = &blend,
+			.pDynamicState = &dynamic,
+			.layout = upscaler.pipeline_layout
+		};
+
+		VkPipeline pipeline{};
+		VK_CHECK(vkCreateGraphicsPipelines(g_vulkan_core.device, g_vulkan_core.pipeline_cache, 1, &pipeline_info, nullptr, &pipeline));
+
+		return pipeline;
+	}
+
+	static void reload_upscaler(void*)
+	{
+		shader_t shaders[2];
+		if (!load_upscale_shaders(shaders))
+			return;
+
+		if (is_layout_compatible(upscaler.reflection, shaders[0].reflection) && is_layout_compatible(upscaler.reflection, shaders[1].reflection))
+		{
+			vkDestroyPipeline(g_vulkan_core.device, upscaler.pipeline, nullptr);
+			upscaler.pipeline = create_upscale_pipeline(shaders);
+		}
+		else
+		{
+			LOG_ERROR(TAG_RENDERER, "upscale shaders changed their bindings, restart to pick them up");
+		}
+
+		destroy_shader(shaders[0]);
+		destroy_shader(shaders[1]);
+	}
+
+	void init_upscaler()
+	{
+		upscaler.filter    = UPSCALE_FILTER_SHARPEN;
+		upscaler.sharpness = DEFAULT_UPSCALE_SHARPNESS;
+
+		// without the shaders dynamic resolution cannot be enabled
+		shader_t shaders[2];
+		if (!load_upscale_shaders(shaders))
+			return;
+
+		merge_shader_reflection(upscaler.reflection, shaders[0].reflection);
+		merge_shader_reflection(upscaler.reflection, shaders[1].reflection);
+
+		assert(upscaler.reflection.push_constant_size == sizeof(upscale_push_t) && "upscale.frag disagrees with upscale_push_t");
+
+		// the rendered corner is sampled with clamped coordinates, edge texels never blend with the unused part
+		VkSamplerCreateInfo sampler_info
+		{
+			.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+			.magFilter = VK_FILTER_LINEAR,
+			.minFilter = VK_FILTER_LINEAR,
+			.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+			.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+			.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+			.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+		};
+
+		VK_CHECK(vkCreateSampler(g_vulkan_core.device, &sampler_info, nullptr, &upscaler.sampler));
+
+		// create descriptor sets, written every frame since the source is a frame graph transient
+		{
+			upscaler.set_layout      = create_reflected_set_layout(upscaler.reflection, 0);
+			upscaler.descriptor_pool = create_reflected_descriptor_pool(upscaler.reflection, 0, MAX_FRAMES);
+
+			VkDescriptorSetLayout set_layouts[MAX_FRAMES];
+			for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+			{
+				set_layouts[i] = upscaler.set_layout;
+			}
+
+			VkDescriptorSetAllocateInfo set_info
+			{
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+				.descriptorPool = upscaler.descriptor_pool,
+				.descriptorSetCount = MAX_FRAMES,
+				.pSetLayouts = set_layouts
+			};
+
+			VK_CHECK(vkAllocateDescriptorSets(g_vulkan_core.device, &set_info, upscaler.sets));
+		}
+
+		upscaler.pipeline_layout = create_reflected_pipeline_layout(upscaler.reflection, &upscaler.set_layout, 1);
+		upscaler.pipeline        = create_upscale_pipeline(shaders);
+
+		destroy_shader(shaders[0]);
+		destroy_shader(shaders[1]);
+
+		watch_shader(UPSCALE_VERTEX_SHADER_PATH, reload_upscaler, nullptr);
+		watch_shader(UPSCALE_FRAGMENT_SHADER_PATH, reload_upscaler, nullptr);
+	}
+
+	void destroy_upscaler()
+	{
+		unwatch_shaders(reload_upscaler);
+
+		vkDestroyPipeline(g_vulkan_core.device, upscaler.pipeline, nullptr);
+		vkDestroyPipelineLayout(g_vulkan_core.device, upscaler.pipeline_layout, nullptr);
+		vkDestroyDescriptorPool(g_vulkan_core.device, upscaler.descriptor_pool, nullptr);
+		vkDestroyDescriptorSetLayout(g_vulkan_core.device, upscaler.set_layout, nullptr);
+		vkDestroySampler(g_vulkan_core.device, upscaler.sampler, nullptr);
+
+		upscaler = {};
+	}
+
+	bool is_upscaler_ready()
+	{
+		return upscaler.pipeline != VK_NULL_HANDLE;
+	}
+
+	void set_upscale_filter(upscale_filter_t filter, float sharpness)
+	{
+		upscaler.filter    = filter;
+		upscaler.sharpness = SDL_clamp(sharpness, 0.0f, 1.0f);
+	}
+
+	void draw_upscale(VkCommandBuffer cmd, VkImageView source, VkExtent2D source_extent)
+	{
+		const VkExtent2D target = g_vulkan_core.swapchain_extent;
+		const uint32_t   frame  = g_vulkan_core.current_frame;
+
+		// the frame slot is free here, begin_frame waited for it
+		VkDescriptorImageInfo image_info
+		{
+			.sampler = upscaler.sampler,
+			.imageView = source,
+			.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		};
+
+		VkWriteDescriptorSet write
+		{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = upscaler.sets[frame],
+			.dstBinding = 0,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+			.pImageInfo = &image_info
+		};
+
+		vkUpdateDescriptorSets(g_vulkan_core.device, 1, &write, 0, nullptr);
+
+		upscale_push_t push
+		{
+			.uv_scale = { (float)source_extent.width / (float)target.width, (float)source_extent.height / (float)target.height },
+			.uv_max = { ((float)source_extent.width - 0.5f) / (float)target.width, ((float)source_extent.height - 0.5f) / (float)target.height },
+			.texel_size = { 1.0f / (float)target.width, 1.0f / (float)target.height },
+			.sharpness = upscaler.filter == UPSCALE_FILTER_SHARPEN ? upscaler.sharpness : 0.0f
+		};
+
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, upscaler.pipeline);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, upscaler.pipeline_layout, 0, 1, &upscaler.sets[frame], 0, nullptr);
+		vkCmdPushConstants(cmd, upscaler.pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(push), &push);
+		vkCmdDraw(cmd, 3, 1, 0, 0);
+	}
+
+} // olivia
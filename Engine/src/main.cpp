@@ -0,0 +1,21 @@
+#include "olivia/olivia.h"
+
+int main(int argc, char* argv[])
+{
+	olivia::run_options_t options{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool value = i + 1 < argc;
+
+		if      (SDL_strcmp(argv[i], "--record") == 0 && value)       options.record_path       = argv[++i];
+		else if (SDL_strcmp(argv[i], "--replay") == 0 && value)       options.replay_path       = argv[++i];
+		else if (SDL_strcmp(argv[i], "--timings") == 0 && value)      options.timings_path      = argv[++i];
+		else if (SDL_strcmp(argv[i], "--memory-trace") == 0 && value) options.memory_trace_path = argv[++i];
+		else if (SDL_strcmp(argv[i], "--huge-pages") == 0)            options.huge_pages        = true;
+	}
+
+	olivia::run("000_setup.dll", options);
+
+	return 0;
+}
\ No newline at end of file
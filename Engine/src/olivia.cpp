@@ -4,7 +4,7 @@ namespace olivia
 {
 	static context_t ctx{};
 
-	void game_load(const char* game, size_t game_storage_size)
+	bool game_open(const char* game, size_t game_storage_size, bool huge_pages)
 	{
 		ctx.olivia_game_path = game;
 
@@ -14,29 +14,56 @@ namespace olivia
 
 			if (ctx.olivia_game)
 			{
-				olivia_load load = (olivia_load)SDL_LoadFunction(ctx.olivia_game, "olivia_load");
-				assert(load && "failed to get olivia_load function address");
+				ctx.olivia_load = (olivia_load)SDL_LoadFunction(ctx.olivia_game, "olivia_load");
+				assert(ctx.olivia_load && "failed to get olivia_load function address");
 
-				ctx.olivia_storage = calloc(1, game_storage_size);
-
-				if (ctx.olivia_storage)
-				{
-					load(ctx.olivia_storage);
+				ctx.olivia_update = (olivia_update)SDL_LoadFunction(ctx.olivia_game, "olivia_update");
+				assert(ctx.olivia_update && "failed to get olivia_update function address");
 
-					ctx.olivia_update = (olivia_update)SDL_LoadFunction(ctx.olivia_game, "olivia_update");
-					assert(ctx.olivia_update && "failed to get olivia_update function address");
+				ctx.olivia_draw = (olivia_draw)SDL_LoadFunction(ctx.olivia_game, "olivia_draw");
+				assert(ctx.olivia_draw && "failed to get olivia_draw function address");
 
-					ctx.olivia_draw = (olivia_draw)SDL_LoadFunction(ctx.olivia_game, "olivia_draw");
-					assert(ctx.olivia_draw && "failed to get olivia_draw function address");
+				ctx.olivia_storage = create_game_storage(game_storage_size, huge_pages);
 
-					ctx.running = true;
-				}
+				return ctx.olivia_storage != nullptr;
 			}
 		}
+
+		return false;
+	}
+
+	void game_load(const char* game, size_t game_storage_size, bool huge_pages)
+	{
+		if (game_open(game, game_storage_size, huge_pages))
+		{
+			ctx.olivia_load(ctx.olivia_storage);
+			ctx.running = true;
+		}
+	}
+
+	struct game_open_job_t
+	{
+		const char* game;
+		bool        huge_pages;
+		bool        opened;
+	};
+
+	static void open_game(void* data)
+	{
+		game_open_job_t* job = (game_open_job_t*)data;
+
+		uint32_t span = begin_startup_span("game dll + storage");
+
+		job->opened = game_open(job->game, OLIVIA_STORAGE_SIZE, job->huge_pages);
+
+		end_startup_span(span);
 	}
 
 	void reload()
 	{
+		// rollback point in case the new code corrupts the storage
+		snapshot_game_storage();
+
 		SDL_UnloadObject(ctx.olivia_game);
 
 		if (SDL_CopyFile(ctx.olivia_game_path, OLIVIA_GAME))
@@ -45,10 +72,10 @@ namespace olivia
 
 			if (ctx.olivia_game)
 			{
-				olivia_load load = (olivia_load)SDL_LoadFunction(ctx.olivia_game, "olivia_load");
-				assert(load && "failed to get olivia_load function address");
+				ctx.olivia_load = (olivia_load)SDL_LoadFunction(ctx.olivia_game, "olivia_load");
+				assert(ctx.olivia_load && "failed to get olivia_load function address");
 
-				load(ctx.olivia_storage);
+				ctx.olivia_load(ctx.olivia_storage);
 
 				ctx.olivia_update = (olivia_update)SDL_LoadFunction(ctx.olivia_game, "olivia_update");
 				assert(ctx.olivia_update && "failed to get olivia_update function address");
@@ -63,54 +90,198 @@ namespace olivia
 		ctx.running = false;
 	}
 
-	void run(const char* game)
+	static void write_frame_timing(SDL_IOStream* file, uint64_t frame, float dt, float cpu_ms)
+	{
+		char line[256];
+		int length = snprintf(line, sizeof(line), "%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+			(unsigned long long)frame,
+			dt * 1000.0f,
+			cpu_ms,
+			get_gpu_wait_time(),
+			get_acquire_wait_time(),
+			is_depth_prepass_enabled() ? get_gpu_pass_time(RENDER_PASS_DEPTH_PREPASS) : 0.0f,
+			get_gpu_pass_time(RENDER_PASS_MAIN));
+
+		SDL_WriteIO(file, line, (size_t)length);
+	}
+
+	void run(const char* game, const run_options_t& options)
 	{
-		SDL_Window* window = SDL_CreateWindow("Olivia", 640, 480, SDL_WINDOW_VULKAN);
+		const bool replaying = options.replay_path != nullptr;
+
+		begin_startup_trace();
+
+		uint32_t span = begin_startup_span("job system");
+		init_job_system(0);
+		end_startup_span(span);
+
+		// copying and loading the game dll and reserving its storage do not need the
+		// renderer, they overlap window and vulkan creation
+		game_open_job_t game_job{ game, options.huge_pages, false };
+		job_counter_t   game_opened{};
+
+		job_t job{ open_game, &game_job };
+		run_jobs(&job, 1, &game_opened);
+
+		span = begin_startup_span("window");
+		SDL_Window* window = SDL_CreateWindow("Olivia", 640, 480, SDL_WINDOW_VULKAN | (replaying ? SDL_WINDOW_HIDDEN : 0));
+		end_startup_span(span);
+
 		if (!window)
 		{
 			LOG_ERROR(TAG_OLIVIA, "failed to create window");
+			wait_for_counter(&game_opened);
+			destroy_game_storage();
+			destroy_job_system();
 			return;
 		}
 
+		span = begin_startup_span("input");
+		init_input();
+		end_startup_span(span);
+
 		init_renderer(window);
 
-		game_load(game, MEGABYTES(200));
+		wait_for_counter(&game_opened);
+
+		// olivia_load may upload meshes and textures, so it runs once the renderer exists
+		if (game_job.opened)
+		{
+			span = begin_startup_span("game load");
+			ctx.olivia_load(ctx.olivia_storage);
+			ctx.running = true;
+			end_startup_span(span);
+		}
+
+		replay_recorder_t recorder{};
+		replay_t          replay{};
+		SDL_IOStream*     timings{};
+
+		if (ctx.running && replaying)
+		{
+			// replays run as fast as the gpu allows
+			set_vsync(false);
+
+			ctx.running = open_replay(options.replay_path, replay) &&
+				restore_replay_storage(replay, ctx.olivia_storage, OLIVIA_STORAGE_SIZE);
+		}
+		else if (ctx.running && options.record_path)
+		{
+			begin_replay_recording(recorder, options.record_path, ctx.olivia_storage, OLIVIA_STORAGE_SIZE);
+		}
+
+		if (options.timings_path)
+		{
+			timings = SDL_IOFromFile(options.timings_path, "w");
+			if (timings)
+			{
+				const char columns[] = "frame,dt_ms,cpu_ms,gpu_wait_ms,acquire_wait_ms,gpu_depth_prepass_ms,gpu_main_ms\n";
+				SDL_WriteIO(timings, columns, sizeof(columns) - 1);
+			}
+		}
+
+		span = begin_startup_span("first frame");
+
+		uint64_t frame_count{};
+		uint64_t last_frame = SDL_GetTicksNS();
+		uint64_t start      = last_frame;
+		double   total_cpu_ms{};
+		float    max_cpu_ms{};
 		
 		while (ctx.running)
 		{
-			update_input_state();
-
+			// input events are queued by the event watch while SDL pumps them
 			SDL_Event event;
 			while (SDL_PollEvent(&event))
 			{
 				if (event.type == SDL_EVENT_QUIT)
 					ctx.running = false;
-				if (event.type == SDL_EVENT_KEY_DOWN)
-					g_input_state.curr_keys[event.key.scancode] = true;
-				if (event.type == SDL_EVENT_KEY_UP)
-					g_input_state.curr_keys[event.key.scancode] = false;
 			}
 
+			uint64_t frame_start = SDL_GetTicksNS();
+			float    dt{};
+
+			if (replaying)
+			{
+				if (!next_replay_frame(replay, dt))
+					break;
+			}
+			else
+			{
+				update_input_state();
+
+				dt = SDL_min((float)((frame_start - last_frame) * 1e-9), OLIVIA_MAX_DT);
+				record_replay_frame(recorder, dt);
+			}
+
+			last_frame = frame_start;
+
 			if (is_key_pressed(SDL_SCANCODE_F5)) reload();
+			if (is_key_pressed(SDL_SCANCODE_F6)) set_depth_prepass(!is_depth_prepass_enabled());
+			if (is_key_pressed(SDL_SCANCODE_F7)) snapshot_game_storage();
+			if (is_key_pressed(SDL_SCANCODE_F8)) restore_game_storage(get_latest_storage_snapshot());
+			if (is_key_pressed(SDL_SCANCODE_F9)) set_dynamic_resolution(!is_dynamic_resolution_enabled());
 
-			ctx.olivia_update(0.016f);
+			ctx.olivia_update(dt);
 
-			begin_frame();
+			if (!begin_frame())
+				continue;
 
-			ctx.olivia_draw();
-			
+			draw_frame(ctx.olivia_draw);
 			end_frame();
+
+			if (frame_count == 0)
+			{
+				end_startup_span(span);
+				report_startup_trace();
+
+				LOG_INFO(TAG_OLIVIA, "game storage committed %zu KB", get_game_storage_committed() / 1024);
+			}
+
+			float cpu_ms = (float)((SDL_GetTicksNS() - frame_start) * 1e-6);
+			total_cpu_ms += cpu_ms;
+			max_cpu_ms    = SDL_max(max_cpu_ms, cpu_ms);
+
+			if (timings)
+				write_frame_timing(timings, frame_count, dt, cpu_ms);
+
+			if (++frame_count % 120 == 0)
+			{
+				LOG_INFO(TAG_RENDERER, "gpu: frame %.3f ms, depth pre-pass %.3f ms, main pass %.3f ms, render scale %.2f | cpu wait: gpu %.3f ms, acquire %.3f ms",
+					get_gpu_frame_time(),
+					is_depth_prepass_enabled() ? get_gpu_pass_time(RENDER_PASS_DEPTH_PREPASS) : 0.0f,
+					get_gpu_pass_time(RENDER_PASS_MAIN),
+					get_render_scale(),
+					get_gpu_wait_time(),
+					get_acquire_wait_time());
+			}
 		}
 
+		if (replaying && frame_count)
+		{
+			LOG_INFO(TAG_OLIVIA, "replay: %llu frames in %.3f s, cpu avg %.3f ms, max %.3f ms",
+				(unsigned long long)frame_count,
+				(SDL_GetTicksNS() - start) * 1e-9,
+				total_cpu_ms / frame_count,
+				max_cpu_ms);
+		}
+
+		end_replay_recording(recorder);
+		close_replay(replay);
+
+		if (timings)
+			SDL_CloseIO(timings);
+
+		log_memory_usage();
+
+		if (options.memory_trace_path)
+			write_memory_trace(options.memory_trace_path);
+
+		destroy_game_storage();
 		destroy_renderer();
+		destroy_job_system();
+		destroy_input();
 		SDL_DestroyWindow(window);
 	}
 
-} // olivia
-
-int main(int argc, char* argv[])
-{
-	olivia::run("000_setup.dll");
-
-	return 0;
-}
\ No newline at end of file
+} // olivia
\ No newline at end of file
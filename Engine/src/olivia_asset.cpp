@@ -0,0 +1,396 @@
+#include "olivia/olivia_asset.h"
+#include "olivia/core/vector.h"
+#include "olivia/graphics/bvh.h"
+
+#include <lz4.h>
+#include <zstd.h>
+
+namespace olivia
+{
+	constexpr int      ASSET_ZSTD_LEVEL{ 9 };
+	constexpr uint32_t ASSET_WRITE_BATCH{ 256 };
+
+	struct asset_source_block_t
+	{
+		const uint8_t* data;
+		uint32_t       raw_size;
+		uint8_t*       compressed;
+		uint32_t       compressed_size;
+		asset_codec_t  codec;
+	};
+
+	struct asset_compress_job_t
+	{
+		asset_source_block_t* blocks;
+		asset_codec_t         codec;
+	};
+
+	struct asset_lod_job_t
+	{
+		const asset_mesh_source_t* sources;
+		asset_pack_mesh_t*         meshes;
+		uint32_t**                 indices; // the generated streams, null where the source is stored as is
+	};
+
+	static uint32_t append_stream_blocks(vector_t<asset_source_block_t>& blocks, const void* data, size_t size, uint32_t block_size)
+	{
+		uint32_t first = (uint32_t)blocks.size;
+
+		for (size_t offset = 0; offset < size; offset += block_size)
+		{
+			asset_source_block_t block{};
+			block.data     = (const uint8_t*)data + offset;
+			block.raw_size = (uint32_t)SDL_min((size_t)block_size, size - offset);
+
+			vector_push_back(blocks, block);
+		}
+
+		return (uint32_t)blocks.size - first;
+	}
+
+	static void compress_blocks(uint32_t begin, uint32_t end, void* data)
+	{
+		asset_compress_job_t* job = (asset_compress_job_t*)data;
+
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			asset_source_block_t& block = job->blocks[i];
+
+			size_t bound = job->codec == ASSET_CODEC_ZSTD ? ZSTD_compressBound(block.raw_size) : (size_t)LZ4_compressBound((int)block.raw_size);
+			block.compressed = (uint8_t*)malloc(SDL_max(bound, (size_t)block.raw_size));
+			assert(block.compressed && "malloc failed");
+
+			size_t size = 0;
+
+			if (job->codec == ASSET_CODEC_LZ4)
+			{
+				size = (size_t)LZ4_compress_default((const char*)block.data, (char*)block.compressed, (int)block.raw_size, (int)bound);
+			}
+			else if (job->codec == ASSET_CODEC_ZSTD)
+			{
+				size = ZSTD_compress(block.compressed, bound, block.data, block.raw_size, ASSET_ZSTD_LEVEL);
+				if (ZSTD_isError(size)) size = 0;
+			}
+
+			// incompressible blocks are stored raw so decode never costs more than a copy
+			if (size == 0 || size >= block.raw_size)
+			{
+				memcpy(block.compressed, block.data, block.raw_size);
+				block.compressed_size = block.raw_size;
+				block.codec           = ASSET_CODEC_NONE;
+			}
+			else
+			{
+				block.compressed_size = (uint32_t)size;
+				block.codec           = job->codec;
+			}
+		}
+	}
+
+	static void generate_lods(uint32_t begin, uint32_t end, void* data)
+	{
+		asset_lod_job_t* job = (asset_lod_job_t*)data;
+
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const asset_mesh_source_t& source = job->sources[i];
+			asset_pack_mesh_t&         mesh   = job->meshes[i];
+
+			if (source.lod_max_error <= 0.0f)
+			{
+				mesh.lod_count = 1;
+				mesh.lods[0]   = { 0, source.index_count, 0.0f };
+				continue;
+			}
+
+			assert(source.vertex_stride >= sizeof(vec3_t) && "the vertex has no position");
+
+			uint32_t* indices = (uint32_t*)malloc((size_t)MAX_MESH_LODS * source.index_count * sizeof(uint32_t));
+			assert(indices && "malloc failed");
+
+			mesh.lod_count = generate_mesh_lods((const vec3_t*)source.vertices, source.vertex_count, source.vertex_stride,
+				(const uint32_t*)source.indices, source.index_count, source.lod_max_error, indices, mesh.lods);
+
+			const mesh_lod_t& last = mesh.lods[mesh.lod_count - 1];
+			mesh.index_count = last.first_index + last.index_count;
+
+			job->indices[i] = indices;
+		}
+	}
+
+	static void free_lod_indices(vector_t<uint32_t*>& lod_indices)
+	{
+		for (size_t i = 0; i < lod_indices.size; ++i)
+		{
+			free(lod_indices.data[i]);
+		}
+
+		destroy_vector(lod_indices);
+	}
+
+	bool write_asset_pack(const char* path, const asset_mesh_source_t* meshes, uint32_t mesh_count, asset_codec_t codec, uint32_t block_size)
+	{
+		block_size = SDL_clamp(block_size, ASSET_BLOCK_MIN_SIZE, ASSET_BLOCK_MAX_SIZE);
+
+		auto pack_meshes = create_vector<asset_pack_mesh_t>(SDL_max(mesh_count, 1u));
+		auto lod_indices = create_vector<uint32_t*>(SDL_max(mesh_count, 1u));
+		auto blocks      = create_vector<asset_source_block_t>(1024);
+
+		pack_meshes.size = mesh_count;
+		lod_indices.size = mesh_count;
+
+		for (uint32_t i = 0; i < mesh_count; ++i)
+		{
+			pack_meshes.data[i] = {};
+			pack_meshes.data[i].index_count = meshes[i].index_count;
+			lod_indices.data[i] = nullptr;
+		}
+
+		// simplification is by far the slowest part, one mesh per job
+		asset_lod_job_t lod_job{ meshes, pack_meshes.data, lod_indices.data };
+		parallel_for(mesh_count, 1, generate_lods, &lod_job);
+
+		for (uint32_t i = 0; i < mesh_count; ++i)
+		{
+			const asset_mesh_source_t& source = meshes[i];
+			asset_pack_mesh_t&         mesh   = pack_meshes.data[i];
+
+			const void* indices = lod_indices.data[i] ? lod_indices.data[i] : source.indices;
+
+			assert(source.vertex_stride >= sizeof(vec3_t) && "the vertex has no position");
+
+			mesh.vertex_count       = source.vertex_count;
+			mesh.vertex_stride      = source.vertex_stride;
+			mesh.bounds             = compute_aabb((const vec3_t*)source.vertices, source.vertex_count, source.vertex_stride);
+			mesh.first_vertex_block = (uint32_t)blocks.size;
+			mesh.vertex_block_count = append_stream_blocks(blocks, source.vertices, (size_t)source.vertex_count * source.vertex_stride, block_size);
+			mesh.first_index_block  = (uint32_t)blocks.size;
+			mesh.index_block_count  = append_stream_blocks(blocks, indices, (size_t)mesh.index_count * sizeof(uint32_t), block_size);
+		}
+
+		SDL_IOStream* file = SDL_IOFromFile(path, "wb");
+		if (!file)
+		{
+			LOG_ERROR(TAG_OLIVIA, "failed to open %s for writing", path);
+			free_lod_indices(lod_indices);
+			destroy_vector(blocks);
+			destroy_vector(pack_meshes);
+			return false;
+		}
+
+		asset_pack_header_t header
+		{
+			.magic       = ASSET_PACK_MAGIC,
+			.version     = ASSET_PACK_VERSION,
+			.block_size  = block_size,
+			.mesh_count  = mesh_count,
+			.block_count = (uint32_t)blocks.size,
+			.data_offset = sizeof(asset_pack_header_t) + sizeof(asset_pack_mesh_t) * mesh_count + sizeof(asset_pack_block_t) * blocks.size
+		};
+
+		auto pack_blocks = create_vector<asset_pack_block_t>(SDL_max(blocks.size, (size_t)1));
+		pack_blocks.size = blocks.size;
+
+		bool ok = SDL_WriteIO(file, &header, sizeof(header)) == sizeof(header);
+		ok = ok && SDL_WriteIO(file, pack_meshes.data, sizeof(asset_pack_mesh_t) * mesh_count) == sizeof(asset_pack_mesh_t) * mesh_count;
+		ok = ok && SDL_SeekIO(file, (Sint64)header.data_offset, SDL_IO_SEEK_SET) >= 0;
+
+		uint64_t offset = header.data_offset;
+
+		// compress a bounded batch in parallel, then stream it out in order
+		for (size_t first = 0; ok && first < blocks.size; first += ASSET_WRITE_BATCH)
+		{
+			uint32_t count = (uint32_t)SDL_min((size_t)ASSET_WRITE_BATCH, blocks.size - first);
+
+			asset_compress_job_t job{ blocks.data + first, codec };
+			parallel_for(count, 1, compress_blocks, &job);
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				asset_source_block_t& block = blocks.data[first + i];
+
+				pack_blocks.data[first + i] =
+				{
+					.offset          = offset,
+					.compressed_size = block.compressed_size,
+					.raw_size        = block.raw_size,
+					.codec           = block.codec
+				};
+
+				ok = ok && SDL_WriteIO(file, block.compressed, block.compressed_size) == block.compressed_size;
+				offset += block.compressed_size;
+
+				free(block.compressed);
+			}
+		}
+
+		Sint64 block_table = sizeof(asset_pack_header_t) + sizeof(asset_pack_mesh_t) * mesh_count;
+		ok = ok && SDL_SeekIO(file, block_table, SDL_IO_SEEK_SET) >= 0;
+		ok = ok && SDL_WriteIO(file, pack_blocks.data, sizeof(asset_pack_block_t) * pack_blocks.size) == sizeof(asset_pack_block_t) * pack_blocks.size;
+
+		ok = SDL_CloseIO(file) && ok;
+
+		if (!ok)
+		{
+			LOG_ERROR(TAG_OLIVIA, "failed to write asset pack %s", path);
+		}
+
+		free_lod_indices(lod_indices);
+		destroy_vector(pack_blocks);
+		destroy_vector(blocks);
+		destroy_vector(pack_meshes);
+
+		return ok;
+	}
+
+	bool open_asset_pack(const char* path, asset_pack_t& pack)
+	{
+		pack = {};
+
+		if (!map_file(path, pack.file))
+		{
+			LOG_ERROR(TAG_OLIVIA, "failed to map asset pack %s", path);
+			return false;
+		}
+
+		const uint8_t* base = (const uint8_t*)pack.file.data;
+		pack.header = (const asset_pack_header_t*)base;
+
+		bool valid = pack.file.size >= sizeof(asset_pack_header_t) &&
+			pack.header->magic == ASSET_PACK_MAGIC &&
+			pack.header->version == ASSET_PACK_VERSION &&
+			pack.header->data_offset <= pack.file.size;
+
+		if (!valid)
+		{
+			LOG_ERROR(TAG_OLIVIA, "%s is not a valid asset pack", path);
+			close_asset_pack(pack);
+			return false;
+		}
+
+		// the counts are 32 bit, the table sizes cannot overflow 64
+		const uint64_t tables_end = sizeof(asset_pack_header_t) +
+			sizeof(asset_pack_mesh_t) * (uint64_t)pack.header->mesh_count +
+			sizeof(asset_pack_block_t) * (uint64_t)pack.header->block_count;
+
+		valid = pack.header->block_size >= ASSET_BLOCK_MIN_SIZE &&
+			pack.header->block_size <= ASSET_BLOCK_MAX_SIZE &&
+			tables_end <= pack.header->data_offset;
+
+		if (!valid)
+		{
+			LOG_ERROR(TAG_OLIVIA, "%s: the tables do not fit before the block data", path);
+			close_asset_pack(pack);
+			return false;
+		}
+
+		pack.meshes = (const asset_pack_mesh_t*)(base + sizeof(asset_pack_header_t));
+		pack.blocks = (const asset_pack_block_t*)(base + sizeof(asset_pack_header_t) + sizeof(asset_pack_mesh_t) * pack.header->mesh_count);
+
+		for (uint32_t i = 0; i < pack.header->block_count; ++i)
+		{
+			const asset_pack_block_t& block = pack.blocks[i];
+
+			valid = block.raw_size <= pack.header->block_size &&
+				block.codec <= ASSET_CODEC_ZSTD &&
+				(block.codec != ASSET_CODEC_NONE || block.compressed_size == block.raw_size) &&
+				block.offset >= pack.header->data_offset &&
+				block.offset <= pack.file.size &&
+				block.compressed_size <= pack.file.size - block.offset;
+
+			if (!valid)
+			{
+				LOG_ERROR(TAG_OLIVIA, "%s: block %u is corrupt", path, i);
+				close_asset_pack(pack);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void close_asset_pack(asset_pack_t& pack)
+	{
+		unmap_file(pack.file);
+		pack = {};
+	}
+
+	bool decompress_asset_block(const asset_pack_t& pack, uint32_t block_index, void* destination, size_t capacity)
+	{
+		if (block_index >= pack.header->block_count)
+			return false;
+
+		const asset_pack_block_t& block = pack.blocks[block_index];
+
+		// open_asset_pack checked the block lies in the file
+		if (block.raw_size > capacity)
+			return false;
+
+		const uint8_t* source = (const uint8_t*)pack.file.data + block.offset;
+
+		switch (block.codec)
+		{
+		case ASSET_CODEC_NONE:
+			memcpy(destination, source, block.raw_size);
+			return true;
+		case ASSET_CODEC_LZ4:
+			return LZ4_decompress_safe((const char*)source, (char*)destination, (int)block.compressed_size, (int)capacity) == (int)block.raw_size;
+		case ASSET_CODEC_ZSTD:
+			return ZSTD_decompress(destination, capacity, source, block.compressed_size) == block.raw_size;
+		}
+
+		return false;
+	}
+
+	struct asset_decompress_job_t
+	{
+		const asset_pack_t*          pack;
+		const asset_block_target_t*  targets;
+		SDL_AtomicInt                failed;
+	};
+
+	static void decompress_blocks(uint32_t begin, uint32_t end, void* data)
+	{
+		asset_decompress_job_t* job = (asset_decompress_job_t*)data;
+
+		uint8_t* scratch = (uint8_t*)malloc(job->pack->header->block_size);
+		assert(scratch && "malloc failed");
+
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const asset_block_target_t& target = job->targets[i];
+			const asset_pack_block_t&   block  = job->pack->blocks[target.block];
+
+			if (block.codec == ASSET_CODEC_NONE)
+			{
+				if (!decompress_asset_block(*job->pack, target.block, target.destination, target.capacity))
+					SDL_SetAtomicInt(&job->failed, 1);
+
+				continue;
+			}
+
+			if (block.raw_size > target.capacity || !decompress_asset_block(*job->pack, target.block, scratch, job->pack->header->block_size))
+			{
+				SDL_SetAtomicInt(&job->failed, 1);
+				continue;
+			}
+
+			memcpy(target.destination, scratch, block.raw_size);
+		}
+
+		free(scratch);
+	}
+
+	bool decompress_asset_blocks(const asset_pack_t& pack, const asset_block_target_t* targets, uint32_t count)
+	{
+		asset_decompress_job_t job{ &pack, targets };
+
+		uint32_t workers = get_job_worker_count() + 1;
+		uint32_t batch   = SDL_max(count / (workers * 4), 1u);
+
+		parallel_for(count, batch, decompress_blocks, &job);
+
+		return SDL_GetAtomicInt(&job.failed) == 0;
+	}
+
+} // olivia
@@ -1,181 +1,329 @@
 #include "olivia/olivia_graphics.h"
+#include "olivia/core/vector.h"
 
 #define VMA_IMPLEMENTATION
 #include <vma/vk_mem_alloc.h>
 
 namespace olivia
 {
-	static vulkan_core_t vulkan_core{};
+	vulkan_core_t g_vulkan_core{};
 	static renderer_t    renderer{};
 
-	void init_vulkan_core(SDL_Window* window)
+	static frame_draw_function frame_draw{};
+
+	// read on a worker while the instance and device are created
+	static void*         pipeline_cache_data{};
+	static size_t        pipeline_cache_size{};
+	static job_counter_t pipeline_cache_read{};
+
+	static void read_pipeline_cache(void*)
 	{
-		if (!window)
-			return;
+		uint32_t span = begin_startup_span("pipeline cache read");
 
-		vulkan_core.window = window;
+		pipeline_cache_data = SDL_LoadFile(PIPELINE_CACHE_PATH, &pipeline_cache_size);
 
-		// create instance
+		end_startup_span(span);
+	}
+
+	static void create_pipeline_cache()
+	{
+		wait_for_counter(&pipeline_cache_read);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(g_vulkan_core.gpu, &properties);
+
+		// drivers have to reject foreign data themselves, not all of them do it gracefully
+		const VkPipelineCacheHeaderVersionOne* header = (const VkPipelineCacheHeaderVersionOne*)pipeline_cache_data;
+
+		bool valid = pipeline_cache_data &&
+			pipeline_cache_size >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+			header->headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			header->vendorID == properties.vendorID &&
+			header->deviceID == properties.deviceID &&
+			memcmp(header->pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+		VkPipelineCacheCreateInfo pipeline_cache_info
 		{
-			VkApplicationInfo application_info
-			{
-				.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-				.pApplicationName = "Olivia",
-				.pEngineName = "Olivia",
-				.apiVersion = VK_API_VERSION_1_3
-			};
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+			.initialDataSize = valid ? pipeline_cache_size : 0,
+			.pInitialData = valid ? pipeline_cache_data : nullptr
+		};
 
-			uint32_t sdl_extension_count;
-			char const* const* sdl_extensions = SDL_Vulkan_GetInstanceExtensions(&sdl_extension_count);
+		VK_CHECK(vkCreatePipelineCache(g_vulkan_core.device, &pipeline_cache_info, nullptr, &g_vulkan_core.pipeline_cache));
 
-			VkInstanceCreateInfo instance_info
-			{
-				.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-				.pApplicationInfo = &application_info,
-				.enabledExtensionCount = sdl_extension_count,
-				.ppEnabledExtensionNames = sdl_extensions
-			};
+		if (pipeline_cache_data && !valid)
+			LOG_WARN(TAG_RENDERER, "%s was written by another device or driver, starting with an empty pipeline cache", PIPELINE_CACHE_PATH);
 
-#ifdef OLIVIA_DEBUG
-			const char* layers[]
-			{
-				"VK_LAYER_KHRONOS_validation"
-			};
+		SDL_free(pipeline_cache_data);
+		pipeline_cache_data = nullptr;
+		pipeline_cache_size = 0;
+	}
 
-			instance_info.enabledLayerCount = ARRAY_SIZE(layers);
-			instance_info.ppEnabledLayerNames = layers;
-#endif // OLIVIA_DEBUG
+	static void write_pipeline_cache()
+	{
+		size_t size{};
+		if (vkGetPipelineCacheData(g_vulkan_core.device, g_vulkan_core.pipeline_cache, &size, nullptr) != VK_SUCCESS || size == 0)
+			return;
 
-			VK_CHECK(vkCreateInstance(&instance_info, nullptr, &vulkan_core.instance));
-		}
+		void* data = malloc(size);
+		if (!data)
+			return;
 
-		// create surface
+		if (vkGetPipelineCacheData(g_vulkan_core.device, g_vulkan_core.pipeline_cache, &size, data) == VK_SUCCESS)
 		{
-			bool res = SDL_Vulkan_CreateSurface(vulkan_core.window, vulkan_core.instance, nullptr, &vulkan_core.surface);
-			if (!res)
+			SDL_IOStream* file = SDL_IOFromFile(PIPELINE_CACHE_PATH, "wb");
+			if (file)
 			{
-				printf("SDL_Error: %s\n", SDL_GetError());
-				abort();
+				SDL_WriteIO(file, data, size);
+				SDL_CloseIO(file);
 			}
 		}
 
-		// create device
+		free(data);
+	}
+
+	struct gpu_candidate_t
+	{
+		VkPhysicalDevice           gpu;
+		VkPhysicalDeviceProperties properties;
+		gpu_capabilities_t         capabilities;
+		uint32_t                   graphics_queue_index;
+		bool                       suitable;
+		int64_t                    score;
+	};
+
+	static bool has_device_extension(VkPhysicalDevice gpu, const char* name)
+	{
+		uint32_t count{};
+		vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, nullptr);
+		VkExtensionProperties* extensions = (VkExtensionProperties*)calloc(SDL_max(count, 1u), sizeof(VkExtensionProperties));
+		vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, extensions);
+
+		bool found = false;
+		for (uint32_t i = 0; i < count && !found; ++i)
+		{
+			found = strcmp(extensions[i].extensionName, name) == 0;
+		}
+
+		free(extensions);
+
+		return found;
+	}
+
+	// everything the renderer requires, plus the optional capabilities the score rewards
+	static void query_gpu(VkPhysicalDevice gpu, gpu_candidate_t& candidate)
+	{
+		candidate     = {};
+		candidate.gpu = gpu;
+		candidate.graphics_queue_index              = UINT32_MAX;
+		candidate.capabilities.compute_queue_index  = UINT32_MAX;
+		candidate.capabilities.transfer_queue_index = UINT32_MAX;
+
+		vkGetPhysicalDeviceProperties(gpu, &candidate.properties);
+
+		if (candidate.properties.apiVersion < VK_API_VERSION_1_3)
+			return;
+
+		VkPhysicalDeviceVulkan12Features features12{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+		VkPhysicalDeviceVulkan13Features features13{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES, .pNext = &features12 };
+		VkPhysicalDeviceFeatures2        features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = &features13 };
+		vkGetPhysicalDeviceFeatures2(gpu, &features);
+
+		if (!features12.timelineSemaphore || !features12.separateDepthStencilLayouts ||
+			!features13.synchronization2 || !features13.dynamicRendering ||
+			!has_device_extension(gpu, VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+			return;
+
+		uint32_t queue_family_count{};
+		vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queue_family_count, nullptr);
+		VkQueueFamilyProperties* queue_families = (VkQueueFamilyProperties*)calloc(SDL_max(queue_family_count, 1u), sizeof(VkQueueFamilyProperties));
+		vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queue_family_count, queue_families);
+
+		for (uint32_t family = 0; family < queue_family_count; ++family)
 		{
-			uint32_t gpu_count{};
-			vkEnumeratePhysicalDevices(vulkan_core.instance, &gpu_count, nullptr);
+			const VkQueueFlags flags = queue_families[family].queueFlags;
 
-			if (gpu_count <= 0)
+			if ((flags & VK_QUEUE_GRAPHICS_BIT) && candidate.graphics_queue_index == UINT32_MAX)
 			{
+				VkBool32 support_presentation{ VK_FALSE };
+				vkGetPhysicalDeviceSurfaceSupportKHR(gpu, family, g_vulkan_core.surface, &support_presentation);
 
-				printf("No suitable gpu found\n");
-				abort();
+				if (support_presentation)
+					candidate.graphics_queue_index = family;
 			}
 
-			VkPhysicalDevice gpus[10]{};
-			vkEnumeratePhysicalDevices(vulkan_core.instance, &gpu_count, gpus);
+			if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && candidate.capabilities.compute_queue_index == UINT32_MAX)
+				candidate.capabilities.compute_queue_index = family;
 
-			for (uint32_t i = 0; i < gpu_count; ++i)
-			{
-				VkPhysicalDeviceProperties properties;
-				vkGetPhysicalDeviceProperties(gpus[i], &properties);
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) && candidate.capabilities.transfer_queue_index == UINT32_MAX)
+				candidate.capabilities.transfer_queue_index = family;
+		}
 
-				if (properties.apiVersion < VK_API_VERSION_1_3)
-				{
-					continue;
-				}
+		free(queue_families);
 
-				uint32_t queue_family_count = 0;
-				vkGetPhysicalDeviceQueueFamilyProperties(gpus[i], &queue_family_count, nullptr);
+		VkPhysicalDeviceMemoryProperties memory_properties;
+		vkGetPhysicalDeviceMemoryProperties(gpu, &memory_properties);
 
-				VkQueueFamilyProperties queue_family_properties[20];
-				vkGetPhysicalDeviceQueueFamilyProperties(gpus[i], &queue_family_count, queue_family_properties);
+		for (uint32_t heap = 0; heap < memory_properties.memoryHeapCount; ++heap)
+		{
+			if (memory_properties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+				candidate.capabilities.device_local_size += memory_properties.memoryHeaps[heap].size;
+		}
 
-				vulkan_core.graphics_queue_index = UINT32_MAX;
+		candidate.capabilities.discrete = candidate.properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+		candidate.suitable              = candidate.graphics_queue_index != UINT32_MAX;
 
-				for (uint32_t i = 0; i < queue_family_count; ++i)
-				{
-					VkBool32 support_presentation{ VK_FALSE };
-					vkGetPhysicalDeviceSurfaceSupportKHR(gpus[i], i, vulkan_core.surface, &support_presentation);
+		if (!candidate.suitable)
+			return;
 
-					if ((queue_family_properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && support_presentation)
-					{
-						vulkan_core.graphics_queue_index = i;
-						vulkan_core.gpu = gpus[i];
-						break;
-					}
-				}
-			}
+		int64_t score{};
 
-			if (vulkan_core.graphics_queue_index == UINT32_MAX)
-			{
-				abort();
-			}
+		switch (candidate.properties.deviceType)
+		{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   score += 100000; break;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: score += 10000;  break;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    score += 1000;   break;
+		default: break;
+		}
 
-			const char* extensions[]
-			{
-				VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-				VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME
-			};
+		// a MB of vram is worth a point, dedicated queues break ties between similar cards
+		score += (int64_t)(candidate.capabilities.device_local_size / MEGABYTES(1));
+		score += candidate.capabilities.compute_queue_index  != UINT32_MAX ? 500 : 0;
+		score += candidate.capabilities.transfer_queue_index != UINT32_MAX ? 250 : 0;
+		score += features.features.textureCompressionBC ? 100 : 0;
 
-			VkPhysicalDeviceVulkan13Features features
-			{
-				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
-				.pNext = nullptr,
-				.dynamicRendering = VK_TRUE
-			};
+		candidate.score = score;
+	}
 
-			float queue_priority{ 1.0f };
-			VkDeviceQueueCreateInfo queue_info[]
-			{
-				// Graphics Queue
-				{
-					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-					.queueFamilyIndex = vulkan_core.graphics_queue_index,
-					.queueCount = 1,
-					.pQueuePriorities = &queue_priority
-				}
-			};
+	// OLIVIA_GPU picks a device by enumeration index or by a part of its name
+	static bool matches_gpu_override(const char* selection, uint32_t index, const gpu_candidate_t& candidate)
+	{
+		if (selection[0] >= '0' && selection[0] <= '9')
+			return (uint32_t)SDL_atoi(selection) == index;
 
-			VkDeviceCreateInfo device_info
-			{
-				.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-				.pNext = &features,
-				.queueCreateInfoCount = ARRAY_SIZE(queue_info),
-				.pQueueCreateInfos = queue_info,
-				.enabledExtensionCount = ARRAY_SIZE(extensions),
-				.ppEnabledExtensionNames = extensions
-			};
+		return SDL_strcasestr(candidate.properties.deviceName, selection) != nullptr;
+	}
 
-			VK_CHECK(vkCreateDevice(vulkan_core.gpu, &device_info, nullptr, &vulkan_core.device));
+	static void write_device_cache()
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(g_vulkan_core.gpu, &properties);
+
+		device_cache_t cache
+		{
+			.magic          = DEVICE_CACHE_MAGIC,
+			.version        = DEVICE_CACHE_VERSION,
+			.vendor_id      = properties.vendorID,
+			.device_id      = properties.deviceID,
+			.driver_version = properties.driverVersion
+		};
 
-			vkGetDeviceQueue(vulkan_core.device, vulkan_core.graphics_queue_index, 0, &vulkan_core.queue);
+		SDL_IOStream* file = SDL_IOFromFile(DEVICE_CACHE_PATH, "wb");
+		if (file)
+		{
+			SDL_WriteIO(file, &cache, sizeof(cache));
+			SDL_CloseIO(file);
 		}
+	}
 
-		// create allocator
+	// the last selected gpu is reused as long as the same driver reports it, which skips
+	// querying every other device
+	static VkPhysicalDevice find_cached_gpu(const VkPhysicalDevice* gpus, uint32_t gpu_count)
+	{
+		size_t           size{};
+		device_cache_t*  cache = (device_cache_t*)SDL_LoadFile(DEVICE_CACHE_PATH, &size);
+		VkPhysicalDevice found{};
+
+		if (cache && size == sizeof(device_cache_t) && cache->magic == DEVICE_CACHE_MAGIC && cache->version == DEVICE_CACHE_VERSION)
 		{
-			VmaAllocatorCreateInfo vma_info
+			for (uint32_t i = 0; i < gpu_count && !found; ++i)
 			{
-				.physicalDevice = vulkan_core.gpu,
-				.device = vulkan_core.device,
-				.instance = vulkan_core.instance,
-				.vulkanApiVersion = VK_API_VERSION_1_3
-			};
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties(gpus[i], &properties);
 
-			VK_CHECK(vmaCreateAllocator(&vma_info, &vulkan_core.allocator));
+				if (properties.vendorID == cache->vendor_id &&
+					properties.deviceID == cache->device_id &&
+					properties.driverVersion == cache->driver_version)
+					found = gpus[i];
+			}
 		}
 
-		// create command_pool
+		SDL_free(cache);
+
+		return found;
+	}
+
+	static void select_gpu()
+	{
+		uint32_t gpu_count{};
+		vkEnumeratePhysicalDevices(g_vulkan_core.instance, &gpu_count, nullptr);
+
+		VkPhysicalDevice* gpus = (VkPhysicalDevice*)calloc(SDL_max(gpu_count, 1u), sizeof(VkPhysicalDevice));
+		vkEnumeratePhysicalDevices(g_vulkan_core.instance, &gpu_count, gpus);
+
+		const char* selection = SDL_getenv("OLIVIA_GPU");
+
+		gpu_candidate_t chosen{};
+		gpu_candidate_t best{};
+		gpu_candidate_t candidate{};
+
+		VkPhysicalDevice cached = selection ? VK_NULL_HANDLE : find_cached_gpu(gpus, gpu_count);
+
+		if (cached)
+			query_gpu(cached, chosen);
+
+		if (!chosen.suitable)
 		{
-			VkCommandPoolCreateInfo command_pool_info
+			for (uint32_t i = 0; i < gpu_count; ++i)
 			{
-				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-				.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-				.queueFamilyIndex = vulkan_core.graphics_queue_index
-			};
+				query_gpu(gpus[i], candidate);
+
+				LOG_INFO(TAG_RENDERER, "gpu %u: %s, %s, score %lld", i, candidate.properties.deviceName,
+					candidate.suitable ? "suitable" : "unsuitable", (long long)candidate.score);
+
+				if (!candidate.suitable)
+					continue;
+
+				if (selection && !chosen.suitable && matches_gpu_override(selection, i, candidate))
+					chosen = candidate;
+
+				if (!best.suitable || candidate.score > best.score)
+					best = candidate;
+			}
+
+			if (selection && !chosen.suitable)
+				LOG_WARN(TAG_RENDERER, "OLIVIA_GPU=%s matches no suitable gpu, using the best scored one", selection);
+
+			if (!chosen.suitable)
+				chosen = best;
+		}
 
-			VK_CHECK(vkCreateCommandPool(vulkan_core.device, &command_pool_info, nullptr, &vulkan_core.command_pool));
+		free(gpus);
+
+		if (!chosen.suitable)
+		{
+			LOG_ERROR(TAG_RENDERER, "no gpu supports vulkan 1.3 with presentation to the window");
+			abort();
 		}
 
+		g_vulkan_core.gpu                  = chosen.gpu;
+		g_vulkan_core.graphics_queue_index = chosen.graphics_queue_index;
+		g_vulkan_core.capabilities         = chosen.capabilities;
+
+		LOG_INFO(TAG_RENDERER, "selected %s: %s, %llu MB device local, async compute %s, transfer queue %s",
+			chosen.properties.deviceName,
+			chosen.capabilities.discrete ? "discrete" : "integrated",
+			(unsigned long long)(chosen.capabilities.device_local_size / MEGABYTES(1)),
+			chosen.capabilities.compute_queue_index  != UINT32_MAX ? "yes" : "no",
+			chosen.capabilities.transfer_queue_index != UINT32_MAX ? "yes" : "no");
+
+		// an override is a one-off, it does not replace the cached choice
+		if (!selection && chosen.gpu != cached)
+			write_device_cache();
+	}
+
+	static void create_swapchain(VkSwapchainKHR old_swapchain)
+	{
 		// create swapchain
 		{
 			VkSurfaceFormatKHR preferred_formats[]
@@ -184,89 +332,111 @@ namespace olivia
 			};
 
 			uint32_t format_count{};
-			vkGetPhysicalDeviceSurfaceFormatsKHR(vulkan_core.gpu, vulkan_core.surface, &format_count, nullptr);
+			vkGetPhysicalDeviceSurfaceFormatsKHR(g_vulkan_core.gpu, g_vulkan_core.surface, &format_count, nullptr);
 			VkSurfaceFormatKHR formats[15]{};
-			vkGetPhysicalDeviceSurfaceFormatsKHR(vulkan_core.gpu, vulkan_core.surface, &format_count, formats);
+			vkGetPhysicalDeviceSurfaceFormatsKHR(g_vulkan_core.gpu, g_vulkan_core.surface, &format_count, formats);
 
 			for (uint32_t i = 0; i < format_count; ++i)
 			{
-				for (uint32_t j = 0; j < sizeof(preferred_formats[0]) / sizeof(preferred_formats); ++j)
+				for (uint32_t j = 0; j < ARRAY_SIZE(preferred_formats); ++j)
 				{
 					if (preferred_formats[j].format == formats[i].format &&
 						preferred_formats[j].colorSpace == formats[i].colorSpace)
 					{
-						vulkan_core.swapchain_format = preferred_formats[j];
+						g_vulkan_core.swapchain_format = preferred_formats[j];
 						break;
 					}
 				}
 
-				if (vulkan_core.swapchain_format.format != VK_FORMAT_UNDEFINED)
+				if (g_vulkan_core.swapchain_format.format != VK_FORMAT_UNDEFINED)
 				{
 					break;
 				}
 			}
 
-			if (vulkan_core.swapchain_format.format == VK_FORMAT_UNDEFINED)
+			if (g_vulkan_core.swapchain_format.format == VK_FORMAT_UNDEFINED)
 			{
-				vulkan_core.swapchain_format = formats[0];
+				g_vulkan_core.swapchain_format = formats[0];
 			}
 
 			VkSurfaceCapabilitiesKHR capabilities{};
-			vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vulkan_core.gpu, vulkan_core.surface, &capabilities);
+			vkGetPhysicalDeviceSurfaceCapabilitiesKHR(g_vulkan_core.gpu, g_vulkan_core.surface, &capabilities);
 
 			if (capabilities.currentExtent.width != UINT32_MAX)
 			{
-				vulkan_core.swapchain_extent = capabilities.currentExtent;
+				g_vulkan_core.swapchain_extent = capabilities.currentExtent;
 			}
 			else
 			{
 				int width, height;
-				SDL_GetWindowSizeInPixels(vulkan_core.window, &width, &height);
-				vulkan_core.swapchain_extent = { (uint32_t)width, (uint32_t)height };
-				SDL_clamp(vulkan_core.swapchain_extent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
-				SDL_clamp(vulkan_core.swapchain_extent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+				SDL_GetWindowSizeInPixels(g_vulkan_core.window, &width, &height);
+				g_vulkan_core.swapchain_extent = { (uint32_t)width, (uint32_t)height };
+				SDL_clamp(g_vulkan_core.swapchain_extent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+				SDL_clamp(g_vulkan_core.swapchain_extent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
 			}
 
 			uint32_t min_image_count = capabilities.minImageCount > 2 ? capabilities.minImageCount : 2;
 
 			VkPresentModeKHR presentation_mode = VK_PRESENT_MODE_FIFO_KHR;
 
+			// unthrottled presentation for replays and benchmarks, fifo is the only mode that is always supported
+			if (!g_vulkan_core.vsync)
+			{
+				uint32_t mode_count{};
+				vkGetPhysicalDeviceSurfacePresentModesKHR(g_vulkan_core.gpu, g_vulkan_core.surface, &mode_count, nullptr);
+				VkPresentModeKHR modes[8]{};
+				mode_count = SDL_min(mode_count, (uint32_t)ARRAY_SIZE(modes));
+				vkGetPhysicalDeviceSurfacePresentModesKHR(g_vulkan_core.gpu, g_vulkan_core.surface, &mode_count, modes);
+
+				for (uint32_t i = 0; i < mode_count; ++i)
+				{
+					if (modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR)
+					{
+						presentation_mode = modes[i];
+						break;
+					}
+
+					if (modes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+						presentation_mode = modes[i];
+				}
+			}
+
 			VkSwapchainCreateInfoKHR swapchain_info
 			{
 				.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-				.surface = vulkan_core.surface,
+				.surface = g_vulkan_core.surface,
 				.minImageCount = min_image_count,
-				.imageFormat = vulkan_core.swapchain_format.format,
-				.imageColorSpace = vulkan_core.swapchain_format.colorSpace,
-				.imageExtent = vulkan_core.swapchain_extent,
+				.imageFormat = g_vulkan_core.swapchain_format.format,
+				.imageColorSpace = g_vulkan_core.swapchain_format.colorSpace,
+				.imageExtent = g_vulkan_core.swapchain_extent,
 				.imageArrayLayers = 1,
 				.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
 				.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
 				.preTransform = capabilities.currentTransform,
 				.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
 				.presentMode = presentation_mode,
-				.oldSwapchain = VK_NULL_HANDLE,
+				.oldSwapchain = old_swapchain,
 			};
 
-			VK_CHECK(vkCreateSwapchainKHR(vulkan_core.device, &swapchain_info, nullptr, &vulkan_core.swapchain));
+			VK_CHECK(vkCreateSwapchainKHR(g_vulkan_core.device, &swapchain_info, nullptr, &g_vulkan_core.swapchain));
 		}
 
 		// create swapchain images
 		{
-			vkGetSwapchainImagesKHR(vulkan_core.device, vulkan_core.swapchain, &vulkan_core.swapchain_size, nullptr);
-			vkGetSwapchainImagesKHR(vulkan_core.device, vulkan_core.swapchain, &vulkan_core.swapchain_size, vulkan_core.swapchain_images);
+			vkGetSwapchainImagesKHR(g_vulkan_core.device, g_vulkan_core.swapchain, &g_vulkan_core.swapchain_size, nullptr);
+			vkGetSwapchainImagesKHR(g_vulkan_core.device, g_vulkan_core.swapchain, &g_vulkan_core.swapchain_size, g_vulkan_core.swapchain_images);
 		}
 
 		// create swapchain views
 		{
-			for (uint32_t i = 0; i < vulkan_core.swapchain_size; ++i)
+			for (uint32_t i = 0; i < g_vulkan_core.swapchain_size; ++i)
 			{
 				VkImageViewCreateInfo image_view_info
 				{
 					.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-					.image = vulkan_core.swapchain_images[i],
+					.image = g_vulkan_core.swapchain_images[i],
 					.viewType = VK_IMAGE_VIEW_TYPE_2D,
-					.format = vulkan_core.swapchain_format.format,
+					.format = g_vulkan_core.swapchain_format.format,
 					.components
 					{
 						VK_COMPONENT_SWIZZLE_IDENTITY,
@@ -284,259 +454,843 @@ namespace olivia
 					}
 				};
 
-				VK_CHECK(vkCreateImageView(vulkan_core.device, &image_view_info, nullptr, &vulkan_core.swapchain_views[i]));
+				VK_CHECK(vkCreateImageView(g_vulkan_core.device, &image_view_info, nullptr, &g_vulkan_core.swapchain_views[i]));
 			}
 		}
+	}
 
-		// allocate command buffers
+	static void create_depth_attachment()
+	{
+		VkImageCreateInfo image_info
 		{
-			VkCommandBufferAllocateInfo command_buffer_info
-			{
-				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-				.commandPool = vulkan_core.command_pool,
-				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-				.commandBufferCount = MAX_FRAMES
-			};
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = g_vulkan_core.depth_format,
+			.extent = { g_vulkan_core.swapchain_extent.width, g_vulkan_core.swapchain_extent.height, 1 },
+			.mipLevels = 1,
+			.arrayLayers = 1,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+		};
 
-			VK_CHECK(vkAllocateCommandBuffers(vulkan_core.device, &command_buffer_info, vulkan_core.command_buffers));
+		VmaAllocationCreateInfo allocation_info
+		{
+			.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+		};
+
+		// without a pre-pass depth never outlives the main pass, so tilers can keep it on chip
+		if (!g_vulkan_core.depth_prepass)
+		{
+			image_info.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+			allocation_info.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
 		}
 
-		// create semaphores & fences
+		VkResult result = vmaCreateImage(g_vulkan_core.allocator, &image_info, &allocation_info, &g_vulkan_core.depth_image, &g_vulkan_core.depth_allocation, nullptr);
+
+		// no lazily allocated memory type on this device
+		if (result == VK_ERROR_FEATURE_NOT_PRESENT)
 		{
-			VkSemaphoreCreateInfo semaphore_info
-			{
-				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
-			};
+			allocation_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+			result = vmaCreateImage(g_vulkan_core.allocator, &image_info, &allocation_info, &g_vulkan_core.depth_image, &g_vulkan_core.depth_allocation, nullptr);
+		}
 
-			VkFenceCreateInfo fence_info
-			{
-				.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-				.flags = VK_FENCE_CREATE_SIGNALED_BIT
-			};
+		VK_CHECK(result);
 
+		track_allocation(g_vulkan_core.depth_allocation, MEMORY_CATEGORY_TRANSIENT);
 
-			for (uint32_t i = 0; i < MAX_FRAMES; ++i)
-			{
-				VK_CHECK(vkCreateSemaphore(vulkan_core.device, &semaphore_info, nullptr, &vulkan_core.acquire_image[i]));
-				VK_CHECK(vkCreateFence(vulkan_core.device, &fence_info, nullptr, &vulkan_core.queue_submit[i]));
-			}
+		VkImageViewCreateInfo view_info
+		{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = g_vulkan_core.depth_image,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = g_vulkan_core.depth_format,
+			.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 }
+		};
 
-			for (uint32_t i = 0; i < vulkan_core.swapchain_size; ++i)
-			{
-				VK_CHECK(vkCreateSemaphore(vulkan_core.device, &semaphore_info, nullptr, &vulkan_core.present_image[i]));
-			}
-		}
+		VK_CHECK(vkCreateImageView(g_vulkan_core.device, &view_info, nullptr, &g_vulkan_core.depth_view));
 	}
 
-	void destroy_vulkan_core()
+	static void destroy_depth_attachment()
 	{
-		vkDestroyCommandPool(vulkan_core.device, vulkan_core.command_pool, nullptr);
+		vkDestroyImageView(g_vulkan_core.device, g_vulkan_core.depth_view, nullptr);
+		untrack_allocation(g_vulkan_core.depth_allocation);
+		vmaDestroyImage(g_vulkan_core.allocator, g_vulkan_core.depth_image, g_vulkan_core.depth_allocation);
 
-		for (uint32_t i = 0; i < MAX_FRAMES; ++i)
-		{
-			vkDestroyFence(vulkan_core.device, vulkan_core.queue_submit[i], nullptr);
-			vkDestroySemaphore(vulkan_core.device, vulkan_core.acquire_image[i], nullptr);
-		}
+		g_vulkan_core.depth_view       = VK_NULL_HANDLE;
+		g_vulkan_core.depth_image      = VK_NULL_HANDLE;
+		g_vulkan_core.depth_allocation = VK_NULL_HANDLE;
+	}
+
+	static void release_deferred(uint64_t completed)
+	{
+		size_t kept{};
 
-		for (uint32_t i = 0; i < vulkan_core.swapchain_size; ++i)
+		for (size_t i = 0; i < g_vulkan_core.deferred.size; ++i)
 		{
-			vkDestroyImageView(vulkan_core.device, vulkan_core.swapchain_views[i], nullptr);
-			vkDestroySemaphore(vulkan_core.device, vulkan_core.present_image[i], nullptr);
+			deferred_destroy_t& entry = g_vulkan_core.deferred.data[i];
+
+			if (entry.timeline_value > completed)
+			{
+				g_vulkan_core.deferred.data[kept++] = entry;
+				continue;
+			}
+
+			vkDestroyImageView(g_vulkan_core.device, entry.view, nullptr);
+			untrack_allocation(entry.allocation);
+
+			if (entry.image)
+				vmaDestroyImage(g_vulkan_core.allocator, entry.image, entry.allocation);
+			else if (entry.buffer)
+				vmaDestroyBuffer(g_vulkan_core.allocator, entry.buffer, entry.allocation);
+			else if (entry.allocation)
+				vmaFreeMemory(g_vulkan_core.allocator, entry.allocation);
 		}
-		vkDestroySwapchainKHR(vulkan_core.device, vulkan_core.swapchain, nullptr);
-		
-		vmaDestroyAllocator(vulkan_core.allocator);
-		vkDestroyDevice(vulkan_core.device, nullptr);
-		vkDestroySurfaceKHR(vulkan_core.instance, vulkan_core.surface, nullptr);
-		vkDestroyInstance(vulkan_core.instance, nullptr);
+
+		g_vulkan_core.deferred.size = kept;
 	}
 
-	void init_renderer(SDL_Window* window)
+	static void execute_frame_pass(VkCommandBuffer cmd, void* data)
 	{
-		init_vulkan_core(window);
-		init_mesh_group();
+		begin_pass((render_pass_t)(uintptr_t)data);
+		frame_draw();
+		end_pass();
 	}
 
-	void destroy_renderer()
+	static void execute_upscale_pass(VkCommandBuffer cmd, void*)
 	{
-		vkDeviceWaitIdle(vulkan_core.device);
-
-		destroy_mesh_group();
-		destroy_vulkan_core();
+		begin_pass(RENDER_PASS_UPSCALE);
+		draw_upscale(cmd, render_graph_get_view(g_vulkan_core.frame_graph, g_vulkan_core.frame_scene), g_vulkan_core.render_extent);
+		end_pass();
 	}
 
-	void recreate_swapchain()
+	static void build_frame_graph()
 	{
-		// Create VkSwapchainKHR
-		{
-			VkSurfaceFormatKHR preferred_formats[]
-			{
-				{ VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR }
-			};
+		render_graph_t& graph = g_vulkan_core.frame_graph;
 
-			uint32_t format_count{};
-			vkGetPhysicalDeviceSurfaceFormatsKHR(vulkan_core.gpu, vulkan_core.surface, &format_count, nullptr);
-			VkSurfaceFormatKHR formats[15]{};
-			vkGetPhysicalDeviceSurfaceFormatsKHR(vulkan_core.gpu, vulkan_core.surface, &format_count, formats);
+		release_render_graph(graph);
+		reset_render_graph(graph);
 
-			for (uint32_t i = 0; i < format_count; ++i)
-			{
-				for (uint32_t j = 0; j < sizeof(preferred_formats[0]) / sizeof(preferred_formats); ++j)
-				{
-					if (preferred_formats[j].format == formats[i].format &&
-						preferred_formats[j].colorSpace == formats[i].colorSpace)
-					{
-						vulkan_core.swapchain_format = preferred_formats[j];
-						break;
-					}
-				}
+		// the acquire semaphore waits at color attachment output, so the layout
+		// transition has to wait on that stage to run after the image is available
+		g_vulkan_core.frame_backbuffer = render_graph_import_image(graph, "backbuffer", VK_IMAGE_ASPECT_COLOR_BIT, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE, GRAPH_ACCESS_PRESENT, false);
 
-				if (vulkan_core.swapchain_format.format != VK_FORMAT_UNDEFINED)
-				{
-					break;
-				}
-			}
+		// shared by every frame in flight, contents never outlive the frame
+		g_vulkan_core.frame_depth = render_graph_import_image(graph, "depth", VK_IMAGE_ASPECT_DEPTH_BIT, GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE, GRAPH_ACCESS_NONE, false);
 
-			if (vulkan_core.swapchain_format.format == VK_FORMAT_UNDEFINED)
-			{
-				vulkan_core.swapchain_format = formats[0];
-			}
+		if (g_vulkan_core.depth_prepass)
+		{
+			graph_pass_t prepass = render_graph_add_pass(graph, "depth pre-pass", execute_frame_pass, (void*)(uintptr_t)RENDER_PASS_DEPTH_PREPASS);
+			render_graph_use(graph, prepass, g_vulkan_core.frame_depth, GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE);
+		}
 
-			VkSurfaceCapabilitiesKHR capabilities{};
-			vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vulkan_core.gpu, vulkan_core.surface, &capabilities);
+		// the target keeps the swapchain size, resolution changes only move the rendered corner
+		// so nothing is reallocated while the controller works
+		if (g_vulkan_core.dynamic_resolution)
+		{
+			g_vulkan_core.frame_scene = render_graph_create_image(graph, "scene", g_vulkan_core.swapchain_format.format, g_vulkan_core.swapchain_extent, VK_IMAGE_ASPECT_COLOR_BIT);
+		}
 
-			if (capabilities.currentExtent.width != UINT32_MAX)
+		const graph_resource_t color = g_vulkan_core.dynamic_resolution ? g_vulkan_core.frame_scene : g_vulkan_core.frame_backbuffer;
+
+		graph_pass_t main_pass = render_graph_add_pass(graph, "main", execute_frame_pass, (void*)(uintptr_t)RENDER_PASS_MAIN);
+		render_graph_use(graph, main_pass, color, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+		render_graph_use(graph, main_pass, g_vulkan_core.frame_depth, g_vulkan_core.depth_prepass ? GRAPH_ACCESS_DEPTH_ATTACHMENT_READ : GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE);
+
+		if (g_vulkan_core.dynamic_resolution)
+		{
+			graph_pass_t upscale_pass = render_graph_add_pass(graph, "upscale", execute_upscale_pass, nullptr);
+			render_graph_use(graph, upscale_pass, g_vulkan_core.frame_scene, GRAPH_ACCESS_SAMPLED_FRAGMENT);
+			render_graph_use(graph, upscale_pass, g_vulkan_core.frame_backbuffer, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+		}
+
+		realize_render_graph(graph);
+	}
+
+	void init_vulkan_core(SDL_Window* window)
+	{
+		if (!window)
+			return;
+
+		g_vulkan_core.window = window;
+		g_vulkan_core.vsync  = true;
+
+		job_t pipeline_cache_job{ read_pipeline_cache, nullptr };
+		run_jobs(&pipeline_cache_job, 1, &pipeline_cache_read);
+
+		// create instance
+		{
+			uint32_t span = begin_startup_span("vulkan instance");
+
+			VkApplicationInfo application_info
+			{
+				.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+				.pApplicationName = "Olivia",
+				.pEngineName = "Olivia",
+				.apiVersion = VK_API_VERSION_1_3
+			};
+
+			uint32_t sdl_extension_count;
+			char const* const* sdl_extensions = SDL_Vulkan_GetInstanceExtensions(&sdl_extension_count);
+
+			VkInstanceCreateInfo instance_info
+			{
+				.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+				.pApplicationInfo = &application_info,
+				.enabledExtensionCount = sdl_extension_count,
+				.ppEnabledExtensionNames = sdl_extensions
+			};
+
+#ifdef OLIVIA_DEBUG
+			const char* layers[]
+			{
+				"VK_LAYER_KHRONOS_validation"
+			};
+
+			instance_info.enabledLayerCount = ARRAY_SIZE(layers);
+			instance_info.ppEnabledLayerNames = layers;
+#endif // OLIVIA_DEBUG
+
+			VK_CHECK(vkCreateInstance(&instance_info, nullptr, &g_vulkan_core.instance));
+
+			end_startup_span(span);
+		}
+
+		// create surface
+		{
+			bool res = SDL_Vulkan_CreateSurface(g_vulkan_core.window, g_vulkan_core.instance, nullptr, &g_vulkan_core.surface);
+			if (!res)
+			{
+				printf("SDL_Error: %s\n", SDL_GetError());
+				abort();
+			}
+		}
+
+		// create device
+		{
+			uint32_t span = begin_startup_span("vulkan device");
+
+			select_gpu();
+
+			const char* extensions[3]
+			{
+				VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+				VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME
+			};
+			uint32_t extension_count{ 2 };
+
+			uint32_t available_extension_count{};
+			vkEnumerateDeviceExtensionProperties(g_vulkan_core.gpu, nullptr, &available_extension_count, nullptr);
+			VkExtensionProperties* available_extensions = (VkExtensionProperties*)calloc(available_extension_count, sizeof(VkExtensionProperties));
+			vkEnumerateDeviceExtensionProperties(g_vulkan_core.gpu, nullptr, &available_extension_count, available_extensions);
+
+			for (uint32_t i = 0; i < available_extension_count; ++i)
+			{
+				if (strcmp(available_extensions[i].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+				{
+					extensions[extension_count++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+					g_vulkan_core.memory_budget = true;
+				}
+			}
+
+			free(available_extensions);
+
+			VkPhysicalDeviceFeatures supported_features{};
+			vkGetPhysicalDeviceFeatures(g_vulkan_core.gpu, &supported_features);
+
+			g_vulkan_core.texture_compression_bc = supported_features.textureCompressionBC;
+
+			VkPhysicalDeviceFeatures enabled_features
+			{
+				.textureCompressionBC = supported_features.textureCompressionBC
+			};
+
+			// the frame graph transitions the depth aspect on its own, also for D32S8
+			VkPhysicalDeviceVulkan12Features features12
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+				.pNext = nullptr,
+				.separateDepthStencilLayouts = VK_TRUE,
+				.timelineSemaphore = VK_TRUE
+			};
+
+			VkPhysicalDeviceVulkan13Features features
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+				.pNext = &features12,
+				.synchronization2 = VK_TRUE,
+				.dynamicRendering = VK_TRUE
+			};
+
+			const bool async_compute = g_vulkan_core.capabilities.compute_queue_index != UINT32_MAX;
+
+			float queue_priority{ 1.0f };
+			VkDeviceQueueCreateInfo queue_info[]
+			{
+				// Graphics Queue
+				{
+					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+					.queueFamilyIndex = g_vulkan_core.graphics_queue_index,
+					.queueCount = 1,
+					.pQueuePriorities = &queue_priority
+				},
+				// Async Compute Queue
+				{
+					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+					.queueFamilyIndex = g_vulkan_core.capabilities.compute_queue_index,
+					.queueCount = 1,
+					.pQueuePriorities = &queue_priority
+				}
+			};
+
+			VkDeviceCreateInfo device_info
 			{
-				vulkan_core.swapchain_extent = capabilities.currentExtent;
+				.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+				.pNext = &features,
+				.queueCreateInfoCount = async_compute ? 2u : 1u,
+				.pQueueCreateInfos = queue_info,
+				.enabledExtensionCount = extension_count,
+				.ppEnabledExtensionNames = extensions,
+				.pEnabledFeatures = &enabled_features
+			};
+
+			VK_CHECK(vkCreateDevice(g_vulkan_core.gpu, &device_info, nullptr, &g_vulkan_core.device));
+
+			vkGetDeviceQueue(g_vulkan_core.device, g_vulkan_core.graphics_queue_index, 0, &g_vulkan_core.queue);
+
+			if (async_compute)
+			{
+				g_vulkan_core.compute_queue_index = g_vulkan_core.capabilities.compute_queue_index;
+				vkGetDeviceQueue(g_vulkan_core.device, g_vulkan_core.compute_queue_index, 0, &g_vulkan_core.compute_queue);
 			}
 			else
 			{
-				int width, height;
-				SDL_GetWindowSizeInPixels(vulkan_core.window, &width, &height);
-				vulkan_core.swapchain_extent = { (uint32_t)width, (uint32_t)height };
-				SDL_clamp(vulkan_core.swapchain_extent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
-				SDL_clamp(vulkan_core.swapchain_extent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+				g_vulkan_core.compute_queue_index = g_vulkan_core.graphics_queue_index;
+				g_vulkan_core.compute_queue       = g_vulkan_core.queue;
 			}
 
-			uint32_t min_image_count = capabilities.minImageCount > 2 ? capabilities.minImageCount : 2;
+			g_vulkan_core.async_compute = async_compute;
 
-			VkPresentModeKHR presentation_mode = VK_PRESENT_MODE_FIFO_KHR;
+			end_startup_span(span);
+		}
 
-			VkSwapchainCreateInfoKHR swapchain_info
+		// create allocator
+		{
+			uint32_t span = begin_startup_span("vulkan allocator");
+
+			VmaAllocatorCreateInfo vma_info
 			{
-				.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-				.surface = vulkan_core.surface,
-				.minImageCount = min_image_count,
-				.imageFormat = vulkan_core.swapchain_format.format,
-				.imageColorSpace = vulkan_core.swapchain_format.colorSpace,
-				.imageExtent = vulkan_core.swapchain_extent,
-				.imageArrayLayers = 1,
-				.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-				.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
-				.preTransform = capabilities.currentTransform,
-				.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-				.presentMode = presentation_mode,
-				.oldSwapchain = VK_NULL_HANDLE,
+				.physicalDevice = g_vulkan_core.gpu,
+				.device = g_vulkan_core.device,
+				.instance = g_vulkan_core.instance,
+				.vulkanApiVersion = VK_API_VERSION_1_3
+			};
+
+			if (g_vulkan_core.memory_budget)
+			{
+				vma_info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+			}
+
+			VK_CHECK(vmaCreateAllocator(&vma_info, &g_vulkan_core.allocator));
+
+			init_memory_telemetry();
+
+			end_startup_span(span);
+		}
+
+		// create command_pool
+		{
+			VkCommandPoolCreateInfo command_pool_info
+			{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+				.queueFamilyIndex = g_vulkan_core.graphics_queue_index
 			};
 
-			VK_CHECK(vkCreateSwapchainKHR(vulkan_core.device, &swapchain_info, nullptr, &vulkan_core.swapchain));
+			VK_CHECK(vkCreateCommandPool(g_vulkan_core.device, &command_pool_info, nullptr, &g_vulkan_core.command_pool));
+
+			command_pool_info.queueFamilyIndex = g_vulkan_core.compute_queue_index;
+
+			VK_CHECK(vkCreateCommandPool(g_vulkan_core.device, &command_pool_info, nullptr, &g_vulkan_core.compute_command_pool));
 		}
 
-		// Swapchain VkImages
+		// create swapchain & attachments
 		{
-			vkGetSwapchainImagesKHR(vulkan_core.device, vulkan_core.swapchain, &vulkan_core.swapchain_size, nullptr);
-			vkGetSwapchainImagesKHR(vulkan_core.device, vulkan_core.swapchain, &vulkan_core.swapchain_size, vulkan_core.swapchain_images);
+			uint32_t span = begin_startup_span("vulkan swapchain");
+
+			VkFormatProperties format_properties{};
+			vkGetPhysicalDeviceFormatProperties(g_vulkan_core.gpu, VK_FORMAT_D32_SFLOAT, &format_properties);
+
+			g_vulkan_core.depth_format = (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+				? VK_FORMAT_D32_SFLOAT
+				: VK_FORMAT_D32_SFLOAT_S8_UINT;
+
+			create_swapchain(VK_NULL_HANDLE);
+			create_depth_attachment();
+
+			end_startup_span(span);
 		}
 
-		// Swapchain VkImageViews
+		// allocate command buffers
 		{
-			for (uint32_t i = 0; i < vulkan_core.swapchain_size; ++i)
+			VkCommandBufferAllocateInfo command_buffer_info
 			{
-				VkImageViewCreateInfo image_view_info
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = g_vulkan_core.command_pool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = MAX_FRAMES
+			};
+
+			VK_CHECK(vkAllocateCommandBuffers(g_vulkan_core.device, &command_buffer_info, g_vulkan_core.command_buffers));
+
+			command_buffer_info.commandPool = g_vulkan_core.compute_command_pool;
+
+			VK_CHECK(vkAllocateCommandBuffers(g_vulkan_core.device, &command_buffer_info, g_vulkan_core.compute_command_buffers));
+		}
+
+		// create semaphores
+		{
+			VkSemaphoreCreateInfo semaphore_info
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+			};
+
+			VkSemaphoreTypeCreateInfo timeline_type_info
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+				.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+				.initialValue = 0
+			};
+
+			VkSemaphoreCreateInfo timeline_info
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+				.pNext = &timeline_type_info
+			};
+
+			VK_CHECK(vkCreateSemaphore(g_vulkan_core.device, &timeline_info, nullptr, &g_vulkan_core.timeline));
+			VK_CHECK(vkCreateSemaphore(g_vulkan_core.device, &timeline_info, nullptr, &g_vulkan_core.compute_timeline));
+
+			g_vulkan_core.deferred = create_vector<deferred_destroy_t>(DEFERRED_DESTROY_CAPACITY);
+
+			for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+			{
+				VK_CHECK(vkCreateSemaphore(g_vulkan_core.device, &semaphore_info, nullptr, &g_vulkan_core.acquire_image[i]));
+			}
+
+			for (uint32_t i = 0; i < g_vulkan_core.swapchain_size; ++i)
+			{
+				VK_CHECK(vkCreateSemaphore(g_vulkan_core.device, &semaphore_info, nullptr, &g_vulkan_core.present_image[i]));
+			}
+		}
+
+		// create timestamp queries
+		{
+			uint32_t queue_family_count{};
+			vkGetPhysicalDeviceQueueFamilyProperties(g_vulkan_core.gpu, &queue_family_count, nullptr);
+
+			VkQueueFamilyProperties* queue_families = (VkQueueFamilyProperties*)calloc(queue_family_count, sizeof(VkQueueFamilyProperties));
+			vkGetPhysicalDeviceQueueFamilyProperties(g_vulkan_core.gpu, &queue_family_count, queue_families);
+
+			bool timestamps_supported = queue_families[g_vulkan_core.graphics_queue_index].timestampValidBits != 0;
+
+			free(queue_families);
+
+			if (timestamps_supported)
+			{
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties(g_vulkan_core.gpu, &properties);
+
+				g_vulkan_core.timestamp_period = properties.limits.timestampPeriod;
+
+				VkQueryPoolCreateInfo query_pool_info
 				{
-					.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-					.image = vulkan_core.swapchain_images[i],
-					.viewType = VK_IMAGE_VIEW_TYPE_2D,
-					.format = vulkan_core.swapchain_format.format,
-					.components
-					{
-						VK_COMPONENT_SWIZZLE_IDENTITY,
-						VK_COMPONENT_SWIZZLE_IDENTITY,
-						VK_COMPONENT_SWIZZLE_IDENTITY,
-						VK_COMPONENT_SWIZZLE_IDENTITY
-					},
-					.subresourceRange
-					{
-						.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-						.baseMipLevel = 0,
-						.levelCount = 1,
-						.baseArrayLayer = 0,
-						.layerCount = 1
-					}
+					.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+					.queryType = VK_QUERY_TYPE_TIMESTAMP,
+					.queryCount = TIMESTAMPS_PER_FRAME * MAX_FRAMES
 				};
 
-				VK_CHECK(vkCreateImageView(vulkan_core.device, &image_view_info, nullptr, &vulkan_core.swapchain_views[i]));
-			}
-		}
+				VK_CHECK(vkCreateQueryPool(g_vulkan_core.device, &query_pool_info, nullptr, &g_vulkan_core.timestamp_pool));
+			}
+		}
+
+		// create pipeline cache
+		{
+			uint32_t span = begin_startup_span("pipeline cache");
+
+			create_pipeline_cache();
+
+			end_startup_span(span);
+		}
+
+		g_vulkan_core.resolution    = create_dynamic_resolution(DEFAULT_FRAME_TIME_TARGET_MS);
+		g_vulkan_core.render_extent = g_vulkan_core.swapchain_extent;
+
+		for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+		{
+			g_vulkan_core.frame_render_scale[i] = 1.0f;
+		}
+
+		build_frame_graph();
+	}
+
+	void destroy_vulkan_core()
+	{
+		release_render_graph(g_vulkan_core.frame_graph);
+
+		write_pipeline_cache();
+		vkDestroyPipelineCache(g_vulkan_core.device, g_vulkan_core.pipeline_cache, nullptr);
+
+		vkDestroyQueryPool(g_vulkan_core.device, g_vulkan_core.timestamp_pool, nullptr);
+		vkDestroyCommandPool(g_vulkan_core.device, g_vulkan_core.command_pool, nullptr);
+		vkDestroyCommandPool(g_vulkan_core.device, g_vulkan_core.compute_command_pool, nullptr);
+
+		destroy_depth_attachment();
+
+		// the device is idle, everything still queued can go
+		release_deferred(UINT64_MAX);
+		destroy_vector(g_vulkan_core.deferred);
+
+		vkDestroySemaphore(g_vulkan_core.device, g_vulkan_core.timeline, nullptr);
+		vkDestroySemaphore(g_vulkan_core.device, g_vulkan_core.compute_timeline, nullptr);
+
+		for (uint32_t i = 0; i < MAX_FRAMES; ++i)
+		{
+			vkDestroySemaphore(g_vulkan_core.device, g_vulkan_core.acquire_image[i], nullptr);
+		}
+
+		for (uint32_t i = 0; i < g_vulkan_core.swapchain_size; ++i)
+		{
+			vkDestroyImageView(g_vulkan_core.device, g_vulkan_core.swapchain_views[i], nullptr);
+			vkDestroySemaphore(g_vulkan_core.device, g_vulkan_core.present_image[i], nullptr);
+		}
+		vkDestroySwapchainKHR(g_vulkan_core.device, g_vulkan_core.swapchain, nullptr);
+
+		destroy_memory_telemetry();
+		vmaDestroyAllocator(g_vulkan_core.allocator);
+		vkDestroyDevice(g_vulkan_core.device, nullptr);
+		vkDestroySurfaceKHR(g_vulkan_core.instance, g_vulkan_core.surface, nullptr);
+		vkDestroyInstance(g_vulkan_core.instance, nullptr);
+	}
+
+	void init_renderer(SDL_Window* window)
+	{
+		init_vulkan_core(window);
+
+		uint32_t span = begin_startup_span("renderer resources");
+
+		init_mesh_group();
+		init_texture_streamer(0);
+		init_skinning();
+		init_upscaler();
+		init_lighting();
+
+		end_startup_span(span);
+	}
+
+	void destroy_renderer()
+	{
+		vkDeviceWaitIdle(g_vulkan_core.device);
+
+		destroy_particles();
+		destroy_lighting();
+		destroy_upscaler();
+		destroy_skinning();
+		destroy_texture_streamer();
+		destroy_mesh_group();
+		destroy_vulkan_core();
+	}
+
+	void recreate_swapchain()
+	{
+		vkDeviceWaitIdle(g_vulkan_core.device);
+
+		for (uint32_t i = 0; i < g_vulkan_core.swapchain_size; ++i)
+		{
+			vkDestroyImageView(g_vulkan_core.device, g_vulkan_core.swapchain_views[i], nullptr);
+		}
+
+		destroy_depth_attachment();
+
+		VkSwapchainKHR old_swapchain = g_vulkan_core.swapchain;
+
+		create_swapchain(old_swapchain);
+		create_depth_attachment();
+
+		vkDestroySwapchainKHR(g_vulkan_core.device, old_swapchain, nullptr);
+
+		// transients are sized from the swapchain
+		build_frame_graph();
+	}
+
+	// returns false when the frame slot had nothing measured
+	static bool read_gpu_timings()
+	{
+		const uint32_t frame = g_vulkan_core.current_frame;
+
+		uint64_t first = UINT64_MAX;
+		uint64_t last  = 0;
+
+		for (uint32_t pass = 0; pass < RENDER_PASS_COUNT; ++pass)
+		{
+			if (!(g_vulkan_core.timestamp_mask[frame] & (1u << pass)))
+				continue;
+
+			uint64_t timestamps[2]{};
+			VkResult result = vkGetQueryPoolResults(
+				g_vulkan_core.device,
+				g_vulkan_core.timestamp_pool,
+				frame * TIMESTAMPS_PER_FRAME + pass * 2, 2,
+				sizeof(timestamps), timestamps, sizeof(uint64_t),
+				VK_QUERY_RESULT_64_BIT);
+
+			if (result == VK_SUCCESS)
+			{
+				g_vulkan_core.gpu_pass_ms[pass] = (float)((double)(timestamps[1] - timestamps[0]) * g_vulkan_core.timestamp_period * 1e-6);
+
+				first = SDL_min(first, timestamps[0]);
+				last  = SDL_max(last, timestamps[1]);
+			}
+		}
+
+		g_vulkan_core.timestamp_mask[frame] = 0;
+
+		if (first >= last)
+			return false;
+
+		// the barriers between the passes count too
+		g_vulkan_core.gpu_frame_ms = (float)((double)(last - first) * g_vulkan_core.timestamp_period * 1e-6);
+
+		return true;
+	}
+
+	// picks the scale the frame about to be recorded renders at
+	static void update_render_scale(bool measured)
+	{
+		const uint32_t frame = g_vulkan_core.current_frame;
+
+		float scale = 1.0f;
+
+		if (g_vulkan_core.dynamic_resolution)
+		{
+			// the timings just read are of the frame this slot last rendered, at its own scale
+			if (measured)
+			{
+				update_dynamic_resolution(g_vulkan_core.resolution, g_vulkan_core.gpu_frame_ms, g_vulkan_core.frame_render_scale[frame]);
+			}
+
+			scale = g_vulkan_core.fixed_render_scale > 0.0f ? g_vulkan_core.fixed_render_scale : g_vulkan_core.resolution.scale;
+		}
+
+		g_vulkan_core.frame_render_scale[frame] = scale;
+
+		const VkExtent2D extent = g_vulkan_core.swapchain_extent;
+		scale_extent(extent.width, extent.height, scale, g_vulkan_core.render_extent.width, g_vulkan_core.render_extent.height);
+	}
+
+	// records the jobs scheduled since the last frame, the graphics submit in end_frame waits
+	// for them at the stages that consume their results
+	static void submit_compute_jobs(VkCommandBuffer graphics_cmd)
+	{
+		g_vulkan_core.compute_wait_stages = 0;
+
+		if (g_vulkan_core.compute_job_count == 0)
+			return;
+
+		VkPipelineStageFlags2 consumer_stages{};
+		for (uint32_t i = 0; i < g_vulkan_core.compute_job_count; ++i)
+		{
+			consumer_stages |= g_vulkan_core.compute_jobs[i].consumer_stages;
+		}
+
+		if (!g_vulkan_core.async_compute)
+		{
+			for (uint32_t i = 0; i < g_vulkan_core.compute_job_count; ++i)
+			{
+				g_vulkan_core.compute_jobs[i].record(graphics_cmd, g_vulkan_core.compute_jobs[i].data);
+			}
+
+			VkMemoryBarrier2 barrier
+			{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+				.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+				.dstStageMask = consumer_stages,
+				.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT
+			};
+
+			VkDependencyInfo dependency_info
+			{
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.memoryBarrierCount = 1,
+				.pMemoryBarriers = &barrier
+			};
+
+			vkCmdPipelineBarrier2(graphics_cmd, &dependency_info);
+
+			g_vulkan_core.compute_job_count = 0;
+			return;
+		}
+
+		// the graphics submit that last used this slot waited for its compute submit, so
+		// the command buffer is free once begin_frame's timeline wait returned
+		VkCommandBuffer cmd = g_vulkan_core.compute_command_buffers[g_vulkan_core.current_frame];
+
+		vkResetCommandBuffer(cmd, 0);
+		VkCommandBufferBeginInfo cmd_begin = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		vkBeginCommandBuffer(cmd, &cmd_begin);
+
+		for (uint32_t i = 0; i < g_vulkan_core.compute_job_count; ++i)
+		{
+			g_vulkan_core.compute_jobs[i].record(cmd, g_vulkan_core.compute_jobs[i].data);
+		}
+
+		vkEndCommandBuffer(cmd);
+
+		VkSemaphoreSubmitInfo signal_info
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = g_vulkan_core.compute_timeline,
+			.value = ++g_vulkan_core.compute_timeline_value,
+			.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+		};
+
+		VkCommandBufferSubmitInfo command_buffer_info
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+			.commandBuffer = cmd
+		};
+
+		VkSubmitInfo2 submit_info
+		{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+			.commandBufferInfoCount = 1,
+			.pCommandBufferInfos = &command_buffer_info,
+			.signalSemaphoreInfoCount = 1,
+			.pSignalSemaphoreInfos = &signal_info
+		};
+
+		VK_CHECK(vkQueueSubmit2(g_vulkan_core.compute_queue, 1, &submit_info, VK_NULL_HANDLE));
+
+		g_vulkan_core.compute_wait_stages = consumer_stages;
+		g_vulkan_core.compute_job_count   = 0;
 	}
 
-	void begin_frame()
+	bool begin_frame()
 	{
-		vkWaitForFences(vulkan_core.device, 1, &vulkan_core.queue_submit[vulkan_core.current_frame], VK_TRUE, UINT64_MAX);
-		vkResetFences(vulkan_core.device, 1, &vulkan_core.queue_submit[vulkan_core.current_frame]);
+		VkCommandBuffer cmd = g_vulkan_core.command_buffers[g_vulkan_core.current_frame];
+
+		// changed shaders are reloaded while the device is idle, before the frame records anything
+		poll_shader_reload();
+
+		// only the submit that last used this frame slot has to be done, the
+		// other frames in flight keep running while this one is recorded
+		uint64_t wait_start = SDL_GetPerformanceCounter();
+
+		wait_timeline_value(g_vulkan_core.frame_timeline[g_vulkan_core.current_frame]);
 
-		VkResult acquire_result = vkAcquireNextImageKHR(vulkan_core.device, vulkan_core.swapchain, UINT64_MAX, vulkan_core.acquire_image[vulkan_core.current_frame], VK_NULL_HANDLE, &vulkan_core.image_index);
-		if (acquire_result == VK_ERROR_OUT_OF_DATE_KHR || acquire_result == VK_SUBOPTIMAL_KHR)
+		g_vulkan_core.gpu_wait_ms = (float)((double)(SDL_GetPerformanceCounter() - wait_start) * 1000.0 / (double)SDL_GetPerformanceFrequency());
+
+		release_deferred(get_completed_timeline_value());
+		update_render_scale(read_gpu_timings());
+
+		// before update_textures, streaming reads the refreshed budget
+		update_memory_budget();
+
+		uint64_t acquire_start = SDL_GetPerformanceCounter();
+
+		VkResult acquire_result = vkAcquireNextImageKHR(g_vulkan_core.device, g_vulkan_core.swapchain, UINT64_MAX, g_vulkan_core.acquire_image[g_vulkan_core.current_frame], VK_NULL_HANDLE, &g_vulkan_core.image_index);
+		if (acquire_result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
 			printf("Recreating swapchain\n");
 			recreate_swapchain();
-			return;
+
+			// the next update schedules them again
+			g_vulkan_core.compute_job_count = 0;
+			return false;
 		}
-		else if (acquire_result != VK_SUCCESS)
+		else if (acquire_result != VK_SUCCESS && acquire_result != VK_SUBOPTIMAL_KHR)
 		{
 			printf("Failed to acquire next image\n");
 			abort();
 		}
 
-		vkResetCommandBuffer(vulkan_core.command_buffers[vulkan_core.current_frame], 0);
+		g_vulkan_core.acquire_wait_ms = (float)((double)(SDL_GetPerformanceCounter() - acquire_start) * 1000.0 / (double)SDL_GetPerformanceFrequency());
+
+		vkResetCommandBuffer(cmd, 0);
 		VkCommandBufferBeginInfo cmd_begin = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
-		vkBeginCommandBuffer(vulkan_core.command_buffers[vulkan_core.current_frame], &cmd_begin);
-
-		VkImageMemoryBarrier image_barrier_write
-		{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			.srcAccessMask = VK_PIPELINE_STAGE_NONE,
-			.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-			.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.image = vulkan_core.swapchain_images[vulkan_core.image_index],
-			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
-		};
+		vkBeginCommandBuffer(cmd, &cmd_begin);
+
+		if (g_vulkan_core.timestamp_pool)
+		{
+			vkCmdResetQueryPool(cmd, g_vulkan_core.timestamp_pool, g_vulkan_core.current_frame * TIMESTAMPS_PER_FRAME, TIMESTAMPS_PER_FRAME);
+		}
+
+		update_textures(cmd);
+
+		submit_compute_jobs(cmd);
+
+		return true;
+	}
+
+	void draw_frame(frame_draw_function draw)
+	{
+		render_graph_t& graph = g_vulkan_core.frame_graph;
+
+		render_graph_set_image(graph, g_vulkan_core.frame_backbuffer, g_vulkan_core.swapchain_images[g_vulkan_core.image_index], g_vulkan_core.swapchain_views[g_vulkan_core.image_index]);
+		render_graph_set_image(graph, g_vulkan_core.frame_depth, g_vulkan_core.depth_image, g_vulkan_core.depth_view);
+
+		frame_draw = draw;
+
+		execute_render_graph(graph, g_vulkan_core.command_buffers[g_vulkan_core.current_frame]);
+	}
+
+	void begin_pass(render_pass_t pass)
+	{
+		VkCommandBuffer cmd = g_vulkan_core.command_buffers[g_vulkan_core.current_frame];
+
+		g_vulkan_core.current_pass = pass;
 
-		vkCmdPipelineBarrier(
-			vulkan_core.command_buffers[vulkan_core.current_frame],
-			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &image_barrier_write);
+		const bool depth_from_prepass = pass == RENDER_PASS_MAIN && g_vulkan_core.depth_prepass;
+		const bool upscale            = pass == RENDER_PASS_UPSCALE;
+
+		// scene passes render into the corner of the offscreen target with dynamic resolution
+		const VkExtent2D  extent = upscale ? g_vulkan_core.swapchain_extent : g_vulkan_core.render_extent;
+		const VkImageView target = g_vulkan_core.dynamic_resolution && !upscale
+			? render_graph_get_view(g_vulkan_core.frame_graph, g_vulkan_core.frame_scene)
+			: g_vulkan_core.swapchain_views[g_vulkan_core.image_index];
+
+		if (g_vulkan_core.timestamp_pool)
+		{
+			vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, g_vulkan_core.timestamp_pool, g_vulkan_core.current_frame * TIMESTAMPS_PER_FRAME + pass * 2);
+		}
 
 		VkRenderingAttachmentInfo color_attachment
 		{
 			.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-			.imageView = vulkan_core.swapchain_views[vulkan_core.image_index],
+			.imageView = target,
 			.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-			.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.loadOp = upscale ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_CLEAR,
 			.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
 			.clearValue = {{0.0f, 0.0f, 0.0f, 0.0f}}
 		};
 
+		VkRenderingAttachmentInfo depth_attachment
+		{
+			.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+			.imageView = g_vulkan_core.depth_view,
+			.imageLayout = depth_from_prepass ? VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+			.loadOp = depth_from_prepass ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.storeOp = pass == RENDER_PASS_DEPTH_PREPASS ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.clearValue = { .depthStencil = { DEPTH_CLEAR_VALUE, 0 } }
+		};
+
 		VkRect2D render_area
 		{
 			.offset = { 0 },
-			.extent = vulkan_core.swapchain_extent
+			.extent = extent
 		};
 
 		VkRenderingInfo render_info
@@ -544,16 +1298,17 @@ namespace olivia
 			.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
 			.renderArea = render_area,
 			.layerCount = 1,
-			.colorAttachmentCount = 1,
+			.colorAttachmentCount = pass == RENDER_PASS_DEPTH_PREPASS ? 0u : 1u,
 			.pColorAttachments = &color_attachment,
+			.pDepthAttachment = upscale ? nullptr : &depth_attachment
 		};
 
-		vkCmdBeginRendering(vulkan_core.command_buffers[vulkan_core.current_frame], &render_info);
+		vkCmdBeginRendering(cmd, &render_info);
 
 		VkViewport viewport
 		{
-			.width = (float)vulkan_core.swapchain_extent.width,
-			.height = (float)vulkan_core.swapchain_extent.height,
+			.width = (float)extent.width,
+			.height = (float)extent.height,
 			.minDepth = 0.0f,
 			.maxDepth = 1.0f
 		};
@@ -561,59 +1316,94 @@ namespace olivia
 		VkRect2D scissor
 		{
 			.offset = {0, 0},
-			.extent = vulkan_core.swapchain_extent
+			.extent = extent
 		};
 
-		vkCmdSetViewport(vulkan_core.command_buffers[vulkan_core.current_frame], 0, 1, &viewport);
-		vkCmdSetScissor(vulkan_core.command_buffers[vulkan_core.current_frame], 0, 1, &scissor);
+		vkCmdSetViewport(cmd, 0, 1, &viewport);
+		vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+		if (upscale)
+			return;
+
+		// after a pre-pass only the front-most surface passes, so the main pass shades each pixel once
+		vkCmdSetDepthTestEnable(cmd, VK_TRUE);
+		vkCmdSetDepthWriteEnable(cmd, depth_from_prepass ? VK_FALSE : VK_TRUE);
+		vkCmdSetDepthCompareOp(cmd, depth_from_prepass ? VK_COMPARE_OP_EQUAL : DEPTH_COMPARE_OP);
+	}
+
+	void end_pass()
+	{
+		VkCommandBuffer cmd = g_vulkan_core.command_buffers[g_vulkan_core.current_frame];
+
+		vkCmdEndRendering(cmd);
+
+		if (g_vulkan_core.timestamp_pool)
+		{
+			vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, g_vulkan_core.timestamp_pool, g_vulkan_core.current_frame * TIMESTAMPS_PER_FRAME + g_vulkan_core.current_pass * 2 + 1);
+			g_vulkan_core.timestamp_mask[g_vulkan_core.current_frame] |= 1u << g_vulkan_core.current_pass;
+		}
 	}
 
 	void end_frame()
 	{
-		vkCmdEndRendering(vulkan_core.command_buffers[vulkan_core.current_frame]);
+		vkEndCommandBuffer(g_vulkan_core.command_buffers[g_vulkan_core.current_frame]);
 
-		VkImageMemoryBarrier image_barrier_present
+		const uint64_t signal_value = ++g_vulkan_core.timeline_value;
+
+		VkSemaphoreSubmitInfo wait_infos[]
 		{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-			.dstAccessMask = 0,
-			.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-			.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.image = vulkan_core.swapchain_images[vulkan_core.image_index],
-			.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = g_vulkan_core.acquire_image[g_vulkan_core.current_frame],
+				.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT
+			},
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = g_vulkan_core.compute_timeline,
+				.value = g_vulkan_core.compute_timeline_value,
+				.stageMask = g_vulkan_core.compute_wait_stages
+			}
 		};
 
-		vkCmdPipelineBarrier(
-			vulkan_core.command_buffers[vulkan_core.current_frame],
-			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &image_barrier_present);
-
-		vkEndCommandBuffer(vulkan_core.command_buffers[vulkan_core.current_frame]);
+		VkSemaphoreSubmitInfo signal_infos[]
+		{
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = g_vulkan_core.timeline,
+				.value = signal_value,
+				.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+			},
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = g_vulkan_core.present_image[g_vulkan_core.image_index],
+				.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+			}
+		};
 
-		VkPipelineStageFlags wait_stages[]{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		VkSemaphore wait_semaphores[]{ vulkan_core.acquire_image[vulkan_core.current_frame] };
-		VkSemaphore signal_semaphores[]{ vulkan_core.present_image[vulkan_core.current_frame] };
+		VkCommandBufferSubmitInfo command_buffer_info
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+			.commandBuffer = g_vulkan_core.command_buffers[g_vulkan_core.current_frame]
+		};
 
-		VkSubmitInfo submit_info
+		VkSubmitInfo2 submit_info
 		{
-			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.waitSemaphoreCount = 1,
-			.pWaitSemaphores = wait_semaphores,
-			.pWaitDstStageMask = wait_stages,
-			.commandBufferCount = 1,
-			.pCommandBuffers = &vulkan_core.command_buffers[vulkan_core.current_frame],
-			.signalSemaphoreCount = 1,
-			.pSignalSemaphores = signal_semaphores
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+			.waitSemaphoreInfoCount = g_vulkan_core.compute_wait_stages ? 2u : 1u,
+			.pWaitSemaphoreInfos = wait_infos,
+			.commandBufferInfoCount = 1,
+			.pCommandBufferInfos = &command_buffer_info,
+			.signalSemaphoreInfoCount = ARRAY_SIZE(signal_infos),
+			.pSignalSemaphoreInfos = signal_infos
 		};
 
-		vkQueueSubmit(vulkan_core.queue, 1, &submit_info, vulkan_core.queue_submit[vulkan_core.current_frame]);
+		VK_CHECK(vkQueueSubmit2(g_vulkan_core.queue, 1, &submit_info, VK_NULL_HANDLE));
+
+		g_vulkan_core.frame_timeline[g_vulkan_core.current_frame] = signal_value;
 
-		VkSwapchainKHR swapchains[]{ vulkan_core.swapchain };
+		VkSemaphore signal_semaphores[]{ g_vulkan_core.present_image[g_vulkan_core.image_index] };
+
+		VkSwapchainKHR swapchains[]{ g_vulkan_core.swapchain };
 
 		VkPresentInfoKHR present_info
 		{
@@ -622,26 +1412,199 @@ namespace olivia
 			.pWaitSemaphores = signal_semaphores,
 			.swapchainCount = 1,
 			.pSwapchains = swapchains,
-			.pImageIndices = &vulkan_core.image_index
+			.pImageIndices = &g_vulkan_core.image_index
 		};
 
-		VkResult present_result = vkQueuePresentKHR(vulkan_core.queue, &present_info);
+		VkResult present_result = vkQueuePresentKHR(g_vulkan_core.queue, &present_info);
+
+		// the submit went through either way, so the frame slot has to advance
+		g_vulkan_core.current_frame = (g_vulkan_core.current_frame + 1) % MAX_FRAMES;
+
 		if (present_result == VK_ERROR_OUT_OF_DATE_KHR || present_result == VK_SUBOPTIMAL_KHR)
 		{
 			printf("recreating swapchain\n");
 			recreate_swapchain();
-			return;
 		}
 		else if (present_result != VK_SUCCESS)
 		{
 			printf("Failed to present image\n");
+		}
+	}
+
+	void set_depth_prepass(bool enabled)
+	{
+		if (g_vulkan_core.depth_prepass == enabled)
+			return;
+
+		// switching between a transient and a stored depth attachment, frames
+		// in flight keep rendering to the old one
+		defer_destroy_image(g_vulkan_core.depth_image, g_vulkan_core.depth_view, g_vulkan_core.depth_allocation);
+		g_vulkan_core.depth_prepass = enabled;
+		create_depth_attachment();
+
+		build_frame_graph();
+	}
+
+	bool is_depth_prepass_enabled()
+	{
+		return g_vulkan_core.depth_prepass;
+	}
+
+	void set_vsync(bool enabled)
+	{
+		if (g_vulkan_core.vsync == enabled)
+			return;
+
+		g_vulkan_core.vsync = enabled;
+		recreate_swapchain();
+	}
+
+	void set_dynamic_resolution(bool enabled)
+	{
+		if (g_vulkan_core.dynamic_resolution == enabled)
+			return;
+
+		if (enabled && !is_upscaler_ready())
+		{
+			LOG_WARN(TAG_RENDERER, "upscale shaders missing, dynamic resolution stays off");
+			return;
+		}
+
+		if (enabled && !g_vulkan_core.timestamp_pool)
+		{
+			LOG_WARN(TAG_RENDERER, "no timestamp queries, the render scale only changes through set_fixed_render_scale");
+		}
+
+		// frames in flight keep the graph they were recorded with, the release is deferred
+		g_vulkan_core.dynamic_resolution = enabled;
+		build_frame_graph();
+	}
+
+	bool is_dynamic_resolution_enabled()
+	{
+		return g_vulkan_core.dynamic_resolution;
+	}
+
+	void set_dynamic_resolution_target(float target_ms, float min_scale, float max_scale)
+	{
+		g_vulkan_core.resolution = create_dynamic_resolution(target_ms, min_scale, max_scale);
+	}
+
+	void set_fixed_render_scale(float scale)
+	{
+		assert(scale >= 0.0f && scale <= 1.0f && "render scale out of range");
+
+		g_vulkan_core.fixed_render_scale = scale;
+	}
+
+	float get_render_scale()
+	{
+		return g_vulkan_core.frame_render_scale[g_vulkan_core.current_frame];
+	}
+
+	VkExtent2D get_render_extent()
+	{
+		return g_vulkan_core.render_extent;
+	}
+
+	void schedule_compute(compute_record_function record, void* data, VkPipelineStageFlags2 consumer_stages)
+	{
+		assert(record && consumer_stages && "compute job without a consumer");
+		assert(g_vulkan_core.compute_job_count < MAX_COMPUTE_JOBS && "too many compute jobs scheduled");
+
+		g_vulkan_core.compute_jobs[g_vulkan_core.compute_job_count++] = { record, data, consumer_stages };
+	}
+
+	void set_async_compute(bool enabled)
+	{
+		if (enabled && g_vulkan_core.compute_queue == g_vulkan_core.queue)
+		{
+			LOG_WARN(TAG_RENDERER, "no compute-only queue family, compute stays on the graphics queue");
 			return;
 		}
 
-		vulkan_core.current_frame = (vulkan_core.current_frame + 1) % MAX_FRAMES;
+		g_vulkan_core.async_compute = enabled;
+	}
+
+	bool is_async_compute_enabled()
+	{
+		return g_vulkan_core.async_compute;
+	}
+
+	uint32_t get_shared_queue_families(uint32_t families[2])
+	{
+		families[0] = g_vulkan_core.graphics_queue_index;
+		families[1] = g_vulkan_core.compute_queue_index;
+
+		return families[0] == families[1] ? 1 : 2;
+	}
+
+	float get_gpu_pass_time(render_pass_t pass)
+	{
+		return g_vulkan_core.gpu_pass_ms[pass];
+	}
+
+	float get_gpu_frame_time()
+	{
+		return g_vulkan_core.gpu_frame_ms;
+	}
+
+	float get_gpu_wait_time()
+	{
+		return g_vulkan_core.gpu_wait_ms;
+	}
+
+	float get_acquire_wait_time()
+	{
+		return g_vulkan_core.acquire_wait_ms;
+	}
+
+	uint64_t get_frame_timeline_value()
+	{
+		return g_vulkan_core.timeline_value + 1;
+	}
+
+	uint64_t get_completed_timeline_value()
+	{
+		uint64_t value{};
+		VK_CHECK(vkGetSemaphoreCounterValue(g_vulkan_core.device, g_vulkan_core.timeline, &value));
+
+		return value;
+	}
+
+	void wait_timeline_value(uint64_t value)
+	{
+		if (get_completed_timeline_value() >= value)
+			return;
+
+		VkSemaphoreWaitInfo wait_info
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores = &g_vulkan_core.timeline,
+			.pValues = &value
+		};
+
+		VK_CHECK(vkWaitSemaphores(g_vulkan_core.device, &wait_info, UINT64_MAX));
+	}
+
+	static void push_deferred(const deferred_destroy_t& entry)
+	{
+		// entries of the frame being recorded cannot be released before its submit, grow instead
+		vector_push_back(g_vulkan_core.deferred, entry);
+	}
+
+	void defer_destroy_image(VkImage image, VkImageView view, VmaAllocation allocation)
+	{
+		push_deferred({ get_frame_timeline_value(), image, view, VK_NULL_HANDLE, allocation });
+	}
+
+	void defer_destroy_buffer(VkBuffer buffer, VmaAllocation allocation)
+	{
+		push_deferred({ get_frame_timeline_value(), VK_NULL_HANDLE, VK_NULL_HANDLE, buffer, allocation });
 	}
 
-	vulkan_buffer_t create_vulkan_buffer(VkBufferUsageFlags usage_flags, VmaMemoryUsage memory_usage, VmaAllocationCreateFlags allocation_flags, VkDeviceSize size)
+	vulkan_buffer_t create_vulkan_buffer(memory_category_t category, VkBufferUsageFlags usage_flags, VmaMemoryUsage memory_usage, VmaAllocationCreateFlags allocation_flags, VkDeviceSize size, bool shared)
 	{
 		VkBufferCreateInfo buffer_create_info
 		{
@@ -650,6 +1613,14 @@ namespace olivia
 			.usage = usage_flags
 		};
 
+		uint32_t families[2];
+		if (shared && get_shared_queue_families(families) > 1)
+		{
+			buffer_create_info.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+			buffer_create_info.queueFamilyIndexCount = 2;
+			buffer_create_info.pQueueFamilyIndices   = families;
+		}
+
 		VmaAllocationCreateInfo allocation_create_info
 		{
 			.flags = allocation_flags,
@@ -657,38 +1628,75 @@ namespace olivia
 		};
 
 		vulkan_buffer_t buffer{};
-		VK_CHECK(vmaCreateBuffer(vulkan_core.allocator, &buffer_create_info, &allocation_create_info, &buffer.buffer, &buffer.allocation, &buffer.info));
+		VkResult result = vmaCreateBuffer(g_vulkan_core.allocator, &buffer_create_info, &allocation_create_info, &buffer.buffer, &buffer.allocation, &buffer.info);
+
+		// evictors that release right away and every deferred destroy, once the gpu is
+		// idle, make room for one more try
+		if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+		{
+			report_allocation_failure(category, size);
+			request_memory_eviction(size);
+
+			wait_timeline_value(g_vulkan_core.timeline_value);
+			release_deferred(get_completed_timeline_value());
+
+			result = vmaCreateBuffer(g_vulkan_core.allocator, &buffer_create_info, &allocation_create_info, &buffer.buffer, &buffer.allocation, &buffer.info);
+		}
+
+		if (result != VK_SUCCESS)
+		{
+			LOG_ERROR(TAG_RENDERER, "failed to allocate a %llu KB %s buffer", (unsigned long long)(size / KILOBYTES(1)), get_memory_category_name(category));
+			log_memory_usage();
+		}
+
+		VK_CHECK(result);
+
+		track_allocation(buffer.allocation, category);
 
 		return buffer;
 	}
 
 	void destroy_vulkan_buffer(vulkan_buffer_t& buffer)
 	{
-		vmaDestroyBuffer(vulkan_core.allocator, buffer.buffer, buffer.allocation);
+		untrack_allocation(buffer.allocation);
+		vmaDestroyBuffer(g_vulkan_core.allocator, buffer.buffer, buffer.allocation);
 	}
 
 	void init_mesh_group()
 	{
+		// the skinning pass reads the bind pose vertices on the compute queue
 		renderer.mesh_group.vertex_buffer = create_vulkan_buffer(
+			MEMORY_CATEGORY_MESH,
 			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
 			VMA_MEMORY_USAGE_AUTO,
 			VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-			MESH_GROUP_V_BUFFER_SIZE);
+			MESH_GROUP_V_BUFFER_SIZE,
+			true);
 
 		renderer.mesh_group.index_buffer = create_vulkan_buffer(
+			MEMORY_CATEGORY_MESH,
 			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
 			VMA_MEMORY_USAGE_AUTO,
 			VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
 			MESH_GROUP_I_BUFFER_SIZE);
+
+		renderer.mesh_group.skin_buffer = create_vulkan_buffer(
+			MEMORY_CATEGORY_MESH,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VMA_MEMORY_USAGE_AUTO,
+			VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+			MESH_GROUP_S_BUFFER_SIZE,
+			true);
 	}
 
 	void destroy_mesh_group()
 	{
-		vmaDestroyBuffer(vulkan_core.allocator, renderer.mesh_group.vertex_buffer.buffer, renderer.mesh_group.vertex_buffer.allocation);
-		vmaDestroyBuffer(vulkan_core.allocator, renderer.mesh_group.index_buffer.buffer, renderer.mesh_group.index_buffer.allocation);
+		destroy_vulkan_buffer(renderer.mesh_group.vertex_buffer);
+		destroy_vulkan_buffer(renderer.mesh_group.index_buffer);
+		destroy_vulkan_buffer(renderer.mesh_group.skin_buffer);
 	}
 
-	mesh_t upload_mesh(const void* vertices, uint32_t vertex_count, const void* indices, uint32_t index_count)
+	mesh_t reserve_mesh(uint32_t vertex_count, uint32_t index_count, void** vertices, void** indices)
 	{
 		mesh_group_t& mesh_group = renderer.mesh_group;
 
@@ -700,24 +1708,23 @@ namespace olivia
 		assert(mesh_group.i_bytes_used + indices_size < MESH_GROUP_I_BUFFER_SIZE && "mesh group index buffer overflow");
 
 		mesh_t mesh = mesh_group.mesh_count++;
-		
-		uint32_t v_offset{};
-		uint32_t i_offset{};
 
-		if (mesh != 0)
-		{
-			v_offset = mesh_group.v_offset[mesh - 1] + mesh_group.v_count[mesh - 1] * sizeof(vertex3d_t);
-			i_offset = mesh_group.i_offset[mesh - 1] + mesh_group.i_count[mesh - 1] * sizeof(uint32_t);
-		}
+		// the previous mesh may have reserved more indices than its full mesh has, for its levels
+		uint32_t v_offset = (uint32_t)mesh_group.v_bytes_used;
+		uint32_t i_offset = (uint32_t)mesh_group.i_bytes_used;
 
-		memcpy((uint8_t*)mesh_group.vertex_buffer.info.pMappedData + v_offset, vertices, vertices_size);
-		memcpy((uint8_t*)mesh_group.index_buffer.info.pMappedData + i_offset, indices, indices_size);
+		*vertices = (uint8_t*)mesh_group.vertex_buffer.info.pMappedData + v_offset;
+		*indices  = (uint8_t*)mesh_group.index_buffer.info.pMappedData + i_offset;
 
 		mesh_group.v_count[mesh] = vertex_count;
 		mesh_group.i_count[mesh] = index_count;
 
 		mesh_group.i_offset[mesh] = i_offset;
-		mesh_group.i_offset[mesh] = v_offset;
+		mesh_group.v_offset[mesh] = v_offset;
+		mesh_group.s_offset[mesh] = UINT32_MAX;
+
+		mesh_group.lods[mesh][0]   = { 0, index_count, 0.0f };
+		mesh_group.lod_count[mesh] = 1;
 
 		mesh_group.v_bytes_used += vertices_size;
 		mesh_group.i_bytes_used += indices_size;
@@ -725,4 +1732,160 @@ namespace olivia
 		return mesh;
 	}
 
+	mesh_t reserve_skinned_mesh(uint32_t vertex_count, uint32_t index_count, void** vertices, void** indices, skin_vertex_t** skin)
+	{
+		mesh_group_t& mesh_group = renderer.mesh_group;
+
+		size_t skin_size = vertex_count * sizeof(skin_vertex_t);
+
+		assert(mesh_group.s_bytes_used + skin_size <= MESH_GROUP_S_BUFFER_SIZE && "mesh group skin buffer overflow");
+
+		mesh_t mesh = reserve_mesh(vertex_count, index_count, vertices, indices);
+
+		mesh_group.s_offset[mesh] = (uint32_t)mesh_group.s_bytes_used;
+		mesh_group.s_bytes_used  += skin_size;
+
+		*skin = (skin_vertex_t*)((uint8_t*)mesh_group.skin_buffer.info.pMappedData + mesh_group.s_offset[mesh]);
+
+		return mesh;
+	}
+
+	void set_mesh_bounds(mesh_t mesh, const aabb_t& bounds)
+	{
+		assert(mesh < renderer.mesh_group.mesh_count && "invalid mesh");
+		renderer.mesh_group.bounds[mesh] = bounds;
+	}
+
+	void set_mesh_lods(mesh_t mesh, const mesh_lod_t* lods, uint32_t lod_count)
+	{
+		mesh_group_t& mesh_group = renderer.mesh_group;
+
+		assert(mesh < mesh_group.mesh_count && "invalid mesh");
+		assert(lod_count >= 1 && lod_count <= MAX_MESH_LODS && "invalid lod count");
+		assert(lods[lod_count - 1].first_index + lods[lod_count - 1].index_count <= mesh_group.i_count[mesh] && "levels outside the mesh's indices");
+
+		for (uint32_t i = 0; i < lod_count; ++i)
+		{
+			mesh_group.lods[mesh][i] = lods[i];
+		}
+
+		mesh_group.lod_count[mesh] = lod_count;
+		mesh_group.i_count[mesh]   = lods[0].index_count;
+	}
+
+	const mesh_group_t& get_mesh_group()
+	{
+		return renderer.mesh_group;
+	}
+
+	mesh_t upload_mesh(const void* vertices, uint32_t vertex_count, const void* indices, uint32_t index_count)
+	{
+		void* v_destination;
+		void* i_destination;
+
+		mesh_t mesh = reserve_mesh(vertex_count, index_count, &v_destination, &i_destination);
+
+		memcpy(v_destination, vertices, vertex_count * sizeof(vertex3d_t));
+		memcpy(i_destination, indices, index_count * sizeof(uint32_t));
+
+		// from the caller's copy, the mapped one may be uncached
+		renderer.mesh_group.bounds[mesh] = compute_aabb(&((const vertex3d_t*)vertices)->position, vertex_count, sizeof(vertex3d_t));
+
+		return mesh;
+	}
+
+	bool load_mesh_pack(const asset_pack_t& pack, mesh_t* meshes)
+	{
+		const mesh_group_t& mesh_group = renderer.mesh_group;
+		const uint32_t      block_size = pack.header->block_size;
+
+		// everything is validated before the first reservation, the mesh group can't be rolled back
+		if (pack.header->mesh_count > MAX_MESHES - mesh_group.mesh_count)
+		{
+			LOG_ERROR(TAG_RENDERER, "asset pack has %u meshes, the mesh group has room for %u", pack.header->mesh_count, MAX_MESHES - mesh_group.mesh_count);
+			return false;
+		}
+
+		uint64_t vertex_bytes_total{};
+		uint64_t index_bytes_total{};
+
+		for (uint32_t i = 0; i < pack.header->mesh_count; ++i)
+		{
+			const asset_pack_mesh_t& pack_mesh = pack.meshes[i];
+
+			if (pack_mesh.vertex_stride != sizeof(vertex3d_t))
+			{
+				LOG_ERROR(TAG_RENDERER, "asset pack mesh %u has vertex stride %u, expected %zu", i, pack_mesh.vertex_stride, sizeof(vertex3d_t));
+				return false;
+			}
+
+			const uint32_t lod_count = pack_mesh.lod_count;
+			if (lod_count == 0 || lod_count > MAX_MESH_LODS || (uint64_t)pack_mesh.lods[lod_count - 1].first_index + pack_mesh.lods[lod_count - 1].index_count > pack_mesh.index_count)
+			{
+				LOG_ERROR(TAG_RENDERER, "asset pack mesh %u has an invalid LOD table", i);
+				return false;
+			}
+
+			// the blocks must cover the streams exactly, each one is decoded into its slice of the reservation
+			const uint64_t vertex_bytes = (uint64_t)pack_mesh.vertex_count * sizeof(vertex3d_t);
+			const uint64_t index_bytes  = (uint64_t)pack_mesh.index_count * sizeof(uint32_t);
+
+			if ((vertex_bytes + block_size - 1) / block_size != pack_mesh.vertex_block_count ||
+				(index_bytes + block_size - 1) / block_size != pack_mesh.index_block_count ||
+				pack_mesh.vertex_block_count > pack.header->block_count ||
+				pack_mesh.index_block_count > pack.header->block_count ||
+				pack_mesh.first_vertex_block > pack.header->block_count - pack_mesh.vertex_block_count ||
+				pack_mesh.first_index_block > pack.header->block_count - pack_mesh.index_block_count)
+			{
+				LOG_ERROR(TAG_RENDERER, "asset pack mesh %u has an invalid block range", i);
+				return false;
+			}
+
+			vertex_bytes_total += vertex_bytes;
+			index_bytes_total  += index_bytes;
+		}
+
+		if (mesh_group.v_bytes_used + vertex_bytes_total >= MESH_GROUP_V_BUFFER_SIZE ||
+			mesh_group.i_bytes_used + index_bytes_total >= MESH_GROUP_I_BUFFER_SIZE)
+		{
+			LOG_ERROR(TAG_RENDERER, "asset pack needs %llu KB of vertices and %llu KB of indices, more than the mesh group has left",
+				(unsigned long long)(vertex_bytes_total / KILOBYTES(1)), (unsigned long long)(index_bytes_total / KILOBYTES(1)));
+			return false;
+		}
+
+		auto targets = create_vector<asset_block_target_t>(SDL_max(pack.header->block_count, 1u));
+
+		for (uint32_t i = 0; i < pack.header->mesh_count; ++i)
+		{
+			const asset_pack_mesh_t& pack_mesh = pack.meshes[i];
+
+			const size_t vertex_bytes = (size_t)pack_mesh.vertex_count * sizeof(vertex3d_t);
+			const size_t index_bytes  = (size_t)pack_mesh.index_count * sizeof(uint32_t);
+
+			void* vertices;
+			void* indices;
+			meshes[i] = reserve_mesh(pack_mesh.vertex_count, pack_mesh.index_count, &vertices, &indices);
+			set_mesh_lods(meshes[i], pack_mesh.lods, pack_mesh.lod_count);
+			set_mesh_bounds(meshes[i], pack_mesh.bounds);
+
+			for (uint32_t b = 0; b < pack_mesh.vertex_block_count; ++b)
+			{
+				const size_t offset = (size_t)b * block_size;
+				vector_push_back(targets, { pack_mesh.first_vertex_block + b, (uint8_t*)vertices + offset, vertex_bytes - offset });
+			}
+
+			for (uint32_t b = 0; b < pack_mesh.index_block_count; ++b)
+			{
+				const size_t offset = (size_t)b * block_size;
+				vector_push_back(targets, { pack_mesh.first_index_block + b, (uint8_t*)indices + offset, index_bytes - offset });
+			}
+		}
+
+		bool ok = decompress_asset_blocks(pack, targets.data, (uint32_t)targets.size);
+
+		destroy_vector(targets);
+
+		return ok;
+	}
+
 } // olivia
\ No newline at end of file
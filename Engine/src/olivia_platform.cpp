@@ -1,12 +1,1648 @@
 #include "olivia/olivia_platform.h"
 
+#include <zstd.h>
+#include <math.h>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <signal.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 namespace olivia
 {
 	input_state_t g_input_state{};
 
+	static input_system_t    input_system{};
+	static job_system_t      job_system{};
+	static storage_tracker_t storage_tracker{};
+	static startup_trace_t   startup_trace{};
+
+	// bounded MPMC queue: a slot's sequence says whether it is free for the
+	// producer at position pos (== pos) or holds the event for pos (== pos + 1)
+	bool push_input_event(const input_event_t& event)
+	{
+		input_event_queue_t& queue = input_system.queue;
+
+		for (;;)
+		{
+			int      pos  = SDL_GetAtomicInt(&queue.head);
+			uint32_t slot = (uint32_t)pos & (INPUT_EVENT_QUEUE_SIZE - 1);
+			int      diff = SDL_GetAtomicInt(&queue.sequence[slot]) - pos;
+
+			if (diff == 0)
+			{
+				if (SDL_CompareAndSwapAtomicInt(&queue.head, pos, pos + 1))
+				{
+					queue.events[slot] = event;
+					SDL_SetAtomicInt(&queue.sequence[slot], pos + 1);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				SDL_AddAtomicInt(&input_system.dropped_events, 1);
+				return false;
+			}
+		}
+	}
+
+	static bool pop_input_event(input_event_t& event)
+	{
+		input_event_queue_t& queue = input_system.queue;
+
+		for (;;)
+		{
+			int      pos  = SDL_GetAtomicInt(&queue.tail);
+			uint32_t slot = (uint32_t)pos & (INPUT_EVENT_QUEUE_SIZE - 1);
+			int      diff = SDL_GetAtomicInt(&queue.sequence[slot]) - (pos + 1);
+
+			if (diff == 0)
+			{
+				if (SDL_CompareAndSwapAtomicInt(&queue.tail, pos, pos + 1))
+				{
+					event = queue.events[slot];
+					SDL_SetAtomicInt(&queue.sequence[slot], pos + (int)INPUT_EVENT_QUEUE_SIZE);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+		}
+	}
+
+	static void push_text_event(uint64_t timestamp, const char* text)
+	{
+		input_event_t event{ .timestamp = timestamp, .type = INPUT_EVENT_TEXT };
+
+		size_t length = strlen(text);
+
+		while (length > 0)
+		{
+			// split on code point boundaries, continuation bytes are 10xxxxxx
+			size_t chunk = SDL_min(length, sizeof(event.text) - 1);
+			while (chunk < length && chunk > 0 && ((uint8_t)text[chunk] & 0xC0) == 0x80)
+				--chunk;
+
+			memcpy(event.text, text, chunk);
+			event.text[chunk] = '\0';
+			push_input_event(event);
+
+			text   += chunk;
+			length -= chunk;
+		}
+	}
+
+	// runs on whichever thread pumps SDL events, before the event reaches SDL's own queue
+	static bool SDLCALL input_event_watch(void*, SDL_Event* event)
+	{
+		const uint64_t timestamp = event->common.timestamp;
+
+		switch (event->type)
+		{
+		case SDL_EVENT_KEY_DOWN:
+		case SDL_EVENT_KEY_UP:
+			if (!event->key.repeat)
+			{
+				push_input_event(
+				{
+					.timestamp = timestamp,
+					.type = event->type == SDL_EVENT_KEY_DOWN ? INPUT_EVENT_KEY_DOWN : INPUT_EVENT_KEY_UP,
+					.code = (uint16_t)event->key.scancode
+				});
+			}
+			break;
+		case SDL_EVENT_MOUSE_MOTION:
+			push_input_event(
+			{
+				.timestamp = timestamp,
+				.type = INPUT_EVENT_MOUSE_MOTION,
+				.x = event->motion.x,
+				.y = event->motion.y,
+				.dx = event->motion.xrel,
+				.dy = event->motion.yrel
+			});
+			break;
+		case SDL_EVENT_MOUSE_BUTTON_DOWN:
+		case SDL_EVENT_MOUSE_BUTTON_UP:
+			push_input_event(
+			{
+				.timestamp = timestamp,
+				.type = event->type == SDL_EVENT_MOUSE_BUTTON_DOWN ? INPUT_EVENT_MOUSE_BUTTON_DOWN : INPUT_EVENT_MOUSE_BUTTON_UP,
+				.code = event->button.button,
+				.x = event->button.x,
+				.y = event->button.y
+			});
+			break;
+		case SDL_EVENT_MOUSE_WHEEL:
+		{
+			float direction = event->wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -1.0f : 1.0f;
+
+			push_input_event(
+			{
+				.timestamp = timestamp,
+				.type = INPUT_EVENT_MOUSE_WHEEL,
+				.x = event->wheel.x * direction,
+				.y = event->wheel.y * direction
+			});
+			break;
+		}
+		case SDL_EVENT_TEXT_INPUT:
+			push_text_event(timestamp, event->text.text);
+			break;
+		default:
+			break;
+		}
+
+		return true;
+	}
+
+	static float normalize_gamepad_axis(int16_t value)
+	{
+		return SDL_max((float)value / 32767.0f, -1.0f);
+	}
+
+	static void scan_gamepads()
+	{
+		for (uint32_t slot = 0; slot < MAX_GAMEPADS; ++slot)
+		{
+			SDL_Gamepad* gamepad = input_system.gamepads[slot];
+
+			if (gamepad && !SDL_GamepadConnected(gamepad))
+			{
+				LOG_INFO(TAG_PLATFORM, "gamepad %u disconnected", slot);
+
+				SDL_CloseGamepad(gamepad);
+				input_system.gamepads[slot] = nullptr;
+			}
+		}
+
+		int count{};
+		SDL_JoystickID* ids = SDL_GetGamepads(&count);
+		if (!ids)
+			return;
+
+		for (int i = 0; i < count; ++i)
+		{
+			SDL_Gamepad* gamepad = SDL_GetGamepadFromID(ids[i]);
+
+			bool opened = false;
+			for (uint32_t slot = 0; slot < MAX_GAMEPADS && gamepad; ++slot)
+				opened |= input_system.gamepads[slot] == gamepad;
+
+			if (opened)
+				continue;
+
+			for (uint32_t slot = 0; slot < MAX_GAMEPADS; ++slot)
+			{
+				if (input_system.gamepads[slot])
+					continue;
+
+				input_system.gamepads[slot] = SDL_OpenGamepad(ids[i]);
+				if (input_system.gamepads[slot])
+					LOG_INFO(TAG_PLATFORM, "gamepad %u connected: %s", slot, SDL_GetGamepadName(input_system.gamepads[slot]));
+				break;
+			}
+		}
+
+		SDL_free(ids);
+	}
+
+	static void sample_gamepad(uint32_t slot, uint64_t timestamp)
+	{
+		SDL_Gamepad* gamepad = input_system.gamepads[slot];
+
+		uint32_t buttons{};
+		for (int button = 0; button < SDL_GAMEPAD_BUTTON_COUNT; ++button)
+		{
+			if (SDL_GetGamepadButton(gamepad, (SDL_GamepadButton)button))
+				buttons |= 1u << button;
+		}
+
+		// only transitions are queued
+		for (uint32_t changed = buttons ^ input_system.gamepad_buttons[slot]; changed; changed &= changed - 1)
+		{
+			uint32_t button = (uint32_t)SDL_MostSignificantBitIndex32(changed & (~changed + 1));
+
+			push_input_event(
+			{
+				.timestamp = timestamp,
+				.type = (buttons >> button) & 1 ? INPUT_EVENT_GAMEPAD_BUTTON_DOWN : INPUT_EVENT_GAMEPAD_BUTTON_UP,
+				.device = (uint8_t)slot,
+				.code = (uint16_t)button
+			});
+		}
+
+		input_system.gamepad_buttons[slot] = buttons;
+
+		for (int axis = 0; axis < SDL_GAMEPAD_AXIS_COUNT; ++axis)
+		{
+			int16_t value = SDL_GetGamepadAxis(gamepad, (SDL_GamepadAxis)axis);
+
+			if (value == input_system.gamepad_axes[slot][axis])
+				continue;
+
+			input_system.gamepad_axes[slot][axis] = value;
+
+			push_input_event(
+			{
+				.timestamp = timestamp,
+				.type = INPUT_EVENT_GAMEPAD_AXIS,
+				.device = (uint8_t)slot,
+				.code = (uint16_t)axis,
+				.x = normalize_gamepad_axis(value)
+			});
+		}
+	}
+
+	static int input_worker(void*)
+	{
+		constexpr uint64_t SCAN_INTERVAL_NS{ 500000000 };
+
+		uint64_t next_scan{};
+
+		while (SDL_GetAtomicInt(&input_system.running))
+		{
+			// joystick auto update is off, this thread is the only one driving gamepad state
+			SDL_UpdateGamepads();
+
+			uint64_t now = SDL_GetTicksNS();
+
+			if (now >= next_scan)
+			{
+				scan_gamepads();
+				next_scan = now + SCAN_INTERVAL_NS;
+			}
+
+			for (uint32_t slot = 0; slot < MAX_GAMEPADS; ++slot)
+			{
+				if (input_system.gamepads[slot])
+					sample_gamepad(slot, now);
+			}
+
+			SDL_DelayPrecise(INPUT_POLL_INTERVAL_NS);
+		}
+
+		return 0;
+	}
+
+	void init_input()
+	{
+		for (uint32_t i = 0; i < INPUT_EVENT_QUEUE_SIZE; ++i)
+		{
+			SDL_SetAtomicInt(&input_system.queue.sequence[i], (int)i);
+		}
+
+		// gamepads are sampled on the input thread instead of the event pump,
+		// SDL's own gamepad events would only duplicate the queue
+		SDL_SetHint(SDL_HINT_AUTO_UPDATE_JOYSTICKS, "0");
+
+		if (!SDL_InitSubSystem(SDL_INIT_GAMEPAD))
+			LOG_WARN(TAG_PLATFORM, "failed to initialize gamepads: %s", SDL_GetError());
+
+		SDL_SetGamepadEventsEnabled(false);
+		SDL_AddEventWatch(input_event_watch, nullptr);
+
+		SDL_SetAtomicInt(&input_system.running, 1);
+		input_system.thread = SDL_CreateThread(input_worker, "olivia_input", nullptr);
+		assert(input_system.thread && "failed to create input thread");
+	}
+
+	void destroy_input()
+	{
+		SDL_SetAtomicInt(&input_system.running, 0);
+		SDL_WaitThread(input_system.thread, nullptr);
+
+		SDL_RemoveEventWatch(input_event_watch, nullptr);
+
+		for (uint32_t slot = 0; slot < MAX_GAMEPADS; ++slot)
+		{
+			if (input_system.gamepads[slot])
+				SDL_CloseGamepad(input_system.gamepads[slot]);
+		}
+
+		SDL_QuitSubSystem(SDL_INIT_GAMEPAD);
+
+		input_system = {};
+	}
+
+	static void set_input_bit(uint64_t* words, uint32_t bit, bool value)
+	{
+		uint64_t mask = 1ull << (bit & 63);
+		words[bit >> 6] = value ? words[bit >> 6] | mask : words[bit >> 6] & ~mask;
+	}
+
+	// codes and slots index the state and shift masks, events may come from a replay file
+	static bool is_valid_input_event(const input_event_t& event)
+	{
+		switch (event.type)
+		{
+		case INPUT_EVENT_KEY_DOWN:
+		case INPUT_EVENT_KEY_UP:
+			return event.code < SDL_SCANCODE_COUNT;
+		case INPUT_EVENT_MOUSE_BUTTON_DOWN:
+		case INPUT_EVENT_MOUSE_BUTTON_UP:
+			return event.code < 32;
+		case INPUT_EVENT_GAMEPAD_BUTTON_DOWN:
+		case INPUT_EVENT_GAMEPAD_BUTTON_UP:
+			return event.device < MAX_GAMEPADS && event.code < SDL_GAMEPAD_BUTTON_COUNT;
+		case INPUT_EVENT_GAMEPAD_AXIS:
+			return event.device < MAX_GAMEPADS && event.code < SDL_GAMEPAD_AXIS_COUNT;
+		case INPUT_EVENT_MOUSE_MOTION:
+		case INPUT_EVENT_MOUSE_WHEEL:
+			return true;
+		case INPUT_EVENT_TEXT:
+			return SDL_strnlen(event.text, sizeof(event.text)) < sizeof(event.text);
+		}
+
+		return false;
+	}
+
+	static void apply_input_event(input_state_t& state, const input_event_t& event, uint64_t* down_keys, uint64_t* up_keys, uint32_t* down_buttons, uint32_t* up_buttons)
+	{
+		if (!is_valid_input_event(event))
+			return;
+
+		switch (event.type)
+		{
+		case INPUT_EVENT_KEY_DOWN:
+		case INPUT_EVENT_KEY_UP:
+		{
+			bool down = event.type == INPUT_EVENT_KEY_DOWN;
+			set_input_bit(state.curr_keys, event.code, down);
+			set_input_bit(down ? down_keys : up_keys, event.code, true);
+			break;
+		}
+		case INPUT_EVENT_MOUSE_MOTION:
+			state.mouse_x   = event.x;
+			state.mouse_y   = event.y;
+			state.mouse_dx += event.dx;
+			state.mouse_dy += event.dy;
+			break;
+		case INPUT_EVENT_MOUSE_BUTTON_DOWN:
+			state.curr_mouse_buttons |= 1u << event.code;
+			down_buttons[MAX_GAMEPADS] |= 1u << event.code;
+			break;
+		case INPUT_EVENT_MOUSE_BUTTON_UP:
+			state.curr_mouse_buttons &= ~(1u << event.code);
+			up_buttons[MAX_GAMEPADS] |= 1u << event.code;
+			break;
+		case INPUT_EVENT_MOUSE_WHEEL:
+			state.wheel_x += event.x;
+			state.wheel_y += event.y;
+			break;
+		case INPUT_EVENT_GAMEPAD_BUTTON_DOWN:
+			state.curr_gamepad_buttons[event.device] |= 1u << event.code;
+			down_buttons[event.device] |= 1u << event.code;
+			break;
+		case INPUT_EVENT_GAMEPAD_BUTTON_UP:
+			state.curr_gamepad_buttons[event.device] &= ~(1u << event.code);
+			up_buttons[event.device] |= 1u << event.code;
+			break;
+		case INPUT_EVENT_GAMEPAD_AXIS:
+			state.gamepad_axes[event.device][event.code] = event.x;
+			break;
+		case INPUT_EVENT_TEXT:
+		{
+			size_t length = SDL_min(strlen(event.text), sizeof(state.text) - 1 - state.text_length);
+			memcpy(state.text + state.text_length, event.text, length);
+			state.text_length += (uint32_t)length;
+			state.text[state.text_length] = '\0';
+			break;
+		}
+		}
+	}
+
+	void apply_input_events(const input_event_t* events, uint32_t count, uint64_t timestamp)
+	{
+		input_state_t& state = g_input_state;
+
+		memcpy(state.prev_keys, state.curr_keys, sizeof(state.curr_keys));
+		memcpy(state.prev_gamepad_buttons, state.curr_gamepad_buttons, sizeof(state.curr_gamepad_buttons));
+		state.prev_mouse_buttons = state.curr_mouse_buttons;
+
+		state.mouse_dx    = 0.0f;
+		state.mouse_dy    = 0.0f;
+		state.wheel_x     = 0.0f;
+		state.wheel_y     = 0.0f;
+		state.text[0]     = '\0';
+		state.text_length = 0;
+
+		// transitions seen this frame, so a press and release between two frames still registers
+		uint64_t down_keys[INPUT_KEY_WORDS]{};
+		uint64_t up_keys[INPUT_KEY_WORDS]{};
+		uint32_t down_buttons[MAX_GAMEPADS + 1]{};
+		uint32_t up_buttons[MAX_GAMEPADS + 1]{};
+
+		assert(count <= MAX_FRAME_INPUT_EVENTS);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			apply_input_event(state, events[i], down_keys, up_keys, down_buttons, up_buttons);
+			state.events[i] = events[i];
+		}
+
+		state.event_count = count;
+		state.timestamp   = timestamp;
+
+		for (uint32_t i = 0; i < INPUT_KEY_WORDS; ++i)
+		{
+			uint64_t changed = state.curr_keys[i] ^ state.prev_keys[i];
+
+			state.pressed_keys[i]  = (changed & state.curr_keys[i]) | down_keys[i];
+			state.released_keys[i] = (changed & state.prev_keys[i]) | up_keys[i];
+		}
+
+		for (uint32_t i = 0; i < MAX_GAMEPADS; ++i)
+		{
+			uint32_t changed = state.curr_gamepad_buttons[i] ^ state.prev_gamepad_buttons[i];
+
+			state.pressed_gamepad_buttons[i]  = (changed & state.curr_gamepad_buttons[i]) | down_buttons[i];
+			state.released_gamepad_buttons[i] = (changed & state.prev_gamepad_buttons[i]) | up_buttons[i];
+		}
+
+		uint32_t changed = state.curr_mouse_buttons ^ state.prev_mouse_buttons;
+
+		state.pressed_mouse_buttons  = (changed & state.curr_mouse_buttons) | down_buttons[MAX_GAMEPADS];
+		state.released_mouse_buttons = (changed & state.prev_mouse_buttons) | up_buttons[MAX_GAMEPADS];
+	}
+
 	void update_input_state()
 	{
-		memcpy(g_input_state.prev_keys, g_input_state.curr_keys, sizeof(g_input_state.curr_keys));
+		input_event_t events[MAX_FRAME_INPUT_EVENTS];
+		uint32_t      count{};
+
+		// anything beyond a frame's worth stays queued for the next update
+		while (count < MAX_FRAME_INPUT_EVENTS && pop_input_event(events[count]))
+			++count;
+
+		g_input_state.dropped_events = (uint32_t)SDL_SetAtomicInt(&input_system.dropped_events, 0);
+
+		if (g_input_state.dropped_events)
+			LOG_WARN(TAG_PLATFORM, "input queue overflow, %u events dropped", g_input_state.dropped_events);
+
+		apply_input_events(events, count, SDL_GetTicksNS());
+	}
+
+	static bool pop_job(job_t& job, job_counter_t*& counter)
+	{
+		if (job_system.head == job_system.tail)
+			return false;
+
+		uint32_t slot = job_system.head++ % JOB_QUEUE_SIZE;
+		job     = job_system.jobs[slot];
+		counter = job_system.counters[slot];
+
+		return true;
+	}
+
+	static void execute_job(const job_t& job, job_counter_t* counter)
+	{
+		job.function(job.data);
+
+		if (counter)
+			SDL_AddAtomicInt(&counter->pending, -1);
+	}
+
+	static int job_worker(void*)
+	{
+		SDL_LockMutex(job_system.mutex);
+
+		while (job_system.running)
+		{
+			job_t          job;
+			job_counter_t* counter;
+
+			if (pop_job(job, counter))
+			{
+				SDL_UnlockMutex(job_system.mutex);
+				execute_job(job, counter);
+				SDL_LockMutex(job_system.mutex);
+				continue;
+			}
+
+			SDL_WaitCondition(job_system.wake, job_system.mutex);
+		}
+
+		SDL_UnlockMutex(job_system.mutex);
+
+		return 0;
+	}
+
+	void init_job_system(uint32_t worker_count)
+	{
+		if (worker_count == 0)
+		{
+			int cpu_count = SDL_GetNumLogicalCPUCores();
+			worker_count  = cpu_count > 1 ? (uint32_t)cpu_count - 1 : 1;
+		}
+
+		job_system.worker_count = SDL_min(worker_count, MAX_JOB_WORKERS);
+		job_system.mutex        = SDL_CreateMutex();
+		job_system.wake         = SDL_CreateCondition();
+		job_system.running      = true;
+
+		for (uint32_t i = 0; i < job_system.worker_count; ++i)
+		{
+			job_system.workers[i] = SDL_CreateThread(job_worker, "olivia_worker", nullptr);
+			assert(job_system.workers[i] && "failed to create job worker");
+		}
+
+		LOG_INFO(TAG_PLATFORM, "job system started with %u workers", job_system.worker_count);
+	}
+
+	void destroy_job_system()
+	{
+		SDL_LockMutex(job_system.mutex);
+		job_system.running = false;
+		SDL_BroadcastCondition(job_system.wake);
+		SDL_UnlockMutex(job_system.mutex);
+
+		for (uint32_t i = 0; i < job_system.worker_count; ++i)
+		{
+			SDL_WaitThread(job_system.workers[i], nullptr);
+		}
+
+		SDL_DestroyCondition(job_system.wake);
+		SDL_DestroyMutex(job_system.mutex);
+
+		job_system = {};
+	}
+
+	uint32_t get_job_worker_count()
+	{
+		return job_system.worker_count;
+	}
+
+	void run_jobs(const job_t* jobs, uint32_t count, job_counter_t* counter)
+	{
+		if (counter)
+			SDL_AddAtomicInt(&counter->pending, (int)count);
+
+		// without workers (or with a full queue) jobs run inline on the caller
+		if (job_system.worker_count == 0)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				execute_job(jobs[i], counter);
+			}
+
+			return;
+		}
+
+		SDL_LockMutex(job_system.mutex);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (job_system.tail - job_system.head == JOB_QUEUE_SIZE)
+			{
+				SDL_UnlockMutex(job_system.mutex);
+				execute_job(jobs[i], counter);
+				SDL_LockMutex(job_system.mutex);
+				continue;
+			}
+
+			uint32_t slot = job_system.tail++ % JOB_QUEUE_SIZE;
+			job_system.jobs[slot]     = jobs[i];
+			job_system.counters[slot] = counter;
+		}
+
+		SDL_BroadcastCondition(job_system.wake);
+		SDL_UnlockMutex(job_system.mutex);
+	}
+
+	void wait_for_counter(job_counter_t* counter)
+	{
+		while (SDL_GetAtomicInt(&counter->pending) > 0)
+		{
+			job_t          job;
+			job_counter_t* job_counter;
+
+			SDL_LockMutex(job_system.mutex);
+			bool popped = pop_job(job, job_counter);
+			SDL_UnlockMutex(job_system.mutex);
+
+			if (popped)
+				execute_job(job, job_counter);
+			else
+				SDL_CPUPauseInstruction();
+		}
+	}
+
+	struct job_range_t
+	{
+		job_range_function function;
+		void*              data;
+		uint32_t           begin;
+		uint32_t           end;
+	};
+
+	static void execute_job_range(void* data)
+	{
+		job_range_t* range = (job_range_t*)data;
+		range->function(range->begin, range->end, range->data);
+	}
+
+	void parallel_for(uint32_t count, uint32_t batch_size, job_range_function function, void* data)
+	{
+		if (count == 0)
+			return;
+
+		batch_size = SDL_max(batch_size, 1u);
+		uint32_t batch_count = (count + batch_size - 1) / batch_size;
+
+		if (batch_count == 1 || job_system.worker_count == 0)
+		{
+			function(0, count, data);
+			return;
+		}
+
+		job_range_t* ranges = (job_range_t*)calloc(batch_count, sizeof(job_range_t));
+		job_t*       jobs   = (job_t*)calloc(batch_count, sizeof(job_t));
+		assert(ranges && jobs && "calloc failed");
+
+		for (uint32_t i = 0; i < batch_count; ++i)
+		{
+			ranges[i] = { function, data, i * batch_size, SDL_min((i + 1) * batch_size, count) };
+			jobs[i]   = { execute_job_range, &ranges[i] };
+		}
+
+		job_counter_t counter{};
+		run_jobs(jobs, batch_count, &counter);
+		wait_for_counter(&counter);
+
+		free(jobs);
+		free(ranges);
+	}
+
+	void begin_startup_trace()
+	{
+		startup_trace             = {};
+		startup_trace.start       = SDL_GetTicksNS();
+		startup_trace.main_thread = SDL_GetCurrentThreadID();
+	}
+
+	uint32_t begin_startup_span(const char* name)
+	{
+		if (startup_trace.reported)
+			return UINT32_MAX;
+
+		uint32_t span = (uint32_t)SDL_AddAtomicInt(&startup_trace.span_count, 1);
+		if (span >= MAX_STARTUP_SPANS)
+			return UINT32_MAX;
+
+		startup_trace.spans[span] = { name, SDL_GetTicksNS(), 0, SDL_GetCurrentThreadID() };
+
+		return span;
+	}
+
+	void end_startup_span(uint32_t span)
+	{
+		if (span < MAX_STARTUP_SPANS)
+			startup_trace.spans[span].end = SDL_GetTicksNS();
+	}
+
+	void report_startup_trace()
+	{
+		if (startup_trace.reported)
+			return;
+
+		startup_trace.reported = true;
+
+		const uint64_t now   = SDL_GetTicksNS();
+		const uint32_t count = SDL_min((uint32_t)SDL_GetAtomicInt(&startup_trace.span_count), MAX_STARTUP_SPANS);
+
+		LOG_INFO(TAG_PLATFORM, "time to first frame %.3f ms", (now - startup_trace.start) * 1e-6);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const startup_span_t& span = startup_trace.spans[i];
+			const uint64_t        end  = span.end ? span.end : now;
+
+			LOG_INFO(TAG_PLATFORM, "  %-24s %8.3f ms +%8.3f ms%s",
+				span.name,
+				(span.begin - startup_trace.start) * 1e-6,
+				(end - span.begin) * 1e-6,
+				span.thread == startup_trace.main_thread ? "" : " (worker)");
+		}
+	}
+
+#ifdef _WIN32
+	bool map_file(const char* path, file_map_t& map)
+	{
+		map = {};
+
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size{};
+		GetFileSizeEx(file, &size);
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		map.data    = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		map.size    = (size_t)size.QuadPart;
+		map.file    = (intptr_t)file;
+		map.mapping = mapping;
+
+		if (!map.data)
+		{
+			unmap_file(map);
+			return false;
+		}
+
+		return true;
+	}
+
+	void unmap_file(file_map_t& map)
+	{
+		if (map.data)    UnmapViewOfFile(map.data);
+		if (map.mapping) CloseHandle((HANDLE)map.mapping);
+		if (map.file)    CloseHandle((HANDLE)map.file);
+
+		map = {};
+	}
+#else
+	bool map_file(const char* path, file_map_t& map)
+	{
+		map = {};
+
+		int file = open(path, O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat file_stat{};
+		if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		void* data = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED)
+		{
+			close(file);
+			return false;
+		}
+
+		madvise(data, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+
+		map.data = data;
+		map.size = (size_t)file_stat.st_size;
+		map.file = file;
+
+		return true;
+	}
+
+	void unmap_file(file_map_t& map)
+	{
+		if (map.data) munmap((void*)map.data, map.size);
+		if (map.data) close((int)map.file);
+
+		map = {};
+	}
+#endif
+
+	// --- storage snapshots ---
+
+	// the fault handlers set bits concurrently, aligned 64-bit loads do not tear
+	static bool test_storage_bit(const uint64_t* words, size_t bit)
+	{
+		return (((const volatile uint64_t*)words)[bit >> 6] >> (bit & 63)) & 1;
+	}
+
+#ifdef _WIN32
+	static PVOID storage_exception_handler{};
+
+	// reserved chunks are committed on first access, reads included
+	static LONG CALLBACK commit_storage_on_access(EXCEPTION_POINTERS* exception)
+	{
+		const EXCEPTION_RECORD* record = exception->ExceptionRecord;
+
+		if (record->ExceptionCode != EXCEPTION_ACCESS_VIOLATION || record->NumberParameters < 2)
+			return EXCEPTION_CONTINUE_SEARCH;
+
+		uint8_t* address = (uint8_t*)record->ExceptionInformation[1];
+
+		if (address < storage_tracker.base || address >= storage_tracker.base + storage_tracker.size)
+			return EXCEPTION_CONTINUE_SEARCH;
+
+		size_t chunk = (size_t)(address - storage_tracker.base) / storage_tracker.commit_size;
+
+		if (!VirtualAlloc(storage_tracker.base + chunk * storage_tracker.commit_size, storage_tracker.commit_size, MEM_COMMIT, PAGE_READWRITE))
+			return EXCEPTION_CONTINUE_SEARCH;
+
+		_InterlockedOr64((volatile LONG64*)&storage_tracker.committed[chunk >> 6], (LONG64)(1ull << (chunk & 63)));
+
+		return EXCEPTION_CONTINUE_EXECUTION;
+	}
+
+	static bool reserve_tracked_storage()
+	{
+		SYSTEM_INFO info{};
+		GetSystemInfo(&info);
+
+		// large pages have to be committed up front and cannot be write watched
+		if (storage_tracker.huge_pages)
+		{
+			LOG_WARN(TAG_PLATFORM, "huge page game storage is not supported on windows");
+			storage_tracker.huge_pages = false;
+		}
+
+		// the os records written pages for us, only committing needs the exception handler
+		void* base = VirtualAlloc((void*)STORAGE_BASE_ADDRESS, storage_tracker.size, MEM_RESERVE | MEM_WRITE_WATCH, PAGE_READWRITE);
+		if (!base)
+		{
+			LOG_WARN(TAG_PLATFORM, "game storage base address is in use, storage pointers will differ between runs");
+			base = VirtualAlloc(nullptr, storage_tracker.size, MEM_RESERVE | MEM_WRITE_WATCH, PAGE_READWRITE);
+		}
+
+		if (!base)
+			return false;
+
+		storage_tracker.base      = (uint8_t*)base;
+		storage_tracker.page_size = info.dwPageSize;
+		storage_tracker.shadow    = (uint8_t*)VirtualAlloc(nullptr, storage_tracker.size, MEM_RESERVE, PAGE_READWRITE);
+
+		if (!storage_tracker.shadow)
+		{
+			VirtualFree(base, 0, MEM_RELEASE);
+			return false;
+		}
+
+		return true;
+	}
+
+	static void install_storage_handler()
+	{
+		storage_exception_handler = AddVectoredExceptionHandler(1, commit_storage_on_access);
+	}
+
+	static void free_tracked_storage()
+	{
+		RemoveVectoredExceptionHandler(storage_exception_handler);
+		VirtualFree(storage_tracker.base, 0, MEM_RELEASE);
+		VirtualFree(storage_tracker.shadow, 0, MEM_RELEASE);
+	}
+
+	// the shadow is only ever touched by the snapshot code, it commits explicitly
+	static uint8_t* get_shadow_page(size_t offset)
+	{
+		size_t chunk = offset / storage_tracker.commit_size;
+
+		if (!test_storage_bit(storage_tracker.shadow_committed, chunk))
+		{
+			VirtualAlloc(storage_tracker.shadow + chunk * storage_tracker.commit_size, storage_tracker.commit_size, MEM_COMMIT, PAGE_READWRITE);
+			storage_tracker.shadow_committed[chunk >> 6] |= 1ull << (chunk & 63);
+		}
+
+		return storage_tracker.shadow + offset;
+	}
+
+	static void arm_storage_tracking()
+	{
+		ResetWriteWatch(storage_tracker.base, storage_tracker.size);
+	}
+
+	static void unprotect_storage()
+	{
+	}
+
+	// pages written since the last collect or arm, tracking is reset
+	static uint32_t collect_dirty_pages(uint32_t* pages)
+	{
+		ULONG_PTR count       = storage_tracker.page_count;
+		DWORD     granularity = 0;
+
+		if (GetWriteWatch(WRITE_WATCH_FLAG_RESET, storage_tracker.base, storage_tracker.size, storage_tracker.written, &count, &granularity) != 0)
+			return 0;
+
+		for (ULONG_PTR i = 0; i < count; ++i)
+		{
+			pages[i] = (uint32_t)(((uint8_t*)storage_tracker.written[i] - storage_tracker.base) / storage_tracker.page_size);
+		}
+
+		return (uint32_t)count;
+	}
+#else
+	static struct sigaction previous_fault_action{};
+
+	// reserved chunks are PROT_NONE, the first access commits the chunk read-only. committed
+	// pages stay read-only between snapshots, the first write to one marks it dirty and makes
+	// it writable again, so a first write faults twice
+	static void storage_fault_handler(int signal, siginfo_t* info, void* context)
+	{
+		uint8_t* address = (uint8_t*)info->si_addr;
+
+		if (address >= storage_tracker.base && address < storage_tracker.base + storage_tracker.size)
+		{
+			size_t offset = (size_t)(address - storage_tracker.base);
+			size_t chunk  = offset / storage_tracker.commit_size;
+
+			if (!test_storage_bit(storage_tracker.committed, chunk))
+			{
+				__atomic_fetch_or(&storage_tracker.committed[chunk >> 6], 1ull << (chunk & 63), __ATOMIC_RELAXED);
+				mprotect(storage_tracker.base + chunk * storage_tracker.commit_size, storage_tracker.commit_size, PROT_READ);
+				return;
+			}
+
+			size_t page = offset / storage_tracker.page_size;
+
+			__atomic_fetch_or(&storage_tracker.dirty[page >> 6], 1ull << (page & 63), __ATOMIC_RELAXED);
+			mprotect(storage_tracker.base + page * storage_tracker.page_size, storage_tracker.page_size, PROT_READ | PROT_WRITE);
+			return;
+		}
+
+		if ((previous_fault_action.sa_flags & SA_SIGINFO) && previous_fault_action.sa_sigaction)
+		{
+			previous_fault_action.sa_sigaction(signal, info, context);
+			return;
+		}
+
+		// not ours, the faulting instruction runs again with the previous handler in place
+		sigaction(SIGSEGV, &previous_fault_action, nullptr);
+	}
+
+	static uint8_t* reserve_aligned(void* address, size_t size, size_t alignment, int flags)
+	{
+		// over-reserve and trim so chunks line up with huge pages
+		size_t reserved = size + alignment;
+
+		void* base = mmap(address, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | flags, -1, 0);
+		if (base == MAP_FAILED)
+			return nullptr;
+
+		uintptr_t start   = (uintptr_t)base;
+		uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+		if (aligned > start)
+			munmap(base, aligned - start);
+		if (start + reserved > aligned + size)
+			munmap((void*)(aligned + size), start + reserved - aligned - size);
+
+		return (uint8_t*)aligned;
+	}
+
+	static bool reserve_tracked_storage()
+	{
+		uint8_t* base{};
+
+#ifdef MAP_FIXED_NOREPLACE
+		base = reserve_aligned((void*)STORAGE_BASE_ADDRESS, storage_tracker.size, storage_tracker.commit_size, MAP_FIXED_NOREPLACE);
+#endif
+
+		if (base != (uint8_t*)STORAGE_BASE_ADDRESS)
+		{
+			LOG_WARN(TAG_PLATFORM, "game storage base address is in use, storage pointers will differ between runs");
+
+			if (base)
+				munmap(base, storage_tracker.size);
+
+			base = reserve_aligned(nullptr, storage_tracker.size, storage_tracker.commit_size, 0);
+		}
+
+		if (!base)
+			return false;
+
+		storage_tracker.base      = base;
+		storage_tracker.page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+#ifdef MADV_HUGEPAGE
+		// dirty pages are tracked per huge page then, a 4 KB mprotect would split it
+		if (storage_tracker.huge_pages && madvise(base, storage_tracker.size, MADV_HUGEPAGE) == 0)
+			storage_tracker.page_size = storage_tracker.commit_size;
+		else
+			storage_tracker.huge_pages = false;
+#else
+		storage_tracker.huge_pages = false;
+#endif
+
+		// never written pages of a NORESERVE mapping cost nothing
+		void* shadow = mmap(nullptr, storage_tracker.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (shadow == MAP_FAILED)
+		{
+			munmap(base, storage_tracker.size);
+			return false;
+		}
+
+		storage_tracker.shadow = (uint8_t*)shadow;
+
+		return true;
+	}
+
+	static void install_storage_handler()
+	{
+		struct sigaction action{};
+		action.sa_sigaction = storage_fault_handler;
+		action.sa_flags     = SA_SIGINFO;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGSEGV, &action, &previous_fault_action);
+	}
+
+	static void free_tracked_storage()
+	{
+		sigaction(SIGSEGV, &previous_fault_action, nullptr);
+		munmap(storage_tracker.base, storage_tracker.size);
+		munmap(storage_tracker.shadow, storage_tracker.size);
+	}
+
+	static uint8_t* get_shadow_page(size_t offset)
+	{
+		return storage_tracker.shadow + offset;
+	}
+
+	// reserved chunks have to stay PROT_NONE, only committed ones change protection
+	static void protect_committed_storage(int protection)
+	{
+		const size_t chunk_count = storage_tracker.size / storage_tracker.commit_size;
+
+		for (size_t chunk = 0; chunk < chunk_count;)
+		{
+			if (!test_storage_bit(storage_tracker.committed, chunk))
+			{
+				++chunk;
+				continue;
+			}
+
+			size_t first = chunk;
+			while (chunk < chunk_count && test_storage_bit(storage_tracker.committed, chunk))
+				++chunk;
+
+			mprotect(storage_tracker.base + first * storage_tracker.commit_size, (chunk - first) * storage_tracker.commit_size, protection);
+		}
+	}
+
+	static void arm_storage_tracking()
+	{
+		memset(storage_tracker.dirty, 0, sizeof(uint64_t) * ((storage_tracker.page_count + 63) / 64));
+		protect_committed_storage(PROT_READ);
+	}
+
+	static void unprotect_storage()
+	{
+		protect_committed_storage(PROT_READ | PROT_WRITE);
+	}
+
+	static uint32_t collect_dirty_pages(uint32_t* pages)
+	{
+		uint32_t count{};
+
+		for (uint32_t word = 0; word < (storage_tracker.page_count + 63) / 64; ++word)
+		{
+			uint64_t bits = __atomic_exchange_n(&storage_tracker.dirty[word], 0ull, __ATOMIC_RELAXED);
+
+			while (bits)
+			{
+				pages[count++] = word * 64 + (uint32_t)__builtin_ctzll(bits);
+				bits &= bits - 1;
+			}
+		}
+
+		protect_committed_storage(PROT_READ);
+
+		return count;
+	}
+#endif
+
+	static size_t get_snapshot_raw_size(const storage_snapshot_t& snapshot)
+	{
+		return (size_t)snapshot.page_count * storage_tracker.page_size;
+	}
+
+	static void compress_snapshot(void* data)
+	{
+		storage_snapshot_t* snapshot = (storage_snapshot_t*)data;
+
+		size_t raw_size = get_snapshot_raw_size(*snapshot);
+		size_t bound    = ZSTD_compressBound(raw_size);
+		void*  buffer   = malloc(bound);
+
+		if (!buffer)
+			return;
+
+		size_t size = ZSTD_compress(buffer, bound, snapshot->data, raw_size, 1);
+
+		// incompressible pages stay raw, data_size tells the two apart
+		if (ZSTD_isError(size) || size >= raw_size)
+		{
+			free(buffer);
+			return;
+		}
+
+		free(snapshot->data);
+		snapshot->data      = buffer;
+		snapshot->data_size = size;
+	}
+
+	static void free_snapshot(storage_snapshot_t& snapshot)
+	{
+		wait_for_counter(&snapshot.compressed);
+
+		free(snapshot.pages);
+		free(snapshot.data);
+
+		snapshot = {};
+	}
+
+	void* create_game_storage(size_t size, bool huge_pages)
+	{
+		assert(!storage_tracker.base && "game storage already created");
+
+		uint64_t start = SDL_GetTicksNS();
+
+		storage_tracker.commit_size = STORAGE_COMMIT_SIZE;
+		storage_tracker.size        = (size + STORAGE_COMMIT_SIZE - 1) & ~(STORAGE_COMMIT_SIZE - 1);
+		storage_tracker.huge_pages  = huge_pages;
+
+		if (!reserve_tracked_storage())
+		{
+			LOG_ERROR(TAG_PLATFORM, "failed to reserve %zu bytes of game storage", size);
+			storage_tracker = {};
+			return nullptr;
+		}
+
+		const size_t chunk_words = (storage_tracker.size / storage_tracker.commit_size + 63) / 64;
+
+		storage_tracker.page_count       = (uint32_t)(storage_tracker.size / storage_tracker.page_size);
+		storage_tracker.committed        = (uint64_t*)calloc(chunk_words, sizeof(uint64_t));
+		storage_tracker.shadow_committed = (uint64_t*)calloc(chunk_words, sizeof(uint64_t));
+		storage_tracker.dirty            = (uint64_t*)calloc((storage_tracker.page_count + 63) / 64, sizeof(uint64_t));
+		storage_tracker.written          = (void**)calloc(storage_tracker.page_count, sizeof(void*));
+		storage_tracker.dirty_pages      = (uint32_t*)calloc(storage_tracker.page_count, sizeof(uint32_t));
+		assert(storage_tracker.committed && storage_tracker.shadow_committed && storage_tracker.dirty && storage_tracker.written && storage_tracker.dirty_pages && "calloc failed");
+
+		install_storage_handler();
+
+		// storage and shadow both start zeroed, nothing is dirty yet
+		arm_storage_tracking();
+
+		LOG_INFO(TAG_PLATFORM, "game storage reserved at %p, %zu MB%s in %.3f ms",
+			(void*)storage_tracker.base,
+			(size_t)(storage_tracker.size / MEGABYTES(1)),
+			storage_tracker.huge_pages ? " with huge pages" : "",
+			(SDL_GetTicksNS() - start) * 1e-6);
+
+		return storage_tracker.base;
+	}
+
+	void destroy_game_storage()
+	{
+		if (!storage_tracker.base)
+			return;
+
+		for (uint32_t i = 0; i < storage_tracker.count; ++i)
+		{
+			free_snapshot(storage_tracker.snapshots[(storage_tracker.first + i) % MAX_STORAGE_SNAPSHOTS]);
+		}
+
+		free_tracked_storage();
+
+		free(storage_tracker.committed);
+		free(storage_tracker.shadow_committed);
+		free(storage_tracker.dirty);
+		free(storage_tracker.written);
+		free(storage_tracker.dirty_pages);
+
+		storage_tracker = {};
+	}
+
+	uint64_t snapshot_game_storage()
+	{
+		if (!storage_tracker.base)
+			return 0;
+
+		if (storage_tracker.count == MAX_STORAGE_SNAPSHOTS)
+		{
+			free_snapshot(storage_tracker.snapshots[storage_tracker.first]);
+			storage_tracker.first = (storage_tracker.first + 1) % MAX_STORAGE_SNAPSHOTS;
+			--storage_tracker.count;
+		}
+
+		storage_snapshot_t& snapshot = storage_tracker.snapshots[(storage_tracker.first + storage_tracker.count) % MAX_STORAGE_SNAPSHOTS];
+
+		const size_t   page_size = storage_tracker.page_size;
+		const uint32_t count     = collect_dirty_pages(storage_tracker.dirty_pages);
+
+		snapshot            = {};
+		snapshot.id         = ++storage_tracker.next_id;
+		snapshot.page_count = count;
+		snapshot.pages      = (uint32_t*)malloc(sizeof(uint32_t) * SDL_max(count, 1u));
+		snapshot.data       = malloc(SDL_max((size_t)count * page_size, page_size));
+		snapshot.data_size  = (size_t)count * page_size;
+		assert(snapshot.pages && snapshot.data && "malloc failed");
+
+		memcpy(snapshot.pages, storage_tracker.dirty_pages, sizeof(uint32_t) * count);
+
+		// keep what the shadow held for undo, then bring the shadow up to date
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			size_t offset = (size_t)snapshot.pages[i] * page_size;
+			size_t size   = SDL_min(page_size, storage_tracker.size - offset);
+
+			uint8_t* shadow = get_shadow_page(offset);
+
+			memcpy((uint8_t*)snapshot.data + (size_t)i * page_size, shadow, size);
+			memcpy(shadow, storage_tracker.base + offset, size);
+		}
+
+		++storage_tracker.count;
+
+		if (count)
+		{
+			job_t job{ compress_snapshot, &snapshot };
+			run_jobs(&job, 1, &snapshot.compressed);
+		}
+
+		return snapshot.id;
+	}
+
+	bool restore_game_storage(uint64_t id)
+	{
+		uint32_t index = UINT32_MAX;
+
+		for (uint32_t i = 0; i < storage_tracker.count; ++i)
+		{
+			if (storage_tracker.snapshots[(storage_tracker.first + i) % MAX_STORAGE_SNAPSHOTS].id == id)
+				index = i;
+		}
+
+		if (index == UINT32_MAX)
+			return false;
+
+		const size_t page_size = storage_tracker.page_size;
+
+		// pages written since the latest snapshot go back to the shadow copy
+		uint32_t count = collect_dirty_pages(storage_tracker.dirty_pages);
+
+		unprotect_storage();
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			size_t offset = (size_t)storage_tracker.dirty_pages[i] * page_size;
+			memcpy(storage_tracker.base + offset, get_shadow_page(offset), SDL_min(page_size, storage_tracker.size - offset));
+		}
+
+		// then every newer snapshot is undone, newest first
+		while (storage_tracker.count > index + 1)
+		{
+			storage_snapshot_t& snapshot = storage_tracker.snapshots[(storage_tracker.first + storage_tracker.count - 1) % MAX_STORAGE_SNAPSHOTS];
+
+			wait_for_counter(&snapshot.compressed);
+
+			size_t   raw_size = get_snapshot_raw_size(snapshot);
+			uint8_t* pages    = (uint8_t*)snapshot.data;
+
+			if (snapshot.data_size < raw_size)
+			{
+				pages = (uint8_t*)malloc(raw_size);
+				assert(pages && "malloc failed");
+
+				size_t size = ZSTD_decompress(pages, raw_size, snapshot.data, snapshot.data_size);
+				assert(!ZSTD_isError(size) && size == raw_size && "corrupt storage snapshot");
+			}
+
+			for (uint32_t i = 0; i < snapshot.page_count; ++i)
+			{
+				size_t offset = (size_t)snapshot.pages[i] * page_size;
+				size_t size   = SDL_min(page_size, storage_tracker.size - offset);
+
+				memcpy(get_shadow_page(offset), pages + (size_t)i * page_size, size);
+				memcpy(storage_tracker.base + offset, pages + (size_t)i * page_size, size);
+			}
+
+			if (pages != snapshot.data)
+				free(pages);
+
+			free_snapshot(snapshot);
+			--storage_tracker.count;
+		}
+
+		// storage and shadow match again
+		arm_storage_tracking();
+
+		return true;
+	}
+
+	uint64_t get_latest_storage_snapshot()
+	{
+		if (storage_tracker.count == 0)
+			return 0;
+
+		return storage_tracker.snapshots[(storage_tracker.first + storage_tracker.count - 1) % MAX_STORAGE_SNAPSHOTS].id;
+	}
+
+	uint32_t get_storage_snapshot_count()
+	{
+		return storage_tracker.count;
+	}
+
+	bool is_game_storage_committed(const void* address)
+	{
+		const uint8_t* byte = (const uint8_t*)address;
+
+		if (byte < storage_tracker.base || byte >= storage_tracker.base + storage_tracker.size)
+			return true;
+
+		return test_storage_bit(storage_tracker.committed, (size_t)(byte - storage_tracker.base) / storage_tracker.commit_size);
+	}
+
+	size_t get_game_storage_committed()
+	{
+		size_t chunks{};
+
+		for (size_t chunk = 0; chunk < storage_tracker.size / SDL_max(storage_tracker.commit_size, (size_t)1); ++chunk)
+		{
+			chunks += test_storage_bit(storage_tracker.committed, chunk);
+		}
+
+		return chunks * storage_tracker.commit_size;
+	}
+
+	// --- replay ---
+
+	bool begin_replay_recording(replay_recorder_t& recorder, const char* path, const void* storage, size_t storage_size)
+	{
+		recorder = {};
+
+		size_t   bound      = ZSTD_compressBound(storage_size);
+		void*    compressed = malloc(bound);
+		uint8_t* zeros      = (uint8_t*)calloc(1, STORAGE_COMMIT_SIZE);
+		if (!compressed || !zeros)
+		{
+			free(compressed);
+			free(zeros);
+			return false;
+		}
+
+		// game storage is mostly untouched zero pages, the fastest level already shrinks it to a few kilobytes.
+		// chunks that were never committed are fed as zeros instead of being read (and committed)
+		ZSTD_CCtx* context = ZSTD_createCCtx();
+		ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, 1);
+		ZSTD_CCtx_setPledgedSrcSize(context, storage_size);
+
+		ZSTD_outBuffer output{ compressed, bound, 0 };
+		size_t         result{};
+
+		for (size_t offset = 0; offset < storage_size; offset += STORAGE_COMMIT_SIZE)
+		{
+			const uint8_t* chunk      = (const uint8_t*)storage + offset;
+			size_t         chunk_size = SDL_min(STORAGE_COMMIT_SIZE, storage_size - offset);
+			bool           last       = offset + chunk_size == storage_size;
+
+			ZSTD_inBuffer input{ is_game_storage_committed(chunk) ? chunk : zeros, chunk_size, 0 };
+
+			do
+			{
+				result = ZSTD_compressStream2(context, &output, &input, last ? ZSTD_e_end : ZSTD_e_continue);
+			} while (!ZSTD_isError(result) && (last ? result != 0 : input.pos < input.size));
+
+			if (ZSTD_isError(result))
+				break;
+		}
+
+		ZSTD_freeCCtx(context);
+		free(zeros);
+
+		size_t compressed_size = output.pos;
+
+		if (ZSTD_isError(result))
+		{
+			LOG_ERROR(TAG_PLATFORM, "failed to compress replay storage: %s", ZSTD_getErrorName(result));
+			free(compressed);
+			return false;
+		}
+
+		recorder.file = SDL_IOFromFile(path, "wb");
+		if (!recorder.file)
+		{
+			LOG_ERROR(TAG_PLATFORM, "failed to open %s for writing", path);
+			free(compressed);
+			return false;
+		}
+
+		recorder.header =
+		{
+			.magic                   = REPLAY_MAGIC,
+			.version                 = REPLAY_VERSION,
+			.frame_count             = 0,
+			.event_size              = sizeof(input_event_t),
+			.storage_size            = storage_size,
+			.storage_compressed_size = compressed_size
+		};
+
+		bool ok = SDL_WriteIO(recorder.file, &recorder.header, sizeof(recorder.header)) == sizeof(recorder.header);
+		ok = ok && SDL_WriteIO(recorder.file, compressed, compressed_size) == compressed_size;
+
+		free(compressed);
+
+		if (!ok)
+		{
+			LOG_ERROR(TAG_PLATFORM, "failed to write replay %s", path);
+			SDL_CloseIO(recorder.file);
+			recorder = {};
+			return false;
+		}
+
+		LOG_INFO(TAG_PLATFORM, "recording replay %s, storage %zu -> %zu bytes", path, storage_size, compressed_size);
+
+		return true;
+	}
+
+	void record_replay_frame(replay_recorder_t& recorder, float dt)
+	{
+		if (!recorder.file)
+			return;
+
+		replay_frame_t frame
+		{
+			.timestamp   = g_input_state.timestamp,
+			.dt          = dt,
+			.event_count = g_input_state.event_count
+		};
+
+		size_t events_size = sizeof(input_event_t) * frame.event_count;
+
+		bool ok = SDL_WriteIO(recorder.file, &frame, sizeof(frame)) == sizeof(frame);
+		ok = ok && SDL_WriteIO(recorder.file, g_input_state.events, events_size) == events_size;
+
+		if (!ok)
+		{
+			LOG_ERROR(TAG_PLATFORM, "failed to write replay frame %u, recording stopped", recorder.header.frame_count);
+			end_replay_recording(recorder);
+			return;
+		}
+
+		++recorder.header.frame_count;
+	}
+
+	void end_replay_recording(replay_recorder_t& recorder)
+	{
+		if (!recorder.file)
+			return;
+
+		if (SDL_SeekIO(recorder.file, 0, SDL_IO_SEEK_SET) >= 0)
+			SDL_WriteIO(recorder.file, &recorder.header, sizeof(recorder.header));
+
+		SDL_CloseIO(recorder.file);
+
+		LOG_INFO(TAG_PLATFORM, "replay recorded, %u frames", recorder.header.frame_count);
+
+		recorder = {};
+	}
+
+	bool open_replay(const char* path, replay_t& replay)
+	{
+		replay = {};
+
+		if (!map_file(path, replay.file))
+		{
+			LOG_ERROR(TAG_PLATFORM, "failed to open replay %s", path);
+			return false;
+		}
+
+		const replay_header_t* header = (const replay_header_t*)replay.file.data;
+
+		if (replay.file.size < sizeof(replay_header_t) ||
+			header->magic != REPLAY_MAGIC ||
+			header->version != REPLAY_VERSION ||
+			header->event_size != sizeof(input_event_t) ||
+			header->storage_compressed_size > replay.file.size - sizeof(replay_header_t))
+		{
+			LOG_ERROR(TAG_PLATFORM, "%s is not a valid replay", path);
+			unmap_file(replay.file);
+			return false;
+		}
+
+		replay.header = header;
+		replay.offset = sizeof(replay_header_t) + header->storage_compressed_size;
+
+		return true;
+	}
+
+	void close_replay(replay_t& replay)
+	{
+		unmap_file(replay.file);
+
+		replay = {};
+	}
+
+	bool restore_replay_storage(const replay_t& replay, void* storage, size_t storage_size)
+	{
+		if (replay.header->storage_size != storage_size)
+		{
+			LOG_ERROR(TAG_PLATFORM, "replay storage is %llu bytes, the game has %zu", (unsigned long long)replay.header->storage_size, storage_size);
+			return false;
+		}
+
+		uint8_t* chunk = (uint8_t*)malloc(STORAGE_COMMIT_SIZE);
+		if (!chunk)
+			return false;
+
+		// a chunk at a time, zero chunks are not written where the storage was never committed
+		ZSTD_DCtx*    context = ZSTD_createDCtx();
+		ZSTD_inBuffer input{ (const uint8_t*)replay.file.data + sizeof(replay_header_t), replay.header->storage_compressed_size, 0 };
+		bool          ok = true;
+
+		for (size_t offset = 0; ok && offset < storage_size; offset += STORAGE_COMMIT_SIZE)
+		{
+			uint8_t* destination = (uint8_t*)storage + offset;
+			size_t   chunk_size  = SDL_min(STORAGE_COMMIT_SIZE, storage_size - offset);
+
+			ZSTD_outBuffer output{ chunk, chunk_size, 0 };
+
+			while (ok && output.pos < output.size)
+			{
+				size_t written = output.pos;
+				size_t result  = ZSTD_decompressStream(context, &output, &input);
+
+				ok = !ZSTD_isError(result) && (output.pos > written || input.pos < input.size);
+			}
+
+			if (!ok)
+				break;
+
+			bool zero = true;
+			for (size_t i = 0; zero && i < chunk_size; i += sizeof(uint64_t))
+			{
+				uint64_t word;
+				memcpy(&word, chunk + i, sizeof(word));
+				zero = word == 0;
+			}
+
+			if (!zero || is_game_storage_committed(destination))
+				memcpy(destination, chunk, chunk_size);
+		}
+
+		ZSTD_freeDCtx(context);
+		free(chunk);
+
+		if (!ok)
+			LOG_ERROR(TAG_PLATFORM, "replay storage snapshot is corrupt");
+
+		return ok;
+	}
+
+	bool next_replay_frame(replay_t& replay, float& dt)
+	{
+		if (replay.frame >= replay.header->frame_count)
+			return false;
+
+		const uint8_t* data = (const uint8_t*)replay.file.data;
+
+		// records are packed, copy them out instead of reading in place
+		replay_frame_t frame{};
+		if (replay.file.size - replay.offset < sizeof(frame))
+			return false;
+
+		memcpy(&frame, data + replay.offset, sizeof(frame));
+		replay.offset += sizeof(frame);
+
+		size_t events_size = sizeof(input_event_t) * frame.event_count;
+		if (frame.event_count > MAX_FRAME_INPUT_EVENTS || replay.file.size - replay.offset < events_size)
+		{
+			LOG_ERROR(TAG_PLATFORM, "replay frame %u is truncated", replay.frame);
+			return false;
+		}
+
+		// a negative or non-finite step would poison the simulation
+		if (!isfinite(frame.dt) || frame.dt < 0.0f)
+		{
+			LOG_ERROR(TAG_PLATFORM, "replay frame %u has an invalid time step", replay.frame);
+			return false;
+		}
+
+		input_event_t events[MAX_FRAME_INPUT_EVENTS];
+		memcpy(events, data + replay.offset, events_size);
+		replay.offset += events_size;
+
+		for (uint32_t i = 0; i < frame.event_count; ++i)
+		{
+			if (!is_valid_input_event(events[i]))
+			{
+				LOG_ERROR(TAG_PLATFORM, "replay frame %u has an invalid input event", replay.frame);
+				return false;
+			}
+		}
+
+		apply_input_events(events, frame.event_count, frame.timestamp);
+
+		dt = frame.dt;
+		++replay.frame;
+
+		return true;
 	}
 
-} // olivia
\ No newline at end of file
+} // olivia
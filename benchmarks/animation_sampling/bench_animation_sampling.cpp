@@ -0,0 +1,180 @@
+#include "olivia/graphics/animation.h"
+#include "olivia/platform/sdl3_jobs.h"
+
+#include <math.h>
+
+// usage: bench_animation_sampling [instances=1000] [joints=80] [frames=100]
+//
+// every instance samples two compressed clips of a synthetic skeleton, blends
+// them and builds its skinning palette, like update_animations does for a
+// crowd of characters. the stages are timed alone on one core, then the whole
+// update on the caller only and on the job system. throughput is reported in
+// bones (joints) per ms, divided by the thread count for the per core figure.
+
+constexpr uint32_t CLIP_FRAMES{ 60 };
+
+struct bench_animation_t
+{
+	uint16_t                 parents[olivia::MAX_JOINTS];
+	olivia::joint_matrix_t   inverse_bind[olivia::MAX_JOINTS];
+	olivia::skeleton_t       skeleton;
+	olivia::joint_key_t*     keys[2];
+	olivia::animation_clip_t clips[2];
+};
+
+static double ms_since(uint64_t start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void create_animation(bench_animation_t& animation, uint32_t joint_count)
+{
+	animation.skeleton = { joint_count, animation.parents, animation.inverse_bind };
+
+	for (uint32_t joint = 0; joint < joint_count; ++joint)
+	{
+		// a spine with limbs branching every few joints, parents before children
+		animation.parents[joint]      = joint == 0 ? olivia::NO_PARENT : (uint16_t)(joint % 5 == 0 ? joint / 5 : joint - 1);
+		animation.inverse_bind[joint] = { { { 1, 0, 0, 0 }, { 0, 1, 0, -(float)joint * 0.1f }, { 0, 0, 1, 0 } } };
+	}
+
+	olivia::joint_transform_t* transforms = (olivia::joint_transform_t*)malloc(joint_count * CLIP_FRAMES * sizeof(olivia::joint_transform_t));
+	assert(transforms && "malloc failed");
+
+	for (uint32_t clip = 0; clip < 2; ++clip)
+	{
+		for (uint32_t frame = 0; frame < CLIP_FRAMES; ++frame)
+		{
+			for (uint32_t joint = 0; joint < joint_count; ++joint)
+			{
+				float angle = sinf((float)frame * 0.1f + (float)joint * 0.3f + (float)clip) * 0.8f;
+				float s     = sinf(angle * 0.5f);
+
+				// a different axis per joint so every quaternion component is the largest somewhere
+				olivia::vec4_t rotation = joint % 3 == 0 ? olivia::vec4_t{ s, 0, 0, cosf(angle * 0.5f) }
+				                        : joint % 3 == 1 ? olivia::vec4_t{ 0, s, 0, cosf(angle * 0.5f) }
+				                        : olivia::vec4_t{ 0, 0, s, cosf(angle * 0.5f) };
+
+				transforms[frame * joint_count + joint] = { rotation, { 0.0f, 0.1f, (float)frame * 0.001f }, 1.0f };
+			}
+		}
+
+		animation.keys[clip] = (olivia::joint_key_t*)malloc(joint_count * CLIP_FRAMES * sizeof(olivia::joint_key_t));
+		assert(animation.keys[clip] && "malloc failed");
+
+		olivia::compress_animation(transforms, joint_count, CLIP_FRAMES, 30.0f, animation.keys[clip], animation.clips[clip]);
+	}
+
+	free(transforms);
+}
+
+static void bench_stages(const bench_animation_t& animation, uint32_t iterations)
+{
+	static olivia::pose_t pose;
+	static olivia::pose_t other;
+	static olivia::joint_matrix_t palette[olivia::MAX_JOINTS];
+
+	const uint32_t joint_count = animation.skeleton.joint_count;
+	const double   bones       = (double)joint_count * iterations;
+
+	uint64_t start = SDL_GetPerformanceCounter();
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		olivia::sample_animation(animation.clips[i & 1], (float)i * 0.013f, pose);
+	}
+	double sample_ms = ms_since(start);
+
+	olivia::sample_animation(animation.clips[1], 0.5f, other);
+
+	start = SDL_GetPerformanceCounter();
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		olivia::blend_poses(pose, other, (float)(i & 15) / 16.0f, joint_count, pose);
+	}
+	double blend_ms = ms_since(start);
+
+	start = SDL_GetPerformanceCounter();
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		olivia::compute_skinning_palette(animation.skeleton, pose, palette);
+	}
+	double palette_ms = ms_since(start);
+
+	printf("sample  %10.0f bones/ms\n", bones / sample_ms);
+	printf("blend   %10.0f bones/ms\n", bones / blend_ms);
+	printf("palette %10.0f bones/ms\n", bones / palette_ms);
+}
+
+static void bench_update(const char* name, olivia::animation_instance_t* instances, uint32_t instance_count, uint32_t joint_count, uint32_t frames, uint32_t threads)
+{
+	uint64_t start = SDL_GetPerformanceCounter();
+
+	for (uint32_t frame = 0; frame < frames; ++frame)
+	{
+		for (uint32_t i = 0; i < instance_count; ++i)
+		{
+			instances[i].times[0] += 1.0f / 60.0f;
+			instances[i].times[1] += 1.0f / 60.0f;
+		}
+
+		olivia::update_animations(instances, instance_count);
+	}
+
+	double elapsed = ms_since(start);
+	double bones   = (double)joint_count * instance_count * frames;
+
+	printf("%-9s %2u threads  %7.3f ms/frame  %10.0f bones/ms  %9.0f bones/ms per core\n",
+		name, threads, elapsed / frames, bones / elapsed, bones / elapsed / threads);
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t instance_count = argc > 1 ? (uint32_t)atoi(argv[1]) : 1000;
+	uint32_t joint_count    = argc > 2 ? (uint32_t)atoi(argv[2]) : 80;
+	uint32_t frames         = argc > 3 ? (uint32_t)atoi(argv[3]) : 100;
+
+	joint_count = SDL_clamp(joint_count, 1u, olivia::MAX_JOINTS);
+
+	static bench_animation_t animation;
+	create_animation(animation, joint_count);
+
+	olivia::animation_instance_t* instances = (olivia::animation_instance_t*)malloc(instance_count * sizeof(olivia::animation_instance_t));
+	olivia::joint_matrix_t*       palettes  = (olivia::joint_matrix_t*)malloc((size_t)instance_count * joint_count * sizeof(olivia::joint_matrix_t));
+	assert(instances && palettes && "malloc failed");
+
+	for (uint32_t i = 0; i < instance_count; ++i)
+	{
+		instances[i] =
+		{
+			&animation.skeleton,
+			{ &animation.clips[0], &animation.clips[1] },
+			{ (float)i * 0.037f, (float)i * 0.011f },
+			(float)(i % 5) * 0.2f,  // a fifth of the crowd plays a single clip
+			palettes + (size_t)i * joint_count
+		};
+	}
+
+	printf("%u instances, %u joints, %u clip frames, %u frames\n", instance_count, joint_count, CLIP_FRAMES, frames);
+
+	bench_stages(animation, 20000);
+
+	// without workers update_animations runs every batch on the caller
+	bench_update("caller", instances, instance_count, joint_count, frames, 1);
+
+	olivia::init_job_system(0);
+
+	uint32_t threads = olivia::get_job_worker_count() + 1;
+	bench_update("jobs", instances, instance_count, joint_count, frames, threads);
+
+	olivia::destroy_job_system();
+
+	free(palettes);
+	free(instances);
+
+	for (uint32_t clip = 0; clip < 2; ++clip)
+	{
+		free(animation.keys[clip]);
+	}
+
+	return 0;
+}
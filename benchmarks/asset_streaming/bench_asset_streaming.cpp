@@ -0,0 +1,209 @@
+#include "olivia/olivia_asset.h"
+#include "olivia/core/vector.h"
+
+// usage: bench_asset_streaming [scene_mb=2048] [block_kb=128]
+//
+// writes the same synthetic scene as an uncompressed, LZ4 and zstd pack and
+// loads each one back through the job system. ASSET_CODEC_NONE is the
+// uncompressed mmap + copy baseline. packs are read straight after being
+// written, so numbers reflect a warm page cache unless it is dropped between
+// the write and load phases.
+
+struct bench_vertex_t
+{
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+struct bench_scene_t
+{
+	olivia::vector_t<olivia::asset_mesh_source_t> meshes;
+	olivia::vector_t<void*>                        allocations;
+	size_t                                         raw_bytes;
+};
+
+constexpr uint32_t GRID_SIZE{ 1024 };
+
+static double seconds_since(uint64_t start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
+
+static bench_scene_t create_scene(size_t scene_bytes)
+{
+	bench_scene_t scene{};
+	scene.meshes      = olivia::create_vector<olivia::asset_mesh_source_t>(64);
+	scene.allocations = olivia::create_vector<void*>(128);
+
+	const uint32_t vertex_count = GRID_SIZE * GRID_SIZE;
+	const uint32_t index_count  = (GRID_SIZE - 1) * (GRID_SIZE - 1) * 6;
+	const size_t   mesh_bytes   = vertex_count * sizeof(bench_vertex_t) + index_count * sizeof(uint32_t);
+
+	for (uint32_t mesh = 0; scene.raw_bytes < scene_bytes; ++mesh)
+	{
+		bench_vertex_t* vertices = (bench_vertex_t*)malloc(vertex_count * sizeof(bench_vertex_t));
+		uint32_t*       indices  = (uint32_t*)malloc(index_count * sizeof(uint32_t));
+		assert(vertices && indices && "malloc failed");
+
+		// a displaced height field: quantized positions and repeating topology
+		// compress roughly like real terrain/prop geometry
+		for (uint32_t y = 0; y < GRID_SIZE; ++y)
+		{
+			for (uint32_t x = 0; x < GRID_SIZE; ++x)
+			{
+				bench_vertex_t& v = vertices[y * GRID_SIZE + x];
+
+				float height = (float)(((x * 7 + y * 13 + mesh * 31) >> 3) & 63) * 0.25f;
+
+				v.position[0] = (float)x;
+				v.position[1] = height;
+				v.position[2] = (float)y;
+				v.normal[0]   = 0.0f;
+				v.normal[1]   = 1.0f;
+				v.normal[2]   = 0.0f;
+				v.uv[0]       = (float)x / (float)(GRID_SIZE - 1);
+				v.uv[1]       = (float)y / (float)(GRID_SIZE - 1);
+			}
+		}
+
+		uint32_t* index = indices;
+		for (uint32_t y = 0; y < GRID_SIZE - 1; ++y)
+		{
+			for (uint32_t x = 0; x < GRID_SIZE - 1; ++x)
+			{
+				uint32_t i = y * GRID_SIZE + x;
+
+				*index++ = i;
+				*index++ = i + GRID_SIZE;
+				*index++ = i + 1;
+				*index++ = i + 1;
+				*index++ = i + GRID_SIZE;
+				*index++ = i + GRID_SIZE + 1;
+			}
+		}
+
+		olivia::vector_push_back(scene.meshes, { vertices, vertex_count, (uint32_t)sizeof(bench_vertex_t), indices, index_count });
+		olivia::vector_push_back(scene.allocations, (void*)vertices);
+		olivia::vector_push_back(scene.allocations, (void*)indices);
+
+		scene.raw_bytes += mesh_bytes;
+	}
+
+	return scene;
+}
+
+static void destroy_scene(bench_scene_t& scene)
+{
+	for (size_t i = 0; i < scene.allocations.size; ++i)
+	{
+		free(scene.allocations.data[i]);
+	}
+
+	olivia::destroy_vector(scene.allocations);
+	olivia::destroy_vector(scene.meshes);
+}
+
+static void bench_pack(const char* name, const char* path, const bench_scene_t& scene, olivia::asset_codec_t codec, uint32_t block_size, uint8_t* destination)
+{
+	uint64_t start = SDL_GetPerformanceCounter();
+
+	if (!olivia::write_asset_pack(path, scene.meshes.data, (uint32_t)scene.meshes.size, codec, block_size))
+	{
+		printf("%-6s failed to write %s\n", name, path);
+		return;
+	}
+
+	double write_time = seconds_since(start);
+
+	olivia::asset_pack_t pack;
+	if (!olivia::open_asset_pack(path, pack))
+	{
+		printf("%-6s failed to open %s\n", name, path);
+		return;
+	}
+
+	const double raw_mb        = (double)scene.raw_bytes / (double)MEGABYTES(1);
+	const double compressed_mb = (double)(pack.file.size - pack.header->data_offset) / (double)MEGABYTES(1);
+
+	// single core decode throughput over a cache-resident scratch block
+	uint8_t* scratch = (uint8_t*)malloc(pack.header->block_size);
+	assert(scratch && "malloc failed");
+
+	start = SDL_GetPerformanceCounter();
+	size_t decoded = 0;
+	for (uint32_t i = 0; i < pack.header->block_count; ++i)
+	{
+		olivia::decompress_asset_block(pack, i, scratch, pack.header->block_size);
+		decoded += pack.blocks[i].raw_size;
+	}
+	double core_time = seconds_since(start);
+
+	free(scratch);
+
+	// end-to-end: every block decoded in parallel into its final location
+	auto targets = olivia::create_vector<olivia::asset_block_target_t>(pack.header->block_count);
+
+	size_t offset = 0;
+	for (uint32_t i = 0; i < pack.header->block_count; ++i)
+	{
+		olivia::vector_push_back(targets, { i, destination + offset, pack.blocks[i].raw_size });
+		offset += pack.blocks[i].raw_size;
+	}
+
+	olivia::close_asset_pack(pack);
+
+	start = SDL_GetPerformanceCounter();
+
+	olivia::open_asset_pack(path, pack);
+	bool ok = olivia::decompress_asset_blocks(pack, targets.data, (uint32_t)targets.size);
+
+	double load_time = seconds_since(start);
+
+	olivia::close_asset_pack(pack);
+	olivia::destroy_vector(targets);
+
+	printf("%-6s ratio %5.2f  write %7.2f s  decode/core %8.1f MB/s  load %8.1f ms  %8.1f MB/s%s\n",
+		name,
+		raw_mb / compressed_mb,
+		write_time,
+		(double)decoded / (double)MEGABYTES(1) / core_time,
+		load_time * 1000.0,
+		raw_mb / load_time,
+		ok ? "" : "  (FAILED)");
+
+	SDL_RemovePath(path);
+}
+
+int main(int argc, char* argv[])
+{
+	size_t   scene_mb = argc > 1 ? (size_t)atoll(argv[1]) : 2048;
+	uint32_t block_kb = argc > 2 ? (uint32_t)atoi(argv[2]) : 128;
+
+	olivia::init_job_system(0);
+
+	bench_scene_t scene = create_scene(MEGABYTES(scene_mb));
+
+	uint8_t* destination = (uint8_t*)malloc(scene.raw_bytes);
+	assert(destination && "malloc failed");
+
+	// fault the destination in up front so page faults are not timed as decode
+	memset(destination, 0, scene.raw_bytes);
+
+	printf("scene: %zu meshes, %.1f MB, block %u KB, %u threads\n",
+		scene.meshes.size,
+		(double)scene.raw_bytes / (double)MEGABYTES(1),
+		block_kb,
+		olivia::get_job_worker_count() + 1);
+
+	bench_pack("none", "bench_none.olva", scene, olivia::ASSET_CODEC_NONE, (uint32_t)KILOBYTES(block_kb), destination);
+	bench_pack("lz4",  "bench_lz4.olva",  scene, olivia::ASSET_CODEC_LZ4,  (uint32_t)KILOBYTES(block_kb), destination);
+	bench_pack("zstd", "bench_zstd.olva", scene, olivia::ASSET_CODEC_ZSTD, (uint32_t)KILOBYTES(block_kb), destination);
+
+	free(destination);
+	destroy_scene(scene);
+
+	olivia::destroy_job_system();
+
+	return 0;
+}
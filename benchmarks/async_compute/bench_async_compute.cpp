@@ -0,0 +1,475 @@
+#include "olivia/olivia_graphics.h"
+#include "olivia/olivia_platform.h"
+
+// usage: bench_async_compute [frames=1000] [compute_iterations=512] [shade_iterations=256]
+//
+// every frame simulates PARTICLE_COUNT particles on compute and draws a fullscreen
+// pass whose fragment shader reads them. the same frames run twice with vsync off:
+// serialized, with the simulation recorded ahead of the pass on the graphics queue,
+// and overlapped, with the simulation submitted to the compute-only queue. the
+// overlapped pass waits for the simulation at the fragment stage only, so the
+// simulation runs next to the previous frame's shading and the current frame's
+// vertex work. tune the iteration counts until both halves take a few ms.
+
+constexpr uint32_t PARTICLE_COUNT{ 1 << 20 };
+constexpr uint32_t WARMUP_FRAMES{ 60 };
+
+struct bench_push_t
+{
+	uint32_t iterations;
+	uint32_t count;
+};
+
+struct bench_t
+{
+	VkDescriptorSetLayout   set_layout;
+	VkDescriptorPool        descriptor_pool;
+	VkDescriptorSet         sets[olivia::MAX_FRAMES];
+	olivia::vulkan_buffer_t particles[olivia::MAX_FRAMES]; // per frame slot, the previous frame still reads its own
+	VkPipelineLayout        pipeline_layout;
+	VkPipeline              simulate;
+	VkPipeline              shade;
+	uint32_t                compute_iterations;
+	uint32_t                shade_iterations;
+};
+
+struct bench_result_t
+{
+	double frame_ms;
+	double main_pass_ms;
+};
+
+static bench_t bench{};
+
+static VkShaderModule load_shader(const char* name)
+{
+	char path[512];
+	SDL_snprintf(path, sizeof(path), "%s%s", SDL_GetBasePath(), name);
+
+	size_t size{};
+	void* code = SDL_LoadFile(path, &size);
+	if (!code)
+	{
+		printf("failed to load %s\n", path);
+		abort();
+	}
+
+	VkShaderModuleCreateInfo module_info
+	{
+		.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		.codeSize = size,
+		.pCode = (const uint32_t*)code
+	};
+
+	VkShaderModule module{};
+	VK_CHECK(vkCreateShaderModule(olivia::g_vulkan_core.device, &module_info, nullptr, &module));
+
+	SDL_free(code);
+
+	return module;
+}
+
+static void create_bench()
+{
+	VkDevice device = olivia::g_vulkan_core.device;
+
+	// particles are written on the compute queue and read on the graphics queue
+	uint32_t families[2];
+	uint32_t family_count = olivia::get_shared_queue_families(families);
+
+	for (uint32_t i = 0; i < olivia::MAX_FRAMES; ++i)
+	{
+		VkBufferCreateInfo buffer_info
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.size = PARTICLE_COUNT * sizeof(float) * 4,
+			.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			.sharingMode = family_count > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = family_count > 1 ? family_count : 0,
+			.pQueueFamilyIndices = families
+		};
+
+		VmaAllocationCreateInfo allocation_info
+		{
+			.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+		};
+
+		olivia::vulkan_buffer_t& buffer = bench.particles[i];
+		VK_CHECK(vmaCreateBuffer(olivia::g_vulkan_core.allocator, &buffer_info, &allocation_info, &buffer.buffer, &buffer.allocation, &buffer.info));
+	}
+
+	VkDescriptorSetLayoutBinding binding
+	{
+		.binding = 0,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = 1,
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
+	};
+
+	VkDescriptorSetLayoutCreateInfo set_layout_info
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.bindingCount = 1,
+		.pBindings = &binding
+	};
+
+	VK_CHECK(vkCreateDescriptorSetLayout(device, &set_layout_info, nullptr, &bench.set_layout));
+
+	VkDescriptorPoolSize pool_size
+	{
+		.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = olivia::MAX_FRAMES
+	};
+
+	VkDescriptorPoolCreateInfo pool_info
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.maxSets = olivia::MAX_FRAMES,
+		.poolSizeCount = 1,
+		.pPoolSizes = &pool_size
+	};
+
+	VK_CHECK(vkCreateDescriptorPool(device, &pool_info, nullptr, &bench.descriptor_pool));
+
+	VkDescriptorSetLayout set_layouts[olivia::MAX_FRAMES];
+	for (uint32_t i = 0; i < olivia::MAX_FRAMES; ++i)
+	{
+		set_layouts[i] = bench.set_layout;
+	}
+
+	VkDescriptorSetAllocateInfo set_info
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = bench.descriptor_pool,
+		.descriptorSetCount = olivia::MAX_FRAMES,
+		.pSetLayouts = set_layouts
+	};
+
+	VK_CHECK(vkAllocateDescriptorSets(device, &set_info, bench.sets));
+
+	for (uint32_t i = 0; i < olivia::MAX_FRAMES; ++i)
+	{
+		VkDescriptorBufferInfo buffer_info
+		{
+			.buffer = bench.particles[i].buffer,
+			.range = VK_WHOLE_SIZE
+		};
+
+		VkWriteDescriptorSet write
+		{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = bench.sets[i],
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.pBufferInfo = &buffer_info
+		};
+
+		vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+	}
+
+	VkPushConstantRange push_range
+	{
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+		.size = sizeof(bench_push_t)
+	};
+
+	VkPipelineLayoutCreateInfo pipeline_layout_info
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = 1,
+		.pSetLayouts = &bench.set_layout,
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &push_range
+	};
+
+	VK_CHECK(vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &bench.pipeline_layout));
+
+	// simulate
+	{
+		VkShaderModule module = load_shader("bench_simulate.comp.spv");
+
+		VkComputePipelineCreateInfo pipeline_info
+		{
+			.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+			.stage =
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+				.module = module,
+				.pName = "main"
+			},
+			.layout = bench.pipeline_layout
+		};
+
+		VK_CHECK(vkCreateComputePipelines(device, olivia::g_vulkan_core.pipeline_cache, 1, &pipeline_info, nullptr, &bench.simulate));
+
+		vkDestroyShaderModule(device, module, nullptr);
+	}
+
+	// shade
+	{
+		VkShaderModule vertex   = load_shader("bench_fullscreen.vert.spv");
+		VkShaderModule fragment = load_shader("bench_shade.frag.spv");
+
+		VkPipelineShaderStageCreateInfo stages[]
+		{
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_VERTEX_BIT,
+				.module = vertex,
+				.pName = "main"
+			},
+			{
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+				.module = fragment,
+				.pName = "main"
+			}
+		};
+
+		VkPipelineVertexInputStateCreateInfo vertex_input
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO
+		};
+
+		VkPipelineInputAssemblyStateCreateInfo input_assembly
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+			.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+		};
+
+		VkPipelineViewportStateCreateInfo viewport
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+			.viewportCount = 1,
+			.scissorCount = 1
+		};
+
+		VkPipelineRasterizationStateCreateInfo rasterization
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+			.polygonMode = VK_POLYGON_MODE_FILL,
+			.cullMode = VK_CULL_MODE_NONE,
+			.lineWidth = 1.0f
+		};
+
+		VkPipelineMultisampleStateCreateInfo multisample
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+		};
+
+		VkPipelineDepthStencilStateCreateInfo depth_stencil
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
+		};
+
+		VkPipelineColorBlendAttachmentState blend_attachment
+		{
+			.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+		};
+
+		VkPipelineColorBlendStateCreateInfo blend
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+			.attachmentCount = 1,
+			.pAttachments = &blend_attachment
+		};
+
+		// begin_pass sets the depth state
+		VkDynamicState dynamic_states[]
+		{
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR,
+			VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+			VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+			VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
+		};
+
+		VkPipelineDynamicStateCreateInfo dynamic
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.dynamicStateCount = ARRAY_SIZE(dynamic_states),
+			.pDynamicStates = dynamic_states
+		};
+
+		VkPipelineRenderingCreateInfo rendering
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+			.colorAttachmentCount = 1,
+			.pColorAttachmentFormats = &olivia::g_vulkan_core.swapchain_format.format,
+			.depthAttachmentFormat = olivia::g_vulkan_core.depth_format
+		};
+
+		VkGraphicsPipelineCreateInfo pipeline_info
+		{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = &rendering,
+			.stageCount = ARRAY_SIZE(stages),
+			.pStages = stages,
+			.pVertexInputState = &vertex_input,
+			.pInputAssemblyState = &input_assembly,
+			.pViewportState = &viewport,
+			.pRasterizationState = &rasterization,
+			.pMultisampleState = &multisample,
+			.pDepthStencilState = &depth_stencil,
+			.pColorBlendState = &blend,
+			.pDynamicState = &dynamic,
+			.layout = bench.pipeline_layout
+		};
+
+		VK_CHECK(vkCreateGraphicsPipelines(device, olivia::g_vulkan_core.pipeline_cache, 1, &pipeline_info, nullptr, &bench.shade));
+
+		vkDestroyShaderModule(device, vertex, nullptr);
+		vkDestroyShaderModule(device, fragment, nullptr);
+	}
+}
+
+static void destroy_bench()
+{
+	VkDevice device = olivia::g_vulkan_core.device;
+
+	vkDestroyPipeline(device, bench.shade, nullptr);
+	vkDestroyPipeline(device, bench.simulate, nullptr);
+	vkDestroyPipelineLayout(device, bench.pipeline_layout, nullptr);
+	vkDestroyDescriptorPool(device, bench.descriptor_pool, nullptr);
+	vkDestroyDescriptorSetLayout(device, bench.set_layout, nullptr);
+
+	for (uint32_t i = 0; i < olivia::MAX_FRAMES; ++i)
+	{
+		olivia::destroy_vulkan_buffer(bench.particles[i]);
+	}
+}
+
+static void record_simulation(VkCommandBuffer cmd, void*)
+{
+	bench_push_t push{ bench.compute_iterations, PARTICLE_COUNT };
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bench.simulate);
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, bench.pipeline_layout, 0, 1, &bench.sets[olivia::g_vulkan_core.current_frame], 0, nullptr);
+	vkCmdPushConstants(cmd, bench.pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(push), &push);
+	vkCmdDispatch(cmd, PARTICLE_COUNT / 256, 1, 1);
+}
+
+static void draw_bench()
+{
+	if (olivia::g_vulkan_core.current_pass != olivia::RENDER_PASS_MAIN)
+		return;
+
+	VkCommandBuffer cmd = olivia::g_vulkan_core.command_buffers[olivia::g_vulkan_core.current_frame];
+
+	bench_push_t push{ bench.shade_iterations, PARTICLE_COUNT };
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, bench.shade);
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, bench.pipeline_layout, 0, 1, &bench.sets[olivia::g_vulkan_core.current_frame], 0, nullptr);
+	vkCmdPushConstants(cmd, bench.pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(push), &push);
+	vkCmdDraw(cmd, 3, 1, 0, 0);
+}
+
+static bench_result_t run_frames(uint32_t frames)
+{
+	bench_result_t result{};
+	uint64_t       start{};
+	uint32_t       measured{};
+
+	for (uint32_t frame = 0; measured < frames; ++frame)
+	{
+		SDL_Event event;
+		while (SDL_PollEvent(&event)) {}
+
+		if (frame == WARMUP_FRAMES)
+		{
+			start = SDL_GetPerformanceCounter();
+		}
+
+		olivia::schedule_compute(record_simulation, nullptr, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+
+		if (!olivia::begin_frame())
+			continue;
+
+		olivia::draw_frame(draw_bench);
+		olivia::end_frame();
+
+		if (frame >= WARMUP_FRAMES)
+		{
+			// timings of the frame slot that was just waited for
+			result.main_pass_ms += olivia::get_gpu_pass_time(olivia::RENDER_PASS_MAIN);
+			++measured;
+		}
+	}
+
+	olivia::wait_timeline_value(olivia::g_vulkan_core.timeline_value);
+
+	result.frame_ms      = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency() / frames;
+	result.main_pass_ms /= frames;
+
+	return result;
+}
+
+static void print_result(const char* name, const bench_result_t& result)
+{
+	printf("%-10s frame %7.3f ms  %7.1f fps  main pass %7.3f ms\n", name, result.frame_ms, 1000.0 / result.frame_ms, result.main_pass_ms);
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t frames          = argc > 1 ? (uint32_t)SDL_atoi(argv[1]) : 1000;
+	bench.compute_iterations = argc > 2 ? (uint32_t)SDL_atoi(argv[2]) : 512;
+	bench.shade_iterations   = argc > 3 ? (uint32_t)SDL_atoi(argv[3]) : 256;
+
+	frames = SDL_max(frames, 1u);
+
+	if (!SDL_Init(SDL_INIT_VIDEO))
+	{
+		printf("SDL_Init failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	SDL_Window* window = SDL_CreateWindow("bench_async_compute", 1280, 720, SDL_WINDOW_VULKAN);
+	if (!window)
+	{
+		printf("SDL_CreateWindow failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	olivia::init_job_system(0);
+	olivia::init_renderer(window);
+	olivia::set_vsync(false);
+
+	create_bench();
+
+	const bool has_compute_queue = olivia::is_async_compute_enabled();
+
+	printf("particles %u, compute iterations %u, shade iterations %u, %u frames\n",
+		PARTICLE_COUNT, bench.compute_iterations, bench.shade_iterations, frames);
+
+	olivia::set_async_compute(false);
+	bench_result_t serialized = run_frames(frames);
+	print_result("serialized", serialized);
+
+	if (has_compute_queue)
+	{
+		olivia::set_async_compute(true);
+		bench_result_t overlapped = run_frames(frames);
+		print_result("overlapped", overlapped);
+
+		printf("overlap saves %.3f ms per frame (%.1f%%)\n",
+			serialized.frame_ms - overlapped.frame_ms,
+			(serialized.frame_ms - overlapped.frame_ms) * 100.0 / serialized.frame_ms);
+	}
+	else
+	{
+		printf("no compute-only queue family, compute always runs serialized on the graphics queue\n");
+	}
+
+	vkDeviceWaitIdle(olivia::g_vulkan_core.device);
+
+	destroy_bench();
+	olivia::destroy_renderer();
+	olivia::destroy_job_system();
+
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+
+	return 0;
+}
@@ -0,0 +1,31 @@
+#version 450
+
+layout(location = 0) in vec2 in_uv;
+
+layout(location = 0) out vec4 out_color;
+
+layout(set = 0, binding = 0) readonly buffer particles_t
+{
+	vec4 particles[];
+};
+
+layout(push_constant) uniform push_t
+{
+	uint iterations;
+	uint count;
+} push;
+
+void main()
+{
+	// reads the simulation, so the pass has to wait for this frame's compute
+	vec2 p = in_uv + particles[uint(in_uv.x * 1023.0)].xy * 0.0001;
+	vec3 color = vec3(0.0);
+
+	for (uint i = 0; i < push.iterations; ++i)
+	{
+		p = clamp(vec2(p.x * p.x - p.y * p.y, 2.0 * p.x * p.y) + in_uv - 0.5, -4.0, 4.0);
+		color += vec3(abs(p), length(p)) * 0.001;
+	}
+
+	out_color = vec4(fract(color), 1.0);
+}
@@ -0,0 +1,272 @@
+#include "olivia/graphics/bvh.h"
+#include "olivia/platform/sdl3_jobs.h"
+
+#include <math.h>
+
+// usage: bench_bvh_culling [instances=1000000] [iterations=20] [rays=100000]
+//
+// scatters instances of a few mesh bounds with random transforms over a 4 km square
+// and culls them against a 60 degree camera in the middle looking across it. the
+// brute force loop tests every instance's bounds, the bvh culls on the caller only and
+// on the job system, then four views (shadow cascades, say) are culled in one batch.
+// refit moves a tenth of the instances, rays are traced on the job system.
+
+using olivia::vec3_t;
+using olivia::aabb_t;
+
+struct bench_t
+{
+	aabb_t*   bounds;
+	uint32_t* visible[4];
+	uint32_t  instance_count;
+	uint32_t  iterations;
+};
+
+static bench_t bench{};
+
+static uint32_t random_state = 1;
+
+static float random_float(float min, float max)
+{
+	random_state = random_state * 1664525u + 1013904223u;
+	return min + (max - min) * (float)(random_state >> 8) / (float)(1u << 24);
+}
+
+static double ms_since(uint64_t start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static vec3_t sub(vec3_t a, vec3_t b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static float  dot(vec3_t a, vec3_t b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+static vec3_t cross(vec3_t a, vec3_t b)
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+static vec3_t normalize(vec3_t v)
+{
+	float length = sqrtf(dot(v, v));
+	return { v.x / length, v.y / length, v.z / length };
+}
+
+// column major look-at times a reverse-Z infinite perspective
+static olivia::frustum_t make_camera(vec3_t eye, vec3_t target)
+{
+	vec3_t forward = normalize(sub(target, eye));
+	vec3_t right   = normalize(cross(forward, { 0.0f, 1.0f, 0.0f }));
+	vec3_t up      = cross(right, forward);
+
+	const float f      = 1.0f / tanf(0.5f * 1.0471976f);
+	const float aspect = 16.0f / 9.0f;
+	const float znear  = 0.1f;
+
+	const float view[3][4]
+	{
+		{  right.x,    right.y,    right.z,   -dot(right, eye)   },
+		{ -up.x,      -up.y,      -up.z,       dot(up, eye)      },
+		{  forward.x,  forward.y,  forward.z, -dot(forward, eye) }
+	};
+
+	float m[16];
+	for (uint32_t column = 0; column < 4; ++column)
+	{
+		m[column * 4 + 0] = view[0][column] * f / aspect;
+		m[column * 4 + 1] = view[1][column] * f;
+		m[column * 4 + 2] = column == 3 ? znear : 0.0f;
+		m[column * 4 + 3] = view[2][column];
+	}
+
+	return olivia::make_frustum(m);
+}
+
+static void create_instances()
+{
+	// a crate, a car, a house and a tower
+	const aabb_t meshes[4]
+	{
+		{ { -0.5f, 0.0f, -0.5f }, {  0.5f,  1.0f,  0.5f } },
+		{ { -1.0f, 0.0f, -2.2f }, {  1.0f,  1.5f,  2.2f } },
+		{ { -5.0f, 0.0f, -4.0f }, {  5.0f,  7.0f,  4.0f } },
+		{ { -8.0f, 0.0f, -8.0f }, {  8.0f, 60.0f,  8.0f } }
+	};
+
+	for (uint32_t i = 0; i < bench.instance_count; ++i)
+	{
+		const float angle = random_float(0.0f, 6.2831853f);
+		const float scale = random_float(0.5f, 1.5f);
+		const float c     = cosf(angle) * scale;
+		const float s     = sinf(angle) * scale;
+
+		// rotation around y, uniform scale, on the ground
+		const float model[16]
+		{
+			c,    0.0f,  -s,   0.0f,
+			0.0f, scale, 0.0f, 0.0f,
+			s,    0.0f,  c,    0.0f,
+			random_float(-2000.0f, 2000.0f), 0.0f, random_float(-2000.0f, 2000.0f), 1.0f
+		};
+
+		bench.bounds[i] = olivia::transform_aabb(meshes[i % 7 == 0 ? 3 : i % 4], model);
+	}
+}
+
+static double bench_brute_force(const olivia::frustum_t& frustum, uint32_t& visible_count)
+{
+	uint64_t start = SDL_GetPerformanceCounter();
+
+	for (uint32_t iteration = 0; iteration < bench.iterations; ++iteration)
+	{
+		visible_count = 0;
+
+		for (uint32_t i = 0; i < bench.instance_count; ++i)
+		{
+			if (olivia::is_aabb_visible(frustum, bench.bounds[i]))
+			{
+				bench.visible[0][visible_count++] = i;
+			}
+		}
+	}
+
+	return ms_since(start) / bench.iterations;
+}
+
+static double bench_cull(const olivia::bvh_t& bvh, olivia::bvh_cull_query_t* queries, uint32_t query_count)
+{
+	uint64_t start = SDL_GetPerformanceCounter();
+
+	for (uint32_t iteration = 0; iteration < bench.iterations; ++iteration)
+	{
+		olivia::cull_bvh(bvh, queries, query_count);
+	}
+
+	return ms_since(start) / bench.iterations;
+}
+
+int main(int argc, char* argv[])
+{
+	bench.instance_count = argc > 1 ? (uint32_t)atoi(argv[1]) : 1000000;
+	bench.iterations     = argc > 2 ? (uint32_t)atoi(argv[2]) : 20;
+	uint32_t ray_count   = argc > 3 ? (uint32_t)atoi(argv[3]) : 100000;
+
+	bench.instance_count = SDL_max(bench.instance_count, 1u);
+	bench.iterations     = SDL_max(bench.iterations, 1u);
+
+	bench.bounds = (aabb_t*)malloc(bench.instance_count * sizeof(aabb_t));
+	assert(bench.bounds && "malloc failed");
+
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		bench.visible[i] = (uint32_t*)malloc(bench.instance_count * sizeof(uint32_t));
+		assert(bench.visible[i] && "malloc failed");
+	}
+
+	create_instances();
+
+	olivia::bvh_t bvh{};
+
+	uint64_t start = SDL_GetPerformanceCounter();
+	olivia::build_bvh(bvh, bench.bounds, bench.instance_count);
+	double build_ms = ms_since(start);
+
+	printf("%u instances, %zu nodes (%.1f MB), build %.1f ms, %u iterations\n",
+		bench.instance_count, bvh.nodes.size, (double)(bvh.nodes.size * sizeof(olivia::bvh_node_t)) / (1024.0 * 1024.0), build_ms, bench.iterations);
+
+	const olivia::frustum_t camera = make_camera({ 0.0f, 30.0f, 0.0f }, { 1000.0f, 0.0f, 300.0f });
+
+	uint32_t brute_visible{};
+	double   brute_ms = bench_brute_force(camera, brute_visible);
+
+	printf("brute     %2u threads  %8.3f ms  %u visible (%.1f%%)\n", 1, brute_ms, brute_visible, 100.0 * brute_visible / bench.instance_count);
+
+	olivia::bvh_cull_query_t queries[4]{};
+	queries[0] = { camera, bench.visible[0], 0 };
+
+	// without workers the cull tasks all run on the caller
+	double caller_ms = bench_cull(bvh, queries, 1);
+	printf("bvh       %2u threads  %8.3f ms  %u visible, %.1fx brute force\n", 1, caller_ms, queries[0].visible_count, brute_ms / caller_ms);
+
+	olivia::init_job_system(0);
+
+	uint32_t threads = olivia::get_job_worker_count() + 1;
+
+	double jobs_ms = bench_cull(bvh, queries, 1);
+	printf("bvh       %2u threads  %8.3f ms  %u visible, %.1fx brute force\n", threads, jobs_ms, queries[0].visible_count, brute_ms / jobs_ms);
+
+	// four views around the same spot in one call
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		const float angle = 1.5707963f * (float)i;
+		queries[i] = { make_camera({ 0.0f, 30.0f, 0.0f }, { cosf(angle) * 100.0f, 0.0f, sinf(angle) * 100.0f }), bench.visible[i], 0 };
+	}
+
+	double   batch_ms = bench_cull(bvh, queries, 4);
+	uint32_t batch_visible{};
+
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		batch_visible += queries[i].visible_count;
+	}
+
+	printf("batch x4  %2u threads  %8.3f ms  %u visible\n", threads, batch_ms, batch_visible);
+
+	// a tenth of the instances move a little every iteration
+	start = SDL_GetPerformanceCounter();
+
+	for (uint32_t iteration = 0; iteration < bench.iterations; ++iteration)
+	{
+		for (uint32_t i = iteration % 10; i < bench.instance_count; i += 10)
+		{
+			aabb_t moved = bench.bounds[i];
+			float  dx    = random_float(-1.0f, 1.0f);
+
+			moved.min.x += dx;
+			moved.max.x += dx;
+
+			olivia::update_bvh_instance(bvh, i, moved);
+		}
+
+		olivia::refit_bvh(bvh);
+	}
+
+	printf("refit     %2u threads  %8.3f ms  %u moved\n", 1, ms_since(start) / bench.iterations, bench.instance_count / 10);
+
+	olivia::ray_t*     rays = (olivia::ray_t*)malloc(ray_count * sizeof(olivia::ray_t));
+	olivia::ray_hit_t* hits = (olivia::ray_hit_t*)malloc(ray_count * sizeof(olivia::ray_hit_t));
+	assert(rays && hits && "malloc failed");
+
+	// picking rays from above, spread over the whole area
+	for (uint32_t i = 0; i < ray_count; ++i)
+	{
+		vec3_t direction = normalize({ random_float(-0.3f, 0.3f), -1.0f, random_float(-0.3f, 0.3f) });
+		rays[i] = { { random_float(-2000.0f, 2000.0f), 100.0f, random_float(-2000.0f, 2000.0f) }, 1000.0f, direction };
+	}
+
+	start = SDL_GetPerformanceCounter();
+	olivia::intersect_bvh(bvh, rays, ray_count, hits);
+	double ray_ms = ms_since(start);
+
+	uint32_t hit_count{};
+	for (uint32_t i = 0; i < ray_count; ++i)
+	{
+		hit_count += hits[i].instance != olivia::BVH_INVALID;
+	}
+
+	printf("rays      %2u threads  %8.3f ms  %.0f rays/ms, %u hits\n", threads, ray_ms, ray_count / ray_ms, hit_count);
+
+	olivia::destroy_job_system();
+	olivia::destroy_bvh(bvh);
+
+	free(hits);
+	free(rays);
+
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		free(bench.visible[i]);
+	}
+
+	free(bench.bounds);
+
+	return 0;
+}
@@ -0,0 +1,456 @@
+#include "olivia/olivia_graphics.h"
+#include "olivia/olivia_platform.h"
+
+#include <math.h>
+
+// usage: bench_clustered_lighting [frames=200] [max_lights=8192]
+//
+// a ground plane with a grid of spheres on it, seen from above at an angle with vsync off,
+// lit by point lights drifting around the scene. for every light count from 64 up to
+// max_lights (doubling) the same frames run with olivia.frag looping over every light and
+// with the clustered path, where light_cull.comp bins the lights into the froxel grid first.
+// both runs schedule the binning since it also uploads the lights; only the clustered
+// one counts its time. run under lavapipe with OLIVIA_GPU=llvmpipe.
+
+using olivia::vec3_t;
+
+constexpr uint32_t PLANE_CELLS{ 64 };
+constexpr uint32_t SPHERE_ROWS{ 16 };
+constexpr uint32_t SPHERE_COLUMNS{ 32 };
+constexpr uint32_t SPHERE_GRID{ 24 };
+constexpr float    SCENE_SIZE{ 96.0f };
+constexpr float    LIGHT_RADIUS_MIN{ 2.0f };
+constexpr float    LIGHT_RADIUS_MAX{ 5.0f };
+constexpr float    FOV_Y{ 1.0471976f };          // 60 degrees
+constexpr float    Z_NEAR{ 0.1f };
+constexpr float    Z_FAR{ 200.0f };              // the scene's far corner is inside it
+constexpr uint32_t FIRST_LIGHT_COUNT{ 64 };
+constexpr uint32_t WARMUP_FRAMES{ 20 };
+
+struct bench_light_t
+{
+	vec3_t center;  // the light circles around it
+	float  orbit;
+	float  phase;
+};
+
+struct bench_result_t
+{
+	double frame_ms;
+	double main_pass_ms;
+	double culling_ms;
+};
+
+struct bench_t
+{
+	olivia::mesh_t          plane;
+	olivia::mesh_t          sphere;
+	olivia::vulkan_buffer_t instance_buffer; // the plane's transform, then the spheres', never changes
+	uint32_t                sphere_count;
+	bench_light_t*          orbits;
+	olivia::light_t*        lights;
+	bool                    clustered;
+	float                   view_projection[16];
+	olivia::light_view_t    view;
+};
+
+static bench_t bench{};
+
+static double ms_since(uint64_t start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static vec3_t sub(vec3_t a, vec3_t b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static float  dot(vec3_t a, vec3_t b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+static vec3_t cross(vec3_t a, vec3_t b)
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+static vec3_t normalize(vec3_t v)
+{
+	float length = sqrtf(dot(v, v));
+	return { v.x / length, v.y / length, v.z / length };
+}
+
+static float random_float(uint32_t& state)
+{
+	state = state * 1664525u + 1013904223u;
+	return (float)(state >> 8) / (float)(1u << 24);
+}
+
+// column major look-at times a reverse-Z infinite perspective, and the same view for the binning
+static void build_view(vec3_t eye, vec3_t target, float aspect)
+{
+	vec3_t forward = normalize(sub(target, eye));
+	vec3_t right   = normalize(cross(forward, { 0.0f, 1.0f, 0.0f }));
+	vec3_t up      = cross(right, forward);
+
+	const float f = 1.0f / tanf(0.5f * FOV_Y);
+
+	// rows of the view matrix, y flipped for vulkan clip space
+	const float view[3][4]
+	{
+		{  right.x,    right.y,    right.z,   -dot(right, eye)   },
+		{ -up.x,      -up.y,      -up.z,       dot(up, eye)      },
+		{  forward.x,  forward.y,  forward.z, -dot(forward, eye) }
+	};
+
+	float* m = bench.view_projection;
+	float* v = bench.view.view;
+
+	for (uint32_t column = 0; column < 4; ++column)
+	{
+		const float w = column == 3 ? 1.0f : 0.0f;
+
+		m[column * 4 + 0] = view[0][column] * f / aspect;
+		m[column * 4 + 1] = view[1][column] * f;
+		m[column * 4 + 2] = w * Z_NEAR;      // depth = znear / view z
+		m[column * 4 + 3] = view[2][column];
+
+		v[column * 4 + 0] = view[0][column];
+		v[column * 4 + 1] = view[1][column];
+		v[column * 4 + 2] = view[2][column];
+		v[column * 4 + 3] = w;
+	}
+
+	bench.view.tan_half_fov_x = aspect / f;
+	bench.view.tan_half_fov_y = 1.0f / f;
+	bench.view.z_near         = Z_NEAR;
+	bench.view.z_far          = Z_FAR;
+}
+
+// --- scene ---
+
+static olivia::mesh_t create_plane()
+{
+	const uint32_t vertex_count = (PLANE_CELLS + 1) * (PLANE_CELLS + 1);
+	const uint32_t index_count  = PLANE_CELLS * PLANE_CELLS * 6;
+
+	void* v_destination;
+	void* i_destination;
+	olivia::mesh_t mesh = olivia::reserve_mesh(vertex_count, index_count, &v_destination, &i_destination);
+
+	olivia::vertex3d_t* vertices = (olivia::vertex3d_t*)v_destination;
+	uint32_t*           indices  = (uint32_t*)i_destination;
+
+	// unit square on y = 0, scaled by its instance
+	for (uint32_t z = 0; z <= PLANE_CELLS; ++z)
+	{
+		for (uint32_t x = 0; x <= PLANE_CELLS; ++x)
+		{
+			const float u = (float)x / (float)PLANE_CELLS;
+			const float v = (float)z / (float)PLANE_CELLS;
+
+			vertices[z * (PLANE_CELLS + 1) + x] = { { u - 0.5f, 0.0f, v - 0.5f }, { 0.0f, 1.0f, 0.0f }, { u, v } };
+		}
+	}
+
+	for (uint32_t z = 0; z < PLANE_CELLS; ++z)
+	{
+		for (uint32_t x = 0; x < PLANE_CELLS; ++x)
+		{
+			const uint32_t corner = z * (PLANE_CELLS + 1) + x;
+
+			*indices++ = corner;
+			*indices++ = corner + PLANE_CELLS + 1;
+			*indices++ = corner + 1;
+			*indices++ = corner + 1;
+			*indices++ = corner + PLANE_CELLS + 1;
+			*indices++ = corner + PLANE_CELLS + 2;
+		}
+	}
+
+	olivia::set_mesh_bounds(mesh, { { -0.5f, 0.0f, -0.5f }, { 0.5f, 0.0f, 0.5f } });
+
+	return mesh;
+}
+
+// latitude / longitude with a seam, the poles are degenerate rows
+static olivia::mesh_t create_sphere()
+{
+	const uint32_t vertex_count = (SPHERE_ROWS + 1) * (SPHERE_COLUMNS + 1);
+	const uint32_t index_count  = SPHERE_ROWS * SPHERE_COLUMNS * 6;
+
+	void* v_destination;
+	void* i_destination;
+	olivia::mesh_t mesh = olivia::reserve_mesh(vertex_count, index_count, &v_destination, &i_destination);
+
+	olivia::vertex3d_t* vertices = (olivia::vertex3d_t*)v_destination;
+	uint32_t*           indices  = (uint32_t*)i_destination;
+
+	for (uint32_t row = 0; row <= SPHERE_ROWS; ++row)
+	{
+		for (uint32_t column = 0; column <= SPHERE_COLUMNS; ++column)
+		{
+			const float theta = 3.14159265f * (float)row / (float)SPHERE_ROWS;
+			const float phi   = 6.28318531f * (float)column / (float)SPHERE_COLUMNS;
+
+			const vec3_t normal{ sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+
+			vertices[row * (SPHERE_COLUMNS + 1) + column] = { normal, normal, { (float)column / (float)SPHERE_COLUMNS, (float)row / (float)SPHERE_ROWS } };
+		}
+	}
+
+	for (uint32_t row = 0; row < SPHERE_ROWS; ++row)
+	{
+		for (uint32_t column = 0; column < SPHERE_COLUMNS; ++column)
+		{
+			const uint32_t corner = row * (SPHERE_COLUMNS + 1) + column;
+
+			*indices++ = corner;
+			*indices++ = corner + 1;
+			*indices++ = corner + SPHERE_COLUMNS + 1;
+			*indices++ = corner + SPHERE_COLUMNS + 1;
+			*indices++ = corner + 1;
+			*indices++ = corner + SPHERE_COLUMNS + 2;
+		}
+	}
+
+	olivia::set_mesh_bounds(mesh, { { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } });
+
+	return mesh;
+}
+
+static void write_transform(float* m, vec3_t position, float scale)
+{
+	memset(m, 0, 16 * sizeof(float));
+
+	m[0]  = scale;
+	m[5]  = scale;
+	m[10] = scale;
+	m[12] = position.x;
+	m[13] = position.y;
+	m[14] = position.z;
+	m[15] = 1.0f;
+}
+
+static void create_bench(uint32_t max_lights)
+{
+	bench.plane        = create_plane();
+	bench.sphere       = create_sphere();
+	bench.sphere_count = SPHERE_GRID * SPHERE_GRID;
+
+	bench.instance_buffer = olivia::create_vulkan_buffer(
+		olivia::MEMORY_CATEGORY_STAGING,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VMA_MEMORY_USAGE_AUTO,
+		VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+		(1 + bench.sphere_count) * 16 * sizeof(float));
+
+	float* transforms = (float*)bench.instance_buffer.info.pMappedData;
+	write_transform(transforms, { 0.0f, 0.0f, 0.0f }, SCENE_SIZE);
+
+	const float spacing = SCENE_SIZE / (float)SPHERE_GRID;
+	const float half    = 0.5f * SCENE_SIZE - 0.5f * spacing;
+
+	for (uint32_t z = 0; z < SPHERE_GRID; ++z)
+	{
+		for (uint32_t x = 0; x < SPHERE_GRID; ++x)
+		{
+			const float radius = 0.3f * spacing;
+			write_transform(transforms + (1 + z * SPHERE_GRID + x) * 16, { (float)x * spacing - half, radius, (float)z * spacing - half }, radius);
+		}
+	}
+
+	vmaFlushAllocation(olivia::g_vulkan_core.allocator, bench.instance_buffer.allocation, 0, VK_WHOLE_SIZE);
+
+	// the same lights in every run, a run with n lights uses the first n
+	bench.orbits = (bench_light_t*)malloc(max_lights * sizeof(bench_light_t));
+	bench.lights = (olivia::light_t*)malloc(max_lights * sizeof(olivia::light_t));
+	assert(bench.orbits && bench.lights && "malloc failed");
+
+	uint32_t state = 1;
+
+	for (uint32_t i = 0; i < max_lights; ++i)
+	{
+		bench.orbits[i] =
+		{
+			.center = { (random_float(state) - 0.5f) * SCENE_SIZE, 0.5f + 2.5f * random_float(state), (random_float(state) - 0.5f) * SCENE_SIZE },
+			.orbit = 0.5f + 2.0f * random_float(state),
+			.phase = 6.28318531f * random_float(state)
+		};
+
+		bench.lights[i] =
+		{
+			.radius = LIGHT_RADIUS_MIN + (LIGHT_RADIUS_MAX - LIGHT_RADIUS_MIN) * random_float(state),
+			.color = { random_float(state), random_float(state), random_float(state) },
+			.intensity = 4.0f
+		};
+	}
+}
+
+static void destroy_bench()
+{
+	olivia::destroy_vulkan_buffer(bench.instance_buffer);
+
+	free(bench.lights);
+	free(bench.orbits);
+}
+
+// --- frame ---
+
+static void move_lights(uint32_t count, float time)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const bench_light_t& orbit = bench.orbits[i];
+		const float          angle = orbit.phase + time;
+
+		bench.lights[i].position = { orbit.center.x + orbit.orbit * cosf(angle), orbit.center.y, orbit.center.z + orbit.orbit * sinf(angle) };
+	}
+
+	olivia::set_lights(bench.lights, count);
+}
+
+static void draw_mesh(VkCommandBuffer cmd, olivia::mesh_t mesh, uint32_t instance_count, uint32_t first_instance)
+{
+	const olivia::mesh_group_t& mesh_group = olivia::get_mesh_group();
+
+	vkCmdDrawIndexed(cmd, mesh_group.i_count[mesh], instance_count,
+		mesh_group.i_offset[mesh] / (uint32_t)sizeof(uint32_t),
+		(int32_t)(mesh_group.v_offset[mesh] / sizeof(olivia::vertex3d_t)),
+		first_instance);
+}
+
+static void draw_bench()
+{
+	VkCommandBuffer cmd = olivia::g_vulkan_core.command_buffers[olivia::g_vulkan_core.current_frame];
+
+	// nothing to draw in the depth pre-pass
+	if (!olivia::bind_lit_pipeline(cmd, bench.view_projection, bench.clustered))
+		return;
+
+	const olivia::mesh_group_t& mesh_group = olivia::get_mesh_group();
+
+	VkBuffer     vertex_buffers[]{ mesh_group.vertex_buffer.buffer, bench.instance_buffer.buffer };
+	VkDeviceSize offsets[]{ 0, 0 };
+
+	vkCmdBindVertexBuffers(cmd, 0, 2, vertex_buffers, offsets);
+	vkCmdBindIndexBuffer(cmd, mesh_group.index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+	draw_mesh(cmd, bench.plane, 1, 0);
+	draw_mesh(cmd, bench.sphere, bench.sphere_count, 1);
+}
+
+static bench_result_t run_frames(uint32_t frames, uint32_t light_count, bool clustered)
+{
+	bench.clustered = clustered;
+
+	bench_result_t result{};
+	uint64_t       start{};
+	uint32_t       measured{};
+
+	for (uint32_t frame = 0; measured < frames; ++frame)
+	{
+		SDL_Event event;
+		while (SDL_PollEvent(&event)) {}
+
+		if (frame == WARMUP_FRAMES)
+		{
+			start = SDL_GetPerformanceCounter();
+		}
+
+		// the same motion in both runs
+		move_lights(light_count, 0.02f * (float)frame);
+		olivia::schedule_light_culling(bench.view);
+
+		if (!olivia::begin_frame())
+			continue;
+
+		olivia::draw_frame(draw_bench);
+		olivia::end_frame();
+
+		if (frame >= WARMUP_FRAMES)
+		{
+			// both times are of the frame slot begin_frame waited for, the rest of this frame
+			result.main_pass_ms += olivia::get_gpu_pass_time(olivia::RENDER_PASS_MAIN);
+			result.culling_ms   += clustered ? olivia::get_light_culling_gpu_time() : 0.0;
+
+			++measured;
+		}
+	}
+
+	olivia::wait_timeline_value(olivia::g_vulkan_core.timeline_value);
+
+	result.frame_ms      = ms_since(start) / frames;
+	result.main_pass_ms /= frames;
+	result.culling_ms   /= frames;
+
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t frames     = argc > 1 ? (uint32_t)SDL_atoi(argv[1]) : 200;
+	uint32_t max_lights = argc > 2 ? (uint32_t)SDL_atoi(argv[2]) : olivia::MAX_LIGHTS;
+
+	frames     = SDL_max(frames, 1u);
+	max_lights = SDL_clamp(max_lights, FIRST_LIGHT_COUNT, olivia::MAX_LIGHTS);
+
+	if (!SDL_Init(SDL_INIT_VIDEO))
+	{
+		printf("SDL_Init failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	SDL_Window* window = SDL_CreateWindow("bench_clustered_lighting", 1280, 720, SDL_WINDOW_VULKAN);
+	if (!window)
+	{
+		printf("SDL_CreateWindow failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	olivia::init_job_system(0);
+	olivia::init_renderer(window);
+	olivia::set_vsync(false);
+
+	// everything is drawn once, in the main pass
+	olivia::set_depth_prepass(false);
+
+	create_bench(max_lights);
+
+	const VkExtent2D extent = olivia::get_render_extent();
+	build_view({ 0.0f, 28.0f, -0.75f * SCENE_SIZE }, { 0.0f, 0.0f, 0.0f }, (float)extent.width / (float)extent.height);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(olivia::g_vulkan_core.gpu, &properties);
+
+	printf("%s, %ux%u, %u spheres, %ux%ux%u clusters, %u frames\n", properties.deviceName, extent.width, extent.height,
+		bench.sphere_count, olivia::LIGHT_CLUSTER_X, olivia::LIGHT_CLUSTER_Y, olivia::LIGHT_CLUSTER_Z, frames);
+
+	printf("%7s  %22s  %36s  %8s\n", "", "naive", "clustered", "");
+	printf("%7s  %10s %11s  %10s %11s %13s  %8s\n", "lights", "frame ms", "main ms", "frame ms", "main ms", "culling ms", "speedup");
+
+	for (uint32_t light_count = FIRST_LIGHT_COUNT; light_count <= max_lights; light_count *= 2)
+	{
+		bench_result_t naive     = run_frames(frames, light_count, false);
+		bench_result_t clustered = run_frames(frames, light_count, true);
+
+		// of the gpu work lighting costs, the binning counts against the clustered path
+		const double clustered_gpu_ms = clustered.main_pass_ms + clustered.culling_ms;
+
+		printf("%7u  %10.3f %11.3f  %10.3f %11.3f %13.3f  %7.2fx\n", light_count,
+			naive.frame_ms, naive.main_pass_ms,
+			clustered.frame_ms, clustered.main_pass_ms, clustered.culling_ms,
+			clustered_gpu_ms > 0.0 ? naive.main_pass_ms / clustered_gpu_ms : 0.0);
+	}
+
+	if (!olivia::g_vulkan_core.timestamp_pool)
+	{
+		printf("no gpu timestamps on this device, only frame times are measured\n");
+	}
+
+	vkDeviceWaitIdle(olivia::g_vulkan_core.device);
+
+	destroy_bench();
+	olivia::destroy_renderer();
+	olivia::destroy_job_system();
+
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+
+	return 0;
+}
@@ -0,0 +1,236 @@
+#include "olivia/olivia_graphics.h"
+#include "olivia/olivia_platform.h"
+
+#include <math.h>
+
+// usage: bench_gpu_particles [frames=1000] [emitted_per_frame=4096] [life=4]
+//
+// emits a fountain every frame at a fixed 60 Hz step with vsync off and runs until the
+// alive count is steady (emitted_per_frame * life * 60, capped by the capacity), then
+// measures the particle job's gpu time and the cpu time spent in the particle calls
+// plus recording. the same frames run unsorted (additive) and with the back to front
+// sort. particle data never leaves the gpu, the alive count is the analytic steady one.
+// run under lavapipe with OLIVIA_GPU=llvmpipe.
+
+using olivia::vec3_t;
+
+constexpr float FIXED_DT{ 1.0f / 60.0f };
+
+struct bench_result_t
+{
+	double gpu_ms;
+	double cpu_us;
+	double frame_ms;
+};
+
+struct bench_t
+{
+	uint32_t emitted_per_frame;
+	float    life;
+	uint32_t alive;
+	float    view_projection[16];
+};
+
+static bench_t bench{};
+
+static vec3_t sub(vec3_t a, vec3_t b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static float  dot(vec3_t a, vec3_t b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+static vec3_t cross(vec3_t a, vec3_t b)
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+static vec3_t normalize(vec3_t v)
+{
+	float length = sqrtf(dot(v, v));
+	return { v.x / length, v.y / length, v.z / length };
+}
+
+// column major look-at times a reverse-Z infinite perspective
+static void build_view_projection(vec3_t eye, vec3_t target, float aspect, vec3_t& right, vec3_t& up)
+{
+	vec3_t forward = normalize(sub(target, eye));
+	right          = normalize(cross(forward, { 0.0f, 1.0f, 0.0f }));
+	up             = cross(right, forward);
+
+	const float f     = 1.0f / tanf(0.5f * 1.0471976f); // 60 degrees vertical
+	const float znear = 0.1f;
+
+	// rows of the view matrix, y flipped for vulkan clip space
+	const float view[3][4]
+	{
+		{  right.x,    right.y,    right.z,   -dot(right, eye)   },
+		{ -up.x,      -up.y,      -up.z,       dot(up, eye)      },
+		{  forward.x,  forward.y,  forward.z, -dot(forward, eye) }
+	};
+
+	float* m = bench.view_projection;
+	for (uint32_t column = 0; column < 4; ++column)
+	{
+		const float w = column == 3 ? 1.0f : 0.0f;
+
+		m[column * 4 + 0] = view[0][column] * f / aspect;
+		m[column * 4 + 1] = view[1][column] * f;
+		m[column * 4 + 2] = w * znear;       // depth = znear / view z
+		m[column * 4 + 3] = view[2][column];
+	}
+}
+
+static void emit_fountain()
+{
+	olivia::particle_emit_t emit
+	{
+		.position = { 0.0f, 0.0f, 0.0f },
+		.life = bench.life,
+		.spread = { 0.5f, 0.0f, 0.5f },
+		.size = 0.05f,
+		.velocity = { 0.0f, 12.0f, 0.0f },
+		.count = bench.emitted_per_frame,
+		.velocity_spread = { 3.0f, 2.0f, 3.0f },
+		.color = { 1.0f, 0.6f, 0.2f, 0.0f }
+	};
+
+	olivia::emit_particles(emit);
+}
+
+static vec3_t s_right;
+static vec3_t s_up;
+static double s_draw_us;
+
+static void draw_bench()
+{
+	if (olivia::g_vulkan_core.current_pass != olivia::RENDER_PASS_MAIN)
+		return;
+
+	uint64_t start = SDL_GetPerformanceCounter();
+
+	olivia::draw_particles(bench.view_projection, s_right, s_up);
+
+	s_draw_us += (double)(SDL_GetPerformanceCounter() - start) * 1e6 / (double)SDL_GetPerformanceFrequency();
+}
+
+static bench_result_t run_frames(uint32_t frames, bool sorted)
+{
+	const vec3_t   eye           = { 0.0f, 8.0f, -40.0f };
+	const uint32_t warmup_frames = (uint32_t)(bench.life / FIXED_DT) + 2 * olivia::MAX_FRAMES;
+
+	VkExtent2D extent = olivia::g_vulkan_core.swapchain_extent;
+	build_view_projection(eye, { 0.0f, 10.0f, 0.0f }, (float)extent.width / (float)extent.height, s_right, s_up);
+
+	bench_result_t result{};
+	uint64_t       start{};
+	uint32_t       measured{};
+
+	for (uint32_t frame = 0; measured < frames; ++frame)
+	{
+		SDL_Event event;
+		while (SDL_PollEvent(&event)) {}
+
+		if (frame == warmup_frames)
+		{
+			start = SDL_GetPerformanceCounter();
+		}
+
+		s_draw_us = 0.0;
+
+		uint64_t cpu_start = SDL_GetPerformanceCounter();
+
+		emit_fountain();
+		olivia::schedule_particles(FIXED_DT, { 0.0f, -9.8f, 0.0f }, sorted, eye);
+
+		double cpu_us = (double)(SDL_GetPerformanceCounter() - cpu_start) * 1e6 / (double)SDL_GetPerformanceFrequency();
+
+		if (!olivia::begin_frame())
+			continue;
+
+		olivia::draw_frame(draw_bench);
+		olivia::end_frame();
+
+		if (frame >= warmup_frames)
+		{
+			// the gpu time is from the frame slot begin_frame waited for, the record time from this frame
+			result.gpu_ms += olivia::get_particle_gpu_time();
+			result.cpu_us += cpu_us + s_draw_us + olivia::get_particle_record_time() * 1000.0;
+			++measured;
+		}
+	}
+
+	olivia::wait_timeline_value(olivia::g_vulkan_core.timeline_value);
+
+	result.frame_ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency() / frames;
+	result.gpu_ms  /= frames;
+	result.cpu_us  /= frames;
+
+	return result;
+}
+
+static void print_result(const char* name, const bench_result_t& result)
+{
+	printf("%-8s particle gpu %7.3f ms  %9.0f particles/ms  cpu %6.1f us/frame  frame %7.3f ms\n",
+		name, result.gpu_ms, result.gpu_ms > 0.0 ? bench.alive / result.gpu_ms : 0.0, result.cpu_us, result.frame_ms);
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t frames         = argc > 1 ? (uint32_t)SDL_atoi(argv[1]) : 1000;
+	bench.emitted_per_frame = argc > 2 ? (uint32_t)SDL_atoi(argv[2]) : 4096;
+	bench.life              = argc > 3 ? (float)SDL_atof(argv[3]) : 4.0f;
+
+	frames = SDL_max(frames, 1u);
+
+	if (!SDL_Init(SDL_INIT_VIDEO))
+	{
+		printf("SDL_Init failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	SDL_Window* window = SDL_CreateWindow("bench_gpu_particles", 1280, 720, SDL_WINDOW_VULKAN);
+	if (!window)
+	{
+		printf("SDL_CreateWindow failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	olivia::init_job_system(0);
+	olivia::init_renderer(window);
+	olivia::set_vsync(false);
+
+	// every particle emitted within one life is alive at once
+	const uint32_t steady = (uint32_t)((double)bench.emitted_per_frame * bench.life / FIXED_DT);
+	olivia::init_particles(steady);
+
+	uint32_t capacity = olivia::MIN_PARTICLE_CAPACITY;
+	while (capacity < steady)
+	{
+		capacity <<= 1;
+	}
+
+	bench.alive = SDL_min(steady, capacity);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(olivia::g_vulkan_core.gpu, &properties);
+
+	printf("%s, capacity %u, %u alive, %u emitted per frame, life %.1f s, %s compute, %u frames\n",
+		properties.deviceName, capacity, bench.alive, bench.emitted_per_frame, bench.life,
+		olivia::is_async_compute_enabled() ? "async" : "serialized", frames);
+
+	bench_result_t unsorted = run_frames(frames, false);
+	print_result("unsorted", unsorted);
+
+	bench_result_t sorted = run_frames(frames, true);
+	print_result("sorted", sorted);
+
+	if (!olivia::g_vulkan_core.timestamp_pool)
+	{
+		printf("no gpu timestamps on this device, particles/ms is not measured\n");
+	}
+
+	olivia::destroy_renderer();
+	olivia::destroy_job_system();
+
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+
+	return 0;
+}
@@ -0,0 +1,176 @@
+#include "olivia/core/hash_map.h"
+#include "olivia/core/string_interner.h"
+
+#include <SDL3/SDL.h>
+
+#include <string>
+#include <unordered_map>
+
+// usage: bench_hash_map [max_entries=10000000] [strings=1000000]
+//
+// for every size from 1K up to max_entries (times ten each step) inserts random 64 bit
+// keys into hash_map_t and std::unordered_map, looks every key up, looks up as many keys
+// that are not in the map, then erases them all. times are per operation. the interner
+// is timed separately on generated names, once interning and once finding them again.
+
+struct bench_t
+{
+	uint64_t* keys;
+	uint64_t* missing;
+	uint64_t  checksum;
+};
+
+static bench_t bench{};
+
+static uint64_t random_state = 1;
+
+static uint64_t random_u64()
+{
+	uint64_t z = (random_state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static double ns_per_op(uint64_t start, size_t count)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) * 1e9 / (double)SDL_GetPerformanceFrequency() / (double)count;
+}
+
+static void bench_olivia(size_t count)
+{
+	auto map = olivia::create_hash_map<uint64_t, uint64_t>(0);
+
+	uint64_t start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		olivia::hash_map_insert(map, bench.keys[i], (uint64_t)i);
+	}
+	double insert = ns_per_op(start, count);
+
+	start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		bench.checksum += *olivia::hash_map_find(map, bench.keys[i]);
+	}
+	double hit = ns_per_op(start, count);
+
+	start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		bench.checksum += olivia::hash_map_find(map, bench.missing[i]) != nullptr;
+	}
+	double miss = ns_per_op(start, count);
+
+	start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		bench.checksum += olivia::hash_map_erase(map, bench.keys[i]);
+	}
+	double erase = ns_per_op(start, count);
+
+	printf("  hash_map_t          insert %7.1f  hit %7.1f  miss %7.1f  erase %7.1f ns\n", insert, hit, miss, erase);
+
+	olivia::destroy_hash_map(map);
+}
+
+static void bench_std(size_t count)
+{
+	std::unordered_map<uint64_t, uint64_t> map;
+
+	uint64_t start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		map[bench.keys[i]] = (uint64_t)i;
+	}
+	double insert = ns_per_op(start, count);
+
+	start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		bench.checksum += map.find(bench.keys[i])->second;
+	}
+	double hit = ns_per_op(start, count);
+
+	start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		bench.checksum += map.find(bench.missing[i]) != map.end();
+	}
+	double miss = ns_per_op(start, count);
+
+	start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		bench.checksum += map.erase(bench.keys[i]);
+	}
+	double erase = ns_per_op(start, count);
+
+	printf("  std::unordered_map  insert %7.1f  hit %7.1f  miss %7.1f  erase %7.1f ns\n", insert, hit, miss, erase);
+}
+
+static void bench_interner(size_t count)
+{
+	std::string* names = new std::string[count];
+	for (size_t i = 0; i < count; ++i)
+	{
+		names[i] = "assets/meshes/prop_" + std::to_string(random_u64() % (count * 4)) + ".mesh";
+	}
+
+	auto interner = olivia::create_string_interner(0);
+
+	uint64_t start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		bench.checksum += olivia::intern_string(interner, names[i].c_str(), names[i].size());
+	}
+	double intern = ns_per_op(start, count);
+
+	start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < count; ++i)
+	{
+		bench.checksum += olivia::find_string_id(interner, names[i].c_str(), names[i].size());
+	}
+	double find = ns_per_op(start, count);
+
+	printf("interner %zu strings, %zu unique: intern %.1f ns, find %.1f ns\n", count, interner.offsets.size, intern, find);
+
+	olivia::destroy_string_interner(interner);
+	delete[] names;
+}
+
+int main(int argc, char** argv)
+{
+	size_t max_entries  = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 10000000;
+	size_t string_count = argc > 2 ? (size_t)strtoull(argv[2], nullptr, 10) : 1000000;
+
+	bench.keys    = (uint64_t*)malloc(max_entries * sizeof(uint64_t));
+	bench.missing = (uint64_t*)malloc(max_entries * sizeof(uint64_t));
+
+	// odd keys are in the map, even keys never are
+	for (size_t i = 0; i < max_entries; ++i)
+	{
+		bench.keys[i]    = random_u64() | 1;
+		bench.missing[i] = random_u64() & ~1ull;
+	}
+
+	for (size_t count = 1000; count <= max_entries; count *= 10)
+	{
+		printf("%zu entries\n", count);
+
+		bench_olivia(count);
+		bench_std(count);
+	}
+
+	if (string_count)
+	{
+		bench_interner(string_count);
+	}
+
+	printf("checksum %llu\n", (unsigned long long)bench.checksum);
+
+	free(bench.keys);
+	free(bench.missing);
+
+	return 0;
+}
@@ -0,0 +1,12 @@
+#version 450
+
+layout(location = 0) in vec3 in_normal;
+layout(location = 1) in vec2 in_uv;
+
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+	float light = max(dot(normalize(in_normal), normalize(vec3(0.4, 1.0, 0.3))), 0.0) * 0.8 + 0.2;
+	out_color   = vec4(vec3(0.6 + 0.4 * in_uv.x, 0.7, 0.8) * light, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 450
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_normal;
+layout(location = 2) in vec2 in_uv;
+
+// per instance: xyz position, w uniform scale
+layout(location = 3) in vec4 in_instance;
+
+layout(push_constant) uniform push_t
+{
+	mat4 view_projection;
+} push;
+
+layout(location = 0) out vec3 out_normal;
+layout(location = 1) out vec2 out_uv;
+
+void main()
+{
+	out_normal  = in_normal;
+	out_uv      = in_uv;
+	gl_Position = push.view_projection * vec4(in_instance.xyz + in_position * in_instance.w, 1.0);
+}
@@ -0,0 +1,691 @@
+#include "olivia/olivia_graphics.h"
+#include "olivia/olivia_platform.h"
+#include "olivia/olivia_asset.h"
+
+#include <math.h>
+
+// usage: bench_mesh_lod [frames=300] [grid=64] [max_pixel_error=1]
+//
+// imports a displaced sphere through write_asset_pack, which generates its LOD chain,
+// and loads it back into the mesh group. grid * grid instances of it stand on a plane
+// and the camera flies low across them with vsync off. every frame the instances are
+// frustum culled, each visible one picks its level from its projected error (with
+// hysteresis) and they are bucketed by level into the frame's instance buffer, one
+// instanced draw per level. the same flight runs with every instance at the full mesh
+// and with LODs. run under lavapipe with OLIVIA_GPU=llvmpipe.
+
+using olivia::vec3_t;
+
+constexpr uint32_t SPHERE_ROWS{ 96 };
+constexpr uint32_t SPHERE_COLUMNS{ 192 };
+constexpr float    SPHERE_DISPLACEMENT{ 0.05f };
+constexpr float    LOD_MAX_ERROR{ 0.05f };       // object space, of the unit sphere
+constexpr float    LOD_HYSTERESIS{ 0.25f };
+constexpr float    INSTANCE_SPACING{ 4.0f };
+constexpr float    FOV_Y{ 1.0471976f };          // 60 degrees
+constexpr uint32_t WARMUP_FRAMES{ 30 };
+
+struct bench_instance_t
+{
+	float position[3];
+	float scale;
+};
+
+struct bench_result_t
+{
+	double frame_ms;
+	double main_pass_ms;
+	double select_us;
+	double triangles;
+	double visible;
+	double switches;
+	double level_instances[olivia::MAX_MESH_LODS];
+};
+
+struct bench_t
+{
+	olivia::mesh_t          mesh;
+	olivia::shader_t        vertex;
+	olivia::shader_t        fragment;
+	VkPipelineLayout        pipeline_layout;
+	VkPipeline              pipeline;
+	olivia::vulkan_buffer_t instance_buffers[olivia::MAX_FRAMES]; // per frame slot, written by the cpu
+	bench_instance_t*       instances;
+	uint32_t*               visible;      // this frame's culling result
+	uint8_t*                levels;       // per instance, the level it was last drawn with
+	uint32_t                instance_count;
+	float                   max_pixel_error;
+	bool                    lods;
+	vec3_t                  eye;
+	float                   view_projection[16];
+
+	// of the last recorded frame
+	uint32_t                level_counts[olivia::MAX_MESH_LODS];
+	uint32_t                visible_count;
+	uint32_t                switches;
+	double                  triangles;
+	double                  select_us;
+};
+
+static bench_t bench{};
+
+static double ms_since(uint64_t start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static vec3_t sub(vec3_t a, vec3_t b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static float  dot(vec3_t a, vec3_t b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+static vec3_t cross(vec3_t a, vec3_t b)
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+static vec3_t normalize(vec3_t v)
+{
+	float length = sqrtf(dot(v, v));
+	return { v.x / length, v.y / length, v.z / length };
+}
+
+// column major look-at times a reverse-Z infinite perspective
+static void build_view_projection(vec3_t eye, vec3_t target, float aspect)
+{
+	vec3_t forward = normalize(sub(target, eye));
+	vec3_t right   = normalize(cross(forward, { 0.0f, 1.0f, 0.0f }));
+	vec3_t up      = cross(right, forward);
+
+	const float f     = 1.0f / tanf(0.5f * FOV_Y);
+	const float znear = 0.1f;
+
+	// rows of the view matrix, y flipped for vulkan clip space
+	const float view[3][4]
+	{
+		{  right.x,    right.y,    right.z,   -dot(right, eye)   },
+		{ -up.x,      -up.y,      -up.z,       dot(up, eye)      },
+		{  forward.x,  forward.y,  forward.z, -dot(forward, eye) }
+	};
+
+	float* m = bench.view_projection;
+	for (uint32_t column = 0; column < 4; ++column)
+	{
+		const float w = column == 3 ? 1.0f : 0.0f;
+
+		m[column * 4 + 0] = view[0][column] * f / aspect;
+		m[column * 4 + 1] = view[1][column] * f;
+		m[column * 4 + 2] = w * znear;       // depth = znear / view z
+		m[column * 4 + 3] = view[2][column];
+	}
+}
+
+// --- scene ---
+
+// a welded latitude / longitude sphere with ripples, so simplification has something to keep
+static bool import_sphere()
+{
+	const uint32_t vertex_count = (SPHERE_ROWS - 1) * SPHERE_COLUMNS + 2;
+	const uint32_t index_count  = ((SPHERE_ROWS - 2) * 2 + 2) * SPHERE_COLUMNS * 3;
+
+	olivia::vertex3d_t* vertices = (olivia::vertex3d_t*)malloc(vertex_count * sizeof(olivia::vertex3d_t));
+	uint32_t*           indices  = (uint32_t*)malloc(index_count * sizeof(uint32_t));
+	assert(vertices && indices && "malloc failed");
+
+	const uint32_t south = vertex_count - 1;
+
+	vertices[0]     = { { 0.0f, 1.0f, 0.0f },  { 0.0f, 1.0f, 0.0f },  { 0.5f, 0.0f } };
+	vertices[south] = { { 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.5f, 1.0f } };
+
+	for (uint32_t row = 1; row < SPHERE_ROWS; ++row)
+	{
+		for (uint32_t column = 0; column < SPHERE_COLUMNS; ++column)
+		{
+			const float theta = 3.14159265f * (float)row / (float)SPHERE_ROWS;
+			const float phi   = 6.28318531f * (float)column / (float)SPHERE_COLUMNS;
+
+			const vec3_t normal{ sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+			const float  radius = 1.0f + SPHERE_DISPLACEMENT * sinf(8.0f * theta) * cosf(6.0f * phi);
+
+			vertices[1 + (row - 1) * SPHERE_COLUMNS + column] =
+			{
+				{ normal.x * radius, normal.y * radius, normal.z * radius },
+				normal,
+				{ (float)column / (float)SPHERE_COLUMNS, (float)row / (float)SPHERE_ROWS }
+			};
+		}
+	}
+
+	auto at = [](uint32_t row, uint32_t column) { return 1 + (row - 1) * SPHERE_COLUMNS + column % SPHERE_COLUMNS; };
+
+	uint32_t* index = indices;
+	for (uint32_t column = 0; column < SPHERE_COLUMNS; ++column)
+	{
+		*index++ = 0;
+		*index++ = at(1, column + 1);
+		*index++ = at(1, column);
+
+		for (uint32_t row = 1; row + 1 < SPHERE_ROWS; ++row)
+		{
+			*index++ = at(row, column);
+			*index++ = at(row, column + 1);
+			*index++ = at(row + 1, column);
+			*index++ = at(row + 1, column);
+			*index++ = at(row, column + 1);
+			*index++ = at(row + 1, column + 1);
+		}
+
+		*index++ = south;
+		*index++ = at(SPHERE_ROWS - 1, column);
+		*index++ = at(SPHERE_ROWS - 1, column + 1);
+	}
+
+	const olivia::asset_mesh_source_t source
+	{
+		.vertices = vertices,
+		.vertex_count = vertex_count,
+		.vertex_stride = sizeof(olivia::vertex3d_t),
+		.indices = indices,
+		.index_count = index_count,
+		.lod_max_error = LOD_MAX_ERROR
+	};
+
+	const char* path = "bench_mesh_lod.olva";
+
+	uint64_t start = SDL_GetPerformanceCounter();
+	bool ok = olivia::write_asset_pack(path, &source, 1, olivia::ASSET_CODEC_LZ4, olivia::ASSET_BLOCK_DEFAULT_SIZE);
+	double import_ms = ms_since(start);
+
+	free(indices);
+	free(vertices);
+
+	olivia::asset_pack_t pack;
+	ok = ok && olivia::open_asset_pack(path, pack);
+	if (!ok)
+	{
+		printf("failed to import %s\n", path);
+		return false;
+	}
+
+	ok = olivia::load_mesh_pack(pack, &bench.mesh);
+
+	olivia::close_asset_pack(pack);
+	SDL_RemovePath(path);
+
+	if (!ok)
+	{
+		printf("failed to load %s\n", path);
+		return false;
+	}
+
+	const olivia::mesh_group_t& mesh_group = olivia::get_mesh_group();
+
+	printf("sphere: %u vertices, import with LODs %.1f ms\n", vertex_count, import_ms);
+
+	for (uint32_t i = 0; i < mesh_group.lod_count[bench.mesh]; ++i)
+	{
+		const olivia::mesh_lod_t& lod = mesh_group.lods[bench.mesh][i];
+		printf("  lod %u: %7u triangles  error %.5f\n", i, lod.index_count / 3, lod.error);
+	}
+
+	return true;
+}
+
+static void create_instances(uint32_t grid)
+{
+	bench.instance_count = grid * grid;
+	bench.instances      = (bench_instance_t*)malloc(bench.instance_count * sizeof(bench_instance_t));
+	bench.visible        = (uint32_t*)malloc(bench.instance_count * sizeof(uint32_t));
+	bench.levels         = (uint8_t*)malloc(bench.instance_count);
+	assert(bench.instances && bench.visible && bench.levels && "malloc failed");
+
+	const float half = 0.5f * (float)(grid - 1) * INSTANCE_SPACING;
+
+	for (uint32_t z = 0; z < grid; ++z)
+	{
+		for (uint32_t x = 0; x < grid; ++x)
+		{
+			const uint32_t hash  = (x * 73856093u) ^ (z * 19349663u);
+			const float    scale = 0.5f + (float)(hash % 1024) / 1024.0f;
+
+			bench.instances[z * grid + x] = { { (float)x * INSTANCE_SPACING - half, scale, (float)z * INSTANCE_SPACING - half }, scale };
+		}
+	}
+}
+
+static void create_bench()
+{
+	VkDevice device = olivia::g_vulkan_core.device;
+
+	for (uint32_t i = 0; i < olivia::MAX_FRAMES; ++i)
+	{
+		bench.instance_buffers[i] = olivia::create_vulkan_buffer(
+			olivia::MEMORY_CATEGORY_STAGING,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VMA_MEMORY_USAGE_AUTO,
+			VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+			bench.instance_count * sizeof(bench_instance_t));
+	}
+
+	if (!olivia::load_shader("bench_mesh.vert.spv", bench.vertex) || !olivia::load_shader("bench_mesh.frag.spv", bench.fragment))
+	{
+		printf("failed to load the bench shaders\n");
+		abort();
+	}
+
+	olivia::shader_reflection_t layout{};
+	olivia::merge_shader_reflection(layout, bench.vertex.reflection);
+	olivia::merge_shader_reflection(layout, bench.fragment.reflection);
+
+	bench.pipeline_layout = olivia::create_reflected_pipeline_layout(layout, nullptr, 0);
+
+	// the mesh group's vertices, then the instance stream
+	VkVertexInputAttributeDescription attributes[olivia::MAX_SHADER_INPUTS];
+	uint32_t vertex_stride{};
+	uint32_t instance_stride{};
+
+	uint32_t attribute_count = olivia::get_vertex_input_attributes(bench.vertex.reflection, 0, 0, 3, attributes, vertex_stride);
+	attribute_count += olivia::get_vertex_input_attributes(bench.vertex.reflection, 1, 3, 4, attributes + attribute_count, instance_stride);
+
+	assert(vertex_stride == sizeof(olivia::vertex3d_t) && instance_stride == sizeof(bench_instance_t) && "shader inputs do not match the streams");
+
+	VkVertexInputBindingDescription bindings[]
+	{
+		{ 0, vertex_stride,   VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 1, instance_stride, VK_VERTEX_INPUT_RATE_INSTANCE }
+	};
+
+	VkPipelineShaderStageCreateInfo stages[]
+	{
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_VERTEX_BIT,
+			.module = bench.vertex.module,
+			.pName = "main"
+		},
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+			.module = bench.fragment.module,
+			.pName = "main"
+		}
+	};
+
+	VkPipelineVertexInputStateCreateInfo vertex_input
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		.vertexBindingDescriptionCount = ARRAY_SIZE(bindings),
+		.pVertexBindingDescriptions = bindings,
+		.vertexAttributeDescriptionCount = attribute_count,
+		.pVertexAttributeDescriptions = attributes
+	};
+
+	VkPipelineInputAssemblyStateCreateInfo input_assembly
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+	};
+
+	VkPipelineViewportStateCreateInfo viewport
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+		.viewportCount = 1,
+		.scissorCount = 1
+	};
+
+	VkPipelineRasterizationStateCreateInfo rasterization
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+		.polygonMode = VK_POLYGON_MODE_FILL,
+		.cullMode = VK_CULL_MODE_NONE,
+		.lineWidth = 1.0f
+	};
+
+	VkPipelineMultisampleStateCreateInfo multisample
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+		.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+	};
+
+	VkPipelineDepthStencilStateCreateInfo depth_stencil
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
+	};
+
+	VkPipelineColorBlendAttachmentState blend_attachment
+	{
+		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+	};
+
+	VkPipelineColorBlendStateCreateInfo blend
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+		.attachmentCount = 1,
+		.pAttachments = &blend_attachment
+	};
+
+	// begin_pass sets the depth state
+	VkDynamicState dynamic_states[]
+	{
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR,
+		VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+		VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+		VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamic
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+		.dynamicStateCount = ARRAY_SIZE(dynamic_states),
+		.pDynamicStates = dynamic_states
+	};
+
+	VkPipelineRenderingCreateInfo rendering
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+		.colorAttachmentCount = 1,
+		.pColorAttachmentFormats = &olivia::g_vulkan_core.swapchain_format.format,
+		.depthAttachmentFormat = olivia::g_vulkan_core.depth_format
+	};
+
+	VkGraphicsPipelineCreateInfo pipeline_info
+	{
+		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.pNext = &rendering,
+		.stageCount = ARRAY_SIZE(stages),
+		.pStages = stages,
+		.pVertexInputState = &vertex_input,
+		.pInputAssemblyState = &input_assembly,
+		.pViewportState = &viewport,
+		.pRasterizationState = &rasterization,
+		.pMultisampleState = &multisample,
+		.pDepthStencilState = &depth_stencil,
+		.pColorBlendState = &blend,
+		.pDynamicState = &dynamic,
+		.layout = bench.pipeline_layout
+	};
+
+	VK_CHECK(vkCreateGraphicsPipelines(device, olivia::g_vulkan_core.pipeline_cache, 1, &pipeline_info, nullptr, &bench.pipeline));
+}
+
+static void destroy_bench()
+{
+	VkDevice device = olivia::g_vulkan_core.device;
+
+	vkDestroyPipeline(device, bench.pipeline, nullptr);
+	vkDestroyPipelineLayout(device, bench.pipeline_layout, nullptr);
+
+	olivia::destroy_shader(bench.fragment);
+	olivia::destroy_shader(bench.vertex);
+
+	for (uint32_t i = 0; i < olivia::MAX_FRAMES; ++i)
+	{
+		olivia::destroy_vulkan_buffer(bench.instance_buffers[i]);
+	}
+
+	free(bench.levels);
+	free(bench.visible);
+	free(bench.instances);
+}
+
+// --- frame ---
+
+// culls, picks every visible instance's level and writes the instances grouped by level
+static void select_levels(bench_instance_t* destination)
+{
+	uint64_t start = SDL_GetPerformanceCounter();
+
+	const olivia::mesh_group_t& mesh_group = olivia::get_mesh_group();
+	const olivia::mesh_lod_t*   lods       = mesh_group.lods[bench.mesh];
+	const uint32_t              lod_count  = bench.lods ? mesh_group.lod_count[bench.mesh] : 1;
+
+	const olivia::lod_selection_t selection
+	{
+		.pixels_per_unit = (float)olivia::g_vulkan_core.swapchain_extent.height * 0.5f / tanf(0.5f * FOV_Y),
+		.max_pixel_error = bench.max_pixel_error,
+		.hysteresis = LOD_HYSTERESIS
+	};
+
+	const olivia::frustum_t frustum = olivia::make_frustum(bench.view_projection);
+
+	// the ripples reach out to 1 + SPHERE_DISPLACEMENT
+	const float bound = 1.0f + SPHERE_DISPLACEMENT;
+
+	for (uint32_t i = 0; i < olivia::MAX_MESH_LODS; ++i)
+	{
+		bench.level_counts[i] = 0;
+	}
+
+	bench.visible_count = 0;
+	bench.switches      = 0;
+
+	for (uint32_t i = 0; i < bench.instance_count; ++i)
+	{
+		const bench_instance_t& instance = bench.instances[i];
+
+		const vec3_t center{ instance.position[0], instance.position[1], instance.position[2] };
+		const float  extent = instance.scale * bound;
+
+		const olivia::aabb_t aabb{ { center.x - extent, center.y - extent, center.z - extent }, { center.x + extent, center.y + extent, center.z + extent } };
+		if (!olivia::is_aabb_visible(frustum, aabb))
+			continue;
+
+		const vec3_t   offset = sub(center, bench.eye);
+		const uint32_t level  = olivia::select_mesh_lod(lods, lod_count, instance.scale, sqrtf(dot(offset, offset)), bench.levels[i], selection);
+
+		bench.switches += level != bench.levels[i];
+		bench.levels[i] = (uint8_t)level;
+
+		++bench.level_counts[level];
+		bench.visible[bench.visible_count++] = i;
+	}
+
+	uint32_t offsets[olivia::MAX_MESH_LODS];
+	uint32_t offset = 0;
+
+	for (uint32_t i = 0; i < olivia::MAX_MESH_LODS; ++i)
+	{
+		offsets[i] = offset;
+		offset    += bench.level_counts[i];
+	}
+
+	for (uint32_t i = 0; i < bench.visible_count; ++i)
+	{
+		const uint32_t instance = bench.visible[i];
+		destination[offsets[bench.levels[instance]]++] = bench.instances[instance];
+	}
+
+	bench.select_us = ms_since(start) * 1000.0;
+}
+
+static void draw_bench()
+{
+	if (olivia::g_vulkan_core.current_pass != olivia::RENDER_PASS_MAIN)
+		return;
+
+	const uint32_t  frame = olivia::g_vulkan_core.current_frame;
+	VkCommandBuffer cmd   = olivia::g_vulkan_core.command_buffers[frame];
+
+	select_levels((bench_instance_t*)bench.instance_buffers[frame].info.pMappedData);
+
+	const olivia::mesh_group_t& mesh_group = olivia::get_mesh_group();
+	const olivia::mesh_lod_t*   lods       = mesh_group.lods[bench.mesh];
+
+	VkBuffer     vertex_buffers[]{ mesh_group.vertex_buffer.buffer, bench.instance_buffers[frame].buffer };
+	VkDeviceSize offsets[]{ 0, 0 };
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, bench.pipeline);
+	vkCmdPushConstants(cmd, bench.pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(bench.view_projection), bench.view_projection);
+	vkCmdBindVertexBuffers(cmd, 0, 2, vertex_buffers, offsets);
+	vkCmdBindIndexBuffer(cmd, mesh_group.index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+	// the levels share the mesh's vertices, only the index range differs
+	const uint32_t first_index   = mesh_group.i_offset[bench.mesh] / (uint32_t)sizeof(uint32_t);
+	const int32_t  vertex_offset = (int32_t)(mesh_group.v_offset[bench.mesh] / sizeof(olivia::vertex3d_t));
+
+	uint32_t first_instance = 0;
+	bench.triangles         = 0.0;
+
+	for (uint32_t i = 0; i < olivia::MAX_MESH_LODS; ++i)
+	{
+		const uint32_t count = bench.level_counts[i];
+		if (!count)
+			continue;
+
+		vkCmdDrawIndexed(cmd, lods[i].index_count, count, first_index + lods[i].first_index, vertex_offset, first_instance);
+
+		first_instance  += count;
+		bench.triangles += (double)count * (lods[i].index_count / 3);
+	}
+}
+
+static bench_result_t run_frames(uint32_t frames, bool lods)
+{
+	bench.lods = lods;
+	memset(bench.levels, 0, bench.instance_count);
+
+	const VkExtent2D extent = olivia::g_vulkan_core.swapchain_extent;
+	const float      aspect = (float)extent.width / (float)extent.height;
+	const float      half   = 0.5f * sqrtf((float)bench.instance_count) * INSTANCE_SPACING;
+
+	bench_result_t result{};
+	uint64_t       start{};
+	uint32_t       measured{};
+
+	for (uint32_t frame = 0; measured < frames; ++frame)
+	{
+		SDL_Event event;
+		while (SDL_PollEvent(&event)) {}
+
+		if (frame == WARMUP_FRAMES)
+		{
+			start = SDL_GetPerformanceCounter();
+		}
+
+		// the same flight in both runs: from one edge of the grid to the other, slightly down
+		const float t = (float)frame / (float)(WARMUP_FRAMES + frames);
+
+		bench.eye = { 0.3f * half, 4.0f, -half + 1.6f * half * t };
+		build_view_projection(bench.eye, { bench.eye.x - 0.2f * half, 0.0f, bench.eye.z + half }, aspect);
+
+		if (!olivia::begin_frame())
+			continue;
+
+		olivia::draw_frame(draw_bench);
+		olivia::end_frame();
+
+		if (frame >= WARMUP_FRAMES)
+		{
+			// the pass time is of the frame slot begin_frame waited for, the rest of this frame
+			result.main_pass_ms += olivia::get_gpu_pass_time(olivia::RENDER_PASS_MAIN);
+			result.select_us    += bench.select_us;
+			result.triangles    += bench.triangles;
+			result.visible      += bench.visible_count;
+			result.switches     += bench.switches;
+
+			for (uint32_t i = 0; i < olivia::MAX_MESH_LODS; ++i)
+			{
+				result.level_instances[i] += bench.level_counts[i];
+			}
+
+			++measured;
+		}
+	}
+
+	olivia::wait_timeline_value(olivia::g_vulkan_core.timeline_value);
+
+	result.frame_ms      = ms_since(start) / frames;
+	result.main_pass_ms /= frames;
+	result.select_us    /= frames;
+	result.triangles    /= frames;
+	result.visible      /= frames;
+	result.switches     /= frames;
+
+	for (uint32_t i = 0; i < olivia::MAX_MESH_LODS; ++i)
+	{
+		result.level_instances[i] /= frames;
+	}
+
+	return result;
+}
+
+static void print_result(const char* name, const bench_result_t& result)
+{
+	printf("%-8s frame %8.3f ms  main pass %8.3f ms  %6.2f Mtriangles  %6.0f visible  select %7.1f us  %5.1f switches/frame\n",
+		name, result.frame_ms, result.main_pass_ms, result.triangles / 1e6, result.visible, result.select_us, result.switches);
+
+	printf("         instances per level:");
+	for (uint32_t i = 0; i < olivia::get_mesh_group().lod_count[bench.mesh]; ++i)
+	{
+		printf(" %8.1f", result.level_instances[i]);
+	}
+
+	printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t frames       = argc > 1 ? (uint32_t)SDL_atoi(argv[1]) : 300;
+	uint32_t grid         = argc > 2 ? (uint32_t)SDL_atoi(argv[2]) : 64;
+	bench.max_pixel_error = argc > 3 ? (float)SDL_atof(argv[3]) : 1.0f;
+
+	frames = SDL_max(frames, 1u);
+	grid   = SDL_max(grid, 1u);
+
+	if (!SDL_Init(SDL_INIT_VIDEO))
+	{
+		printf("SDL_Init failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	SDL_Window* window = SDL_CreateWindow("bench_mesh_lod", 1280, 720, SDL_WINDOW_VULKAN);
+	if (!window)
+	{
+		printf("SDL_CreateWindow failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	olivia::init_job_system(0);
+	olivia::init_renderer(window);
+	olivia::set_vsync(false);
+
+	// everything is drawn once, in the main pass
+	olivia::set_depth_prepass(false);
+
+	if (!import_sphere())
+		return 1;
+
+	create_instances(grid);
+	create_bench();
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(olivia::g_vulkan_core.gpu, &properties);
+
+	printf("%s, %u instances, max pixel error %.2f, hysteresis %.2f, %u frames\n",
+		properties.deviceName, bench.instance_count, bench.max_pixel_error, LOD_HYSTERESIS, frames);
+
+	bench_result_t full = run_frames(frames, false);
+	print_result("full", full);
+
+	bench_result_t lods = run_frames(frames, true);
+	print_result("lods", lods);
+
+	printf("lods draw %.1f%% of the triangles, frame time %+.1f%%\n",
+		lods.triangles * 100.0 / SDL_max(full.triangles, 1.0),
+		(lods.frame_ms - full.frame_ms) * 100.0 / full.frame_ms);
+
+	if (!olivia::g_vulkan_core.timestamp_pool)
+	{
+		printf("no gpu timestamps on this device, the main pass is not measured\n");
+	}
+
+	vkDeviceWaitIdle(olivia::g_vulkan_core.device);
+
+	destroy_bench();
+	olivia::destroy_renderer();
+	olivia::destroy_job_system();
+
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include "olivia_bench.h"
+#include "olivia/platform/storage_snapshot.h"
+
+// the game storage commits on first access and tracks writes; its first touch is
+// compared with malloc'd memory, and a snapshot is timed after a fixed number of
+// scattered page writes
+
+constexpr size_t BENCH_PAGE_SIZE{ KILOBYTES(4) };
+
+static double touch_pages(uint8_t* memory, size_t size)
+{
+	uint64_t start = bench_now();
+
+	for (size_t offset = 0; offset < size; offset += BENCH_PAGE_SIZE)
+	{
+		memory[offset] = 1;
+	}
+
+	return bench_seconds_since(start) * 1e9 / (double)(size / BENCH_PAGE_SIZE);
+}
+
+void bench_game_storage_commit(bench_context_t& ctx)
+{
+	const size_t size = ctx.quick ? MEGABYTES(16) : MEGABYTES(256);
+
+	double storage[MAX_BENCH_SAMPLES];
+	double heap[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		uint8_t* memory = (uint8_t*)olivia::create_game_storage(size);
+		if (!memory)
+		{
+			printf("  failed to create the game storage, skipped\n");
+			return;
+		}
+
+		storage[sample] = touch_pages(memory, size);
+		olivia::destroy_game_storage();
+
+		// large enough to be a fresh mapping every time
+		memory = (uint8_t*)malloc(size);
+		assert(memory && "malloc failed");
+
+		heap[sample] = touch_pages(memory, size);
+		free(memory);
+	}
+
+	report_metric(ctx, "allocators/storage_first_touch", "ns/page", storage, ctx.samples);
+	report_metric(ctx, "allocators/malloc_first_touch", "ns/page", heap, ctx.samples);
+}
+
+void bench_game_storage_snapshot(bench_context_t& ctx)
+{
+	const size_t   size        = ctx.quick ? MEGABYTES(16) : MEGABYTES(128);
+	const uint32_t dirty_pages = ctx.quick ? 256 : 2048;
+	const uint32_t page_count  = (uint32_t)(size / BENCH_PAGE_SIZE);
+
+	uint8_t* memory = (uint8_t*)olivia::create_game_storage(size);
+	if (!memory)
+	{
+		printf("  failed to create the game storage, skipped\n");
+		return;
+	}
+
+	// committed and clean, the samples only pay for their own writes
+	touch_pages(memory, size);
+	olivia::snapshot_game_storage();
+
+	double samples[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		for (uint32_t i = 0; i < dirty_pages; ++i)
+		{
+			memory[(bench_random_u64() % page_count) * BENCH_PAGE_SIZE + i % BENCH_PAGE_SIZE] += 1;
+		}
+
+		uint64_t start = bench_now();
+		bench_consume(olivia::snapshot_game_storage());
+		samples[sample] = bench_seconds_since(start) * 1e6;
+	}
+
+	olivia::destroy_game_storage();
+
+	char name[96];
+	SDL_snprintf(name, sizeof(name), "allocators/storage_snapshot_%u_pages", dirty_pages);
+
+	report_metric(ctx, name, "us", samples, ctx.samples);
+}
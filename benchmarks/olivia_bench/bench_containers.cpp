@@ -0,0 +1,143 @@
+#include "olivia_bench.h"
+#include "olivia/core/hash_map.h"
+#include "olivia/core/string_interner.h"
+
+// vector_t growth from one element, hash_map_t on random 64 bit keys and the string
+// interner on asset-like paths with repeats; ns per operation
+
+void bench_vector_push_back(bench_context_t& ctx)
+{
+	const uint32_t count = ctx.quick ? 100000 : 10000000;
+
+	double samples[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		uint64_t start = bench_now();
+
+		auto vec = olivia::create_vector<uint32_t>(1);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			olivia::vector_push_back(vec, i);
+		}
+
+		samples[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		bench_consume(vec.data[count / 2]);
+		olivia::destroy_vector(vec);
+	}
+
+	report_metric(ctx, "containers/vector_push_back", "ns/op", samples, ctx.samples);
+}
+
+void bench_hash_map(bench_context_t& ctx)
+{
+	const uint32_t count = ctx.quick ? 100000 : 1000000;
+
+	// odd keys are inserted, even ones are never in the map
+	uint64_t* keys    = (uint64_t*)malloc(count * sizeof(uint64_t));
+	uint64_t* missing = (uint64_t*)malloc(count * sizeof(uint64_t));
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		keys[i]    = bench_random_u64() | 1;
+		missing[i] = bench_random_u64() & ~1ull;
+	}
+
+	double insert[MAX_BENCH_SAMPLES];
+	double hit[MAX_BENCH_SAMPLES];
+	double miss[MAX_BENCH_SAMPLES];
+	double erase[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		auto map = olivia::create_hash_map<uint64_t, uint64_t>(0);
+
+		uint64_t start = bench_now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			olivia::hash_map_insert(map, keys[i], i);
+		}
+		insert[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		uint64_t sum = 0;
+
+		start = bench_now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			sum += *olivia::hash_map_find(map, keys[i]);
+		}
+		hit[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		start = bench_now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			sum += olivia::hash_map_find(map, missing[i]) != nullptr;
+		}
+		miss[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		start = bench_now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			sum += olivia::hash_map_erase(map, keys[i]);
+		}
+		erase[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		bench_consume(sum);
+		olivia::destroy_hash_map(map);
+	}
+
+	report_metric(ctx, "containers/hash_map_insert", "ns/op", insert, ctx.samples);
+	report_metric(ctx, "containers/hash_map_find_hit", "ns/op", hit, ctx.samples);
+	report_metric(ctx, "containers/hash_map_find_miss", "ns/op", miss, ctx.samples);
+	report_metric(ctx, "containers/hash_map_erase", "ns/op", erase, ctx.samples);
+
+	free(keys);
+	free(missing);
+}
+
+void bench_string_interner(bench_context_t& ctx)
+{
+	constexpr uint32_t NAME_SIZE{ 48 };
+
+	const uint32_t count = ctx.quick ? 20000 : 500000;
+
+	// about a quarter of the names repeat
+	char* names = (char*)malloc((size_t)count * NAME_SIZE);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		SDL_snprintf(names + (size_t)i * NAME_SIZE, NAME_SIZE, "assets/meshes/prop_%llu.mesh", (unsigned long long)(bench_random_u64() % (count * 2)));
+	}
+
+	double intern[MAX_BENCH_SAMPLES];
+	double find[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		auto interner = olivia::create_string_interner(0);
+
+		uint64_t sum = 0;
+
+		uint64_t start = bench_now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			sum += olivia::intern_string(interner, names + (size_t)i * NAME_SIZE);
+		}
+		intern[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		start = bench_now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			sum += olivia::find_string_id(interner, names + (size_t)i * NAME_SIZE);
+		}
+		find[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		bench_consume(sum);
+		olivia::destroy_string_interner(interner);
+	}
+
+	report_metric(ctx, "containers/string_intern", "ns/op", intern, ctx.samples);
+	report_metric(ctx, "containers/string_find", "ns/op", find, ctx.samples);
+
+	free(names);
+}
@@ -0,0 +1,202 @@
+#include "olivia_bench.h"
+#include "olivia/olivia_graphics.h"
+
+#include <math.h>
+
+// the engine's frame loop with vsync off: an empty frame (acquire, frame graph, submit,
+// present), then one that emits 1024 particles a frame living 4 s, simulates and draws
+// them. per frame: wall time, cpu time of the engine calls, and the gpu main pass and
+// particle job when the device has timestamps
+
+using olivia::vec3_t;
+
+constexpr float    FRAME_DT{ 1.0f / 60.0f };
+constexpr uint32_t WARMUP_FRAMES{ 60 };
+constexpr uint32_t PARTICLES_PER_FRAME{ 1024 };
+constexpr uint32_t PARTICLE_LIFE_FRAMES{ 240 };
+constexpr vec3_t   EYE{ 0.0f, 8.0f, -40.0f };
+
+struct frame_samples_t
+{
+	double* frame_ms;
+	double* cpu_ms;
+	double* gpu_ms;
+	double* particle_ms;
+};
+
+struct frame_bench_t
+{
+	bool   particles;
+	float  view_projection[16];
+	vec3_t right;
+	vec3_t up;
+};
+
+static frame_bench_t frame_bench{};
+
+static void draw_bench()
+{
+	if (frame_bench.particles && olivia::g_vulkan_core.current_pass == olivia::RENDER_PASS_MAIN)
+	{
+		olivia::draw_particles(frame_bench.view_projection, frame_bench.right, frame_bench.up);
+	}
+}
+
+static vec3_t sub(vec3_t a, vec3_t b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static float  dot(vec3_t a, vec3_t b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+static vec3_t cross(vec3_t a, vec3_t b)
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+static vec3_t normalize(vec3_t v)
+{
+	float length = sqrtf(dot(v, v));
+	return { v.x / length, v.y / length, v.z / length };
+}
+
+// column major look-at times a reverse-Z infinite perspective
+static void build_view_projection(vec3_t eye, vec3_t target, float aspect)
+{
+	vec3_t forward    = normalize(sub(target, eye));
+	frame_bench.right = normalize(cross(forward, { 0.0f, 1.0f, 0.0f }));
+	frame_bench.up    = cross(frame_bench.right, forward);
+
+	const vec3_t right = frame_bench.right;
+	const vec3_t up    = frame_bench.up;
+
+	const float f     = 1.0f / tanf(0.5f * 1.0471976f); // 60 degrees vertical
+	const float znear = 0.1f;
+
+	// rows of the view matrix, y flipped for vulkan clip space
+	const float view[3][4]
+	{
+		{  right.x,    right.y,    right.z,   -dot(right, eye)   },
+		{ -up.x,      -up.y,      -up.z,       dot(up, eye)      },
+		{  forward.x,  forward.y,  forward.z, -dot(forward, eye) }
+	};
+
+	float* m = frame_bench.view_projection;
+	for (uint32_t column = 0; column < 4; ++column)
+	{
+		const float w = column == 3 ? 1.0f : 0.0f;
+
+		m[column * 4 + 0] = view[0][column] * f / aspect;
+		m[column * 4 + 1] = view[1][column] * f;
+		m[column * 4 + 2] = w * znear;       // depth = znear / view z
+		m[column * 4 + 3] = view[2][column];
+	}
+}
+
+static void run_frames(bench_context_t& ctx, const char* name)
+{
+	frame_samples_t samples{};
+
+	samples.frame_ms    = (double*)malloc(ctx.frames * sizeof(double));
+	samples.cpu_ms      = (double*)malloc(ctx.frames * sizeof(double));
+	samples.gpu_ms      = (double*)malloc(ctx.frames * sizeof(double));
+	samples.particle_ms = (double*)malloc(ctx.frames * sizeof(double));
+
+	uint64_t last     = bench_now();
+	uint32_t measured = 0;
+
+	for (uint32_t frame = 0; measured < ctx.frames; ++frame)
+	{
+		SDL_Event event;
+		while (SDL_PollEvent(&event)) {}
+
+		uint64_t cpu_start = bench_now();
+
+		if (frame_bench.particles)
+		{
+			olivia::particle_emit_t emit
+			{
+				.position = { 0.0f, 0.0f, 0.0f },
+				.life = PARTICLE_LIFE_FRAMES * FRAME_DT,
+				.spread = { 0.5f, 0.0f, 0.5f },
+				.size = 0.05f,
+				.velocity = { 0.0f, 12.0f, 0.0f },
+				.count = PARTICLES_PER_FRAME,
+				.velocity_spread = { 3.0f, 2.0f, 3.0f },
+				.color = { 1.0f, 0.6f, 0.2f, 0.0f }
+			};
+
+			olivia::emit_particles(emit);
+			olivia::schedule_particles(FRAME_DT, { 0.0f, -9.8f, 0.0f }, false, EYE);
+		}
+
+		if (!olivia::begin_frame())
+			continue;
+
+		olivia::draw_frame(draw_bench);
+		olivia::end_frame();
+
+		double cpu_ms = bench_seconds_since(cpu_start) * 1000.0;
+
+		uint64_t end = bench_now();
+		double frame_ms = (double)(end - last) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+		last = end;
+
+		// the particle fountain needs a full life to reach its steady count
+		if (frame < WARMUP_FRAMES + (frame_bench.particles ? PARTICLE_LIFE_FRAMES : 0))
+			continue;
+
+		// gpu times are of the frame slot begin_frame waited for
+		samples.frame_ms[measured]    = frame_ms;
+		samples.cpu_ms[measured]      = cpu_ms;
+		samples.gpu_ms[measured]      = olivia::get_gpu_pass_time(olivia::RENDER_PASS_MAIN);
+		samples.particle_ms[measured] = frame_bench.particles ? olivia::get_particle_gpu_time() : 0.0;
+		++measured;
+	}
+
+	olivia::wait_timeline_value(olivia::g_vulkan_core.timeline_value);
+
+	char metric[96];
+
+	SDL_snprintf(metric, sizeof(metric), "frame/%s_frame", name);
+	report_metric(ctx, metric, "ms", samples.frame_ms, ctx.frames);
+
+	SDL_snprintf(metric, sizeof(metric), "frame/%s_cpu", name);
+	report_metric(ctx, metric, "ms", samples.cpu_ms, ctx.frames);
+
+	if (olivia::g_vulkan_core.timestamp_pool)
+	{
+		SDL_snprintf(metric, sizeof(metric), "frame/%s_gpu_main_pass", name);
+		report_metric(ctx, metric, "ms", samples.gpu_ms, ctx.frames);
+
+		if (frame_bench.particles)
+		{
+			SDL_snprintf(metric, sizeof(metric), "frame/%s_gpu_particle_job", name);
+			report_metric(ctx, metric, "ms", samples.particle_ms, ctx.frames);
+		}
+	}
+
+	free(samples.frame_ms);
+	free(samples.cpu_ms);
+	free(samples.gpu_ms);
+	free(samples.particle_ms);
+}
+
+void bench_frame_loop_empty(bench_context_t& ctx)
+{
+	frame_bench.particles = false;
+
+	run_frames(ctx, "empty");
+}
+
+void bench_frame_loop_particles(bench_context_t& ctx)
+{
+	olivia::init_particles(PARTICLES_PER_FRAME * PARTICLE_LIFE_FRAMES);
+
+	VkExtent2D extent = olivia::g_vulkan_core.swapchain_extent;
+	build_view_projection(EYE, { 0.0f, 10.0f, 0.0f }, (float)extent.width / (float)extent.height);
+
+	frame_bench.particles = true;
+
+	run_frames(ctx, "particles");
+
+	frame_bench.particles = false;
+
+	olivia::destroy_particles();
+}
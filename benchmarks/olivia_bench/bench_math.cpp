@@ -0,0 +1,189 @@
+#include "olivia_bench.h"
+#include "olivia/graphics/bvh.h"
+#include "olivia/graphics/animation.h"
+
+#include <math.h>
+
+// bounds and culling math on random boxes, and the skinning palette of a 128 joint chain
+
+static olivia::aabb_t random_box()
+{
+	olivia::vec3_t center{ bench_random_float(-500.0f, 500.0f), bench_random_float(-20.0f, 20.0f), bench_random_float(-500.0f, 500.0f) };
+	float          size = bench_random_float(0.5f, 4.0f);
+
+	return { { center.x - size, center.y - size, center.z - size }, { center.x + size, center.y + size, center.z + size } };
+}
+
+// column major, looking down +z from the origin; x and y in [-z, z], depth = 0.1 / z
+static void make_view_projection(float* m)
+{
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		m[i] = 0.0f;
+	}
+
+	m[0]  = 1.0f;
+	m[5]  = 1.0f;
+	m[11] = 1.0f;
+	m[14] = 0.1f;
+}
+
+void bench_transform_aabb(bench_context_t& ctx)
+{
+	const uint32_t count = ctx.quick ? 10000 : 1000000;
+
+	olivia::aabb_t* boxes = (olivia::aabb_t*)malloc(count * sizeof(olivia::aabb_t));
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		boxes[i] = random_box();
+	}
+
+	// a rotation about y, a scale and a translation
+	const float c = cosf(0.7f) * 1.5f;
+	const float s = sinf(0.7f) * 1.5f;
+
+	const float matrix[16]
+	{
+		c,     0.0f, -s,    0.0f,
+		0.0f,  1.5f, 0.0f,  0.0f,
+		s,     0.0f, c,     0.0f,
+		10.0f, 2.0f, -4.0f, 1.0f
+	};
+
+	double samples[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		float sum = 0.0f;
+
+		uint64_t start = bench_now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			olivia::aabb_t box = olivia::transform_aabb(boxes[i], matrix);
+			sum += box.max.x - box.min.x;
+		}
+		samples[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		bench_consume((uint64_t)sum);
+	}
+
+	report_metric(ctx, "math/transform_aabb", "ns/op", samples, ctx.samples);
+
+	free(boxes);
+}
+
+void bench_frustum_cull(bench_context_t& ctx)
+{
+	const uint32_t count = ctx.quick ? 10000 : 1000000;
+
+	olivia::aabb_t* boxes   = (olivia::aabb_t*)malloc(count * sizeof(olivia::aabb_t));
+	uint32_t*       visible = (uint32_t*)malloc(count * sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		boxes[i] = random_box();
+	}
+
+	float view_projection[16];
+	make_view_projection(view_projection);
+
+	const olivia::frustum_t frustum = olivia::make_frustum(view_projection);
+
+	olivia::bvh_t bvh{};
+	olivia::build_bvh(bvh, boxes, count);
+
+	double brute[MAX_BENCH_SAMPLES];
+	double tree[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		uint32_t visible_count = 0;
+
+		uint64_t start = bench_now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			visible_count += olivia::is_aabb_visible(frustum, boxes[i]);
+		}
+		brute[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		olivia::bvh_cull_query_t query{ frustum, visible, 0 };
+
+		start = bench_now();
+		olivia::cull_bvh(bvh, &query, 1);
+		tree[sample] = bench_seconds_since(start) * 1e9 / count;
+
+		assert(query.visible_count == visible_count && "bvh and brute force culling disagree");
+		bench_consume(query.visible_count + visible_count);
+	}
+
+	report_metric(ctx, "math/frustum_cull_brute_force", "ns/instance", brute, ctx.samples);
+	report_metric(ctx, "math/frustum_cull_bvh", "ns/instance", tree, ctx.samples);
+
+	olivia::destroy_bvh(bvh);
+
+	free(boxes);
+	free(visible);
+}
+
+void bench_skinning_palette(bench_context_t& ctx)
+{
+	constexpr uint32_t JOINT_COUNT{ 128 };
+	constexpr uint32_t FRAME_COUNT{ 60 };
+
+	const uint32_t iterations = ctx.quick ? 1000 : 20000;
+
+	// a chain bending a little at every joint; the key frames are too big for the stack
+	uint16_t                         parents[JOINT_COUNT];
+	olivia::joint_matrix_t           inverse_bind[JOINT_COUNT];
+	static olivia::joint_transform_t transforms[FRAME_COUNT * JOINT_COUNT];
+	static olivia::joint_key_t       keys[FRAME_COUNT * JOINT_COUNT];
+
+	for (uint32_t joint = 0; joint < JOINT_COUNT; ++joint)
+	{
+		parents[joint]      = joint ? (uint16_t)(joint - 1) : olivia::NO_PARENT;
+		inverse_bind[joint] = { { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, -(float)joint }, { 0.0f, 0.0f, 1.0f, 0.0f } } };
+
+		for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+		{
+			float angle = 0.05f * sinf((float)frame * 0.1f + (float)joint);
+
+			transforms[frame * JOINT_COUNT + joint] = { { 0.0f, 0.0f, sinf(angle), cosf(angle) }, { 0.0f, 1.0f, 0.0f }, 1.0f };
+		}
+	}
+
+	olivia::animation_clip_t clip{};
+	olivia::compress_animation(transforms, JOINT_COUNT, FRAME_COUNT, 30.0f, keys, clip);
+
+	olivia::skeleton_t skeleton{ JOINT_COUNT, parents, inverse_bind };
+
+	olivia::pose_t*         pose    = (olivia::pose_t*)malloc(sizeof(olivia::pose_t));
+	olivia::joint_matrix_t* palette = (olivia::joint_matrix_t*)malloc(JOINT_COUNT * sizeof(olivia::joint_matrix_t));
+
+	double sampling[MAX_BENCH_SAMPLES];
+	double converting[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		uint64_t start = bench_now();
+		for (uint32_t i = 0; i < iterations; ++i)
+		{
+			olivia::sample_animation(clip, (float)i * 0.013f, *pose);
+		}
+		sampling[sample] = bench_seconds_since(start) * 1e9 / ((double)iterations * JOINT_COUNT);
+
+		start = bench_now();
+		for (uint32_t i = 0; i < iterations; ++i)
+		{
+			olivia::compute_skinning_palette(skeleton, *pose, palette);
+		}
+		converting[sample] = bench_seconds_since(start) * 1e9 / ((double)iterations * JOINT_COUNT);
+
+		bench_consume((uint64_t)(palette[JOINT_COUNT - 1].rows[0].w * 1000.0f));
+	}
+
+	report_metric(ctx, "math/sample_animation", "ns/joint", sampling, ctx.samples);
+	report_metric(ctx, "math/skinning_palette", "ns/joint", converting, ctx.samples);
+
+	free(pose);
+	free(palette);
+}
@@ -0,0 +1,148 @@
+#include "olivia_bench.h"
+#include "olivia/olivia_graphics.h"
+
+// cpu writes into persistently mapped upload memory (what the mesh group and the
+// texture streamer fill), and a full staging upload: the write plus a copy into device
+// local memory on the graphics queue, waited on with a fence. GB/s, higher is better
+
+static uint8_t* create_source(size_t size)
+{
+	uint8_t* source = (uint8_t*)malloc(size);
+	assert(source && "malloc failed");
+
+	for (size_t i = 0; i < size; i += sizeof(uint64_t))
+	{
+		uint64_t value = bench_random_u64();
+		memcpy(source + i, &value, sizeof(value));
+	}
+
+	return source;
+}
+
+void bench_mapped_write(bench_context_t& ctx)
+{
+	const size_t size = ctx.quick ? MEGABYTES(8) : MEGABYTES(64);
+
+	uint8_t* source = create_source(size);
+
+	olivia::vulkan_buffer_t staging = olivia::create_vulkan_buffer(
+		olivia::MEMORY_CATEGORY_STAGING,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VMA_MEMORY_USAGE_AUTO,
+		VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+		size);
+
+	// first touch is not part of the measurement
+	memcpy(staging.info.pMappedData, source, size);
+
+	double samples[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample < ctx.samples; ++sample)
+	{
+		uint64_t start = bench_now();
+		memcpy(staging.info.pMappedData, source, size);
+		samples[sample] = (double)size / bench_seconds_since(start) * 1e-9;
+	}
+
+	report_metric(ctx, "upload/mapped_write", "GB/s", samples, ctx.samples, false);
+
+	olivia::destroy_vulkan_buffer(staging);
+	free(source);
+}
+
+void bench_staging_copy(bench_context_t& ctx)
+{
+	const size_t size = ctx.quick ? MEGABYTES(8) : MEGABYTES(64);
+
+	uint8_t* source = create_source(size);
+
+	olivia::vulkan_buffer_t staging = olivia::create_vulkan_buffer(
+		olivia::MEMORY_CATEGORY_STAGING,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VMA_MEMORY_USAGE_AUTO,
+		VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+		size);
+
+	olivia::vulkan_buffer_t destination = olivia::create_vulkan_buffer(
+		olivia::MEMORY_CATEGORY_MESH,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+		0,
+		size);
+
+	VkDevice device = olivia::g_vulkan_core.device;
+
+	VkCommandPoolCreateInfo pool_info
+	{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = olivia::g_vulkan_core.graphics_queue_index
+	};
+
+	VkCommandPool pool;
+	VK_CHECK(vkCreateCommandPool(device, &pool_info, nullptr, &pool));
+
+	VkCommandBufferAllocateInfo allocate_info
+	{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.commandPool = pool,
+		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandBufferCount = 1
+	};
+
+	VkCommandBuffer cmd;
+	VK_CHECK(vkAllocateCommandBuffers(device, &allocate_info, &cmd));
+
+	VkFenceCreateInfo fence_info{ .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+
+	VkFence fence;
+	VK_CHECK(vkCreateFence(device, &fence_info, nullptr, &fence));
+
+	// one warm-up upload, then the measured ones
+	double samples[MAX_BENCH_SAMPLES];
+
+	for (uint32_t sample = 0; sample <= ctx.samples; ++sample)
+	{
+		uint64_t start = bench_now();
+
+		memcpy(staging.info.pMappedData, source, size);
+
+		VK_CHECK(vkResetCommandPool(device, pool, 0));
+
+		VkCommandBufferBeginInfo begin_info
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+		};
+
+		VK_CHECK(vkBeginCommandBuffer(cmd, &begin_info));
+
+		VkBufferCopy region{ .size = size };
+		vkCmdCopyBuffer(cmd, staging.buffer, destination.buffer, 1, &region);
+
+		VK_CHECK(vkEndCommandBuffer(cmd));
+
+		VkSubmitInfo submit_info
+		{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &cmd
+		};
+
+		VK_CHECK(vkQueueSubmit(olivia::g_vulkan_core.queue, 1, &submit_info, fence));
+		VK_CHECK(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
+		VK_CHECK(vkResetFences(device, 1, &fence));
+
+		if (sample > 0)
+			samples[sample - 1] = (double)size / bench_seconds_since(start) * 1e-9;
+	}
+
+	report_metric(ctx, "upload/staging_copy", "GB/s", samples, ctx.samples, false);
+
+	vkDestroyFence(device, fence, nullptr);
+	vkDestroyCommandPool(device, pool, nullptr);
+
+	olivia::destroy_vulkan_buffer(destination);
+	olivia::destroy_vulkan_buffer(staging);
+	free(source);
+}
@@ -0,0 +1,269 @@
+#include "olivia_bench.h"
+#include "olivia/olivia_graphics.h"
+#include "olivia/platform/sdl3_jobs.h"
+
+// usage: olivia_bench [--filter prefix] [--json path] [--samples 7] [--frames 600]
+//                     [--commit id] [--headless] [--quick] [--list]
+//
+// micro benchmarks repeat a fixed problem --samples times and report the median, macro
+// benchmarks run the frame loop for --frames measured frames. cases whose name starts
+// with --filter run, in table order. --headless uses SDL's offscreen video driver, so
+// the renderer cases need no display; with OLIVIA_GPU=llvmpipe they run on lavapipe.
+//
+// --json writes
+//   { "schema": 1, "commit": "...", "build": "...", "cpu_threads": n, "gpu": "...",
+//     "metrics": [ { "name": "...", "unit": "...", "lower_is_better": true,
+//                    "median": x, "min": x, "max": x, "samples": n }, ... ] }
+// with one metric per line so runs of two commits diff line by line.
+
+#ifndef OLIVIA_BENCH_COMMIT
+#define OLIVIA_BENCH_COMMIT "unknown"
+#endif
+
+#ifdef OLIVIA_DEBUG
+#define OLIVIA_BENCH_BUILD "debug"
+#else
+#define OLIVIA_BENCH_BUILD "release"
+#endif
+
+static const bench_case_t BENCH_CASES[]
+{
+	{ "containers/vector_push_back", bench_vector_push_back,      false },
+	{ "containers/hash_map",         bench_hash_map,              false },
+	{ "containers/string_interner",  bench_string_interner,       false },
+	{ "allocators/storage_commit",   bench_game_storage_commit,   false },
+	{ "allocators/storage_snapshot", bench_game_storage_snapshot, false },
+	{ "math/transform_aabb",         bench_transform_aabb,        false },
+	{ "math/frustum_cull",           bench_frustum_cull,          false },
+	{ "math/skinning_palette",       bench_skinning_palette,      false },
+	{ "upload/mapped_write",         bench_mapped_write,          true  },
+	{ "upload/staging_copy",         bench_staging_copy,          true  },
+	{ "frame/empty",                 bench_frame_loop_empty,      true  },
+	{ "frame/particles",             bench_frame_loop_particles,  true  },
+};
+
+static volatile uint64_t s_sink;
+static uint64_t          s_random_state = 1;
+
+void bench_consume(uint64_t value)
+{
+	s_sink = s_sink + value;
+}
+
+uint64_t bench_random_u64()
+{
+	uint64_t z = (s_random_state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+float bench_random_float(float min, float max)
+{
+	return min + (max - min) * (float)(bench_random_u64() >> 40) / (float)(1u << 24);
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+
+	return (x > y) - (x < y);
+}
+
+void report_metric(bench_context_t& ctx, const char* name, const char* unit, double* samples, uint32_t count, bool lower_is_better)
+{
+	assert(count > 0 && "no samples");
+
+	SDL_qsort(samples, count, sizeof(double), compare_doubles);
+
+	bench_metric_t metric{};
+
+	SDL_strlcpy(metric.name, name, sizeof(metric.name));
+	metric.unit            = unit;
+	metric.lower_is_better = lower_is_better;
+	metric.median          = count % 2 ? samples[count / 2] : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+	metric.min             = samples[0];
+	metric.max             = samples[count - 1];
+	metric.sample_count    = count;
+
+	olivia::vector_push_back(ctx.metrics, metric);
+
+	printf("  %-44s %12.3f %-8s [%.3f, %.3f]\n", metric.name, metric.median, metric.unit, metric.min, metric.max);
+}
+
+// names and the gpu come from code and drivers, only quotes and backslashes need escaping
+static void write_json_string(SDL_IOStream* file, const char* str)
+{
+	SDL_WriteIO(file, "\"", 1);
+
+	for (; *str; ++str)
+	{
+		if (*str == '"' || *str == '\\')
+			SDL_WriteIO(file, "\\", 1);
+
+		if ((unsigned char)*str >= 0x20)
+			SDL_WriteIO(file, str, 1);
+	}
+
+	SDL_WriteIO(file, "\"", 1);
+}
+
+static bool write_json(const char* path, const bench_context_t& ctx, const char* commit, const char* gpu)
+{
+	SDL_IOStream* file = SDL_IOFromFile(path, "w");
+	if (!file)
+	{
+		printf("failed to open %s: %s\n", path, SDL_GetError());
+		return false;
+	}
+
+	SDL_IOprintf(file, "{\n\t\"schema\": 1,\n\t\"commit\": ");
+	write_json_string(file, commit);
+	SDL_IOprintf(file, ",\n\t\"build\": \"%s\",\n\t\"cpu_threads\": %d,\n\t\"gpu\": ", OLIVIA_BENCH_BUILD, SDL_GetNumLogicalCPUCores());
+	write_json_string(file, gpu);
+	SDL_IOprintf(file, ",\n\t\"metrics\": [\n");
+
+	for (size_t i = 0; i < ctx.metrics.size; ++i)
+	{
+		const bench_metric_t& metric = ctx.metrics.data[i];
+
+		SDL_IOprintf(file, "\t\t{ \"name\": ");
+		write_json_string(file, metric.name);
+		SDL_IOprintf(file, ", \"unit\": ");
+		write_json_string(file, metric.unit);
+		SDL_IOprintf(file, ", \"lower_is_better\": %s, \"median\": %.6g, \"min\": %.6g, \"max\": %.6g, \"samples\": %u }%s\n",
+			metric.lower_is_better ? "true" : "false",
+			metric.median,
+			metric.min,
+			metric.max,
+			metric.sample_count,
+			i + 1 < ctx.metrics.size ? "," : "");
+	}
+
+	SDL_IOprintf(file, "\t]\n}\n");
+
+	return SDL_CloseIO(file);
+}
+
+static bool matches_filter(const char* name, const char* filter)
+{
+	return !filter || SDL_strncmp(name, filter, SDL_strlen(filter)) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	bench_context_t ctx{};
+
+	ctx.samples = 7;
+	ctx.frames  = 600;
+
+	const char* filter    = nullptr;
+	const char* json_path = nullptr;
+	const char* commit    = OLIVIA_BENCH_COMMIT;
+	bool        headless  = false;
+	bool        list      = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool value = i + 1 < argc;
+
+		if      (SDL_strcmp(argv[i], "--filter") == 0 && value)  filter      = argv[++i];
+		else if (SDL_strcmp(argv[i], "--json") == 0 && value)    json_path   = argv[++i];
+		else if (SDL_strcmp(argv[i], "--samples") == 0 && value) ctx.samples = (uint32_t)SDL_atoi(argv[++i]);
+		else if (SDL_strcmp(argv[i], "--frames") == 0 && value)  ctx.frames  = (uint32_t)SDL_atoi(argv[++i]);
+		else if (SDL_strcmp(argv[i], "--commit") == 0 && value)  commit      = argv[++i];
+		else if (SDL_strcmp(argv[i], "--headless") == 0)         headless    = true;
+		else if (SDL_strcmp(argv[i], "--quick") == 0)            ctx.quick   = true;
+		else if (SDL_strcmp(argv[i], "--list") == 0)             list        = true;
+		else
+		{
+			printf("unknown argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	ctx.samples = SDL_clamp(ctx.samples, 1u, MAX_BENCH_SAMPLES);
+	ctx.frames  = SDL_max(ctx.frames, 1u);
+
+	bool needs_renderer = false;
+
+	for (const bench_case_t& bench_case : BENCH_CASES)
+	{
+		if (!matches_filter(bench_case.name, filter))
+			continue;
+
+		if (list)
+			printf("%s%s\n", bench_case.name, bench_case.needs_renderer ? " (renderer)" : "");
+
+		needs_renderer |= bench_case.needs_renderer;
+	}
+
+	if (list)
+		return 0;
+
+	if (headless)
+	{
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+	}
+
+	if (!SDL_Init(needs_renderer ? SDL_INIT_VIDEO : 0))
+	{
+		printf("SDL_Init failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	olivia::init_job_system(0);
+
+	SDL_Window* window = nullptr;
+	char        gpu[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE] = "none";
+
+	if (needs_renderer)
+	{
+		window = SDL_CreateWindow("olivia_bench", 1280, 720, SDL_WINDOW_VULKAN);
+		if (!window)
+		{
+			printf("SDL_CreateWindow failed: %s\n", SDL_GetError());
+			return 1;
+		}
+
+		olivia::init_renderer(window);
+		olivia::set_vsync(false);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(olivia::g_vulkan_core.gpu, &properties);
+
+		SDL_strlcpy(gpu, properties.deviceName, sizeof(gpu));
+	}
+
+	printf("olivia_bench %s (%s), %d threads, gpu %s, %u samples, %u frames\n",
+		commit, OLIVIA_BENCH_BUILD, SDL_GetNumLogicalCPUCores(), gpu, ctx.samples, ctx.frames);
+
+	ctx.metrics = olivia::create_vector<bench_metric_t>(64);
+
+	for (const bench_case_t& bench_case : BENCH_CASES)
+	{
+		if (!matches_filter(bench_case.name, filter))
+			continue;
+
+		printf("%s\n", bench_case.name);
+		bench_case.function(ctx);
+	}
+
+	bool written = !json_path || write_json(json_path, ctx, commit, gpu);
+
+	olivia::destroy_vector(ctx.metrics);
+
+	if (window)
+	{
+		vkDeviceWaitIdle(olivia::g_vulkan_core.device);
+
+		olivia::destroy_renderer();
+		SDL_DestroyWindow(window);
+	}
+
+	olivia::destroy_job_system();
+	SDL_Quit();
+
+	return written ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "olivia/olivia_core.h"
+#include "olivia/core/vector.h"
+
+#include <SDL3/SDL.h>
+
+// shared by every olivia_bench case, the command line and the json are in olivia_bench.cpp
+
+constexpr uint32_t MAX_BENCH_SAMPLES{ 64 };
+
+// one reported number, the median of its samples; min and max show the spread
+struct bench_metric_t
+{
+	char        name[96];
+	const char* unit;
+	bool        lower_is_better;
+	double      median;
+	double      min;
+	double      max;
+	uint32_t    sample_count;
+};
+
+struct bench_context_t
+{
+	uint32_t                         samples; // repetitions of every micro benchmark
+	uint32_t                         frames;  // measured frames of every macro benchmark
+	bool                             quick;   // smaller problems, for smoke runs
+	olivia::vector_t<bench_metric_t> metrics;
+};
+
+typedef void (*bench_function)(bench_context_t& ctx);
+
+struct bench_case_t
+{
+	const char*    name;
+	bench_function function;
+	bool           needs_renderer; // runs after init_renderer on the shared window
+};
+
+inline uint64_t bench_now()
+{
+	return SDL_GetPerformanceCounter();
+}
+
+inline double bench_seconds_since(uint64_t start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
+
+// sorts the samples
+void report_metric(bench_context_t& ctx, const char* name, const char* unit, double* samples, uint32_t count, bool lower_is_better = true);
+
+// keeps the optimizer from dropping a result
+void bench_consume(uint64_t value);
+
+uint64_t bench_random_u64();
+
+float bench_random_float(float min, float max);
+
+// --- micro: containers ---
+
+void bench_vector_push_back(bench_context_t& ctx);
+void bench_hash_map(bench_context_t& ctx);
+void bench_string_interner(bench_context_t& ctx);
+
+// --- micro: allocators ---
+
+void bench_game_storage_commit(bench_context_t& ctx);
+void bench_game_storage_snapshot(bench_context_t& ctx);
+
+// --- micro: math ---
+
+void bench_transform_aabb(bench_context_t& ctx);
+void bench_frustum_cull(bench_context_t& ctx);
+void bench_skinning_palette(bench_context_t& ctx);
+
+// --- micro: uploads ---
+
+void bench_mapped_write(bench_context_t& ctx);
+void bench_staging_copy(bench_context_t& ctx);
+
+// --- macro ---
+
+void bench_frame_loop_empty(bench_context_t& ctx);
+void bench_frame_loop_particles(bench_context_t& ctx);
@@ -0,0 +1,202 @@
+#include <catch2/catch_test_macros.hpp>
+#include "olivia/graphics/animation.h"
+#include "olivia/platform/sdl3_jobs.h"
+
+#include <math.h>
+
+using namespace olivia;
+
+constexpr float TOLERANCE{ 0.002f };
+
+static bool near(float a, float b, float tolerance = TOLERANCE)
+{
+	return fabsf(a - b) <= tolerance;
+}
+
+static vec4_t axis_angle(float x, float y, float z, float angle)
+{
+	float s = sinf(angle * 0.5f);
+	return { x * s, y * s, z * s, cosf(angle * 0.5f) };
+}
+
+static const joint_matrix_t IDENTITY{ { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 } } };
+
+// q and -q are the same rotation
+static bool same_rotation(const vec4_t& a, const vec4_t& b)
+{
+	float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	return near(fabsf(dot), 1.0f);
+}
+
+TEST_CASE("Sampling a keyframe returns the compressed transforms")
+{
+	constexpr uint32_t JOINT_COUNT{ 7 };
+	constexpr uint32_t FRAME_COUNT{ 3 };
+
+	joint_transform_t transforms[FRAME_COUNT * JOINT_COUNT];
+	for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+	{
+		for (uint32_t joint = 0; joint < JOINT_COUNT; ++joint)
+		{
+			float angle = 0.4f * (float)(joint + 1) - 0.9f * (float)frame;
+
+			// every component gets to be the largest one
+			vec4_t rotation = joint % 4 == 0 ? axis_angle(1, 0, 0, angle) : joint % 4 == 1 ? axis_angle(0, 1, 0, angle + 2.8f)
+			                : joint % 4 == 2 ? axis_angle(0, 0, 1, angle - 2.5f) : axis_angle(0.577f, 0.577f, 0.577f, angle);
+
+			transforms[frame * JOINT_COUNT + joint] = { rotation, { (float)joint, -2.0f * (float)frame, 0.5f }, 1.0f + 0.25f * (float)frame };
+		}
+	}
+
+	joint_key_t      keys[FRAME_COUNT * JOINT_COUNT];
+	animation_clip_t clip;
+	compress_animation(transforms, JOINT_COUNT, FRAME_COUNT, 30.0f, keys, clip);
+
+	static pose_t pose;
+	sample_animation(clip, 1.0f / 30.0f, pose);
+
+	for (uint32_t joint = 0; joint < JOINT_COUNT; ++joint)
+	{
+		const joint_transform_t& expected = transforms[JOINT_COUNT + joint];
+		joint_transform_t        sampled  = get_joint_transform(pose, joint);
+
+		CHECK(same_rotation(sampled.rotation, expected.rotation));
+		CHECK(near(sampled.translation.x, expected.translation.x));
+		CHECK(near(sampled.translation.y, expected.translation.y));
+		CHECK(near(sampled.translation.z, expected.translation.z));
+		CHECK(near(sampled.scale, expected.scale));
+	}
+}
+
+TEST_CASE("Sampling between keyframes interpolates and loops")
+{
+	joint_transform_t transforms[2]
+	{
+		{ axis_angle(0, 0, 1, 0.0f), { 0, 0, 0 }, 1.0f },
+		{ axis_angle(0, 0, 1, 1.0f), { 4, 0, 0 }, 1.0f }
+	};
+
+	joint_key_t      keys[2];
+	animation_clip_t clip;
+	compress_animation(transforms, 1, 2, 1.0f, keys, clip);
+
+	static pose_t pose;
+
+	sample_animation(clip, 0.5f, pose);
+	joint_transform_t half = get_joint_transform(pose, 0);
+
+	CHECK(same_rotation(half.rotation, axis_angle(0, 0, 1, 0.5f)));
+	CHECK(near(half.translation.x, 2.0f));
+
+	// 1.25 s wraps back towards frame 0
+	sample_animation(clip, 1.25f, pose);
+	CHECK(near(get_joint_transform(pose, 0).translation.x, 3.0f));
+
+	sample_animation(clip, 2.25f, pose);
+	CHECK(near(get_joint_transform(pose, 0).translation.x, 1.0f));
+}
+
+TEST_CASE("Blending two poses")
+{
+	joint_transform_t a{ axis_angle(0, 1, 0, 0.0f), { 0, 0, 0 }, 1.0f };
+	joint_transform_t b{ axis_angle(0, 1, 0, 1.0f), { 0, 2, 0 }, 3.0f };
+
+	joint_key_t      keys_a[1], keys_b[1];
+	animation_clip_t clip_a, clip_b;
+	compress_animation(&a, 1, 1, 30.0f, keys_a, clip_a);
+	compress_animation(&b, 1, 1, 30.0f, keys_b, clip_b);
+
+	static pose_t pose_a, pose_b, pose;
+	sample_animation(clip_a, 0.0f, pose_a);
+	sample_animation(clip_b, 0.0f, pose_b);
+
+	blend_poses(pose_a, pose_b, 0.25f, 1, pose);
+
+	joint_transform_t blended = get_joint_transform(pose, 0);
+	CHECK(same_rotation(blended.rotation, axis_angle(0, 1, 0, 0.25f)));
+	CHECK(near(blended.translation.y, 0.5f));
+	CHECK(near(blended.scale, 1.5f));
+}
+
+TEST_CASE("Skinning palette walks the hierarchy")
+{
+	// a chain of three joints, each one unit along the rotated x axis of its parent
+	joint_transform_t transforms[3]
+	{
+		{ axis_angle(0, 0, 1, 1.5707963f), { 1, 0, 0 }, 1.0f },
+		{ axis_angle(0, 0, 1, 0.0f),       { 1, 0, 0 }, 1.0f },
+		{ axis_angle(0, 0, 1, 0.0f),       { 1, 0, 0 }, 2.0f }
+	};
+
+	joint_key_t      keys[3];
+	animation_clip_t clip;
+	compress_animation(transforms, 3, 1, 30.0f, keys, clip);
+
+	static pose_t pose;
+	sample_animation(clip, 0.0f, pose);
+
+	const uint16_t       parents[3]{ NO_PARENT, 0, 1 };
+	const joint_matrix_t inverse_bind[3]{ IDENTITY, IDENTITY, IDENTITY };
+	const skeleton_t     skeleton{ 3, parents, inverse_bind };
+
+	joint_matrix_t palette[3];
+	compute_skinning_palette(skeleton, pose, palette);
+
+	// root at (1, 0, 0) rotated 90 degrees, children continue along +y
+	CHECK(near(palette[0].rows[0].w, 1.0f));
+	CHECK(near(palette[0].rows[1].w, 0.0f));
+	CHECK(near(palette[1].rows[0].w, 1.0f));
+	CHECK(near(palette[1].rows[1].w, 1.0f));
+	CHECK(near(palette[2].rows[0].w, 1.0f));
+	CHECK(near(palette[2].rows[1].w, 2.0f));
+
+	// the scale of the last joint does not reach its parent
+	CHECK(near(palette[1].rows[1].x, 1.0f));
+	CHECK(near(palette[2].rows[1].x, 2.0f));
+
+	// the inverse bind matrix is applied last
+	joint_matrix_t shifted_bind[3]{ IDENTITY, IDENTITY, IDENTITY };
+	shifted_bind[2].rows[2].w = -1.0f;
+
+	const skeleton_t shifted{ 3, parents, shifted_bind };
+	compute_skinning_palette(shifted, pose, palette);
+
+	CHECK(near(palette[2].rows[2].w, -2.0f));
+}
+
+TEST_CASE("Animations update on the job system")
+{
+	init_job_system(2);
+
+	joint_transform_t transforms[2]
+	{
+		{ axis_angle(1, 0, 0, 0.0f), { 0, 0, 0 }, 1.0f },
+		{ axis_angle(1, 0, 0, 0.0f), { 0, 0, 8 }, 1.0f }
+	};
+
+	joint_key_t      keys[2];
+	animation_clip_t clip;
+	compress_animation(transforms, 1, 2, 1.0f, keys, clip);
+
+	const uint16_t   parents[1]{ NO_PARENT };
+	const skeleton_t skeleton{ 1, parents, &IDENTITY };
+
+	constexpr uint32_t INSTANCE_COUNT{ 100 };
+
+	static animation_instance_t instances[INSTANCE_COUNT];
+	static joint_matrix_t       palettes[INSTANCE_COUNT];
+
+	for (uint32_t i = 0; i < INSTANCE_COUNT; ++i)
+	{
+		instances[i] = { &skeleton, { &clip, nullptr }, { (float)(i % 8) / 8.0f, 0.0f }, 0.0f, &palettes[i] };
+	}
+
+	update_animations(instances, INSTANCE_COUNT);
+
+	for (uint32_t i = 0; i < INSTANCE_COUNT; ++i)
+	{
+		CHECK(near(palettes[i].rows[2].w, (float)(i % 8)));
+	}
+
+	destroy_job_system();
+}
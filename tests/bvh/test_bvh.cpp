@@ -0,0 +1,260 @@
+#include <catch2/catch_test_macros.hpp>
+#include "olivia/graphics/bvh.h"
+#include "olivia/platform/sdl3_jobs.h"
+
+#include <math.h>
+
+using namespace olivia;
+
+constexpr uint32_t INSTANCE_COUNT{ 5000 };
+
+static uint32_t random_state = 1;
+
+static float random_float(float min, float max)
+{
+	random_state = random_state * 1664525u + 1013904223u;
+	return min + (max - min) * (float)(random_state >> 8) / (float)(1u << 24);
+}
+
+static aabb_t random_box()
+{
+	vec3_t center{ random_float(-100.0f, 100.0f), random_float(-10.0f, 10.0f), random_float(-100.0f, 100.0f) };
+	float  size = random_float(0.1f, 2.0f);
+
+	return { { center.x - size, center.y - size, center.z - size }, { center.x + size, center.y + size, center.z + size } };
+}
+
+// column major, looking down +z from the origin; x and y in [-z, z], depth = 0.1 / z
+static void make_view_projection(float* m)
+{
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		m[i] = 0.0f;
+	}
+
+	m[0]  = 1.0f;
+	m[5]  = 1.0f;
+	m[11] = 1.0f;
+	m[14] = 0.1f;
+}
+
+static bool is_sorted_subset(const uint32_t* visible, uint32_t count, const bool* expected)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (!expected[visible[i]])
+			return false;
+	}
+
+	return true;
+}
+
+TEST_CASE("Bounds")
+{
+	const vec3_t positions[3]{ { 1, 2, 3 }, { -1, 5, 0 }, { 0, 0, 9 } };
+
+	aabb_t aabb = compute_aabb(positions, 3, sizeof(vec3_t));
+	CHECK(aabb.min.x == -1.0f);
+	CHECK(aabb.min.y == 0.0f);
+	CHECK(aabb.max.y == 5.0f);
+	CHECK(aabb.max.z == 9.0f);
+
+	// a quarter turn around y then a translation
+	const float matrix[16]
+	{
+		0, 0, -1, 0,
+		0, 1,  0, 0,
+		1, 0,  0, 0,
+		10, 0, 0, 1
+	};
+
+	aabb_t moved = transform_aabb({ { 0, 0, 0 }, { 2, 1, 1 } }, matrix);
+	CHECK(fabsf(moved.min.x - 10.0f) < 1e-5f);
+	CHECK(fabsf(moved.max.x - 11.0f) < 1e-5f);
+	CHECK(fabsf(moved.min.z + 2.0f) < 1e-5f);
+	CHECK(fabsf(moved.max.z) < 1e-5f);
+}
+
+TEST_CASE("Frustum planes")
+{
+	float view_projection[16];
+	make_view_projection(view_projection);
+
+	frustum_t frustum = make_frustum(view_projection);
+
+	CHECK(is_aabb_visible(frustum, { { -1, -1, 5 }, { 1, 1, 6 } }));
+	CHECK(is_aabb_visible(frustum, { { 4, -1, 5 }, { 6, 1, 6 } }));     // straddles the right plane
+	CHECK(!is_aabb_visible(frustum, { { 7, -1, 5 }, { 8, 1, 6 } }));
+	CHECK(!is_aabb_visible(frustum, { { -1, -1, -6 }, { 1, 1, -5 } }));  // behind
+	CHECK(!is_aabb_visible(frustum, { { -1, -1, 0 }, { 1, 1, 0.05f } })); // before the near plane
+	CHECK(is_aabb_visible(frustum, { { -1, -1, 1e6f }, { 1, 1, 1e6f + 1 } }));
+}
+
+TEST_CASE("Culling matches testing every instance")
+{
+	init_job_system(2);
+
+	static aabb_t   bounds[INSTANCE_COUNT];
+	static bool     expected[INSTANCE_COUNT];
+	static uint32_t visible[2][INSTANCE_COUNT];
+
+	for (uint32_t i = 0; i < INSTANCE_COUNT; ++i)
+	{
+		bounds[i] = random_box();
+	}
+
+	bvh_t bvh{};
+	build_bvh(bvh, bounds, INSTANCE_COUNT);
+
+	float view_projection[16];
+	make_view_projection(view_projection);
+
+	// the second query looks the other way, down -z
+	float behind[16];
+	make_view_projection(behind);
+	behind[0]  = -1.0f;
+	behind[10] = 0.0f;
+	behind[11] = -1.0f;
+
+	bvh_cull_query_t queries[2]{};
+	queries[0] = { make_frustum(view_projection), visible[0], 0 };
+	queries[1] = { make_frustum(behind), visible[1], 0 };
+
+	for (uint32_t round = 0; round < 2; ++round)
+	{
+		cull_bvh(bvh, queries, 2);
+
+		for (uint32_t q = 0; q < 2; ++q)
+		{
+			uint32_t expected_count{};
+			for (uint32_t i = 0; i < INSTANCE_COUNT; ++i)
+			{
+				expected[i]     = is_aabb_visible(queries[q].frustum, bvh.bounds.data[i]);
+				expected_count += expected[i];
+			}
+
+			CHECK(expected_count > 0);
+			CHECK(queries[q].visible_count == expected_count);
+			CHECK(is_sorted_subset(queries[q].visible, queries[q].visible_count, expected));
+		}
+
+		// move a third of the instances and refit instead of rebuilding
+		for (uint32_t i = 0; i < INSTANCE_COUNT; i += 3)
+		{
+			update_bvh_instance(bvh, i, random_box());
+		}
+
+		refit_bvh(bvh);
+		CHECK(bvh.dirty_count == 0);
+	}
+
+	destroy_bvh(bvh);
+	destroy_job_system();
+}
+
+TEST_CASE("Rays hit the closest instance")
+{
+	init_job_system(2);
+
+	static aabb_t bounds[INSTANCE_COUNT];
+	for (uint32_t i = 0; i < INSTANCE_COUNT; ++i)
+	{
+		bounds[i] = random_box();
+	}
+
+	bvh_t bvh{};
+	build_bvh(bvh, bounds, INSTANCE_COUNT);
+
+	constexpr uint32_t RAY_COUNT{ 1000 };
+
+	static ray_t     rays[RAY_COUNT];
+	static ray_hit_t hits[RAY_COUNT];
+
+	for (uint32_t i = 0; i < RAY_COUNT; ++i)
+	{
+		vec3_t direction{ random_float(-1.0f, 1.0f), random_float(-0.1f, 0.1f), random_float(-1.0f, 1.0f) };
+		float  length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+
+		rays[i] = { { random_float(-50.0f, 50.0f), 0.0f, random_float(-50.0f, 50.0f) }, 500.0f, { direction.x / length, direction.y / length, direction.z / length } };
+	}
+
+	intersect_bvh(bvh, rays, RAY_COUNT, hits);
+
+	uint32_t hit_count{};
+
+	for (uint32_t r = 0; r < RAY_COUNT; ++r)
+	{
+		const ray_t& ray = rays[r];
+
+		// brute force slab test against every box
+		float closest = ray.t_max;
+		for (uint32_t i = 0; i < INSTANCE_COUNT; ++i)
+		{
+			float t0 = 0.0f;
+			float t1 = ray.t_max;
+
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				float inverse = 1.0f / (&ray.direction.x)[axis];
+				float a       = ((&bounds[i].min.x)[axis] - (&ray.origin.x)[axis]) * inverse;
+				float b       = ((&bounds[i].max.x)[axis] - (&ray.origin.x)[axis]) * inverse;
+
+				t0 = fmaxf(t0, fminf(a, b));
+				t1 = fminf(t1, fmaxf(a, b));
+			}
+
+			if (t0 <= t1 && t0 < closest)
+			{
+				closest = t0;
+			}
+		}
+
+		if (closest < ray.t_max)
+		{
+			++hit_count;
+
+			REQUIRE(hits[r].instance != BVH_INVALID);
+			CHECK(fabsf(hits[r].t - closest) < 1e-3f);
+		}
+		else
+		{
+			CHECK(hits[r].instance == BVH_INVALID);
+		}
+	}
+
+	CHECK(hit_count > RAY_COUNT / 2);
+
+	destroy_bvh(bvh);
+	destroy_job_system();
+}
+
+TEST_CASE("Empty and tiny trees")
+{
+	bvh_t bvh{};
+	build_bvh(bvh, nullptr, 0);
+
+	float view_projection[16];
+	make_view_projection(view_projection);
+
+	uint32_t         visible[2];
+	bvh_cull_query_t query{ make_frustum(view_projection), visible, 7 };
+
+	cull_bvh(bvh, &query, 1);
+	CHECK(query.visible_count == 0);
+
+	const aabb_t bounds[2]{ { { -1, -1, 4 }, { 1, 1, 5 } }, { { -1, -1, -5 }, { 1, 1, -4 } } };
+	build_bvh(bvh, bounds, 2);
+
+	cull_bvh(bvh, &query, 1);
+	REQUIRE(query.visible_count == 1);
+	CHECK(visible[0] == 0);
+
+	ray_t     ray{ { 0, 0, 0 }, 100.0f, { 0, 0, -1 } };
+	ray_hit_t hit;
+	intersect_bvh(bvh, &ray, 1, &hit);
+
+	CHECK(hit.instance == 1);
+	CHECK(fabsf(hit.t - 4.0f) < 1e-5f);
+
+	destroy_bvh(bvh);
+}
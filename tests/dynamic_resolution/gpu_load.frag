@@ -0,0 +1,23 @@
+#version 450
+
+// a fixed amount of dependent math per pixel, the frame time follows the rendered pixel count
+layout(push_constant) uniform push_t
+{
+	uint iterations;
+} push;
+
+layout(location = 0) in vec2 in_uv;
+
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+	vec2 value = in_uv;
+
+	for (uint i = 0; i < push.iterations; ++i)
+	{
+		value = fract(sin(value.yx * 12.9898 + value) * 43758.5453);
+	}
+
+	out_color = vec4(value, 0.0, 1.0);
+}
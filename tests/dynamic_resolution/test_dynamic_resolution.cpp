@@ -0,0 +1,189 @@
+#include <catch2/catch_test_macros.hpp>
+#include "olivia/graphics/dynamic_resolution.h"
+
+#include <math.h>
+
+using namespace olivia;
+
+// frames in flight: the timings read at the start of a frame are of the one rendered this many frames earlier
+constexpr uint32_t LATENCY{ 2 };
+
+// a gpu whose frame time is fixed_ms plus full_ms at full resolution scaled by the pixel count
+struct simulated_gpu_t
+{
+	float    fixed_ms;
+	float    full_ms;
+	float    noise;     // relative, uniform in [-noise, noise]
+	uint32_t random_state;
+
+	float    scales[LATENCY];
+	float    times[LATENCY];
+	uint32_t frame;
+};
+
+static float random_signed(simulated_gpu_t& gpu)
+{
+	gpu.random_state = gpu.random_state * 1664525u + 1013904223u;
+	return (float)(gpu.random_state >> 8) / (float)(1u << 23) - 1.0f;
+}
+
+// renders one frame at the controller's scale and feeds it the frame LATENCY frames back, returns
+// the time of the frame that was just rendered
+static float run_frame(simulated_gpu_t& gpu, dynamic_resolution_t& controller)
+{
+	const uint32_t slot = gpu.frame % LATENCY;
+
+	if (gpu.frame >= LATENCY)
+	{
+		update_dynamic_resolution(controller, gpu.times[slot], gpu.scales[slot]);
+	}
+
+	const float scale = controller.scale;
+	const float time  = (gpu.fixed_ms + gpu.full_ms * scale * scale) * (1.0f + gpu.noise * random_signed(gpu));
+
+	gpu.scales[slot] = scale;
+	gpu.times[slot]  = time;
+	gpu.frame++;
+
+	return time;
+}
+
+TEST_CASE("Dynamic resolution converges on the target frame time")
+{
+	simulated_gpu_t      gpu{ 1.0f, 20.0f, 0.0f, 1 };
+	dynamic_resolution_t controller = create_dynamic_resolution(10.0f, 0.25f, 1.0f);
+
+	float time{};
+	for (uint32_t frame = 0; frame < 60; ++frame)
+	{
+		time = run_frame(gpu, controller);
+	}
+
+	// 1 + 20 * s^2 = 10
+	REQUIRE(fabsf(time - 10.0f) < 0.5f);
+	REQUIRE(fabsf(controller.scale - sqrtf(9.0f / 20.0f)) < 0.03f);
+
+	// and stays there, the deadband keeps it from resizing every frame
+	const float settled = controller.scale;
+	for (uint32_t frame = 0; frame < 60; ++frame)
+	{
+		run_frame(gpu, controller);
+	}
+
+	REQUIRE(controller.scale == settled);
+}
+
+TEST_CASE("Dynamic resolution stays inside its range")
+{
+	SECTION("a light load renders at full resolution")
+	{
+		simulated_gpu_t      gpu{ 0.5f, 5.0f, 0.0f, 1 };
+		dynamic_resolution_t controller = create_dynamic_resolution(16.0f, 0.5f, 1.0f);
+
+		for (uint32_t frame = 0; frame < 30; ++frame)
+		{
+			run_frame(gpu, controller);
+		}
+
+		REQUIRE(controller.scale == 1.0f);
+	}
+
+	SECTION("a load the target cannot hold bottoms out at the minimum")
+	{
+		simulated_gpu_t      gpu{ 0.5f, 200.0f, 0.0f, 1 };
+		dynamic_resolution_t controller = create_dynamic_resolution(10.0f, 0.5f, 1.0f);
+
+		for (uint32_t frame = 0; frame < 30; ++frame)
+		{
+			run_frame(gpu, controller);
+		}
+
+		REQUIRE(controller.scale == 0.5f);
+	}
+}
+
+TEST_CASE("Dynamic resolution follows a load change")
+{
+	simulated_gpu_t      gpu{ 1.0f, 20.0f, 0.0f, 1 };
+	dynamic_resolution_t controller = create_dynamic_resolution(10.0f, 0.25f, 1.0f);
+
+	for (uint32_t frame = 0; frame < 60; ++frame)
+	{
+		run_frame(gpu, controller);
+	}
+
+	// twice the work per pixel: over budget for no more than a handful of frames
+	gpu.full_ms = 40.0f;
+
+	uint32_t over_budget{};
+	float    time{};
+
+	for (uint32_t frame = 0; frame < 60; ++frame)
+	{
+		time = run_frame(gpu, controller);
+		over_budget += time > 10.5f;
+	}
+
+	REQUIRE(over_budget <= 6);
+	REQUIRE(fabsf(time - 10.0f) < 0.5f);
+
+	// and back, the resolution recovers
+	gpu.full_ms = 20.0f;
+
+	for (uint32_t frame = 0; frame < 120; ++frame)
+	{
+		time = run_frame(gpu, controller);
+	}
+
+	REQUIRE(fabsf(time - 10.0f) < 0.5f);
+	REQUIRE(fabsf(controller.scale - sqrtf(9.0f / 20.0f)) < 0.03f);
+}
+
+TEST_CASE("Dynamic resolution holds the target under noisy timings")
+{
+	simulated_gpu_t      gpu{ 1.0f, 20.0f, 0.1f, 7 };
+	dynamic_resolution_t controller = create_dynamic_resolution(10.0f, 0.25f, 1.0f);
+
+	for (uint32_t frame = 0; frame < 60; ++frame)
+	{
+		run_frame(gpu, controller);
+	}
+
+	float    sum{};
+	float    min_scale{ 1.0f };
+	float    max_scale{ 0.0f };
+	uint32_t frames{ 600 };
+
+	for (uint32_t frame = 0; frame < frames; ++frame)
+	{
+		sum += run_frame(gpu, controller);
+
+		min_scale = fminf(min_scale, controller.scale);
+		max_scale = fmaxf(max_scale, controller.scale);
+	}
+
+	// faster reaction to rises keeps the average a little under the target, never over it by much
+	const float average = sum / (float)frames;
+
+	REQUIRE(average < 10.3f);
+	REQUIRE(average > 8.5f);
+	REQUIRE(max_scale - min_scale < 0.15f);
+}
+
+TEST_CASE("Scaled extents round and never reach zero")
+{
+	uint32_t width{};
+	uint32_t height{};
+
+	scale_extent(1920, 1080, 1.0f, width, height);
+	REQUIRE((width == 1920 && height == 1080));
+
+	scale_extent(1920, 1080, 0.5f, width, height);
+	REQUIRE((width == 960 && height == 540));
+
+	scale_extent(1280, 720, 0.7071f, width, height);
+	REQUIRE((width == 905 && height == 509));
+
+	scale_extent(3, 1, 0.1f, width, height);
+	REQUIRE((width == 1 && height == 1));
+}
@@ -0,0 +1,345 @@
+#include <catch2/catch_test_macros.hpp>
+#include "olivia/olivia_graphics.h"
+#include "olivia/olivia_platform.h"
+
+#include <math.h>
+
+// the renderer on SDL's offscreen driver with a fullscreen triangle whose fragment cost is
+// tuned until the full resolution frame is slow, then the controller gets half of that as
+// its target and has to find the resolution that holds it. pick the device with OLIVIA_GPU,
+// e.g. OLIVIA_GPU=llvmpipe
+
+constexpr float    LOAD_MIN_MS{ 20.0f };       // the scaled load has to dwarf the upscale pass
+constexpr uint32_t MAX_LOAD_ITERATIONS{ 1u << 20 };
+constexpr uint32_t SETTLE_FRAMES{ olivia::MAX_FRAMES + 2 };
+constexpr uint32_t MEASURE_FRAMES{ 16 };
+constexpr uint32_t CONVERGE_FRAMES{ 150 };
+constexpr uint32_t STABLE_FRAMES{ 30 };        // the tail the checks look at
+constexpr float    TARGET_FRACTION{ 0.5f };
+constexpr float    TARGET_TOLERANCE{ 0.15f };
+
+struct gpu_load_t
+{
+	olivia::shader_t vertex;
+	olivia::shader_t fragment;
+	VkPipelineLayout pipeline_layout;
+	VkPipeline       pipeline;
+	uint32_t         iterations;
+};
+
+static gpu_load_t gpu_load{};
+
+// init_vulkan_core aborts without a device, so look before handing the window to it
+static bool has_vulkan_device()
+{
+	Uint32 extension_count{};
+	const char* const* extensions = SDL_Vulkan_GetInstanceExtensions(&extension_count);
+	if (!extensions)
+		return false;
+
+	VkApplicationInfo app_info
+	{
+		.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+		.apiVersion = VK_API_VERSION_1_3
+	};
+
+	VkInstanceCreateInfo instance_info
+	{
+		.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+		.pApplicationInfo = &app_info,
+		.enabledExtensionCount = extension_count,
+		.ppEnabledExtensionNames = extensions
+	};
+
+	VkInstance instance{};
+	if (vkCreateInstance(&instance_info, nullptr, &instance) != VK_SUCCESS)
+		return false;
+
+	uint32_t gpu_count{};
+	vkEnumeratePhysicalDevices(instance, &gpu_count, nullptr);
+	vkDestroyInstance(instance, nullptr);
+
+	return gpu_count > 0;
+}
+
+static void create_gpu_load()
+{
+	REQUIRE(olivia::load_shader("gpu_load.vert.spv", gpu_load.vertex));
+	REQUIRE(olivia::load_shader("gpu_load.frag.spv", gpu_load.fragment));
+
+	olivia::shader_reflection_t layout{};
+	olivia::merge_shader_reflection(layout, gpu_load.vertex.reflection);
+	olivia::merge_shader_reflection(layout, gpu_load.fragment.reflection);
+
+	gpu_load.pipeline_layout = olivia::create_reflected_pipeline_layout(layout, nullptr, 0);
+
+	VkPipelineShaderStageCreateInfo stages[]
+	{
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_VERTEX_BIT,
+			.module = gpu_load.vertex.module,
+			.pName = "main"
+		},
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+			.module = gpu_load.fragment.module,
+			.pName = "main"
+		}
+	};
+
+	VkPipelineVertexInputStateCreateInfo vertex_input
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO
+	};
+
+	VkPipelineInputAssemblyStateCreateInfo input_assembly
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
+	};
+
+	VkPipelineViewportStateCreateInfo viewport
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+		.viewportCount = 1,
+		.scissorCount = 1
+	};
+
+	VkPipelineRasterizationStateCreateInfo rasterization
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+		.polygonMode = VK_POLYGON_MODE_FILL,
+		.cullMode = VK_CULL_MODE_NONE,
+		.lineWidth = 1.0f
+	};
+
+	VkPipelineMultisampleStateCreateInfo multisample
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+		.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+	};
+
+	VkPipelineDepthStencilStateCreateInfo depth_stencil
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
+	};
+
+	VkPipelineColorBlendAttachmentState blend_attachment
+	{
+		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+	};
+
+	VkPipelineColorBlendStateCreateInfo blend
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+		.attachmentCount = 1,
+		.pAttachments = &blend_attachment
+	};
+
+	// begin_pass sets the depth state
+	VkDynamicState dynamic_states[]
+	{
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR,
+		VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+		VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+		VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamic
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+		.dynamicStateCount = ARRAY_SIZE(dynamic_states),
+		.pDynamicStates = dynamic_states
+	};
+
+	VkPipelineRenderingCreateInfo rendering
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+		.colorAttachmentCount = 1,
+		.pColorAttachmentFormats = &olivia::g_vulkan_core.swapchain_format.format,
+		.depthAttachmentFormat = olivia::g_vulkan_core.depth_format
+	};
+
+	VkGraphicsPipelineCreateInfo pipeline_info
+	{
+		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.pNext = &rendering,
+		.stageCount = ARRAY_SIZE(stages),
+		.pStages = stages,
+		.pVertexInputState = &vertex_input,
+		.pInputAssemblyState = &input_assembly,
+		.pViewportState = &viewport,
+		.pRasterizationState = &rasterization,
+		.pMultisampleState = &multisample,
+		.pDepthStencilState = &depth_stencil,
+		.pColorBlendState = &blend,
+		.pDynamicState = &dynamic,
+		.layout = gpu_load.pipeline_layout
+	};
+
+	VK_CHECK(vkCreateGraphicsPipelines(olivia::g_vulkan_core.device, olivia::g_vulkan_core.pipeline_cache, 1, &pipeline_info, nullptr, &gpu_load.pipeline));
+}
+
+static void destroy_gpu_load()
+{
+	vkDestroyPipeline(olivia::g_vulkan_core.device, gpu_load.pipeline, nullptr);
+	vkDestroyPipelineLayout(olivia::g_vulkan_core.device, gpu_load.pipeline_layout, nullptr);
+
+	olivia::destroy_shader(gpu_load.fragment);
+	olivia::destroy_shader(gpu_load.vertex);
+
+	gpu_load = {};
+}
+
+static void draw_gpu_load()
+{
+	if (olivia::g_vulkan_core.current_pass != olivia::RENDER_PASS_MAIN)
+		return;
+
+	VkCommandBuffer cmd = olivia::g_vulkan_core.command_buffers[olivia::g_vulkan_core.current_frame];
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, gpu_load.pipeline);
+	vkCmdPushConstants(cmd, gpu_load.pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &gpu_load.iterations);
+	vkCmdDraw(cmd, 3, 1, 0, 0);
+}
+
+// returns the gpu frame time the last frame's begin_frame read, of a frame MAX_FRAMES back
+static float run_frame()
+{
+	SDL_Event event;
+	while (SDL_PollEvent(&event)) {}
+
+	while (!olivia::begin_frame()) {}
+
+	const float gpu_ms = olivia::get_gpu_frame_time();
+
+	olivia::draw_frame(draw_gpu_load);
+	olivia::end_frame();
+
+	return gpu_ms;
+}
+
+// mean gpu frame time once the frames in flight caught up with a change
+static float measure_frames()
+{
+	for (uint32_t frame = 0; frame < SETTLE_FRAMES; ++frame)
+	{
+		run_frame();
+	}
+
+	float sum{};
+	for (uint32_t frame = 0; frame < MEASURE_FRAMES; ++frame)
+	{
+		sum += run_frame();
+	}
+
+	return sum / (float)MEASURE_FRAMES;
+}
+
+TEST_CASE("Dynamic resolution holds a frame time target under gpu load")
+{
+	SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+	REQUIRE(SDL_Init(SDL_INIT_VIDEO));
+
+	SDL_Window* window = SDL_CreateWindow("test_dynamic_resolution", 1280, 720, SDL_WINDOW_VULKAN);
+
+	if (!window || !has_vulkan_device())
+	{
+		if (window)
+			SDL_DestroyWindow(window);
+
+		SDL_Quit();
+		SKIP("no vulkan device behind the offscreen video driver");
+	}
+
+	olivia::init_job_system(0);
+	olivia::init_renderer(window);
+	olivia::set_vsync(false);
+	olivia::set_depth_prepass(false);
+
+	const bool timestamps = olivia::g_vulkan_core.timestamp_pool != VK_NULL_HANDLE;
+
+	uint32_t iterations{};
+	float    full_ms{};
+	float    target_ms{};
+	float    frame_ms[STABLE_FRAMES]{};
+	float    scales[STABLE_FRAMES]{};
+
+	if (timestamps)
+	{
+		create_gpu_load();
+
+		olivia::set_upscale_filter(olivia::UPSCALE_FILTER_BILINEAR);
+		olivia::set_dynamic_resolution(true);
+		REQUIRE(olivia::is_dynamic_resolution_enabled());
+
+		// full resolution, upscale pass included, until the load is heavy enough
+		olivia::set_fixed_render_scale(1.0f);
+
+		for (gpu_load.iterations = 16; ; gpu_load.iterations *= 2)
+		{
+			full_ms = measure_frames();
+
+			if (full_ms >= LOAD_MIN_MS || gpu_load.iterations >= MAX_LOAD_ITERATIONS)
+				break;
+		}
+
+		iterations = gpu_load.iterations;
+		target_ms  = full_ms * TARGET_FRACTION;
+
+		olivia::set_dynamic_resolution_target(target_ms, 0.25f, 1.0f);
+		olivia::set_fixed_render_scale(0.0f);
+
+		for (uint32_t frame = 0; frame < CONVERGE_FRAMES; ++frame)
+		{
+			const float gpu_ms = run_frame();
+
+			if (frame >= CONVERGE_FRAMES - STABLE_FRAMES)
+			{
+				frame_ms[frame - (CONVERGE_FRAMES - STABLE_FRAMES)] = gpu_ms;
+				scales[frame - (CONVERGE_FRAMES - STABLE_FRAMES)]   = olivia::get_render_scale();
+			}
+		}
+
+		olivia::wait_timeline_value(olivia::g_vulkan_core.timeline_value);
+
+		olivia::set_dynamic_resolution(false);
+		destroy_gpu_load();
+	}
+
+	vkDeviceWaitIdle(olivia::g_vulkan_core.device);
+
+	olivia::destroy_renderer();
+	olivia::destroy_job_system();
+
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+
+	if (!timestamps)
+		SKIP("the device has no timestamp queries");
+
+	float mean_ms{};
+	float min_scale{ 1.0f };
+	float max_scale{ 0.0f };
+
+	for (uint32_t i = 0; i < STABLE_FRAMES; ++i)
+	{
+		mean_ms  += frame_ms[i] / (float)STABLE_FRAMES;
+		min_scale = fminf(min_scale, scales[i]);
+		max_scale = fmaxf(max_scale, scales[i]);
+	}
+
+	INFO("load " << iterations << " iterations, full resolution " << full_ms << " ms, target " << target_ms
+		<< " ms, converged to " << mean_ms << " ms at scale " << min_scale << " - " << max_scale);
+
+	REQUIRE(full_ms >= LOAD_MIN_MS);
+	REQUIRE(fabsf(mean_ms - target_ms) <= target_ms * TARGET_TOLERANCE);
+
+	// inside the range, not pinned to an end, and settled rather than oscillating
+	REQUIRE(max_scale < 1.0f);
+	REQUIRE(min_scale > 0.25f);
+	REQUIRE(max_scale - min_scale < 0.1f);
+}
@@ -0,0 +1,248 @@
+#include <catch2/catch_test_macros.hpp>
+#include "olivia/core/hash_map.h"
+#include "olivia/core/string_interner.h"
+
+#include <string>
+#include <unordered_map>
+
+using namespace olivia;
+
+static uint64_t random_state = 1;
+
+static uint64_t random_u64()
+{
+	uint64_t z = (random_state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+template<typename _Kty, typename _Ty>
+static size_t count_full_slots(const hash_map_t<_Kty, _Ty>& map)
+{
+	size_t count = 0;
+	for (size_t i = hash_map_next(map, 0); i < map.capacity; i = hash_map_next(map, i + 1))
+	{
+		++count;
+	}
+
+	return count;
+}
+
+TEST_CASE("Hash map matches std::unordered_map under random operations")
+{
+	auto map = create_hash_map<uint32_t, uint64_t>(0);
+
+	std::unordered_map<uint32_t, uint64_t> reference;
+
+	// a small key range so inserts, overwrites and erases of present keys all happen often
+	for (uint32_t i = 0; i < 200000; ++i)
+	{
+		uint32_t key   = (uint32_t)(random_u64() % 4096);
+		uint64_t value = random_u64();
+
+		switch (random_u64() % 3)
+		{
+		case 0:
+			hash_map_insert(map, key, value);
+			reference[key] = value;
+			break;
+		case 1:
+			REQUIRE(hash_map_erase(map, key) == (reference.erase(key) == 1));
+			break;
+		case 2:
+		{
+			uint64_t* found = hash_map_find(map, key);
+			auto      it    = reference.find(key);
+
+			REQUIRE((found != nullptr) == (it != reference.end()));
+			if (found)
+				REQUIRE(*found == it->second);
+			break;
+		}
+		}
+
+		REQUIRE(map.size == reference.size());
+	}
+
+	REQUIRE(count_full_slots(map) == reference.size());
+
+	for (const auto& [key, value] : reference)
+	{
+		uint64_t* found = hash_map_find(map, key);
+
+		REQUIRE(found);
+		REQUIRE(*found == value);
+	}
+
+	destroy_hash_map(map);
+}
+
+TEST_CASE("Hash map grows and iterates every entry once")
+{
+	constexpr uint32_t COUNT{ 100000 };
+
+	auto map = create_hash_map<uint64_t, uint32_t>(16);
+
+	for (uint32_t i = 0; i < COUNT; ++i)
+	{
+		hash_map_insert(map, (uint64_t)i * 0x100000000ull, i);
+	}
+
+	REQUIRE(map.size == COUNT);
+	REQUIRE(map.size <= hash_map_max_load(map.capacity));
+
+	auto seen = create_vector<uint8_t>(COUNT);
+
+	for (size_t i = hash_map_next(map, 0); i < map.capacity; i = hash_map_next(map, i + 1))
+	{
+		uint32_t value = map.slots[i].value;
+
+		REQUIRE(map.slots[i].key == (uint64_t)value * 0x100000000ull);
+		REQUIRE(seen.data[value] == 0);
+		seen.data[value] = 1;
+	}
+
+	for (uint32_t i = 0; i < COUNT; ++i)
+	{
+		REQUIRE(seen.data[i] == 1);
+	}
+
+	hash_map_clear(map);
+
+	REQUIRE(map.size == 0);
+	REQUIRE(hash_map_find(map, 0) == nullptr);
+	REQUIRE(hash_map_next(map, 0) == map.capacity);
+
+	destroy_vector(seen);
+	destroy_hash_map(map);
+}
+
+TEST_CASE("Hash map tombstones do not grow the table")
+{
+	auto map = create_hash_map<uint32_t, uint32_t>(1000);
+
+	const size_t capacity = map.capacity;
+
+	// a sliding window of live keys, every insert is a key never seen before
+	for (uint32_t i = 0; i < 1000000; ++i)
+	{
+		hash_map_insert(map, i, i);
+		if (i >= 1000)
+			REQUIRE(hash_map_erase(map, i - 1000));
+	}
+
+	REQUIRE(map.size == 1000);
+	REQUIRE(map.capacity == capacity);
+
+	for (uint32_t i = 1000000 - 1000; i < 1000000; ++i)
+	{
+		REQUIRE(hash_map_find(map, i));
+	}
+
+	REQUIRE_FALSE(hash_map_erase(map, 0));
+
+	destroy_hash_map(map);
+}
+
+TEST_CASE("Hash map reserve keeps entries")
+{
+	auto map = create_hash_map<uint32_t, uint32_t>(4);
+
+	for (uint32_t i = 0; i < 10; ++i)
+	{
+		hash_map_insert(map, i, i * 3);
+	}
+
+	hash_map_reserve(map, 100000);
+
+	REQUIRE(hash_map_max_load(map.capacity) >= 100000);
+	REQUIRE(map.size == 10);
+
+	size_t capacity = map.capacity;
+	for (uint32_t i = 10; i < 100000; ++i)
+	{
+		hash_map_insert(map, i, i * 3);
+	}
+
+	REQUIRE(map.capacity == capacity);
+
+	for (uint32_t i = 0; i < 100000; ++i)
+	{
+		REQUIRE(*hash_map_find(map, i) == i * 3);
+	}
+
+	destroy_hash_map(map);
+}
+
+TEST_CASE("Hash map struct keys compare by bytes")
+{
+	struct cell_t
+	{
+		int32_t x;
+		int32_t y;
+		int32_t z;
+	};
+
+	auto map = create_hash_map<cell_t, uint32_t>(64);
+
+	for (int32_t i = 0; i < 1000; ++i)
+	{
+		hash_map_insert(map, cell_t{ i, -i, i * 7 }, (uint32_t)i);
+	}
+
+	for (int32_t i = 0; i < 1000; ++i)
+	{
+		uint32_t* found = hash_map_find(map, cell_t{ i, -i, i * 7 });
+
+		REQUIRE(found);
+		REQUIRE(*found == (uint32_t)i);
+	}
+
+	REQUIRE(hash_map_find(map, cell_t{ 1, 1, 7 }) == nullptr);
+
+	destroy_hash_map(map);
+}
+
+TEST_CASE("String interner returns dense stable ids")
+{
+	auto interner = create_string_interner(4);
+
+	REQUIRE(find_string_id(interner, "albedo") == INVALID_STRING_ID);
+
+	string_id_t albedo = intern_string(interner, "albedo");
+	string_id_t normal = intern_string(interner, "normal");
+	string_id_t empty  = intern_string(interner, "");
+
+	REQUIRE(albedo == 0);
+	REQUIRE(normal == 1);
+	REQUIRE(empty == 2);
+
+	REQUIRE(intern_string(interner, "albedo") == albedo);
+	REQUIRE(find_string_id(interner, "normal") == normal);
+	REQUIRE(find_string_id(interner, "") == empty);
+
+	// a prefix is a different string
+	REQUIRE(find_string_id(interner, "albedo", 3) == INVALID_STRING_ID);
+	REQUIRE(intern_string(interner, "albedo", 3) == 3);
+
+	// ids and contents survive growth of every table
+	for (uint32_t i = 0; i < 20000; ++i)
+	{
+		std::string name = "entity_" + std::to_string(i);
+		REQUIRE(intern_string(interner, name.c_str()) == i + 4);
+	}
+
+	for (uint32_t i = 0; i < 20000; ++i)
+	{
+		std::string name = "entity_" + std::to_string(i);
+
+		REQUIRE(find_string_id(interner, name.c_str()) == i + 4);
+		REQUIRE(name == get_interned_string(interner, i + 4));
+	}
+
+	REQUIRE(std::string(get_interned_string(interner, albedo)) == "albedo");
+	REQUIRE(std::string(get_interned_string(interner, 3)) == "alb");
+
+	destroy_string_interner(interner);
+}
@@ -0,0 +1,250 @@
+#include <catch2/catch_test_macros.hpp>
+#include "olivia/graphics/mesh_simplify.h"
+#include "olivia/core/vector.h"
+
+#include <math.h>
+
+using namespace olivia;
+
+constexpr uint32_t GRID_SIZE{ 33 };
+constexpr uint32_t CUBE_SIZE{ 16 };
+
+struct test_mesh_t
+{
+	vector_t<vec3_t>   positions;
+	vector_t<uint32_t> indices;
+};
+
+static void push_quad(test_mesh_t& mesh, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	vector_push_back(mesh.indices, a);
+	vector_push_back(mesh.indices, b);
+	vector_push_back(mesh.indices, c);
+	vector_push_back(mesh.indices, c);
+	vector_push_back(mesh.indices, b);
+	vector_push_back(mesh.indices, d);
+}
+
+// a GRID_SIZE x GRID_SIZE vertex plane at y = 0, open on all four sides
+static test_mesh_t create_plane()
+{
+	test_mesh_t mesh{ create_vector<vec3_t>(GRID_SIZE * GRID_SIZE), create_vector<uint32_t>(GRID_SIZE * GRID_SIZE * 6) };
+
+	for (uint32_t z = 0; z < GRID_SIZE; ++z)
+	{
+		for (uint32_t x = 0; x < GRID_SIZE; ++x)
+		{
+			vector_push_back(mesh.positions, { (float)x, 0.0f, (float)z });
+		}
+	}
+
+	for (uint32_t z = 0; z + 1 < GRID_SIZE; ++z)
+	{
+		for (uint32_t x = 0; x + 1 < GRID_SIZE; ++x)
+		{
+			uint32_t i = z * GRID_SIZE + x;
+			push_quad(mesh, i, i + GRID_SIZE, i + 1, i + GRID_SIZE + 1);
+		}
+	}
+
+	return mesh;
+}
+
+// a subdivided cube pushed out onto the unit sphere, closed and welded
+static test_mesh_t create_sphere()
+{
+	constexpr uint32_t N{ CUBE_SIZE + 1 };
+
+	test_mesh_t mesh{ create_vector<vec3_t>(N * N * 6), create_vector<uint32_t>(N * N * 36) };
+
+	// surface lattice points of the cube get a vertex, the rest stay UINT32_MAX
+	uint32_t* lattice = (uint32_t*)malloc(N * N * N * sizeof(uint32_t));
+
+	for (uint32_t z = 0; z < N; ++z)
+	{
+		for (uint32_t y = 0; y < N; ++y)
+		{
+			for (uint32_t x = 0; x < N; ++x)
+			{
+				uint32_t& vertex = lattice[(z * N + y) * N + x];
+				vertex = UINT32_MAX;
+
+				if (x != 0 && y != 0 && z != 0 && x != CUBE_SIZE && y != CUBE_SIZE && z != CUBE_SIZE)
+					continue;
+
+				vec3_t p{ (float)x / CUBE_SIZE * 2.0f - 1.0f, (float)y / CUBE_SIZE * 2.0f - 1.0f, (float)z / CUBE_SIZE * 2.0f - 1.0f };
+				float  length = sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+
+				vertex = (uint32_t)mesh.positions.size;
+				vector_push_back(mesh.positions, { p.x / length, p.y / length, p.z / length });
+			}
+		}
+	}
+
+	auto at = [&](uint32_t axis, uint32_t side, uint32_t u, uint32_t v)
+	{
+		uint32_t c[3];
+		c[axis]           = side;
+		c[(axis + 1) % 3] = u;
+		c[(axis + 2) % 3] = v;
+
+		return lattice[(c[2] * N + c[1]) * N + c[0]];
+	};
+
+	for (uint32_t axis = 0; axis < 3; ++axis)
+	{
+		for (uint32_t side : { 0u, CUBE_SIZE })
+		{
+			for (uint32_t v = 0; v < CUBE_SIZE; ++v)
+			{
+				for (uint32_t u = 0; u < CUBE_SIZE; ++u)
+				{
+					push_quad(mesh, at(axis, side, u, v), at(axis, side, u + 1, v), at(axis, side, u, v + 1), at(axis, side, u + 1, v + 1));
+				}
+			}
+		}
+	}
+
+	free(lattice);
+
+	return mesh;
+}
+
+static void destroy_mesh(test_mesh_t& mesh)
+{
+	destroy_vector(mesh.indices);
+	destroy_vector(mesh.positions);
+}
+
+static bool has_degenerate_triangles(const uint32_t* indices, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i += 3)
+	{
+		if (indices[i] == indices[i + 1] || indices[i + 1] == indices[i + 2] || indices[i + 2] == indices[i])
+			return true;
+	}
+
+	return false;
+}
+
+TEST_CASE("Simplify a flat plane")
+{
+	test_mesh_t mesh = create_plane();
+
+	const uint32_t index_count = (uint32_t)mesh.indices.size;
+	uint32_t*      destination = (uint32_t*)malloc(index_count * sizeof(uint32_t));
+
+	float    error{};
+	uint32_t count = simplify_mesh(mesh.positions.data, (uint32_t)mesh.positions.size, sizeof(vec3_t), mesh.indices.data, index_count, 0, 1.0f, destination, error);
+
+	// the interior collapses for free, the border ring stays
+	CHECK(count < index_count / 4);
+	CHECK(count % 3 == 0);
+	CHECK(error < 1e-4f);
+	CHECK_FALSE(has_degenerate_triangles(destination, count));
+
+	bool* used = (bool*)calloc(mesh.positions.size, sizeof(bool));
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		used[destination[i]] = true;
+	}
+
+	bool border_kept = true;
+	for (uint32_t i = 0; i < GRID_SIZE; ++i)
+	{
+		border_kept &= used[i] && used[(GRID_SIZE - 1) * GRID_SIZE + i] && used[i * GRID_SIZE] && used[i * GRID_SIZE + GRID_SIZE - 1];
+	}
+
+	CHECK(border_kept);
+
+	free(used);
+	free(destination);
+	destroy_mesh(mesh);
+}
+
+TEST_CASE("Simplify a sphere to a target")
+{
+	test_mesh_t mesh = create_sphere();
+
+	const uint32_t index_count = (uint32_t)mesh.indices.size;
+	uint32_t*      destination = (uint32_t*)malloc(index_count * sizeof(uint32_t));
+
+	SECTION("reaches the target")
+	{
+		float    error{};
+		uint32_t count = simplify_mesh(mesh.positions.data, (uint32_t)mesh.positions.size, sizeof(vec3_t), mesh.indices.data, index_count, index_count / 4, 1.0f, destination, error);
+
+		CHECK(count <= index_count / 4);
+		CHECK(count > index_count / 8);
+		CHECK(error > 0.0f);
+		CHECK(error < 0.1f);
+		CHECK_FALSE(has_degenerate_triangles(destination, count));
+	}
+
+	SECTION("stops at the error bound")
+	{
+		float    error{};
+		uint32_t count = simplify_mesh(mesh.positions.data, (uint32_t)mesh.positions.size, sizeof(vec3_t), mesh.indices.data, index_count, 0, 0.01f, destination, error);
+
+		CHECK(count < index_count);
+		CHECK(count > index_count / 8);
+		CHECK(error <= 0.01f);
+	}
+
+	free(destination);
+	destroy_mesh(mesh);
+}
+
+TEST_CASE("LOD chain")
+{
+	test_mesh_t mesh = create_sphere();
+
+	const uint32_t index_count = (uint32_t)mesh.indices.size;
+	uint32_t*      destination = (uint32_t*)malloc(MAX_MESH_LODS * index_count * sizeof(uint32_t));
+
+	mesh_lod_t lods[MAX_MESH_LODS];
+	uint32_t   lod_count = generate_mesh_lods(mesh.positions.data, (uint32_t)mesh.positions.size, sizeof(vec3_t), mesh.indices.data, index_count, 1.0f, destination, lods);
+
+	REQUIRE(lod_count == MAX_MESH_LODS);
+	CHECK(lods[0].first_index == 0);
+	CHECK(lods[0].index_count == index_count);
+	CHECK(lods[0].error == 0.0f);
+
+	for (uint32_t i = 1; i < lod_count; ++i)
+	{
+		// packed one after the other, each smaller and no more accurate than the last
+		CHECK(lods[i].first_index == lods[i - 1].first_index + lods[i - 1].index_count);
+		CHECK((float)lods[i].index_count <= (float)lods[i - 1].index_count * MESH_LOD_MIN_REDUCTION);
+		CHECK(lods[i].error >= lods[i - 1].error);
+		CHECK_FALSE(has_degenerate_triangles(destination + lods[i].first_index, lods[i].index_count));
+	}
+
+	free(destination);
+	destroy_mesh(mesh);
+}
+
+TEST_CASE("LOD selection")
+{
+	const mesh_lod_t lods[3]{ { 0, 300, 0.0f }, { 300, 150, 0.01f }, { 450, 75, 0.04f } };
+
+	// one pixel per unit at distance 1, so error 0.01 is one pixel at distance 0.01
+	const lod_selection_t selection{ 1.0f, 1.0f, 0.25f };
+
+	CHECK(select_mesh_lod(lods, 3, 1.0f, 0.005f, 0, selection) == 0);
+	CHECK(select_mesh_lod(lods, 3, 1.0f, 0.02f, 0, selection) == 1);
+	CHECK(select_mesh_lod(lods, 3, 1.0f, 1.0f, 0, selection) == 2);
+
+	// scaling an instance up makes its error bigger on screen
+	CHECK(select_mesh_lod(lods, 3, 4.0f, 0.02f, 0, selection) == 0);
+
+	SECTION("hysteresis")
+	{
+		// 0.9 pixels: fine where it is, but not far enough under to go coarser
+		CHECK(select_mesh_lod(lods, 3, 1.0f, 0.01f / 0.9f, 0, selection) == 0);
+		CHECK(select_mesh_lod(lods, 3, 1.0f, 0.01f / 0.9f, 1, selection) == 1);
+
+		// going finer happens as soon as the error shows
+		CHECK(select_mesh_lod(lods, 3, 1.0f, 0.01f / 1.1f, 1, selection) == 0);
+		CHECK(select_mesh_lod(lods, 3, 1.0f, 0.04f / 1.1f, 2, selection) == 1);
+	}
+}
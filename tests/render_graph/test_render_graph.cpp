@@ -0,0 +1,263 @@
+#include <catch2/catch_test_macros.hpp>
+#include "olivia/graphics/render_graph.h"
+
+using namespace olivia;
+
+static void execute_nothing(VkCommandBuffer, void*)
+{
+}
+
+static uint32_t pass_barrier_count(const render_graph_t& graph, graph_pass_t pass)
+{
+	return graph.pass_barriers[pass + 1] - graph.pass_barriers[pass];
+}
+
+static uint32_t final_barrier_count(const render_graph_t& graph)
+{
+	return graph.barrier_count - graph.pass_barriers[graph.pass_count];
+}
+
+static const graph_barrier_t* find_barrier(const render_graph_t& graph, graph_pass_t pass, graph_resource_t resource)
+{
+	for (uint32_t i = graph.pass_barriers[pass]; i < graph.pass_barriers[pass + 1]; ++i)
+	{
+		if (graph.barriers[i].resource == resource)
+			return &graph.barriers[i];
+	}
+
+	return nullptr;
+}
+
+static const graph_barrier_t* find_final_barrier(const render_graph_t& graph, graph_resource_t resource)
+{
+	for (uint32_t i = graph.pass_barriers[graph.pass_count]; i < graph.barrier_count; ++i)
+	{
+		if (graph.barriers[i].resource == resource)
+			return &graph.barriers[i];
+	}
+
+	return nullptr;
+}
+
+constexpr VkPipelineStageFlags2 DEPTH_STAGES{ VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT };
+constexpr VkAccessFlags2        DEPTH_ACCESS{ VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+
+TEST_CASE("Frame graph with a depth pre-pass")
+{
+	static render_graph_t graph{};
+	reset_render_graph(graph);
+
+	graph_resource_t backbuffer = render_graph_import_image(graph, "backbuffer", VK_IMAGE_ASPECT_COLOR_BIT, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE, GRAPH_ACCESS_PRESENT, false);
+	graph_resource_t depth      = render_graph_import_image(graph, "depth", VK_IMAGE_ASPECT_DEPTH_BIT, GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE, GRAPH_ACCESS_NONE, false);
+
+	graph_pass_t prepass = render_graph_add_pass(graph, "depth pre-pass", execute_nothing, nullptr);
+	render_graph_use(graph, prepass, depth, GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE);
+
+	graph_pass_t main_pass = render_graph_add_pass(graph, "main", execute_nothing, nullptr);
+	render_graph_use(graph, main_pass, backbuffer, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+	render_graph_use(graph, main_pass, depth, GRAPH_ACCESS_DEPTH_ATTACHMENT_READ);
+
+	compile_render_graph(graph, nullptr);
+
+	REQUIRE_FALSE(graph.culled[prepass]);
+	REQUIRE_FALSE(graph.culled[main_pass]);
+	REQUIRE(graph.barrier_count == 4);
+
+	// previous frame's depth tests finish before the contents are discarded
+	REQUIRE(pass_barrier_count(graph, prepass) == 1);
+	const graph_barrier_t* depth_write = find_barrier(graph, prepass, depth);
+	REQUIRE(depth_write);
+	CHECK(depth_write->src_stage == DEPTH_STAGES);
+	CHECK(depth_write->src_access == DEPTH_ACCESS);
+	CHECK(depth_write->dst_stage == DEPTH_STAGES);
+	CHECK(depth_write->dst_access == DEPTH_ACCESS);
+	CHECK(depth_write->old_layout == VK_IMAGE_LAYOUT_UNDEFINED);
+	CHECK(depth_write->new_layout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+
+	REQUIRE(pass_barrier_count(graph, main_pass) == 2);
+
+	// the source access is a real access mask and chains with the acquire semaphore wait
+	const graph_barrier_t* color_write = find_barrier(graph, main_pass, backbuffer);
+	REQUIRE(color_write);
+	CHECK(color_write->src_stage == VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+	CHECK(color_write->src_access == VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+	CHECK(color_write->dst_stage == VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+	CHECK(color_write->dst_access == VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+	CHECK(color_write->old_layout == VK_IMAGE_LAYOUT_UNDEFINED);
+	CHECK(color_write->new_layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+	const graph_barrier_t* depth_read = find_barrier(graph, main_pass, depth);
+	REQUIRE(depth_read);
+	CHECK(depth_read->src_stage == DEPTH_STAGES);
+	CHECK(depth_read->src_access == DEPTH_ACCESS);
+	CHECK(depth_read->dst_access == VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT);
+	CHECK(depth_read->old_layout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+	CHECK(depth_read->new_layout == VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL);
+
+	// depth is not used after the frame, only the backbuffer is transitioned
+	REQUIRE(final_barrier_count(graph) == 1);
+	const graph_barrier_t* present = find_final_barrier(graph, backbuffer);
+	REQUIRE(present);
+	CHECK(present->src_stage == VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+	CHECK(present->src_access == VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+	CHECK(present->dst_stage == VK_PIPELINE_STAGE_2_NONE);
+	CHECK(present->dst_access == VK_ACCESS_2_NONE);
+	CHECK(present->old_layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	CHECK(present->new_layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+}
+
+TEST_CASE("Passes whose results are never read are culled")
+{
+	static render_graph_t graph{};
+	reset_render_graph(graph);
+
+	graph_resource_t backbuffer = render_graph_import_image(graph, "backbuffer", VK_IMAGE_ASPECT_COLOR_BIT, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE, GRAPH_ACCESS_PRESENT, false);
+	graph_resource_t shadow     = render_graph_create_image(graph, "shadow", VK_FORMAT_D32_SFLOAT, { 1024, 1024 }, VK_IMAGE_ASPECT_DEPTH_BIT);
+	graph_resource_t counters   = render_graph_create_buffer(graph, "counters", 256);
+
+	graph_pass_t shadow_pass = render_graph_add_pass(graph, "shadow", execute_nothing, nullptr);
+	render_graph_use(graph, shadow_pass, shadow, GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE);
+
+	graph_pass_t debug_pass = render_graph_add_pass(graph, "debug", execute_nothing, nullptr);
+	render_graph_use(graph, debug_pass, counters, GRAPH_ACCESS_STORAGE_WRITE_COMPUTE);
+
+	graph_pass_t main_pass = render_graph_add_pass(graph, "main", execute_nothing, nullptr);
+	render_graph_use(graph, main_pass, backbuffer, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+
+	SECTION("nothing reads the shadow map")
+	{
+		compile_render_graph(graph, nullptr);
+
+		CHECK(graph.culled[shadow_pass]);
+		CHECK(graph.culled[debug_pass]);
+		CHECK_FALSE(graph.culled[main_pass]);
+
+		CHECK(pass_barrier_count(graph, shadow_pass) == 0);
+		CHECK(pass_barrier_count(graph, debug_pass) == 0);
+		CHECK(graph.first_use[shadow] == GRAPH_NOT_USED);
+		CHECK(graph.first_use[counters] == GRAPH_NOT_USED);
+	}
+
+	SECTION("side effects and readers keep passes alive")
+	{
+		render_graph_set_side_effects(graph, debug_pass);
+		render_graph_use(graph, main_pass, shadow, GRAPH_ACCESS_SAMPLED_FRAGMENT);
+
+		compile_render_graph(graph, nullptr);
+
+		CHECK_FALSE(graph.culled[shadow_pass]);
+		CHECK_FALSE(graph.culled[debug_pass]);
+		CHECK_FALSE(graph.culled[main_pass]);
+
+		CHECK(graph.image_usage[shadow] == (VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT));
+		CHECK(graph.buffer_usage[counters] == VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+		const graph_barrier_t* shadow_read = find_barrier(graph, main_pass, shadow);
+		REQUIRE(shadow_read);
+		CHECK(shadow_read->src_stage == DEPTH_STAGES);
+		CHECK(shadow_read->dst_stage == VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+		CHECK(shadow_read->new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+}
+
+TEST_CASE("A write only needs one barrier per reading stage")
+{
+	static render_graph_t graph{};
+	reset_render_graph(graph);
+
+	graph_resource_t particles = render_graph_import_buffer(graph, "particles", GRAPH_ACCESS_NONE, GRAPH_ACCESS_NONE);
+
+	graph_pass_t simulate = render_graph_add_pass(graph, "simulate", execute_nothing, nullptr);
+	render_graph_use(graph, simulate, particles, GRAPH_ACCESS_STORAGE_WRITE_COMPUTE);
+	render_graph_set_side_effects(graph, simulate);
+
+	graph_pass_t count = render_graph_add_pass(graph, "count", execute_nothing, nullptr);
+	render_graph_use(graph, count, particles, GRAPH_ACCESS_STORAGE_READ_COMPUTE);
+	render_graph_set_side_effects(graph, count);
+
+	graph_pass_t sort = render_graph_add_pass(graph, "sort", execute_nothing, nullptr);
+	render_graph_use(graph, sort, particles, GRAPH_ACCESS_STORAGE_READ_COMPUTE);
+	render_graph_set_side_effects(graph, sort);
+
+	graph_pass_t draw = render_graph_add_pass(graph, "draw", execute_nothing, nullptr);
+	render_graph_use(graph, draw, particles, GRAPH_ACCESS_STORAGE_READ_VERTEX);
+	render_graph_set_side_effects(graph, draw);
+
+	compile_render_graph(graph, nullptr);
+
+	// nothing was written before the graph, the first write has nothing to wait for
+	CHECK(pass_barrier_count(graph, simulate) == 0);
+
+	REQUIRE(pass_barrier_count(graph, count) == 1);
+	const graph_barrier_t* compute_read = find_barrier(graph, count, particles);
+	CHECK(compute_read->src_stage == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	CHECK(compute_read->src_access == (VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT));
+	CHECK(compute_read->dst_stage == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	CHECK(compute_read->dst_access == VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+
+	// read after read in the same stage: already visible
+	CHECK(pass_barrier_count(graph, sort) == 0);
+
+	// a new stage still has to wait for the write
+	REQUIRE(pass_barrier_count(graph, draw) == 1);
+	const graph_barrier_t* vertex_read = find_barrier(graph, draw, particles);
+	CHECK(vertex_read->src_stage == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+	CHECK(vertex_read->dst_stage == VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+
+	CHECK(final_barrier_count(graph) == 0);
+}
+
+TEST_CASE("Transients with disjoint lifetimes share memory")
+{
+	static render_graph_t graph{};
+	reset_render_graph(graph);
+
+	graph_resource_t backbuffer = render_graph_import_image(graph, "backbuffer", VK_IMAGE_ASPECT_COLOR_BIT, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE, GRAPH_ACCESS_PRESENT, false);
+	graph_resource_t hdr        = render_graph_create_image(graph, "hdr", VK_FORMAT_R16G16B16A16_SFLOAT, { 1920, 1080 }, VK_IMAGE_ASPECT_COLOR_BIT);
+	graph_resource_t bloom      = render_graph_create_image(graph, "bloom", VK_FORMAT_R16G16B16A16_SFLOAT, { 1920, 1080 }, VK_IMAGE_ASPECT_COLOR_BIT);
+	graph_resource_t ldr        = render_graph_create_image(graph, "ldr", VK_FORMAT_R8G8B8A8_UNORM, { 1920, 1080 }, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	graph_pass_t scene = render_graph_add_pass(graph, "scene", execute_nothing, nullptr);
+	render_graph_use(graph, scene, hdr, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+
+	graph_pass_t bright = render_graph_add_pass(graph, "bloom", execute_nothing, nullptr);
+	render_graph_use(graph, bright, hdr, GRAPH_ACCESS_SAMPLED_FRAGMENT);
+	render_graph_use(graph, bright, bloom, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+
+	graph_pass_t tonemap = render_graph_add_pass(graph, "tonemap", execute_nothing, nullptr);
+	render_graph_use(graph, tonemap, bloom, GRAPH_ACCESS_SAMPLED_FRAGMENT);
+	render_graph_use(graph, tonemap, ldr, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+
+	graph_pass_t blit = render_graph_add_pass(graph, "blit", execute_nothing, nullptr);
+	render_graph_use(graph, blit, ldr, GRAPH_ACCESS_SAMPLED_FRAGMENT);
+	render_graph_use(graph, blit, backbuffer, GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+
+	VkMemoryRequirements requirements[GRAPH_MAX_RESOURCES]{};
+	requirements[hdr]   = { 16 * 1024 * 1024, 65536, 0x3 };
+	requirements[bloom] = { 16 * 1024 * 1024, 65536, 0x6 };
+	requirements[ldr]   = {  8 * 1024 * 1024, 65536, 0x2 };
+
+	compile_render_graph(graph, requirements);
+
+	REQUIRE(graph.aliased);
+	CHECK(graph.transient_memory_types == 0x2);
+	CHECK(graph.transient_alignment == 65536);
+
+	// hdr and bloom are alive together in the bloom pass, ldr reuses hdr once it is dead
+	CHECK_FALSE(graph.alias_offset[hdr] == graph.alias_offset[bloom]);
+	CHECK(graph.alias_offset[ldr] == graph.alias_offset[hdr]);
+	CHECK(graph.transient_size == 32 * 1024 * 1024);
+
+	// ldr overwrites memory hdr was sampled from
+	const graph_barrier_t* ldr_write = find_barrier(graph, tonemap, ldr);
+	REQUIRE(ldr_write);
+	CHECK((ldr_write->src_stage & VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT) != 0);
+	CHECK(ldr_write->old_layout == VK_IMAGE_LAYOUT_UNDEFINED);
+	CHECK(ldr_write->new_layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+	// the previous execution sampled bloom last, the next write has to wait for it
+	const graph_barrier_t* bloom_write = find_barrier(graph, bright, bloom);
+	REQUIRE(bloom_write);
+	CHECK(bloom_write->src_stage == VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+	CHECK(bloom_write->src_access == VK_ACCESS_2_NONE);
+}
@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+#include "olivia/graphics/shader_reflect.h"
+
+#include <stdio.h>
+
+using namespace olivia;
+
+static bool reflect_file(const char* name, shader_reflection_t& reflection)
+{
+	char path[512];
+	snprintf(path, sizeof(path), "%s%s", SHADER_BIN_DIR, name);
+
+	FILE* file = fopen(path, "rb");
+	if (!file)
+		return false;
+
+	static uint32_t code[1 << 16];
+	size_t size = fread(code, 1, sizeof(code), file);
+	fclose(file);
+
+	return reflect_shader(code, size, reflection);
+}
+
+TEST_CASE("Vertex inputs of the mesh shader")
+{
+	static shader_reflection_t reflection{};
+	REQUIRE(reflect_file("olivia.vert.spv", reflection));
+
+	REQUIRE(reflection.stages == VK_SHADER_STAGE_VERTEX_BIT);
+	REQUIRE(reflection.input_count == 7);
+
+	// position, normal, uv per vertex, then the model matrix and color per instance
+	VkVertexInputAttributeDescription attributes[MAX_SHADER_INPUTS];
+	uint32_t stride{};
+
+	REQUIRE(get_vertex_input_attributes(reflection, 0, 0, 3, attributes, stride) == 3);
+	REQUIRE(stride == 32);
+	REQUIRE(attributes[0].format == VK_FORMAT_R32G32B32_SFLOAT);
+	REQUIRE(attributes[1].offset == 12);
+	REQUIRE(attributes[2].format == VK_FORMAT_R32G32_SFLOAT);
+	REQUIRE(attributes[2].offset == 24);
+
+	REQUIRE(get_vertex_input_attributes(reflection, 1, 3, MAX_SHADER_INPUTS, attributes, stride) == 4);
+	REQUIRE(stride == 64);
+	REQUIRE(attributes[0].binding == 1);
+	REQUIRE(attributes[0].location == 3);
+	REQUIRE(attributes[3].format == VK_FORMAT_R32G32B32A32_SFLOAT);
+	REQUIRE(attributes[3].offset == 48);
+}
+
+TEST_CASE("Bindings and push constants of a compute shader")
+{
+	static shader_reflection_t reflection{};
+	REQUIRE(reflect_file("skinning.comp.spv", reflection));
+
+	REQUIRE(reflection.stages == VK_SHADER_STAGE_COMPUTE_BIT);
+	REQUIRE(reflection.local_size[0] == 64);
+	REQUIRE(reflection.local_size[1] == 1);
+
+	REQUIRE(reflection.binding_count == 4);
+	for (uint32_t binding = 0; binding < 4; ++binding)
+	{
+		const shader_binding_t* found = find_shader_binding(reflection, 0, binding);
+
+		REQUIRE(found);
+		REQUIRE(found->type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		REQUIRE(found->count == 1);
+		REQUIRE(found->stages == VK_SHADER_STAGE_COMPUTE_BIT);
+	}
+
+	REQUIRE(reflection.push_constant_size == 5 * sizeof(uint32_t));
+	REQUIRE(reflection.push_constant_stages == VK_SHADER_STAGE_COMPUTE_BIT);
+	REQUIRE(reflection.input_count == 0);
+}
+
+TEST_CASE("Specialization constants")
+{
+	static shader_reflection_t reflection{};
+	REQUIRE(reflect_file("particle.vert.spv", reflection));
+
+	REQUIRE(has_spec_constant(reflection, 0));
+	REQUIRE(!has_spec_constant(reflection, 1));
+	REQUIRE(reflection.spec_constants[0].default_value == 0);
+}
+
+TEST_CASE("Merged reflections and layout compatibility")
+{
+	static shader_reflection_t vertex{};
+	static shader_reflection_t fragment{};
+	static shader_reflection_t simulate{};
+
+	REQUIRE(reflect_file("particle.vert.spv", vertex));
+	REQUIRE(reflect_file("particle.frag.spv", fragment));
+	REQUIRE(reflect_file("particle_simulate.comp.spv", simulate));
+
+	static shader_reflection_t draw{};
+	merge_shader_reflection(draw, vertex);
+	merge_shader_reflection(draw, fragment);
+
+	REQUIRE(draw.stages == (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+	REQUIRE(draw.input_count == 0);
+	REQUIRE(is_layout_compatible(draw, vertex));
+	REQUIRE(is_layout_compatible(draw, fragment));
+
+	// the compute stage is missing from the draw layout
+	REQUIRE(!is_layout_compatible(draw, simulate));
+
+	static shader_reflection_t all{};
+	merge_shader_reflection(all, draw);
+	merge_shader_reflection(all, simulate);
+
+	REQUIRE(is_layout_compatible(all, simulate));
+	REQUIRE(is_layout_compatible(all, vertex));
+
+	for (uint32_t i = 0; i < vertex.binding_count; ++i)
+	{
+		const shader_binding_t* merged = find_shader_binding(all, vertex.bindings[i].set, vertex.bindings[i].binding);
+
+		REQUIRE(merged);
+		REQUIRE((merged->stages & VK_SHADER_STAGE_VERTEX_BIT));
+	}
+
+	// a binding that changed type needs a new layout
+	static shader_reflection_t changed{};
+	changed = simulate;
+	changed.bindings[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+	REQUIRE(!is_layout_compatible(all, changed));
+
+	// as do larger push constants
+	changed = simulate;
+	changed.push_constant_size = all.push_constant_size + 16;
+
+	REQUIRE(!is_layout_compatible(all, changed));
+}
+
+TEST_CASE("Not SPIR-V")
+{
+	static shader_reflection_t reflection{};
+
+	const uint32_t garbage[]{ 0xDEADBEEF, 0x00010000, 0, 16, 0 };
+	REQUIRE(!reflect_shader(garbage, sizeof(garbage), reflection));
+
+	// a header with no instructions declares no stage
+	const uint32_t header[]{ SPIRV_MAGIC, 0x00010000, 0, 16, 0 };
+	REQUIRE(!reflect_shader(header, sizeof(header), reflection));
+
+	REQUIRE(!reflect_shader(header, 12, reflection));
+}
@@ -23,4 +23,24 @@ TEST_CASE("Vector works")
 	printf("]\n");
 
 	olivia::destroy_vector(vec);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Vector grows past its capacity")
+{
+	auto vec = olivia::create_vector<uint32_t>(2);
+
+	for (uint32_t i = 0; i < 100; ++i)
+	{
+		olivia::vector_push_back(vec, i);
+	}
+
+	REQUIRE(vec.size == 100);
+	REQUIRE(vec.capacity >= 100);
+
+	for (uint32_t i = 0; i < 100; ++i)
+	{
+		REQUIRE(vec.data[i] == i);
+	}
+
+	olivia::destroy_vector(vec);
+}